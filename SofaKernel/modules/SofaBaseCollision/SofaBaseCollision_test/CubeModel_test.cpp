@@ -0,0 +1,232 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaBaseCollision/CubeModel.h>
+using sofa::component::collision::Cube;
+using sofa::component::collision::CubeCollisionModel;
+
+#include <SofaBaseCollision/LinearBVH.h>
+namespace lbvh = sofa::component::collision::lbvh;
+
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+namespace
+{
+
+using sofa::type::Vector3;
+
+std::vector<std::pair<Vector3, Vector3> > generateBoxes(std::size_t n, unsigned int seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<SReal> position(-10, 10);
+    std::uniform_real_distribution<SReal> extent(0, 0.5);
+    std::vector<std::pair<Vector3, Vector3> > boxes(n);
+    for (auto& box : boxes)
+    {
+        box.first = Vector3(position(gen), position(gen), position(gen));
+        box.second = box.first + Vector3(extent(gen), extent(gen), extent(gen));
+    }
+    return boxes;
+}
+
+/// Check that each cell contains its subcells, and count the leaf cubes below the cell
+void checkCell(const Cube& cell, const CubeCollisionModel* leaves, std::vector<int>& nbVisits)
+{
+    const std::pair<Cube, Cube>& subcells = cell.subcells();
+    if (subcells.first == subcells.second)
+    {
+        ASSERT_EQ(cell.getCollisionModel(), leaves);
+        ++nbVisits[leaves->getLeafIndex(cell.getIndex())];
+        return;
+    }
+    for (Cube c = subcells.first; c != subcells.second; ++c)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            EXPECT_LE(cell.minVect()[i], c.minVect()[i]);
+            EXPECT_GE(cell.maxVect()[i], c.maxVect()[i]);
+        }
+        checkCell(c, leaves, nbVisits);
+    }
+}
+
+void checkTree(CubeCollisionModel* leaves, const std::vector<std::pair<Vector3, Vector3> >& boxes)
+{
+    std::vector<int> nbVisits(boxes.size(), 0);
+    auto* root = dynamic_cast<CubeCollisionModel*>(leaves->getFirst());
+    ASSERT_NE(root, nullptr);
+    ASSERT_EQ(root->getSize(), 1u);
+    checkCell(Cube(root, 0), leaves, nbVisits);
+    for (std::size_t i = 0; i < boxes.size(); ++i)
+    {
+        EXPECT_EQ(nbVisits[i], 1) << i;
+    }
+    for (sofa::Index i = 0; i < leaves->getSize(); ++i)
+    {
+        const sofa::Index element = leaves->getLeafIndex(i);
+        EXPECT_EQ(Cube(leaves, i).minVect(), boxes[element].first);
+        EXPECT_EQ(Cube(leaves, i).maxVect(), boxes[element].second);
+    }
+}
+
+CubeCollisionModel::SPtr createLeaves(const std::vector<std::pair<Vector3, Vector3> >& boxes)
+{
+    auto leaves = sofa::core::objectmodel::New<CubeCollisionModel>();
+    leaves->resize(sofa::Size(boxes.size()));
+    for (std::size_t i = 0; i < boxes.size(); ++i)
+        leaves->setParentOf(sofa::Index(i), boxes[i].first, boxes[i].second);
+    return leaves;
+}
+
+} // namespace
+
+namespace sofa
+{
+
+TEST(LinearBVH, radixSortIsStable)
+{
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<std::uint32_t> code(0, (1u << 30) - 1);
+    std::uniform_int_distribution<std::uint32_t> smallCode(0, 1000);
+
+    for (std::size_t n : {std::size_t(0), std::size_t(1), std::size_t(100), std::size_t(50000)})
+    {
+        type::vector<std::uint32_t> codes(n);
+        for (std::size_t i = 0; i < n; ++i)
+            codes[i] = (i % 2) ? code(gen) : smallCode(gen); // many duplicates
+
+        std::vector<Index> expected(n);
+        std::iota(expected.begin(), expected.end(), Index(0));
+        std::stable_sort(expected.begin(), expected.end(), [&codes](Index a, Index b) { return codes[a] < codes[b]; });
+
+        type::vector<std::uint32_t> sorted = codes;
+        type::vector<Index> order;
+        lbvh::radixSort(sorted, order);
+        ASSERT_EQ(order.size(), n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            EXPECT_EQ(order[i], expected[i]);
+            EXPECT_EQ(sorted[i], codes[expected[i]]);
+        }
+    }
+}
+
+TEST(LinearBVH, findSplit)
+{
+    const type::vector<std::uint32_t> codes { 0b0001, 0b0010, 0b0100, 0b0101, 0b0111, 0b1000 };
+    EXPECT_EQ(lbvh::findSplit(codes, 0, 6), 5u);
+    EXPECT_EQ(lbvh::findSplit(codes, 0, 5), 2u);
+    EXPECT_EQ(lbvh::findSplit(codes, 2, 5), 4u);
+
+    const type::vector<std::uint32_t> same(8, 42u);
+    EXPECT_EQ(lbvh::findSplit(same, 0, 8), 4u);
+}
+
+TEST(LinearBVH, mortonCodeOrder)
+{
+    const Vector3 minBBox(0, 0, 0), maxBBox(1, 1, 1);
+    EXPECT_EQ(lbvh::mortonCode(minBBox, minBBox, maxBBox), 0u);
+    EXPECT_EQ(lbvh::mortonCode(maxBBox, minBBox, maxBBox), (1u << 30) - 1);
+    EXPECT_EQ(lbvh::mortonCode(Vector3(1, 0, 0), minBBox, maxBBox), 0b100100100100100100100100100100u);
+    EXPECT_LT(lbvh::mortonCode(Vector3(0.4, 0.4, 0.4), minBBox, maxBBox), lbvh::mortonCode(Vector3(0.6, 0.6, 0.6), minBBox, maxBBox));
+}
+
+TEST(CubeCollisionModel, parallelBuild)
+{
+    using simulation::TaskScheduler;
+    const auto boxes = generateBoxes(20000, 3);
+
+    // without a running task scheduler, the tree is built sequentially, without creating one
+    const bool hasScheduler = TaskScheduler::getCurrentInstance() != nullptr;
+    auto sequential = createLeaves(boxes);
+    sequential->computeBoundingTree(8);
+    if (!hasScheduler)
+        EXPECT_EQ(TaskScheduler::getCurrentInstance(), nullptr);
+
+    TaskScheduler::getInstance()->init(4);
+    auto parallel = createLeaves(boxes);
+    parallel->computeBoundingTree(8);
+    TaskScheduler::getInstance()->stop();
+
+    checkTree(parallel.get(), boxes);
+    ASSERT_EQ(parallel->getSize(), sequential->getSize());
+    for (Index i = 0; i < sequential->getSize(); ++i)
+        EXPECT_EQ(parallel->getLeafIndex(i), sequential->getLeafIndex(i));
+    const Cube sequentialRoot(dynamic_cast<CubeCollisionModel*>(sequential->getFirst()), 0);
+    const Cube parallelRoot(dynamic_cast<CubeCollisionModel*>(parallel->getFirst()), 0);
+    EXPECT_EQ(parallelRoot.minVect(), sequentialRoot.minVect());
+    EXPECT_EQ(parallelRoot.maxVect(), sequentialRoot.maxVect());
+}
+
+TEST(CubeCollisionModel, buildAndRefit)
+{
+    auto* taskScheduler = simulation::TaskScheduler::getInstance();
+    if (taskScheduler->getThreadCount() < 1)
+        taskScheduler->init(4);
+
+    auto boxes = generateBoxes(5000, 1);
+    auto leaves = createLeaves(boxes);
+    leaves->computeBoundingTree(6);
+    checkTree(leaves.get(), boxes);
+
+    std::vector<Index> leafOrder(boxes.size());
+    for (Index i = 0; i < leaves->getSize(); ++i)
+        leafOrder[i] = leaves->getLeafIndex(i);
+
+    // deform: the tree is only refitted
+    auto* root = leaves->getFirst();
+    for (auto& box : boxes)
+    {
+        box.first *= 1.5;
+        box.second = box.first + (box.second - box.first) * 0.5;
+    }
+    for (std::size_t i = 0; i < boxes.size(); ++i)
+        leaves->setParentOf(Index(i), boxes[i].first, boxes[i].second);
+    leaves->computeBoundingTree(6);
+    EXPECT_EQ(leaves->getFirst(), root);
+    checkTree(leaves.get(), boxes);
+    for (Index i = 0; i < leaves->getSize(); ++i)
+        EXPECT_EQ(leaves->getLeafIndex(i), leafOrder[i]);
+
+    // rebuild at each call
+    leaves->setRefitOnly(false);
+    boxes = generateBoxes(boxes.size(), 2);
+    for (std::size_t i = 0; i < boxes.size(); ++i)
+        leaves->setParentOf(Index(i), boxes[i].first, boxes[i].second);
+    leaves->computeBoundingTree(6);
+    checkTree(leaves.get(), boxes);
+}
+
+TEST(CubeCollisionModel, identicalBoxes)
+{
+    const std::vector<std::pair<Vector3, Vector3> > boxes(100, {Vector3(1, 1, 1), Vector3(2, 2, 2)});
+    auto leaves = createLeaves(boxes);
+    leaves->computeBoundingTree(4);
+    checkTree(leaves.get(), boxes);
+}
+
+} // namespace sofa
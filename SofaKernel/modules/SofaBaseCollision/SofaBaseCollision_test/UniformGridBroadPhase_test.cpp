@@ -0,0 +1,144 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaBaseCollision/BruteForceBroadPhase.h>
+using sofa::component::collision::BruteForceBroadPhase;
+
+#include <SofaBaseCollision/UniformGridBroadPhase.h>
+using sofa::component::collision::UniformGridBroadPhase;
+
+#include <SofaBaseCollision/MinProximityIntersection.h>
+using sofa::component::collision::MinProximityIntersection;
+
+#include <SofaSimulationCommon/SceneLoaderXML.h>
+using sofa::simulation::SceneLoaderXML;
+
+#include <sofa/simulation/Node.h>
+using sofa::simulation::Node;
+
+#include <sofa/testing/BaseSimulationTest.h>
+using sofa::testing::BaseSimulationTest;
+
+#include <random>
+#include <sstream>
+
+namespace sofa
+{
+
+struct UniformGridBroadPhase_test : public BaseSimulationTest
+{
+    Node::SPtr root;
+    MinProximityIntersection::SPtr intersection;
+    type::vector<core::CollisionModel*> models;
+
+    /// Create groups of spheres, some of them colliding with themselves, and a large model
+    void createScene(unsigned int nbModels)
+    {
+        std::mt19937 gen(7);
+        std::uniform_real_distribution<SReal> position(0, 20);
+        std::uniform_real_distribution<SReal> offset(-0.3, 0.3);
+
+        std::stringstream scene;
+        scene << "<?xml version='1.0'?><Node name='Root'>";
+        for (unsigned int i = 0; i < nbModels; ++i)
+        {
+            const type::Vector3 center(position(gen), position(gen), position(gen) * 0.2);
+            scene << "<Node name='Object" << i << "'><MechanicalObject template='Vec3d' position='";
+            for (int p = 0; p < 4; ++p)
+                scene << center + type::Vector3(offset(gen), offset(gen), offset(gen)) << " ";
+            scene << "'/><SphereCollisionModel radius='0.2' selfCollision='" << (i % 5 == 0) << "'/></Node>";
+        }
+        scene << "<Node name='Floor'><MechanicalObject template='Vec3d' position='-5 -5 -0.5  25 -5 -0.5  -5 25 -0.5  25 25 -0.5'/>"
+                 "<SphereCollisionModel radius='0.1' simulated='0' moving='0'/></Node>";
+        scene << "</Node>";
+
+        root = SceneLoaderXML::loadFromMemory("testscene", scene.str().c_str(), scene.str().size());
+        ASSERT_NE(root.get(), nullptr);
+        root->init(core::execparams::defaultInstance());
+
+        intersection = core::objectmodel::New<MinProximityIntersection>();
+        intersection->setAlarmDistance(0.3);
+        intersection->setContactDistance(0.1);
+
+        type::vector<core::CollisionModel*> leaves;
+        root->getTreeObjects<core::CollisionModel>(&leaves);
+        models.clear();
+        for (auto* cm : leaves)
+        {
+            cm->computeBoundingTree(0);
+            models.push_back(cm->getFirst());
+        }
+    }
+
+    type::vector<core::collision::BroadPhaseDetection::CollisionModelPair> detect(core::collision::BroadPhaseDetection* broadPhase)
+    {
+        broadPhase->setIntersectionMethod(intersection.get());
+        broadPhase->beginBroadPhase();
+        broadPhase->addCollisionModels(models);
+        broadPhase->endBroadPhase();
+        return broadPhase->getCollisionModelPairs();
+    }
+
+    void TearDown() override
+    {
+        if (root)
+            simulation::getSimulation()->unload(root);
+    }
+};
+
+TEST_F(UniformGridBroadPhase_test, samePairsAsBruteForce)
+{
+    createScene(400);
+
+    auto bruteForce = core::objectmodel::New<BruteForceBroadPhase>();
+    bruteForce->init();
+    const auto expected = detect(bruteForce.get());
+    ASSERT_GT(expected.size(), models.size() / 5);
+
+    auto grid = core::objectmodel::New<UniformGridBroadPhase>();
+    grid->init();
+    EXPECT_EQ(detect(grid.get()), expected);
+    EXPECT_GT(grid->getCurrentCellSize(), 0);
+
+    // a second step, reusing the buffers
+    EXPECT_EQ(detect(grid.get()), expected);
+
+    // small cells: many models are tested as large models
+    grid->d_cellSize.setValue(0.05);
+    grid->d_maxCellsPerModel.setValue(8);
+    EXPECT_EQ(detect(grid.get()), expected);
+
+    // huge cells: all the models in the same cell
+    grid->d_cellSize.setValue(100);
+    EXPECT_EQ(detect(grid.get()), expected);
+}
+
+TEST_F(UniformGridBroadPhase_test, fewModels)
+{
+    createScene(1);
+    auto grid = core::objectmodel::New<UniformGridBroadPhase>();
+    grid->init();
+    auto bruteForce = core::objectmodel::New<BruteForceBroadPhase>();
+    bruteForce->init();
+    EXPECT_EQ(detect(grid.get()), detect(bruteForce.get()));
+}
+
+} // namespace sofa
@@ -88,39 +88,44 @@ void BruteForceBroadPhase::addCollisionModel (core::CollisionModel *cm)
     // Browse all other collision models to check if there is a potential collision (conservative check)
     for (const auto& model : m_collisionModels)
     {
-        auto* cm2 = model.firstCollisionModel;
-        auto* finalCm2 = model.lastCollisionModel;
+        addCollisionPairIfIntersecting(cm, finalCollisionModel, model);
+    }
 
-        // ignore this pair if both are NOT simulated (inactive)
-        if (!cm->isSimulated() && !cm2->isSimulated())
-        {
-            continue;
-        }
+    //accumulate CollisionModel's in a vector so the next CollisionModel can be tested against all previous ones
+    m_collisionModels.emplace_back(cm, finalCollisionModel);
+}
 
-        if (!keepCollisionBetween(finalCollisionModel, finalCm2))
-            continue;
+void BruteForceBroadPhase::addCollisionPairIfIntersecting(core::CollisionModel* cm, core::CollisionModel* finalCollisionModel, const FirstLastCollisionModel& model)
+{
+    auto* cm2 = model.firstCollisionModel;
+    auto* finalCm2 = model.lastCollisionModel;
 
-        bool swapModels = false;
-        core::collision::ElementIntersector* intersector = intersectionMethod->findIntersector(cm, cm2, swapModels);
-        if (intersector == nullptr)
-            continue;
+    // ignore this pair if both are NOT simulated (inactive)
+    if (!cm->isSimulated() && !cm2->isSimulated())
+    {
+        return;
+    }
 
-        core::CollisionModel* cm1 = cm;
-        if (swapModels)
-        {
-            std::swap(cm1, cm2);
-        }
+    if (!keepCollisionBetween(finalCollisionModel, finalCm2))
+        return;
 
-        // Here we assume a single root element is present in both models
-        if (intersector->canIntersect(cm1->begin(), cm2->begin()))
-        {
-            //both collision models will be further examined in the narrow phase
-            cmPairs.emplace_back(cm1, cm2);
-        }
+    bool swapModels = false;
+    core::collision::ElementIntersector* intersector = intersectionMethod->findIntersector(cm, cm2, swapModels);
+    if (intersector == nullptr)
+        return;
+
+    core::CollisionModel* cm1 = cm;
+    if (swapModels)
+    {
+        std::swap(cm1, cm2);
     }
 
-    //accumulate CollisionModel's in a vector so the next CollisionModel can be tested against all previous ones
-    m_collisionModels.emplace_back(cm, finalCollisionModel);
+    // Here we assume a single root element is present in both models
+    if (intersector->canIntersect(cm1->begin(), cm2->begin()))
+    {
+        //both collision models will be further examined in the narrow phase
+        cmPairs.emplace_back(cm1, cm2);
+    }
 }
 
 bool BruteForceBroadPhase::keepCollisionBetween(core::CollisionModel *cm1, core::CollisionModel *cm2)
@@ -96,6 +96,10 @@ protected:
         FirstLastCollisionModel(core::CollisionModel* a, core::CollisionModel* b) : firstCollisionModel(a), lastCollisionModel(b) {}
     };
 
+    /// Add the pair made of the collision model cm (whose last collision model is finalCollisionModel) and a
+    /// previously added collision model, if they can intersect
+    void addCollisionPairIfIntersecting(core::CollisionModel* cm, core::CollisionModel* finalCollisionModel, const FirstLastCollisionModel& model);
+
     /// vector of accumulated CollisionModel's when the collision pipeline asks
     /// to add a CollisionModel in BruteForceBroadPhase::addCollisionModel
     /// This vector is emptied at each time step in BruteForceBroadPhase::beginBroadPhase
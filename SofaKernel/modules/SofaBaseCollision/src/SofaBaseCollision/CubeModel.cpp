@@ -20,11 +20,14 @@
 * Contact information: contact@sofa-framework.org                             *
 ******************************************************************************/
 #include <SofaBaseCollision/CubeModel.h>
+#include <SofaBaseCollision/LinearBVH.h>
 
 #include <sofa/core/visual/VisualParams.h>
 #include <sofa/helper/visual/DrawTool.h>
 #include <sofa/core/ObjectFactory.h>
+#include <sofa/simulation/ParallelForEach.h>
 #include <algorithm>
+#include <limits>
 
 namespace sofa::component::collision
 {
@@ -32,6 +35,27 @@ namespace sofa::component::collision
 using namespace sofa::type;
 using namespace sofa::defaulttype;
 
+namespace
+{
+
+/// Loop over [0, n). The collision pipeline does not create a task scheduler by itself, so the loop
+/// only runs in parallel when the scene already initialized one on several threads.
+template<class Function>
+void forEachCube(Index n, const Function& f)
+{
+    if (simulation::hasParallelTaskScheduler())
+    {
+        simulation::parallelForEach(Index(0), n, f);
+        return;
+    }
+    for (Index i = 0; i < n; ++i)
+    {
+        f(i);
+    }
+}
+
+} // namespace
+
 int CubeCollisionModelClass = core::RegisterObject("Collision model representing a cube")
         .add< CubeCollisionModel >()
         ;
@@ -99,6 +123,13 @@ void CubeCollisionModel::setLeafCube(Index cubeIndex, std::pair<core::CollisionE
 }
 
 Index CubeCollisionModel::addCube(Cube subcellsBegin, Cube subcellsEnd)
+{
+    const Index index = appendCube(subcellsBegin, subcellsEnd);
+    updateCube(index);
+    return index;
+}
+
+Index CubeCollisionModel::appendCube(Cube subcellsBegin, Cube subcellsEnd)
 {
     Index index = size;
 
@@ -109,7 +140,6 @@ Index CubeCollisionModel::addCube(Cube subcellsBegin, Cube subcellsEnd)
     elems[index].subcells.second = subcellsEnd;
     elems[index].children.first = core::CollisionElementIterator();
     elems[index].children.second = core::CollisionElementIterator();
-    updateCube(index);
     return index;
 }
 
@@ -158,8 +188,45 @@ void CubeCollisionModel::updateCube(Index index)
 
 void CubeCollisionModel::updateCubes()
 {
-    for (Index i=0; i<size; i++)
+    // the cubes of a level only depend on the cubes of the next level
+    forEachCube(Index(size), [this](Index i)
+    {
         updateCube(i);
+    });
+}
+
+void CubeCollisionModel::sortLeafCubes()
+{
+    using BBox = std::pair<Vector3, Vector3>;
+    const BBox emptyBBox(Vector3(std::numeric_limits<SReal>::max(), std::numeric_limits<SReal>::max(), std::numeric_limits<SReal>::max()),
+                         Vector3(std::numeric_limits<SReal>::lowest(), std::numeric_limits<SReal>::lowest(), std::numeric_limits<SReal>::lowest()));
+
+    // bounding box of the centers of the leaf cubes
+    BBox centers = emptyBBox;
+    for (Index i = 0; i < Index(size); ++i)
+    {
+        const Vector3 center = (elems[i].minBBox + elems[i].maxBBox) * 0.5;
+        for (int c = 0; c < 3; ++c)
+        {
+            centers.first[c] = std::min(centers.first[c], center[c]);
+            centers.second[c] = std::max(centers.second[c], center[c]);
+        }
+    }
+
+    m_mortonCodes.resize(size);
+    forEachCube(Index(size), [this, &centers](Index i)
+    {
+        m_mortonCodes[i] = lbvh::mortonCode((elems[i].minBBox + elems[i].maxBBox) * 0.5, centers.first, centers.second);
+    });
+
+    lbvh::radixSort(m_mortonCodes, m_sortedLeaves);
+
+    sofa::type::vector<CubeData> sorted(size);
+    forEachCube(Index(size), [this, &sorted](Index i)
+    {
+        sorted[i] = elems[m_sortedLeaves[i]];
+    });
+    elems.swap(sorted);
 }
 
 void CubeCollisionModel::draw(const core::visual::VisualParams* vparams)
@@ -246,7 +313,7 @@ void CubeCollisionModel::computeBoundingTree(int maxDepth)
         levels.push_front(levels.front()->createPrevious<CubeCollisionModel>());
     CubeCollisionModel* root = levels.front();
 
-    if (root->empty() || root->getPrevious() != nullptr)
+    if (root->empty() || root->getPrevious() != nullptr || !m_refitOnly)
     {
         // Tree must be reconstructed
         dmsg_info() << "Building Tree with depth " << maxDepth << " from " << size << " elements.";
@@ -266,10 +333,13 @@ void CubeCollisionModel::computeBoundingTree(int maxDepth)
                 level->resize(0);
         }
 
+        // Sort the leaf cubes along the Morton curve
+        sortLeafCubes();
+
         // Then build root cell
         dmsg_info() << "CubeCollisionModel: add root cube";
-        root->addCube(Cube(this,0),Cube(this,size));
-        // Construct tree by splitting cells along their biggest dimension
+        root->appendCube(Cube(this,0),Cube(this,size));
+        // Construct tree by splitting cells along the Morton curve
         auto it = levels.begin();
         CubeCollisionModel* level = *it;
         ++it;
@@ -287,30 +357,13 @@ void CubeCollisionModel::computeBoundingTree(int maxDepth)
                 if (ncells > 4)
                 {
                     // Only split cells with more than 4 childs
-                    // Find the biggest dimension
-                    int splitAxis;
-                    Vector3 l = cell.maxVect()-cell.minVect();
-                    Index middle = subcells.first.getIndex()+(ncells+1)/2;
-                    if(l[0]>l[1])
-                        if (l[0]>l[2])
-                            splitAxis = 0;
-                        else
-                            splitAxis = 2;
-                    else if (l[1]>l[2])
-                        splitAxis = 1;
-                    else
-                        splitAxis = 2;
-
-                    // Separate cells on each side of the median cell
-                    CubeSortPredicate sortpred(splitAxis);
-                    std::sort(elems.begin() + subcells.first.getIndex(), elems.begin() + subcells.second.getIndex(), sortpred);
+                    const Index middle = lbvh::findSplit(m_mortonCodes, subcells.first.getIndex(), subcells.second.getIndex());
 
                     // Create the two new subcells
                     Cube cmiddle(this, middle);
-                    Index c1 = clevel->addCube(subcells.first, cmiddle);
-                    Index c2 = clevel->addCube(cmiddle, subcells.second);
-                    dmsg_info() << "L" << lvl << " cell " << cell.getIndex() << " split along " << (splitAxis == 0 ? 'X' : splitAxis == 1 ? 'Y' : 'Z') << " in cell " << c1 << " size " << middle - subcells.first.getIndex() << " and cell " << c2 << " size " << subcells.second.getIndex() - middle << ".";
-                    //level->elems[cell.getIndex()].subcells = std::make_pair(Cube(clevel,c1),Cube(clevel,c2+1));
+                    Index c1 = clevel->appendCube(subcells.first, cmiddle);
+                    Index c2 = clevel->appendCube(cmiddle, subcells.second);
+                    dmsg_info() << "L" << lvl << " cell " << cell.getIndex() << " split in cell " << c1 << " size " << middle - subcells.first.getIndex() << " and cell " << c2 << " size " << subcells.second.getIndex() - middle << ".";
                     level->elems[cell.getIndex()].subcells.first = Cube(clevel,c1);
                     level->elems[cell.getIndex()].subcells.second = Cube(clevel,c2+1);
                 }
@@ -321,10 +374,15 @@ void CubeCollisionModel::computeBoundingTree(int maxDepth)
         }
         if (!parentOf.empty())
         {
-            // Finally update parentOf to reflect new cell order
-            for (Size i=0; i<size; i++)
+            // Update parentOf to reflect new cell order
+            forEachCube(Index(size), [this](Index i)
+            {
                 parentOf[elems[i].children.first.getIndex()] = i;
+            });
         }
+        // Finally compute the bounding boxes, starting from the bottom
+        for (auto lit = levels.rbegin(); lit != levels.rend(); ++lit)
+            (*lit)->updateCubes();
     }
     else
     {
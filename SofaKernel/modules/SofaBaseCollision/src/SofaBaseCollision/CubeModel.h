@@ -25,6 +25,8 @@
 #include <sofa/core/CollisionModel.h>
 #include <sofa/defaulttype/VecTypes.h>
 
+#include <cstdint>
+
 namespace sofa::component::collision
 {
 
@@ -81,6 +83,10 @@ protected:
     sofa::type::vector<CubeData> elems;
     sofa::type::vector<Index> parentOf; ///< Given the index of a child leaf element, store the index of the parent cube
 
+    bool m_refitOnly { true }; ///< Keep the tree and only update the bounding boxes, as long as the number of elements does not change
+    sofa::type::vector<std::uint32_t> m_mortonCodes; ///< Morton codes of the leaf cubes, used to build the tree
+    sofa::type::vector<Index> m_sortedLeaves; ///< Leaf cubes sorted by Morton code, used to build the tree
+
 public:
     typedef core::CollisionElementIterator ChildIterator;
     typedef sofa::defaulttype::Vec3Types DataTypes;
@@ -119,15 +125,22 @@ public:
 
     const CubeData & getCubeData(Index index)const{return elems[index];}
 
+    /// If true (default), an existing tree is only refitted to the new bounding boxes of the elements, as long as
+    /// their number does not change: this is enough for deforming meshes whose connectivity does not change.
+    /// If false, the tree is rebuilt at each call to computeBoundingTree.
+    void setRefitOnly(bool refitOnly) { m_refitOnly = refitOnly; }
+    bool isRefitOnly() const { return m_refitOnly; }
+
     // -- CollisionModel interface
 
     /**
       *Here we make up the hierarchy (a tree) of bounding boxes which contain final CollisionElements like Spheres or Triangles.
-      *The leafs of the tree contain final CollisionElements. This hierarchy is made up from the top to the bottom, i.e., we begin
-      *to compute a bounding box containing all CollisionElements, then we divide this big bounding box into two boxes.
-      *These new two boxes inherit from the root box and have depth 1. Then we can do the same operation for the new boxes.
-      *The division is done only if the box contains more than 4 final CollisionElements and if the depth doesn't exceed
-      *the max depth. The division is made along an axis. This axis corresponds to the biggest dimension of the current bounding box.
+      *The leafs of the tree contain final CollisionElements. This hierarchy is a linear BVH: the leaf boxes are sorted
+      *along a Morton curve of their centers, then the tree is made up from the top to the bottom by splitting the range of
+      *sorted boxes of a cell where the highest bit of the Morton codes changes (i.e. in the middle of the cell along the
+      *Morton curve). The division is done only if the box contains more than 4 final CollisionElements and if the depth
+      *doesn't exceed the max depth. The bounding boxes of the cells are then computed from the bottom to the top.
+      *Once built, the tree is only refitted from the bottom to the top if the number of elements does not change (see setRefitOnly).
       *Note : a bounding box is a Cube here.
       */
     void computeBoundingTree(int maxDepth=0) override;
@@ -143,6 +156,13 @@ public:
     Index addCube(Cube subcellsBegin, Cube subcellsEnd);
     void updateCube(Index index);
     void updateCubes();
+
+protected:
+    /// Add a cube without computing its bounding box
+    Index appendCube(Cube subcellsBegin, Cube subcellsEnd);
+
+    /// Sort the leaf cubes by Morton code of their centers
+    void sortLeafCubes();
 };
 
 inline Cube::Cube(CubeCollisionModel* model, Index index)
@@ -0,0 +1,155 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaBaseCollision/LinearBVH.h>
+
+#include <sofa/simulation/ParallelForEach.h>
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+namespace sofa::component::collision::lbvh
+{
+
+std::uint32_t expandBits(std::uint32_t v)
+{
+    v &= 0x000003FFu;
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+std::uint32_t mortonCode(const type::Vector3& p, const type::Vector3& minBBox, const type::Vector3& maxBBox)
+{
+    constexpr SReal cells = SReal(1u << MortonBitsPerAxis);
+    std::uint32_t code = 0;
+    for (unsigned int c = 0; c < 3; ++c)
+    {
+        const SReal extent = maxBBox[c] - minBBox[c];
+        const SReal x = (extent > 0) ? (p[c] - minBBox[c]) / extent * cells : SReal(0);
+        const auto q = static_cast<std::uint32_t>(std::clamp<SReal>(x, 0, cells - 1));
+        code |= expandBits(q) << (2 - c);
+    }
+    return code;
+}
+
+void radixSort(type::vector<std::uint32_t>& codes, type::vector<sofa::Index>& order)
+{
+    const std::size_t n = codes.size();
+    order.resize(n);
+    std::iota(order.begin(), order.end(), sofa::Index(0));
+    if (n < 2) return;
+
+    constexpr unsigned int RadixBits = 8;
+    constexpr std::size_t Radix = std::size_t(1) << RadixBits;
+    constexpr std::size_t ChunkSize = 16384;
+    const std::size_t nbChunks = (n + ChunkSize - 1) / ChunkSize;
+
+    type::vector<std::uint32_t> sortedCodes(n);
+    type::vector<sofa::Index> sortedOrder(n);
+    std::vector<std::array<std::size_t, Radix> > offsets(nbChunks);
+
+    // the chunks are only sorted in parallel if the scene already runs a task scheduler on several threads
+    const bool parallel = simulation::hasParallelTaskScheduler();
+    const auto forEachChunk = [parallel, nbChunks](const auto& f)
+    {
+        if (parallel)
+        {
+            simulation::parallelForEach(std::size_t(0), nbChunks, f, 1);
+            return;
+        }
+        for (std::size_t chunk = 0; chunk < nbChunks; ++chunk)
+        {
+            f(chunk);
+        }
+    };
+
+    for (unsigned int shift = 0; shift < 3 * MortonBitsPerAxis; shift += RadixBits)
+    {
+        // histogram of the digits of each chunk
+        forEachChunk([&](std::size_t chunk)
+        {
+            auto& histogram = offsets[chunk];
+            histogram.fill(0);
+            const std::size_t end = std::min(n, (chunk + 1) * ChunkSize);
+            for (std::size_t i = chunk * ChunkSize; i < end; ++i)
+                ++histogram[(codes[i] >> shift) & (Radix - 1)];
+        });
+
+        // first position of each digit in each chunk, the chunks being kept in order for a given digit
+        std::size_t position = 0;
+        bool singleDigit = false;
+        for (std::size_t digit = 0; digit < Radix; ++digit)
+        {
+            const std::size_t digitBegin = position;
+            for (auto& histogram : offsets)
+            {
+                const std::size_t count = histogram[digit];
+                histogram[digit] = position;
+                position += count;
+            }
+            singleDigit = singleDigit || (position - digitBegin == n);
+        }
+        if (singleDigit) continue; // this pass would not change the order
+
+        forEachChunk([&](std::size_t chunk)
+        {
+            auto& next = offsets[chunk];
+            const std::size_t end = std::min(n, (chunk + 1) * ChunkSize);
+            for (std::size_t i = chunk * ChunkSize; i < end; ++i)
+            {
+                const std::size_t p = next[(codes[i] >> shift) & (Radix - 1)]++;
+                sortedCodes[p] = codes[i];
+                sortedOrder[p] = order[i];
+            }
+        });
+
+        codes.swap(sortedCodes);
+        order.swap(sortedOrder);
+    }
+}
+
+sofa::Index findSplit(const type::vector<std::uint32_t>& codes, sofa::Index first, sofa::Index last)
+{
+    const std::uint32_t firstCode = codes[first];
+    const std::uint32_t lastCode = codes[last - 1];
+    if (firstCode == lastCode)
+        return first + (last - first) / 2;
+
+    // highest differing bit: the codes of the range share the higher bits, and are sorted, so this bit is 0 in
+    // the first half of the range and 1 in the second half
+    std::uint32_t mask = firstCode ^ lastCode;
+    mask |= mask >> 1;
+    mask |= mask >> 2;
+    mask |= mask >> 4;
+    mask |= mask >> 8;
+    mask |= mask >> 16;
+    mask ^= mask >> 1;
+
+    const auto split = std::partition_point(codes.begin() + first, codes.begin() + last,
+                                            [mask](std::uint32_t code) { return (code & mask) == 0; });
+    return sofa::Index(split - codes.begin());
+}
+
+} // namespace sofa::component::collision::lbvh
@@ -0,0 +1,59 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaBaseCollision/config.h>
+
+#include <sofa/type/Vec.h>
+#include <sofa/type/vector.h>
+
+#include <cstdint>
+
+/**
+ * Tools to build a linear bounding volume hierarchy (LBVH): the primitives are sorted along a Morton (Z-order)
+ * curve, so that the hierarchy can be obtained by splitting ranges of the sorted primitives.
+ */
+namespace sofa::component::collision::lbvh
+{
+
+/// Number of bits per axis of the Morton codes
+inline constexpr unsigned int MortonBitsPerAxis = 10;
+
+/// Spread the 10 lowest bits of v, with two zero bits between each of them
+SOFA_SOFABASECOLLISION_API std::uint32_t expandBits(std::uint32_t v);
+
+/// 30-bit Morton code of a point, quantized in the given bounding box
+SOFA_SOFABASECOLLISION_API std::uint32_t mortonCode(const type::Vector3& p, const type::Vector3& minBBox, const type::Vector3& maxBBox);
+
+/** Sort codes in increasing order, and give in order the initial index of each sorted code.
+ *
+ * Parallel least significant digit radix sort. The sort is stable, so the result does not depend on the number
+ * of threads.
+ */
+SOFA_SOFABASECOLLISION_API void radixSort(type::vector<std::uint32_t>& codes, type::vector<sofa::Index>& order);
+
+/** Split the range [first, last) of sorted codes where the highest bit differing between its first and last codes
+ * changes, and return the first index of the second half. The middle of the range is returned if all the codes are
+ * identical.
+ */
+SOFA_SOFABASECOLLISION_API sofa::Index findSplit(const type::vector<std::uint32_t>& codes, sofa::Index first, sofa::Index last);
+
+} // namespace sofa::component::collision::lbvh
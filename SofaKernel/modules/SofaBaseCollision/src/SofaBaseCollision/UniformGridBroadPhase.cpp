@@ -0,0 +1,335 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+
+#include <SofaBaseCollision/UniformGridBroadPhase.h>
+
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/core/collision/Intersection.h>
+#include <sofa/simulation/ParallelForEach.h>
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace sofa::component::collision
+{
+
+int UniformGridBroadPhaseClass = core::RegisterObject("Broad phase collision detection using a uniform grid, computed in parallel")
+        .add< UniformGridBroadPhase >()
+;
+
+namespace
+{
+/// Number of bits of each coordinate of a cell in its key
+constexpr int CellBits = 21;
+constexpr int MaxCellCoordinate = (1 << CellBits) - 1;
+}
+
+UniformGridBroadPhase::UniformGridBroadPhase()
+    : d_cellSize(initData(&d_cellSize, SReal(0), "cellSize", "Size of the cells of the grid. If 0, the median size of the bounding boxes of the collision models is used"))
+    , d_maxCellsPerModel(initData(&d_maxCellsPerModel, 64u, "maxCellsPerModel", "Collision models covering more cells are tested against all the other collision models"))
+{}
+
+void UniformGridBroadPhase::init()
+{
+    BruteForceBroadPhase::init();
+
+    auto* taskScheduler = sofa::simulation::TaskScheduler::getInstance();
+    if (taskScheduler->getThreadCount() < 1)
+    {
+        taskScheduler->init(0);
+        msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+    }
+}
+
+void UniformGridBroadPhase::beginBroadPhase()
+{
+    BruteForceBroadPhase::beginBroadPhase();
+    m_selfCollision.clear();
+}
+
+void UniformGridBroadPhase::addCollisionModel(core::CollisionModel *cm)
+{
+    if (cm == nullptr || cm->empty())
+        return;
+    assert(intersectionMethod != nullptr);
+
+    // If a box is defined, check that the collision model intersects the box
+    if (boxModel && !intersectWithBoxModel(cm))
+    {
+        return;
+    }
+
+    m_selfCollision.push_back(doesSelfCollide(cm));
+    m_collisionModels.emplace_back(cm, cm->getLast());
+}
+
+void UniformGridBroadPhase::endBroadPhase()
+{
+    const auto nbModels = static_cast<sofa::Index>(m_collisionModels.size());
+
+    m_candidates.clear();
+    if (nbModels > 1)
+    {
+        computeModelBoxes();
+        findCandidatesInGrid();
+        findCandidatesOfLargeModels();
+        std::sort(m_candidates.begin(), m_candidates.end());
+    }
+
+    // The candidates are checked in the same order as in BruteForceBroadPhase
+    auto candidate = m_candidates.begin();
+    for (sofa::Index k = 0; k < nbModels; ++k)
+    {
+        const auto& model = m_collisionModels[k];
+        if (m_selfCollision[k])
+        {
+            cmPairs.emplace_back(model.firstCollisionModel, model.firstCollisionModel);
+        }
+        for (; candidate != m_candidates.end() && candidate->first == k; ++candidate)
+        {
+            addCollisionPairIfIntersecting(model.firstCollisionModel, model.lastCollisionModel, m_collisionModels[candidate->second]);
+        }
+    }
+
+    BruteForceBroadPhase::endBroadPhase();
+}
+
+void UniformGridBroadPhase::computeModelBoxes()
+{
+    const auto nbModels = static_cast<sofa::Index>(m_collisionModels.size());
+    const SReal alarmDistance = intersectionMethod->getAlarmDistance();
+
+    m_boxes.clear();
+    m_boxes.resize(nbModels);
+    sofa::simulation::parallelForEach(sofa::Index(0), nbModels, [&](sofa::Index i)
+    {
+        core::CollisionModel* cm = m_collisionModels[i].firstCollisionModel;
+        auto* cubeModel = dynamic_cast<CubeCollisionModel*>(cm);
+        if (cubeModel == nullptr || cubeModel->getSize() == 0)
+            return; // unknown bounding volume: tested against all the other models
+
+        const Cube root(cubeModel, 0);
+        const SReal margin = alarmDistance + cm->getProximity();
+        ModelBox& box = m_boxes[i];
+        box.minBBox = root.minVect() - type::Vector3(margin, margin, margin);
+        box.maxBBox = root.maxVect() + type::Vector3(margin, margin, margin);
+        box.hasBox = true;
+        box.large = false;
+    });
+
+    // origin of the grid and size of the cells
+    sofa::type::vector<SReal> sizes;
+    sizes.reserve(nbModels);
+    m_origin = type::Vector3(std::numeric_limits<SReal>::max(), std::numeric_limits<SReal>::max(), std::numeric_limits<SReal>::max());
+    type::Vector3 maxBBox(std::numeric_limits<SReal>::lowest(), std::numeric_limits<SReal>::lowest(), std::numeric_limits<SReal>::lowest());
+    for (const ModelBox& box : m_boxes)
+    {
+        if (box.large) continue;
+        const type::Vector3 extent = box.maxBBox - box.minBBox;
+        sizes.push_back(std::max({extent[0], extent[1], extent[2]}));
+        for (int c = 0; c < 3; ++c)
+        {
+            m_origin[c] = std::min(m_origin[c], box.minBBox[c]);
+            maxBBox[c] = std::max(maxBBox[c], box.maxBBox[c]);
+        }
+    }
+    if (sizes.empty()) return;
+
+    m_currentCellSize = d_cellSize.getValue();
+    if (m_currentCellSize <= 0)
+    {
+        auto median = sizes.begin() + sizes.size() / 2;
+        std::nth_element(sizes.begin(), median, sizes.end());
+        m_currentCellSize = *median;
+    }
+    if (!(m_currentCellSize > 0) || !std::isfinite(m_currentCellSize))
+    {
+        const type::Vector3 extent = maxBBox - m_origin;
+        m_currentCellSize = std::max({extent[0], extent[1], extent[2], SReal(1)});
+    }
+
+    // the models covering too many cells are tested against all the other models
+    const auto maxCells = static_cast<std::int64_t>(d_maxCellsPerModel.getValue());
+    sofa::simulation::parallelForEach(sofa::Index(0), nbModels, [&](sofa::Index i)
+    {
+        ModelBox& box = m_boxes[i];
+        if (box.large) return;
+        type::Vec3i minCell, maxCell;
+        getCellRange(box.minBBox, box.maxBBox, minCell, maxCell);
+        std::int64_t nbCells = 1;
+        for (int c = 0; c < 3; ++c)
+        {
+            nbCells *= static_cast<std::int64_t>(maxCell[c] - minCell[c] + 1);
+            if (maxCell[c] >= MaxCellCoordinate) nbCells = std::numeric_limits<std::int64_t>::max();
+            if (nbCells > maxCells) break;
+        }
+        box.large = nbCells > maxCells;
+    });
+}
+
+void UniformGridBroadPhase::findCandidatesInGrid()
+{
+    const auto nbModels = static_cast<sofa::Index>(m_collisionModels.size());
+
+    // entries of each model in the grid
+    sofa::type::vector<std::size_t> firstEntry(nbModels + 1, 0);
+    for (sofa::Index i = 0; i < nbModels; ++i)
+    {
+        std::size_t nbCells = 0;
+        if (!m_boxes[i].large)
+        {
+            type::Vec3i minCell, maxCell;
+            getCellRange(m_boxes[i].minBBox, m_boxes[i].maxBBox, minCell, maxCell);
+            nbCells = static_cast<std::size_t>(maxCell[0] - minCell[0] + 1) * (maxCell[1] - minCell[1] + 1) * (maxCell[2] - minCell[2] + 1);
+        }
+        firstEntry[i + 1] = firstEntry[i] + nbCells;
+    }
+
+    m_entries.resize(firstEntry.back());
+    sofa::simulation::parallelForEach(sofa::Index(0), nbModels, [&](sofa::Index i)
+    {
+        if (m_boxes[i].large) return;
+        type::Vec3i minCell, maxCell;
+        getCellRange(m_boxes[i].minBBox, m_boxes[i].maxBBox, minCell, maxCell);
+        std::size_t e = firstEntry[i];
+        type::Vec3i cell;
+        for (cell[2] = minCell[2]; cell[2] <= maxCell[2]; ++cell[2])
+            for (cell[1] = minCell[1]; cell[1] <= maxCell[1]; ++cell[1])
+                for (cell[0] = minCell[0]; cell[0] <= maxCell[0]; ++cell[0])
+                    m_entries[e++] = GridEntry{ getCellKey(cell), i };
+    });
+
+    std::sort(m_entries.begin(), m_entries.end());
+
+    m_cellBegin.clear();
+    for (std::size_t e = 0; e < m_entries.size(); ++e)
+    {
+        if (e == 0 || m_entries[e].cell != m_entries[e - 1].cell)
+            m_cellBegin.push_back(e);
+    }
+    m_cellBegin.push_back(m_entries.size());
+    const std::size_t nbCells = m_cellBegin.size() - 1;
+
+    // pairs of models sharing a cell, each pair being only kept in the cell containing the minimum corner of the
+    // intersection of the boxes
+    auto* taskScheduler = sofa::simulation::TaskScheduler::getInstance();
+    const std::size_t nbChunks = std::max<std::size_t>(1, std::min<std::size_t>(nbCells, 4 * taskScheduler->getThreadCount()));
+    m_chunkCandidates.resize(nbChunks);
+    sofa::simulation::parallelForEach(std::size_t(0), nbChunks, [&](std::size_t chunk)
+    {
+        auto& candidates = m_chunkCandidates[chunk];
+        candidates.clear();
+        for (std::size_t cell = chunk * nbCells / nbChunks; cell < (chunk + 1) * nbCells / nbChunks; ++cell)
+        {
+            const std::size_t begin = m_cellBegin[cell];
+            const std::size_t end = m_cellBegin[cell + 1];
+            for (std::size_t a = begin; a < end; ++a)
+            {
+                const sofa::Index i = m_entries[a].model;
+                for (std::size_t b = a + 1; b < end; ++b)
+                {
+                    const sofa::Index j = m_entries[b].model;
+                    if (!intersect(m_boxes[i], m_boxes[j]))
+                        continue;
+
+                    type::Vector3 corner;
+                    for (int c = 0; c < 3; ++c)
+                        corner[c] = std::max(m_boxes[i].minBBox[c], m_boxes[j].minBBox[c]);
+                    type::Vec3i cornerCell, unused;
+                    getCellRange(corner, corner, cornerCell, unused);
+                    if (getCellKey(cornerCell) == m_entries[a].cell)
+                        candidates.emplace_back(j, i);
+                }
+            }
+        }
+    }, 1);
+
+    for (const auto& candidates : m_chunkCandidates)
+        m_candidates.insert(m_candidates.end(), candidates.begin(), candidates.end());
+}
+
+void UniformGridBroadPhase::findCandidatesOfLargeModels()
+{
+    const auto nbModels = static_cast<sofa::Index>(m_collisionModels.size());
+
+    sofa::type::vector<sofa::Index> largeModels;
+    for (sofa::Index i = 0; i < nbModels; ++i)
+    {
+        if (m_boxes[i].large)
+            largeModels.push_back(i);
+    }
+    if (largeModels.empty()) return;
+
+    m_chunkCandidates.resize(largeModels.size());
+    sofa::simulation::parallelForEach(std::size_t(0), largeModels.size(), [&](std::size_t l)
+    {
+        auto& candidates = m_chunkCandidates[l];
+        candidates.clear();
+        const sofa::Index i = largeModels[l];
+        for (sofa::Index j = 0; j < nbModels; ++j)
+        {
+            // a pair of large models is found from the one added last
+            if (j == i || (m_boxes[j].large && j > i))
+                continue;
+            if (intersect(m_boxes[i], m_boxes[j]))
+                candidates.emplace_back(std::max(i, j), std::min(i, j));
+        }
+    }, 1);
+
+    for (std::size_t l = 0; l < largeModels.size(); ++l)
+        m_candidates.insert(m_candidates.end(), m_chunkCandidates[l].begin(), m_chunkCandidates[l].end());
+}
+
+void UniformGridBroadPhase::getCellRange(const type::Vector3& minBBox, const type::Vector3& maxBBox, type::Vec3i& minCell, type::Vec3i& maxCell) const
+{
+    for (int c = 0; c < 3; ++c)
+    {
+        const SReal minCoord = std::floor((minBBox[c] - m_origin[c]) / m_currentCellSize);
+        const SReal maxCoord = std::floor((maxBBox[c] - m_origin[c]) / m_currentCellSize);
+        minCell[c] = static_cast<int>(std::clamp<SReal>(minCoord, 0, MaxCellCoordinate));
+        maxCell[c] = static_cast<int>(std::clamp<SReal>(maxCoord, 0, MaxCellCoordinate));
+    }
+}
+
+std::uint64_t UniformGridBroadPhase::getCellKey(const type::Vec3i& cell)
+{
+    return static_cast<std::uint64_t>(cell[0])
+        | (static_cast<std::uint64_t>(cell[1]) << CellBits)
+        | (static_cast<std::uint64_t>(cell[2]) << (2 * CellBits));
+}
+
+bool UniformGridBroadPhase::intersect(const ModelBox& a, const ModelBox& b)
+{
+    // unknown bounding volumes always intersect
+    if (!a.hasBox || !b.hasBox)
+        return true;
+    for (int c = 0; c < 3; ++c)
+    {
+        if (a.minBBox[c] > b.maxBBox[c] || b.minBBox[c] > a.maxBBox[c])
+            return false;
+    }
+    return true;
+}
+
+} // namespace sofa::component::collision
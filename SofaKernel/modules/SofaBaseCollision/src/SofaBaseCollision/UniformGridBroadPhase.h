@@ -0,0 +1,118 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <SofaBaseCollision/config.h>
+#include <SofaBaseCollision/BruteForceBroadPhase.h>
+
+#include <cstdint>
+
+namespace sofa::component::collision
+{
+
+/**
+ * @brief Broad phase collision detection based on a uniform grid
+ *
+ * The bounding boxes of the collision models (the root cube of their bounding tree, extended by the alarm distance
+ * and the proximity) are inserted in the cells of a uniform grid, and only the models sharing a cell are tested for
+ * intersection. A pair of models is only considered in the cell containing the minimum corner of the intersection of
+ * their boxes, so that each pair is found once. The models covering too many cells, such as a floor, are tested
+ * against all the other models instead.
+ * The grid is built and traversed in parallel, using the task scheduler.
+ *
+ * The potentially colliding pairs are the same as with BruteForceBroadPhase, and are given in the same order.
+ */
+class SOFA_SOFABASECOLLISION_API UniformGridBroadPhase : public BruteForceBroadPhase
+{
+public:
+    SOFA_CLASS(UniformGridBroadPhase, BruteForceBroadPhase);
+
+    Data<SReal> d_cellSize; ///< Size of the cells of the grid. If 0, the median size of the bounding boxes of the collision models is used
+    Data<unsigned int> d_maxCellsPerModel; ///< Collision models covering more cells are tested against all the other collision models
+
+protected:
+    UniformGridBroadPhase();
+    ~UniformGridBroadPhase() override = default;
+
+public:
+    void init() override;
+
+    void beginBroadPhase() override;
+
+    /// The collision models are only stored, the pairs are computed in endBroadPhase
+    void addCollisionModel(core::CollisionModel *cm) override;
+
+    void endBroadPhase() override;
+
+    /// Size of the cells used by the last broad phase
+    SReal getCurrentCellSize() const { return m_currentCellSize; }
+
+protected:
+
+    /// Bounding box of a collision model, extended by the alarm distance and its proximity
+    struct ModelBox
+    {
+        type::Vector3 minBBox, maxBBox;
+        bool hasBox { false }; ///< false if the bounding volume of the model is unknown
+        bool large { true }; ///< the model is tested against all the other models
+    };
+
+    /// A collision model in a cell of the grid
+    struct GridEntry
+    {
+        std::uint64_t cell;
+        sofa::Index model;
+
+        bool operator<(const GridEntry& other) const { return cell < other.cell || (cell == other.cell && model < other.model); }
+    };
+
+    /// A pair of collision models which may intersect, the first one being added after the second one
+    using CandidatePair = std::pair<sofa::Index, sofa::Index>;
+
+    /// Compute the boxes of the collision models and the cell size
+    void computeModelBoxes();
+
+    /// Insert the models in the grid and find the pairs of models sharing a cell
+    void findCandidatesInGrid();
+
+    /// Find the pairs involving a large model
+    void findCandidatesOfLargeModels();
+
+    /// Range of cells covered by a box
+    void getCellRange(const type::Vector3& minBBox, const type::Vector3& maxBBox, type::Vec3i& minCell, type::Vec3i& maxCell) const;
+
+    static std::uint64_t getCellKey(const type::Vec3i& cell);
+
+    static bool intersect(const ModelBox& a, const ModelBox& b);
+
+    sofa::type::vector<bool> m_selfCollision; ///< true for the collision models which can collide with themselves
+    sofa::type::vector<ModelBox> m_boxes;
+    sofa::type::vector<GridEntry> m_entries;
+    sofa::type::vector<std::size_t> m_cellBegin; ///< first entry of each non-empty cell, in the sorted entries
+    sofa::type::vector<sofa::type::vector<CandidatePair> > m_chunkCandidates;
+    sofa::type::vector<CandidatePair> m_candidates;
+
+    type::Vector3 m_origin;
+    SReal m_currentCellSize { 0 };
+};
+
+} // namespace sofa::component::collision
@@ -0,0 +1,254 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+
+/**
+ * Micro-benchmark of the matrix-vector products of CompressedRowSparseMatrix.
+ *
+ * The matrices are the stiffness of a linear elastic tetrahedral FEM on a regular grid,
+ * assembled with scalar, 3x3 (one block per node) and 6x6 (one block per pair of nodes) blocks.
+ * For each of them, it compares:
+ *  - the generic BaseMatrix product (virtual element access),
+ *  - the templated product used before the BCSR kernels,
+ *  - the BCSR kernels, for each instruction set supported by the CPU,
+ * for y=A*x, y+=A*x, y+=A^T*x and y=a*A*x+b*y.
+ *
+ * Usage: SofaBaseLinearSolver_bench [gridSize] [repetitions]
+ */
+
+#include <SofaBaseLinearSolver/CompressedRowSparseMatrix.h>
+#include <SofaBaseLinearSolver/CompressedRowSparseMatrixKernels.h>
+#include <SofaBaseLinearSolver/FullVector.h>
+
+#include <sofa/type/Mat.h>
+#include <sofa/type/Vec.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace sofa::component::linearsolver;
+using sofa::type::Mat3x3d;
+using sofa::type::Vec3d;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+
+/// Expose the templated products of CompressedRowSparseMatrix used before the BCSR kernels
+template<class TBloc>
+struct ReferenceMatrix : public CompressedRowSparseMatrix<TBloc>
+{
+    using CompressedRowSparseMatrix<TBloc>::tmul;
+    using CompressedRowSparseMatrix<TBloc>::taddMul;
+    using CompressedRowSparseMatrix<TBloc>::taddMulTranspose;
+};
+
+struct TetraMesh
+{
+    std::vector<Vec3d> points;
+    std::vector<std::array<int, 4> > tetrahedra;
+};
+
+/// n x n x n hexahedra, each split into 6 tetrahedra
+TetraMesh createGrid(int n)
+{
+    TetraMesh mesh;
+    const int np = n + 1;
+    auto index = [np](int i, int j, int k) { return i + np * (j + np * k); };
+    for (int k = 0; k < np; ++k)
+        for (int j = 0; j < np; ++j)
+            for (int i = 0; i < np; ++i)
+                mesh.points.emplace_back(i, j, k);
+
+    static const int cube[6][4] = { {0,5,1,6}, {0,1,2,6}, {0,2,3,6}, {0,3,7,6}, {0,7,4,6}, {0,4,5,6} };
+    for (int k = 0; k < n; ++k)
+        for (int j = 0; j < n; ++j)
+            for (int i = 0; i < n; ++i)
+            {
+                const int c[8] = { index(i,j,k), index(i+1,j,k), index(i+1,j+1,k), index(i,j+1,k),
+                                   index(i,j,k+1), index(i+1,j,k+1), index(i+1,j+1,k+1), index(i,j+1,k+1) };
+                for (const auto& t : cube)
+                    mesh.tetrahedra.push_back({ c[t[0]], c[t[1]], c[t[2]], c[t[3]] });
+            }
+    return mesh;
+}
+
+/// Add the linear elastic stiffness of each tetrahedron, K_ab = V (lambda ga gb^T + mu gb ga^T + mu (ga.gb) I)
+template<class AddBlock>
+void assembleStiffness(const TetraMesh& mesh, double youngModulus, double poissonRatio, AddBlock addBlock)
+{
+    const double lambda = youngModulus * poissonRatio / ((1 + poissonRatio) * (1 - 2 * poissonRatio));
+    const double mu = youngModulus / (2 * (1 + poissonRatio));
+    for (const auto& t : mesh.tetrahedra)
+    {
+        Mat3x3d m;
+        for (int c = 0; c < 3; ++c)
+            for (int r = 0; r < 3; ++r)
+                m[r][c] = mesh.points[t[c + 1]][r] - mesh.points[t[0]][r];
+        Mat3x3d minv;
+        if (!minv.invert(m)) continue;
+        const double volume = std::abs(sofa::type::determinant(m)) / 6;
+
+        Vec3d g[4];
+        for (int a = 0; a < 3; ++a)
+            g[a + 1] = minv[a];
+        g[0] = -(g[1] + g[2] + g[3]);
+
+        for (int a = 0; a < 4; ++a)
+            for (int b = 0; b < 4; ++b)
+            {
+                Mat3x3d k;
+                const double gab = g[a] * g[b];
+                for (int i = 0; i < 3; ++i)
+                    for (int j = 0; j < 3; ++j)
+                        k[i][j] = volume * (lambda * g[a][i] * g[b][j] + mu * g[a][j] * g[b][i] + (i == j ? mu * gab : 0));
+                addBlock(t[a], t[b], k);
+            }
+    }
+}
+
+template<class Function>
+double timeIt(int repetitions, Function f)
+{
+    f(); // warm-up
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        const auto start = Clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+template<class TBloc>
+void benchmark(const std::string& name, ReferenceMatrix<TBloc>& matrix, int repetitions)
+{
+    matrix.compress();
+    const auto rows = matrix.rowSize();
+    const auto cols = matrix.colSize();
+
+    FullVector<double> x(cols), y(rows), xt(rows), yt(cols);
+    for (sofa::Index i = 0; i < sofa::Index(cols); ++i) x[i] = 1.0 + 1e-3 * i;
+    for (sofa::Index i = 0; i < sofa::Index(rows); ++i) xt[i] = 1.0 - 1e-3 * i;
+
+    const std::size_t nnz = matrix.getColsValue().size() * matrix.NL * matrix.NC;
+    std::cout << "\n" << name << ": " << rows << " rows, " << nnz << " non-zeros, " << matrix.getColsValue().size() << " blocks\n";
+    std::cout << std::left << std::setw(22) << "  product"
+              << std::right << std::setw(14) << "y=A*x" << std::setw(14) << "y+=A*x"
+              << std::setw(14) << "y+=A^T*x" << std::setw(14) << "y=aA*x+by" << "   (ms)\n";
+
+    auto print = [](const std::string& label, double mul, double addMul, double addMulTranspose, double mulAdd)
+    {
+        std::cout << std::left << std::setw(22) << ("  " + label) << std::right << std::fixed << std::setprecision(3);
+        for (double t : { mul, addMul, addMulTranspose, mulAdd })
+        {
+            if (t < 0) std::cout << std::setw(14) << "-";
+            else std::cout << std::setw(14) << t;
+        }
+        std::cout << "\n";
+    };
+
+    {
+        sofa::defaulttype::BaseMatrix& base = matrix;
+        const double mul = timeIt(repetitions, [&] { base.sofa::defaulttype::BaseMatrix::opMulV(&y, &x); });
+        const double addMulTranspose = timeIt(repetitions, [&] { base.sofa::defaulttype::BaseMatrix::opPMulTV(&yt, &xt); });
+        const double addMul = timeIt(repetitions, [&] { base.sofa::defaulttype::BaseMatrix::opPMulV(&y, &x); });
+        print("BaseMatrix", mul, addMul, addMulTranspose, -1);
+    }
+    {
+        const double mul = timeIt(repetitions, [&] { matrix.template tmul<double>(y, x); });
+        const double addMul = timeIt(repetitions, [&] { matrix.template taddMul<double>(y, x); });
+        const double addMulTranspose = timeIt(repetitions, [&] { matrix.template taddMulTranspose<double>(yt, xt); });
+        print("template", mul, addMul, addMulTranspose, -1);
+    }
+
+    const bcsr::InstructionSet detected = bcsr::detectInstructionSet();
+    for (int i = 0; i <= static_cast<int>(detected); ++i)
+    {
+        const auto instructionSet = bcsr::setInstructionSet(static_cast<bcsr::InstructionSet>(i));
+        const double mul = timeIt(repetitions, [&] { matrix.mul(y, x); });
+        const double addMul = timeIt(repetitions, [&] { matrix.addMul(y, x); });
+        const double addMulTranspose = timeIt(repetitions, [&] { matrix.addMultTranspose(yt, xt); });
+        const double mulAdd = timeIt(repetitions, [&] { matrix.mulAdd(y, x, 0.5, 0.25); });
+        print(std::string("kernel ") + bcsr::getInstructionSetName(instructionSet), mul, addMul, addMulTranspose, mulAdd);
+    }
+    bcsr::setInstructionSet(detected);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int gridSize = argc > 1 ? std::max(1, std::atoi(argv[1])) : 30;
+    const int repetitions = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+
+    const TetraMesh mesh = createGrid(gridSize);
+    const int nbNodes = static_cast<int>(mesh.points.size());
+    std::cout << "Tetrahedral grid " << gridSize << "^3: " << nbNodes << " nodes, "
+              << mesh.tetrahedra.size() << " tetrahedra\n";
+    std::cout << "Detected instruction set: " << bcsr::getInstructionSetName(bcsr::detectInstructionSet()) << "\n";
+
+    {
+        ReferenceMatrix<double> matrix;
+        matrix.resize(3 * nbNodes, 3 * nbNodes);
+        assembleStiffness(mesh, 1e4, 0.45, [&](int a, int b, const Mat3x3d& k)
+        {
+            for (int i = 0; i < 3; ++i)
+                for (int j = 0; j < 3; ++j)
+                    matrix.add(3 * a + i, 3 * b + j, k[i][j]);
+        });
+        benchmark("scalar blocks", matrix, repetitions);
+    }
+    {
+        ReferenceMatrix<Mat3x3d> matrix;
+        matrix.resize(3 * nbNodes, 3 * nbNodes);
+        assembleStiffness(mesh, 1e4, 0.45, [&](int a, int b, const Mat3x3d& k)
+        {
+            *matrix.wbloc(a, b, true) += k;
+        });
+        benchmark("3x3 blocks", matrix, repetitions);
+    }
+    {
+        // a 6x6 block couples two consecutive nodes
+        using Mat6x6d = sofa::type::Mat<6, 6, double>;
+        const int nbPairs = (nbNodes + 1) / 2;
+        ReferenceMatrix<Mat6x6d> matrix;
+        matrix.resize(6 * nbPairs, 6 * nbPairs);
+        assembleStiffness(mesh, 1e4, 0.45, [&](int a, int b, const Mat3x3d& k)
+        {
+            Mat6x6d& bloc = *matrix.wbloc(a / 2, b / 2, true);
+            for (int i = 0; i < 3; ++i)
+                for (int j = 0; j < 3; ++j)
+                    bloc[3 * (a % 2) + i][3 * (b % 2) + j] += k[i][j];
+        });
+        benchmark("6x6 blocks", matrix, repetitions);
+    }
+
+    return 0;
+}
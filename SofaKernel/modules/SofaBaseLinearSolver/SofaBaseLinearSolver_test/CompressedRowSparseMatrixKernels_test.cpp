@@ -0,0 +1,177 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaBaseLinearSolver/CompressedRowSparseMatrix.h>
+#include <SofaBaseLinearSolver/CompressedRowSparseMatrixKernels.h>
+#include <SofaBaseLinearSolver/FullVector.h>
+
+#include <sofa/type/Mat.h>
+
+#include <gtest/gtest.h>
+#include <random>
+
+namespace sofa
+{
+
+using namespace sofa::component::linearsolver;
+
+/// Compare the products computed by the BCSR kernels of each available instruction set with a dense reference
+template<class TBloc>
+struct CompressedRowSparseMatrixKernels_test : public ::testing::Test
+{
+    using Matrix = CompressedRowSparseMatrix<TBloc>;
+    using Vector = FullVector<double>;
+    static constexpr int N = matrix_bloc_traits<TBloc, sofa::SignedIndex>::NL;
+
+    static constexpr int NbBlockRows = 23;
+    static constexpr int NbBlockCols = 17;
+
+    Matrix matrix;
+    type::vector<double> dense; ///< row-major copy of the matrix
+    Vector x, xt, y0, yt0;
+
+    void SetUp() override
+    {
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+        const int nbRows = NbBlockRows * N;
+        const int nbCols = NbBlockCols * N;
+        matrix.resize(nbRows, nbCols);
+        dense.assign((std::size_t)nbRows * nbCols, 0.0);
+
+        // some block rows are left empty, the others have a variable number of blocks
+        for (int bi = 0; bi < NbBlockRows; ++bi)
+        {
+            if (bi % 5 == 3) continue;
+            for (int bj = 0; bj < NbBlockCols; ++bj)
+            {
+                if ((bi * 7 + bj * 3) % 4 == 0) continue;
+                for (int i = 0; i < N; ++i)
+                    for (int j = 0; j < N; ++j)
+                    {
+                        const double value = distribution(generator);
+                        matrix.add(bi * N + i, bj * N + j, value);
+                        dense[(std::size_t)(bi * N + i) * nbCols + bj * N + j] += value;
+                    }
+            }
+        }
+        matrix.compress();
+
+        auto fill = [&](Vector& v, int size)
+        {
+            v.resize(size);
+            for (int i = 0; i < size; ++i) v[i] = distribution(generator);
+        };
+        fill(x, nbCols);
+        fill(xt, nbRows);
+        fill(y0, nbRows);
+        fill(yt0, nbCols);
+    }
+
+    /// alpha * A * x + beta * y, or alpha * A^T * x + beta * y
+    type::vector<double> reference(const Vector& v, const Vector& y, double alpha, double beta, bool transpose) const
+    {
+        const int nbRows = NbBlockRows * N;
+        const int nbCols = NbBlockCols * N;
+        const int size = transpose ? nbCols : nbRows;
+        type::vector<double> result(size);
+        for (int i = 0; i < size; ++i)
+        {
+            double acc = 0.0;
+            for (int k = 0; k < (transpose ? nbRows : nbCols); ++k)
+                acc += (transpose ? dense[(std::size_t)k * nbCols + i] : dense[(std::size_t)i * nbCols + k]) * v[k];
+            result[i] = alpha * acc + beta * y[i];
+        }
+        return result;
+    }
+
+    void expectNear(const Vector& actual, const type::vector<double>& expected) const
+    {
+        ASSERT_EQ((std::size_t)actual.size(), expected.size());
+        for (std::size_t i = 0; i < expected.size(); ++i)
+            EXPECT_NEAR(actual[i], expected[i], 1e-12) << "index " << i;
+    }
+
+    void checkProducts()
+    {
+        Vector zero;
+        zero.resize(NbBlockCols * N);
+
+        Vector y;
+        matrix.mul(y, x);
+        expectNear(y, reference(x, y0, 1.0, 0.0, false));
+
+        y = y0;
+        matrix.addMul(y, x);
+        expectNear(y, reference(x, y0, 1.0, 1.0, false));
+
+        y = y0;
+        matrix.mulAdd(y, x, 2.0, -0.5);
+        expectNear(y, reference(x, y0, 2.0, -0.5, false));
+
+        Vector yt;
+        yt.resize(NbBlockCols * N);
+        matrix.addMultTranspose(yt, xt);
+        expectNear(yt, reference(xt, zero, 1.0, 0.0, true));
+
+        yt = yt0;
+        matrix.addMultTranspose(yt, xt);
+        expectNear(yt, reference(xt, yt0, 1.0, 1.0, true));
+
+        // BaseMatrix interface
+        matrix.opMulV(&y, &x);
+        expectNear(y, reference(x, y0, 1.0, 0.0, false));
+        matrix.opMulTV(&yt, &xt);
+        expectNear(yt, reference(xt, zero, 1.0, 0.0, true));
+
+        // the accumulating products add to the values already in the result
+        y = y0;
+        matrix.opPMulV(&y, &x);
+        expectNear(y, reference(x, y0, 1.0, 1.0, false));
+        yt = yt0;
+        matrix.opPMulTV(&yt, &xt);
+        expectNear(yt, reference(xt, yt0, 1.0, 1.0, true));
+    }
+};
+
+using BlocTypes = ::testing::Types<double, type::Mat<3,3,double>, type::Mat<6,6,double> >;
+TYPED_TEST_SUITE(CompressedRowSparseMatrixKernels_test, BlocTypes);
+
+TYPED_TEST(CompressedRowSparseMatrixKernels_test, usesKernels)
+{
+    EXPECT_TRUE((TestFixture::Matrix::template canUseBCSRKernels<FullVector<double>, FullVector<double> >()));
+    EXPECT_FALSE((CompressedRowSparseMatrix<type::Mat<3,3,float> >::canUseBCSRKernels<FullVector<float>, FullVector<float> >()));
+}
+
+TYPED_TEST(CompressedRowSparseMatrixKernels_test, products)
+{
+    const bcsr::InstructionSet detected = bcsr::detectInstructionSet();
+    for (int instructionSet = 0; instructionSet <= static_cast<int>(detected); ++instructionSet)
+    {
+        SCOPED_TRACE(bcsr::getInstructionSetName(static_cast<bcsr::InstructionSet>(instructionSet)));
+        EXPECT_EQ(bcsr::setInstructionSet(static_cast<bcsr::InstructionSet>(instructionSet)), static_cast<bcsr::InstructionSet>(instructionSet));
+        this->checkProducts();
+    }
+    bcsr::setInstructionSet(detected);
+}
+
+} // namespace sofa
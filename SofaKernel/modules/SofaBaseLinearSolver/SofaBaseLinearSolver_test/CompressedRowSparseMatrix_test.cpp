@@ -0,0 +1,288 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaBaseLinearSolver/CompressedRowSparseMatrix.h>
+
+#include <sofa/type/Mat.h>
+#include <sofa/simulation/ParallelForEach.h>
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+
+namespace sofa
+{
+
+using namespace sofa::component::linearsolver;
+
+namespace
+{
+
+using Matrix = CompressedRowSparseMatrix<type::Mat<3,3,double> >;
+
+/// Assemble a symmetric tridiagonal bloc matrix, optionally with an empty off-diagonal bloc
+/// and with the blocs added in reverse order
+void assemble(Matrix& m, bool withZero, bool reverse)
+{
+    const int n = 5;
+    m.resize(3 * n, 3 * n);
+    for (int k = 0; k < n; ++k)
+    {
+        const int b = reverse ? n - 1 - k : k;
+        type::Mat<3,3,double> d;
+        d.identity();
+        *m.wbloc(b, b, true) += d * (2.0 + b);
+        if (b + 1 < n)
+        {
+            const double v = (withZero && b == 2) ? 0.0 : -1.0;
+            *m.wbloc(b, b + 1, true) += d * v;
+            *m.wbloc(b + 1, b, true) += d * v;
+        }
+    }
+    m.compress();
+}
+
+void checkValues(const Matrix& m, bool withZero)
+{
+    for (int i = 0; i < m.rowSize(); ++i)
+    {
+        for (int j = 0; j < m.colSize(); ++j)
+        {
+            const int bi = i / 3, bj = j / 3;
+            double expected = 0;
+            if (i == j) expected = 2.0 + bi;
+            else if (i % 3 == j % 3 && std::abs(bi - bj) == 1 && !(withZero && std::min(bi, bj) == 2)) expected = -1.0;
+            EXPECT_EQ(m.element(i, j), expected) << "(" << i << "," << j << ")";
+        }
+    }
+}
+
+/// Contributions of a force field: blocs and scalar values, with values which are not exactly summed
+struct Contributions
+{
+    struct BlocContribution { int i, j; type::Mat<3,3,double> value; };
+    struct ScalarContribution { int i, j; double value; };
+    std::vector<BlocContribution> blocs;
+    std::vector<ScalarContribution> scalars;
+
+    void addTo(Matrix& m) const
+    {
+        for (const auto& b : blocs)
+            *m.wbloc(b.i, b.j, true) += b.value;
+        for (const auto& s : scalars)
+            m.add(s.i, s.j, s.value);
+    }
+};
+
+std::vector<Contributions> generateContributions(int nbBlocs, std::size_t nbForceFields)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> bloc(0, nbBlocs - 1);
+    std::uniform_int_distribution<int> entry(0, 3 * nbBlocs - 1);
+    std::uniform_real_distribution<double> value(-1.0, 1.0);
+
+    std::vector<Contributions> forceFields(nbForceFields);
+    for (auto& ff : forceFields)
+    {
+        for (int k = 0; k < 20 * nbBlocs; ++k)
+        {
+            const int i = bloc(gen);
+            const int j = std::max(0, std::min(nbBlocs - 1, i + bloc(gen) % 5 - 2));
+            type::Mat<3,3,double> v;
+            for (int a = 0; a < 3; ++a)
+                for (int b = 0; b < 3; ++b)
+                    v[a][b] = value(gen) * 1e3;
+            ff.blocs.push_back({i, j, v});
+        }
+        for (int k = 0; k < 5 * nbBlocs; ++k)
+        {
+            const int i = entry(gen);
+            ff.scalars.push_back({i, i, value(gen)});
+            ff.scalars.push_back({i, i, value(gen) * 1e-3}); // same entry twice in a row
+        }
+    }
+    return forceFields;
+}
+
+void expectBitwiseEqual(const Matrix& a, const Matrix& b)
+{
+    ASSERT_EQ(a.rowSize(), b.rowSize());
+    ASSERT_EQ(a.colSize(), b.colSize());
+    for (int i = 0; i < a.rowSize(); ++i)
+    {
+        for (int j = 0; j < a.colSize(); ++j)
+        {
+            const double va = a.element(i, j), vb = b.element(i, j);
+            EXPECT_EQ(std::memcmp(&va, &vb, sizeof(double)), 0) << "(" << i << "," << j << "): " << va << " != " << vb;
+        }
+    }
+}
+
+}
+
+TEST(CompressedRowSparseMatrixPattern, unlockedRemovesEmptyBlocs)
+{
+    Matrix m;
+    assemble(m, false, false);
+    EXPECT_EQ(m.getColsIndex().size(), 13u);
+
+    assemble(m, true, false);
+    checkValues(m, true);
+    EXPECT_EQ(m.getColsIndex().size(), 11u);
+}
+
+TEST(CompressedRowSparseMatrixPattern, lockedKeepsPattern)
+{
+    Matrix m;
+    m.setPatternLocked(true);
+    assemble(m, false, false);
+    checkValues(m, false);
+    const auto colsIndex = m.getColsIndex();
+    const auto rowBegin = m.getRowBegin();
+    ASSERT_EQ(colsIndex.size(), 13u);
+
+    // the empty blocs are kept and the values are written in the existing blocs
+    const auto* values = m.getColsValue().data();
+    assemble(m, true, false);
+    checkValues(m, true);
+    EXPECT_EQ(m.getColsIndex(), colsIndex);
+    EXPECT_EQ(m.getRowBegin(), rowBegin);
+    EXPECT_EQ(m.getColsValue().data(), values);
+    EXPECT_TRUE(m.btemp.empty());
+
+    // a different sequence of calls still finds the blocs
+    assemble(m, false, true);
+    checkValues(m, false);
+    EXPECT_EQ(m.getColsIndex(), colsIndex);
+    assemble(m, false, false);
+    checkValues(m, false);
+    EXPECT_EQ(m.getColsIndex(), colsIndex);
+}
+
+TEST(CompressedRowSparseMatrixPattern, lockedAddsNewBlocs)
+{
+    Matrix m;
+    m.setPatternLocked(true);
+    assemble(m, false, false);
+    assemble(m, false, false);
+
+    m.clear();
+    *m.wbloc(0, 0, true) += type::Mat<3,3,double>(type::Mat<3,3,double>::Line(1, 2, 3), type::Mat<3,3,double>::Line(4, 5, 6), type::Mat<3,3,double>::Line(7, 8, 9));
+    *m.wbloc(0, 4, true) += type::Mat<3,3,double>(type::Mat<3,3,double>::Line(1, 0, 0), type::Mat<3,3,double>::Line(0, 1, 0), type::Mat<3,3,double>::Line(0, 0, 1));
+    m.compress();
+    EXPECT_EQ(m.getColsIndex().size(), 14u);
+    EXPECT_EQ(m.element(1, 2), 6.0);
+    EXPECT_EQ(m.element(2, 14), 1.0);
+    EXPECT_EQ(m.element(4, 4), 0.0);
+
+    assemble(m, false, false);
+    checkValues(m, false);
+    EXPECT_EQ(m.getColsIndex().size(), 14u);
+}
+
+TEST(CompressedRowSparseMatrixPattern, rebuildPattern)
+{
+    Matrix m;
+    m.setPatternLocked(true);
+    assemble(m, false, false);
+    assemble(m, true, false);
+    EXPECT_EQ(m.getColsIndex().size(), 13u);
+
+    m.rebuildPattern();
+    assemble(m, true, false);
+    checkValues(m, true);
+    EXPECT_EQ(m.getColsIndex().size(), 13u); // the empty blocs added by the assembly are part of the new pattern
+
+    m.setPatternLocked(false);
+    assemble(m, true, false);
+    checkValues(m, true);
+    EXPECT_EQ(m.getColsIndex().size(), 11u);
+}
+
+TEST(CompressedRowSparseMatrixAssemblyBuffer, bitwiseEqualToSequentialAssembly)
+{
+    sofa::simulation::TaskScheduler* taskScheduler = sofa::simulation::TaskScheduler::getInstance();
+    if (taskScheduler->getThreadCount() < 1)
+        taskScheduler->init(4);
+
+    const int nbBlocs = 40;
+    const auto forceFields = generateContributions(nbBlocs, 6);
+
+    // sequential assembly in the compressed matrix
+    Matrix sequential;
+    sequential.resize(3 * nbBlocs, 3 * nbBlocs);
+    for (const auto& ff : forceFields)
+        ff.addTo(sequential);
+    sequential.compress();
+    sequential.clear();
+    for (const auto& ff : forceFields)
+        ff.addTo(sequential);
+    sequential.compress();
+
+    std::vector<Matrix> buffers(forceFields.size());
+    type::vector<const Matrix*> bufferPtrs;
+    for (auto& buffer : buffers)
+    {
+        buffer.setAssemblyBuffer(true);
+        bufferPtrs.push_back(&buffer);
+    }
+    const auto fillBuffers = [&]()
+    {
+        sofa::simulation::parallelForEach(std::size_t(0), forceFields.size(), [&](std::size_t i)
+        {
+            buffers[i].resize(3 * nbBlocs, 3 * nbBlocs);
+            forceFields[i].addTo(buffers[i]);
+        }, 1);
+    };
+
+    // all the blocs are new
+    Matrix parallel;
+    parallel.resize(3 * nbBlocs, 3 * nbBlocs);
+    fillBuffers();
+    parallel.addBuffers(bufferPtrs);
+    expectBitwiseEqual(parallel, sequential);
+    EXPECT_EQ(parallel.getColsIndex(), sequential.getColsIndex());
+
+    // all the blocs exist
+    parallel.clear();
+    fillBuffers();
+    parallel.addBuffers(bufferPtrs);
+    expectBitwiseEqual(parallel, sequential);
+    EXPECT_EQ(parallel.getColsIndex(), sequential.getColsIndex());
+
+    // some blocs exist, with the buffers appended in a single buffer first
+    Matrix partial;
+    partial.resize(3 * nbBlocs, 3 * nbBlocs);
+    forceFields[0].addTo(partial);
+    partial.compress();
+    partial.clear();
+    Matrix merged;
+    merged.setAssemblyBuffer(true);
+    merged.resize(3 * nbBlocs, 3 * nbBlocs);
+    fillBuffers();
+    merged.addBuffers(bufferPtrs);
+    partial.addBuffers({&merged});
+    expectBitwiseEqual(partial, sequential);
+}
+
+} // namespace sofa
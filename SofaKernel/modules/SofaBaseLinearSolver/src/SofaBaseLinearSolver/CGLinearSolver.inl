@@ -106,7 +106,7 @@ void CGLinearSolver<TMatrix,TVector>::solve(Matrix& A, Vector& x, Vector& b)
     Vector& q = *vtmp.createTempVector(); // temporary vector computing A*p
     Vector& r = *vtmp.createTempVector(); // residual
 
-    double rho, rho_1=0, alpha, beta;
+    double rho, rho_1=0, rho_next=0, alpha, beta;
 
     msg_info() << "b = " << b ;
 
@@ -157,8 +157,8 @@ void CGLinearSolver<TMatrix,TVector>::solve(Matrix& A, Vector& x, Vector& b)
             }
 #endif
 
-            /// Compute ρ = r²
-            rho = r.dot(r);
+            /// Compute ρ = r², which is computed with the update of r after the first iteration
+            rho = ( nb_iter == 1 ) ? r.dot(r) : rho_next;
 
             /// Compute the error from the norm of ρ and b
             double normr = sqrt(rho);
@@ -271,7 +271,7 @@ void CGLinearSolver<TMatrix,TVector>::solve(Matrix& A, Vector& x, Vector& b)
                 /// End of the CG step by updating x and r
                 /// x = x + alpha p
                 /// r = r - alpha p
-                cgstep_alpha(params, x,r,p,q,alpha);
+                rho_next = cgstep_alpha(params, x,r,p,q,alpha);
 
                 msg_info() << "den = " << den << ", alpha = " << alpha << ", x = " << x << ", r = " << r;
             }
@@ -341,13 +341,15 @@ inline void CGLinearSolver<TMatrix,TVector>::cgstep_beta(const core::ExecParams*
 }
 
 template<class TMatrix, class TVector>
-inline void CGLinearSolver<TMatrix,TVector>::cgstep_alpha(const core::ExecParams* /*params*/, Vector& x, Vector& r, Vector& p, Vector& q, SReal alpha)
+inline SReal CGLinearSolver<TMatrix,TVector>::cgstep_alpha(const core::ExecParams* /*params*/, Vector& x, Vector& r, Vector& p, Vector& q, SReal alpha)
 {
     // x = x + alpha p
     x.peq(p,alpha);
 
     // r = r - alpha q
     r.peq(q,-alpha);
+
+    return r.dot(r);
 }
 
 } // namespace sofa::component::linearsolver
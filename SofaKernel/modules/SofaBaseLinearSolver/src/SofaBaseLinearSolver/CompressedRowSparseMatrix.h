@@ -26,9 +26,15 @@
 #include <SofaBaseLinearSolver/MatrixExpr.h>
 #include <SofaBaseLinearSolver/matrix_bloc_traits.h>
 #include <SofaBaseLinearSolver/FullMatrix.h>
+#include <SofaBaseLinearSolver/CompressedRowSparseMatrixKernels.h>
 #include <sofa/type/vector.h>
 #include <sofa/helper/rmath.h>
 #include <sofa/defaulttype/typeinfo/TypeInfo_Mat.h>
+#include <sofa/simulation/ParallelForEach.h>
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <algorithm>
+#include <bitset>
 
 namespace sofa::component::linearsolver
 {
@@ -164,16 +170,37 @@ public :
     VecIndex oldRowBegin;
     VecIndex oldColsIndex;
     VecBloc  oldColsValue;
+
+    /// Position in the compressed data of the bloc accessed by a call to wbloc(i,j,true)
+    struct PatternSlot
+    {
+        sofa::Index rowId;   ///< index in rowIndex
+        sofa::Index valueId; ///< index in colsIndex and colsValue
+    };
+
+    // locked sparsity pattern
+    bool patternLocked;                   ///< true if the blocs are kept (even if empty) when the matrix is cleared or compressed
+    type::vector<PatternSlot> patternSlots; ///< position of the bloc accessed by each call to wbloc(i,j,true) since the last clear
+    Index patternCursor;                  ///< number of calls to wbloc(i,j,true) since the last clear
+
+    // assembly buffer
+    bool assemblyBuffer;                  ///< true if btemp records the contributions instead of summing them
+    std::bitset<NL*NC> lastBlocWritten;   ///< entries of the last bloc of btemp already written by add
+
+    // Temporary vectors used by addBuffers
+    VecIndex bufferRowBegin;
+    type::vector<const IndexedBloc*> bufferEntries;
+    type::vector<VecIndexedBloc> bufferNewBlocs;
 public:
     CompressedRowSparseMatrix()
-        : nRow(0), nCol(0), nBlocRow(0), nBlocCol(0), compressed(true)
+        : nRow(0), nCol(0), nBlocRow(0), nBlocCol(0), compressed(true), patternLocked(false), patternCursor(0), assemblyBuffer(false)
     {
     }
 
     CompressedRowSparseMatrix(Index nbRow, Index nbCol)
         : nRow(nbRow), nCol(nbCol),
           nBlocRow((nbRow + NL-1) / NL), nBlocCol((nbCol + NC-1) / NC),
-          compressed(true)
+          compressed(true), patternLocked(false), patternCursor(0), assemblyBuffer(false)
     {
     }
 
@@ -205,10 +232,7 @@ public:
         if (nBlocRow == nbBRow && nBlocRow == nbBCol)
         {
             // just clear the matrix
-            for (Index i=0; i < (Index)colsValue.size(); ++i)
-                traits::clear(colsValue[i]);
-            compressed = colsValue.empty();
-            btemp.clear();
+            clear();
         }
         else
         {
@@ -225,11 +249,166 @@ public:
             colsValue.clear();
             compressed = true;
             btemp.clear();
+            patternSlots.clear();
+            patternCursor = 0;
+        }
+    }
+
+    /// @name Locked sparsity pattern
+    /// When the pattern is locked, the blocs of the matrix are kept when it is cleared or compressed, even if they
+    /// are empty: an assembly writing in the same blocs as the previous one does not modify the structure of the
+    /// matrix and does not need any compression. The position of the bloc accessed by each call to wbloc(i,j,true)
+    /// (i.e. add and set) is cached, so that the same sequence of calls directly writes in the compressed values.
+    /// New blocs are still added to the pattern, and rebuildPattern() removes all of them, for instance after a
+    /// topological change.
+    /// @{
+
+    void setPatternLocked(bool locked)
+    {
+        if (locked == patternLocked) return;
+        patternLocked = locked;
+        patternSlots.clear();
+        patternCursor = 0;
+    }
+
+    bool isPatternLocked() const { return patternLocked; }
+
+    /// Remove all the blocs of the matrix, the pattern is built again by the next assembly
+    void rebuildPattern()
+    {
+        rowIndex.clear();
+        rowBegin.clear();
+        colsIndex.clear();
+        colsValue.clear();
+        compressed = true;
+        btemp.clear();
+        patternSlots.clear();
+        patternCursor = 0;
+    }
+
+    /// @}
+
+    /// @name Assembly buffer
+    /// A matrix in assembly buffer mode records the contributions of an assembly in btemp, in the order of the
+    /// calls, instead of summing them: each call to wbloc(i,j,true) gives a new bloc, and add only reuses the last
+    /// bloc if the entry was not written yet. Buffers filled in parallel are then summed in the final matrix by
+    /// addBuffers, which gives exactly the same values as writing all the contributions sequentially in the
+    /// final matrix (as long as the values are only added, set has no meaning in a buffer).
+    /// A buffer is never compressed: its values can only be read through addBuffers.
+    /// @{
+
+    void setAssemblyBuffer(bool buffer)
+    {
+        if (buffer == assemblyBuffer) return;
+        assemblyBuffer = buffer;
+        if (buffer)
+        {
+            rebuildPattern();
+            lastBlocWritten.set();
+        }
+    }
+
+    bool isAssemblyBuffer() const { return assemblyBuffer; }
+
+    /// Number of contributions recorded by a buffer
+    std::size_t getNbBufferedBlocs() const { return btemp.size(); }
+
+    /// Add the contributions recorded by the buffers, in the order of the buffers and of the calls in each buffer.
+    /// If this matrix is itself a buffer, the contributions are appended to it. Otherwise the block rows are
+    /// summed in parallel, and each bloc of the matrix receives its contributions in the same order as if they
+    /// had been written sequentially in it.
+    void addBuffers(const type::vector<const Matrix*>& buffers)
+    {
+        if (assemblyBuffer)
+        {
+            for (const Matrix* buffer : buffers)
+                btemp.insert(btemp.end(), buffer->btemp.begin(), buffer->btemp.end());
+            lastBlocWritten.set();
+            return;
+        }
+
+        if (!btemp.empty())
+            compress();
+
+        // sort the contributions by block row, keeping their order
+        bufferRowBegin.assign(nBlocRow + 1, 0);
+        std::size_t nbEntries = 0;
+        for (const Matrix* buffer : buffers)
+        {
+            for (const IndexedBloc& b : buffer->btemp)
+                ++bufferRowBegin[b.l + 1];
+            nbEntries += buffer->btemp.size();
         }
+        if (nbEntries == 0) return;
+        for (Index i = 0; i < nBlocRow; ++i)
+            bufferRowBegin[i + 1] += bufferRowBegin[i];
+        bufferEntries.resize(nbEntries);
+        {
+            VecIndex position(bufferRowBegin.begin(), bufferRowBegin.end() - 1);
+            for (const Matrix* buffer : buffers)
+                for (const IndexedBloc& b : buffer->btemp)
+                    bufferEntries[position[b.l]++] = &b;
+        }
+
+        // The block rows are split in a fixed number of chunks, the blocs which are not in the matrix yet
+        // are summed in the chunk and added to the matrix at the end
+        auto* taskScheduler = sofa::simulation::TaskScheduler::getInstance();
+        const Index nbChunks = std::max<Index>(1, std::min<Index>(nBlocRow, 4 * Index(taskScheduler->getThreadCount())));
+        bufferNewBlocs.resize(nbChunks);
+
+        sofa::simulation::parallelForEach(Index(0), nbChunks, [&](Index chunk)
+        {
+            VecIndexedBloc& newBlocs = bufferNewBlocs[chunk];
+            newBlocs.clear();
+            Index rowId = 0;
+            for (Index i = chunk * nBlocRow / nbChunks; i < (chunk + 1) * nBlocRow / nbChunks; ++i)
+            {
+                if (bufferRowBegin[i] == bufferRowBegin[i + 1]) continue;
+                // the contributions of the row are sorted by column, keeping their order in each column, and
+                // merged with the columns of the row in the matrix
+                const auto first = bufferEntries.begin() + bufferRowBegin[i];
+                const auto last = bufferEntries.begin() + bufferRowBegin[i + 1];
+                std::stable_sort(first, last, [](const IndexedBloc* a, const IndexedBloc* b) { return a->c < b->c; });
+                const bool rowFound = sortedFind(rowIndex, i, rowId);
+                Index colId = rowFound ? rowBegin[rowId] : 0;
+                const Index colEnd = rowFound ? rowBegin[rowId + 1] : 0;
+                for (auto e = first; e != last;)
+                {
+                    const Index c = (*e)->c;
+                    while (colId < colEnd && (Index)colsIndex[colId] < c)
+                        ++colId;
+                    Bloc* value;
+                    if (colId < colEnd && (Index)colsIndex[colId] == c)
+                    {
+                        value = &colsValue[colId];
+                    }
+                    else
+                    {
+                        newBlocs.push_back(IndexedBloc(i, c));
+                        traits::clear(newBlocs.back().value);
+                        value = &newBlocs.back().value;
+                    }
+                    for (; e != last && (*e)->c == c; ++e)
+                        *value += (*e)->value;
+                }
+            }
+        }, 1);
+
+        bool hasNewBlocs = false;
+        for (const VecIndexedBloc& newBlocs : bufferNewBlocs)
+        {
+            btemp.insert(btemp.end(), newBlocs.begin(), newBlocs.end());
+            hasNewBlocs = hasNewBlocs || !newBlocs.empty();
+        }
+        if (hasNewBlocs)
+            compress();
     }
 
+    /// @}
+
     void compress() override
     {
+        if (assemblyBuffer) return;
         if (compressed && btemp.empty()) return;
         if (!btemp.empty())
         {
@@ -272,7 +451,7 @@ public:
                 Range inRow( oldRowBegin[inRowId], oldRowBegin[inRowId+1] );
                 while (!inRow.empty())
                 {
-                    if (!traits::empty(oldColsValue[inRow.begin()]))
+                    if (patternLocked || !traits::empty(oldColsValue[inRow.begin()]))
                     {
                         colsIndex.push_back(oldColsIndex[inRow.begin()]);
                         colsValue.push_back(oldColsValue[inRow.begin()]);
@@ -316,7 +495,7 @@ public:
                 {
                     if (inColIndex < bColIndex)
                     {
-                        if (!traits::empty(oldColsValue[inRow.begin()]))
+                        if (patternLocked || !traits::empty(oldColsValue[inRow.begin()]))
                         {
                             colsIndex.push_back(inColIndex);
                             colsValue.push_back(oldColsValue[inRow.begin()]);
@@ -640,6 +819,16 @@ public:
 
     Bloc* wbloc(Index i, Index j, bool create = false)
     {
+        if (create && assemblyBuffer)
+        {
+            btemp.push_back(IndexedBloc(i,j));
+            traits::clear(btemp.back().value);
+            lastBlocWritten.set();
+            return &btemp.back().value;
+        }
+        if (create && patternLocked)
+            return wblocLockedPattern(i, j);
+
         Index rowId = i * (Index)rowIndex.size() / nBlocRow;
         if (sortedFind(rowIndex, i, rowId))
         {
@@ -669,6 +858,49 @@ public:
         return nullptr;
     }
 
+protected:
+    /// wbloc(i,j,true) when the pattern is locked: the position of the bloc is first looked for in the cache
+    Bloc* wblocLockedPattern(Index i, Index j)
+    {
+        const Index call = patternCursor++;
+        if (call < (Index)patternSlots.size())
+        {
+            // the cached position is checked against the current structure, which may have changed since it was stored
+            const PatternSlot& slot = patternSlots[call];
+            if (slot.rowId < rowIndex.size() && rowIndex[slot.rowId] == (sofa::Index)i
+                && slot.valueId >= rowBegin[slot.rowId] && slot.valueId < rowBegin[slot.rowId+1]
+                && colsIndex[slot.valueId] == (sofa::Index)j)
+            {
+                return &colsValue[slot.valueId];
+            }
+        }
+        else
+        {
+            patternSlots.push_back({ sofa::InvalidID, sofa::InvalidID });
+        }
+
+        Index rowId = i * (Index)rowIndex.size() / nBlocRow;
+        if (sortedFind(rowIndex, i, rowId))
+        {
+            Range rowRange(rowBegin[rowId], rowBegin[rowId+1]);
+            Index colId = rowRange.begin() + j * rowRange.size() / nBlocCol;
+            if (sortedFind(colsIndex, rowRange, j, colId))
+            {
+                patternSlots[call] = { (sofa::Index)rowId, (sofa::Index)colId };
+                return &colsValue[colId];
+            }
+        }
+
+        // new bloc, added to the pattern at the next compression
+        if (btemp.empty() || btemp.back().l != i || btemp.back().c != j)
+        {
+            btemp.push_back(IndexedBloc(i,j));
+            traits::clear(btemp.back().value);
+        }
+        return &btemp.back().value;
+    }
+
+public:
     ///< Mathematical size of the matrix
     Index rowSize() const override
     {
@@ -745,6 +977,21 @@ public:
         dmsg_info_when(EMIT_EXTRA_MESSAGE)
             << "(" << rowBSize() << "*" << NL << "," << colBSize() << "*" << NC << "): bloc(" << i << "," << j << ")[" << bi << "," << bj << "] += " << v;
 
+        if (assemblyBuffer)
+        {
+            // a new bloc is needed if this entry of the last bloc already received a contribution
+            const std::size_t entry = bi * NC + bj;
+            if (btemp.empty() || btemp.back().l != i || btemp.back().c != j || lastBlocWritten.test(entry))
+            {
+                btemp.push_back(IndexedBloc(i,j));
+                traits::clear(btemp.back().value);
+                lastBlocWritten.reset();
+            }
+            lastBlocWritten.set(entry);
+            traits::v(btemp.back().value, bi, bj) += (Real)v;
+            return;
+        }
+
         traits::v(*wbloc(i,j,true), bi, bj) += (Real)v;
     }
 
@@ -870,8 +1117,10 @@ public:
     {
         for (Index i=0; i < (Index)colsValue.size(); ++i)
             traits::clear(colsValue[i]);
-        compressed = colsValue.empty();
+        compressed = patternLocked || colsValue.empty();
         btemp.clear();
+        patternCursor = 0;
+        lastBlocWritten.set();
     }
 
     /// @name Get information about the content and structure of this matrix (diagonal, band, sparse, full, block size, ...)
@@ -1397,6 +1646,36 @@ protected:
       }
 
 
+      /// Compute the product of the BaseMatrix operators with the BCSR kernels, if the block and vector types allow it
+      bool opBCSRKernel(defaulttype::BaseVector* result, const defaulttype::BaseVector* v, bool add, bool transpose) const
+      {
+          if constexpr (canUseBCSRKernels< FullVector<double>, FullVector<double> >())
+          {
+              auto* fullResult = dynamic_cast<FullVector<double>*>(result);
+              const auto* fullV = dynamic_cast<const FullVector<double>*>(v);
+              if (!fullResult || !fullV)
+                  return false;
+
+              const bcsr::MatrixView view = getBCSRView();
+              const Index size = transpose ? colSize() : rowSize();
+              if (fullResult->size() != size)
+                  fullResult->resize(size);
+              if (transpose)
+                  bcsr::mulTransposeAdd(view, fullV->ptr(), fullResult->ptr(), 1.0, add ? 1.0 : 0.0);
+              else
+                  bcsr::mulAdd(view, fullV->ptr(), fullResult->ptr(), 1.0, add ? 1.0 : 0.0);
+              return true;
+          }
+          else
+          {
+              SOFA_UNUSED(result);
+              SOFA_UNUSED(v);
+              SOFA_UNUSED(add);
+              SOFA_UNUSED(transpose);
+              return false;
+          }
+      }
+
 /// @}
 
 
@@ -1527,12 +1806,54 @@ public:
     /// @name specialization of product methods on a few vector types
     /// @{
 
+    /// True if the products with vectors of types V1 and V2 are computed by the kernels of CompressedRowSparseMatrixKernels.h:
+    /// the blocks must be square matrices of double of size 1, 3 or 6, and the vectors FullVector<double>.
+    template< typename V1, typename V2 >
+    static constexpr bool canUseBCSRKernels()
+    {
+        if constexpr (std::is_same_v<Real, double> && int(NL) == int(NC) && bcsr::hasKernel(NL))
+        {
+            return sizeof(Bloc) == NL * NC * sizeof(double)
+                && std::is_same_v<typename VecIndex::value_type, sofa::Index>
+                && std::is_same_v<V1, FullVector<double> > && std::is_same_v<V2, FullVector<double> >;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    /// View on the compressed data of the matrix, used by the BCSR kernels
+    bcsr::MatrixView getBCSRView() const
+    {
+        ((Matrix*)this)->compress();
+        bcsr::MatrixView view;
+        view.blockSize = NL;
+        view.nbBlockRows = rowBSize();
+        view.nbBlockCols = colBSize();
+        view.nbNonEmptyRows = static_cast<sofa::Index>(rowIndex.size());
+        view.rowIndex = rowIndex.data();
+        view.rowBegin = rowBegin.data();
+        view.colsIndex = colsIndex.data();
+        view.values = reinterpret_cast<const double*>(colsValue.data());
+        return view;
+    }
+
     /// equal result = this * v
     /// @warning The block sizes must be compatible ie v.size() must be a multiple of block size.
     template< typename V1, typename V2 >
     void mul( V2& result, const V1& v ) const
     {
-        tmul< Real, V2, V1 >(result, v);
+        if constexpr (canUseBCSRKernels<V1, V2>())
+        {
+            const bcsr::MatrixView view = getBCSRView();
+            result.fastResize(rowSize());
+            bcsr::mulAdd(view, v.ptr(), result.ptr(), 1.0, 0.0);
+        }
+        else
+        {
+            tmul< Real, V2, V1 >(result, v);
+        }
     }
 
 
@@ -1541,7 +1862,40 @@ public:
     template< typename V1, typename V2 >
     void addMultTranspose( V1& result, const V2& v ) const
     {
-        taddMulTranspose< Real, V1, V2 >(result, v);
+        if constexpr (canUseBCSRKernels<V1, V2>())
+        {
+            const bcsr::MatrixView view = getBCSRView();
+            if (result.size() != colSize()) result.resize(colSize());
+            bcsr::mulTransposeAdd(view, v.ptr(), result.ptr(), 1.0, 1.0);
+        }
+        else
+        {
+            taddMulTranspose< Real, V1, V2 >(result, v);
+        }
+    }
+
+    /// equal result = alpha * this * v + beta * result, in a single pass over result
+    /// @warning The block sizes must be compatible ie v.size() must be a multiple of block size.
+    /// If beta is not 0, result must have the size of the rows of the matrix.
+    template< typename V1, typename V2 >
+    void mulAdd( V1& result, const V2& v, Real alpha, Real beta ) const
+    {
+        if constexpr (canUseBCSRKernels<V1, V2>())
+        {
+            const bcsr::MatrixView view = getBCSRView();
+            if (result.size() != rowSize()) result.resize(rowSize());
+            bcsr::mulAdd(view, v.ptr(), result.ptr(), alpha, beta);
+        }
+        else
+        {
+            V1 product;
+            tmul< Real, V1, V2 >(product, v);
+            if (beta == 0)
+                vresize(result, rowBSize(), rowSize());
+            for (Index i = 0; i < rowBSize(); ++i)
+                for (Index bi = 0; bi < NL; ++bi)
+                    vset(result, i, NL, bi, alpha * vget(product, i, NL, bi) + (beta == 0 ? Real(0) : beta * vget(result, i, NL, bi)));
+        }
     }
 
     /// @returns this * v
@@ -1573,7 +1927,49 @@ public:
     template< typename V1, typename V2 >
     void addMul( V1& res, const V2& v ) const
     {
-        taddMul< Real,V1,V2 >( res, v );
+        if constexpr (canUseBCSRKernels<V1, V2>())
+        {
+            const bcsr::MatrixView view = getBCSRView();
+            if (res.size() != rowSize()) res.resize(rowSize());
+            bcsr::mulAdd(view, v.ptr(), res.ptr(), 1.0, 1.0);
+        }
+        else
+        {
+            taddMul< Real,V1,V2 >( res, v );
+        }
+    }
+
+    using defaulttype::BaseMatrix::opMulV;
+    using defaulttype::BaseMatrix::opPMulV;
+    using defaulttype::BaseMatrix::opMulTV;
+    using defaulttype::BaseMatrix::opPMulTV;
+
+    /// Multiply the matrix by vector v and put the result in vector result
+    void opMulV(defaulttype::BaseVector* result, const defaulttype::BaseVector* v) const override
+    {
+        if (!opBCSRKernel(result, v, false, false))
+            defaulttype::BaseMatrix::opMulV(result, v);
+    }
+
+    /// Multiply the matrix by vector v and add the result in vector result
+    void opPMulV(defaulttype::BaseVector* result, const defaulttype::BaseVector* v) const override
+    {
+        if (!opBCSRKernel(result, v, true, false))
+            defaulttype::BaseMatrix::opPMulV(result, v);
+    }
+
+    /// Multiply the transposed matrix by vector v and put the result in vector result
+    void opMulTV(defaulttype::BaseVector* result, const defaulttype::BaseVector* v) const override
+    {
+        if (!opBCSRKernel(result, v, false, true))
+            defaulttype::BaseMatrix::opMulTV(result, v);
+    }
+
+    /// Multiply the transposed matrix by vector v and add the result in vector result
+    void opPMulTV(defaulttype::BaseVector* result, const defaulttype::BaseVector* v) const override
+    {
+        if (!opBCSRKernel(result, v, true, true))
+            defaulttype::BaseMatrix::opPMulTV(result, v);
     }
 
 
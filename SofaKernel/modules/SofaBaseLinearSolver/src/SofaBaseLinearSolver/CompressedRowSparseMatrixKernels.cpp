@@ -0,0 +1,441 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaBaseLinearSolver/CompressedRowSparseMatrixKernels.h>
+
+#include <atomic>
+#include <cassert>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SOFA_BCSR_X86_KERNELS
+#include <immintrin.h>
+#define SOFA_BCSR_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define SOFA_BCSR_TARGET_AVX512 __attribute__((target("avx2,fma,avx512f,avx512vl")))
+#endif
+
+namespace sofa::component::linearsolver::bcsr
+{
+
+namespace
+{
+
+/// Compute the products of the blocks of one block row with x: acc = sum_k blocks[k] * x[cols[k]]
+using RowProduct = void (*)(const double* blocks, const sofa::Index* cols, sofa::Index count, const double* x, double* acc);
+
+/// Accumulate the products of the transposed blocks of one block row with v: y[cols[k]] += blocks[k]^T * v
+using RowTransposeProduct = void (*)(const double* blocks, const sofa::Index* cols, sofa::Index count, const double* v, double* y);
+
+/// y = alpha * A * x + beta * y, the products of the block rows being computed by rowProduct
+template<int N>
+void mulAddRows(const MatrixView& A, const double* x, double* y, double alpha, double beta, RowProduct rowProduct)
+{
+    auto scaleRows = [&](sofa::Index begin, sofa::Index end)
+    {
+        if (beta == 0.0)
+            for (sofa::Index i = begin * N; i < end * N; ++i) y[i] = 0.0;
+        else if (beta != 1.0)
+            for (sofa::Index i = begin * N; i < end * N; ++i) y[i] *= beta;
+    };
+
+    sofa::Index nextRow = 0;
+    for (sofa::Index r = 0; r < A.nbNonEmptyRows; ++r)
+    {
+        const sofa::Index row = A.rowIndex[r];
+        scaleRows(nextRow, row);
+
+        double acc[N];
+        const sofa::Index begin = A.rowBegin[r];
+        rowProduct(A.values + (std::size_t)begin * N * N, A.colsIndex + begin, A.rowBegin[r+1] - begin, x, acc);
+
+        double* yRow = y + (std::size_t)row * N;
+        if (beta == 0.0)
+            for (int i = 0; i < N; ++i) yRow[i] = alpha * acc[i];
+        else
+            for (int i = 0; i < N; ++i) yRow[i] = alpha * acc[i] + beta * yRow[i];
+
+        nextRow = row + 1;
+    }
+    scaleRows(nextRow, A.nbBlockRows);
+}
+
+/// y = alpha * A^T * x + beta * y, the products of the transposed block rows being computed by rowProduct
+template<int N>
+void mulTransposeAddRows(const MatrixView& A, const double* x, double* y, double alpha, double beta, RowTransposeProduct rowProduct)
+{
+    const std::size_t size = (std::size_t)A.nbBlockCols * N;
+    if (beta == 0.0)
+        for (std::size_t i = 0; i < size; ++i) y[i] = 0.0;
+    else if (beta != 1.0)
+        for (std::size_t i = 0; i < size; ++i) y[i] *= beta;
+
+    for (sofa::Index r = 0; r < A.nbNonEmptyRows; ++r)
+    {
+        double v[N];
+        const double* xRow = x + (std::size_t)A.rowIndex[r] * N;
+        for (int i = 0; i < N; ++i) v[i] = alpha * xRow[i];
+
+        const sofa::Index begin = A.rowBegin[r];
+        rowProduct(A.values + (std::size_t)begin * N * N, A.colsIndex + begin, A.rowBegin[r+1] - begin, v, y);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+// Generic kernels
+
+template<int N>
+void genericRowProduct(const double* blocks, const sofa::Index* cols, sofa::Index count, const double* x, double* acc)
+{
+    for (int i = 0; i < N; ++i) acc[i] = 0.0;
+    for (sofa::Index k = 0; k < count; ++k)
+    {
+        const double* b = blocks + (std::size_t)k * N * N;
+        const double* xb = x + (std::size_t)cols[k] * N;
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                acc[i] += b[i * N + j] * xb[j];
+    }
+}
+
+template<int N>
+void genericRowTransposeProduct(const double* blocks, const sofa::Index* cols, sofa::Index count, const double* v, double* y)
+{
+    for (sofa::Index k = 0; k < count; ++k)
+    {
+        const double* b = blocks + (std::size_t)k * N * N;
+        double* yb = y + (std::size_t)cols[k] * N;
+        double r[N];
+        for (int j = 0; j < N; ++j) r[j] = yb[j];
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                r[j] += b[i * N + j] * v[i];
+        for (int j = 0; j < N; ++j) yb[j] = r[j];
+    }
+}
+
+#ifdef SOFA_BCSR_X86_KERNELS
+
+//////////////////////////////////////////////////////////////////////
+// AVX2 kernels
+
+SOFA_BCSR_TARGET_AVX2 inline double horizontalSum(__m256d v)
+{
+    const __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+SOFA_BCSR_TARGET_AVX2 inline double horizontalSum(__m128d v)
+{
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+SOFA_BCSR_TARGET_AVX2 void avx2RowProduct1(const double* values, const sofa::Index* cols, sofa::Index count, const double* x, double* acc)
+{
+    __m256d sum = _mm256_setzero_pd();
+    sofa::Index k = 0;
+    for (; k + 4 <= count; k += 4)
+    {
+        const __m128i index = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cols + k));
+        sum = _mm256_fmadd_pd(_mm256_loadu_pd(values + k), _mm256_i32gather_pd(x, index, 8), sum);
+    }
+    double result = horizontalSum(sum);
+    for (; k < count; ++k) result += values[k] * x[cols[k]];
+    acc[0] = result;
+}
+
+/// The rows of a 3x3 block, and the chunks of x, are loaded in the 3 first lanes of 4-lane registers
+SOFA_BCSR_TARGET_AVX2 void avx2RowProduct3(const double* blocks, const sofa::Index* cols, sofa::Index count, const double* x, double* acc)
+{
+    const __m256i mask = _mm256_set_epi64x(0, -1, -1, -1);
+    __m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd(), a2 = _mm256_setzero_pd();
+    for (sofa::Index k = 0; k < count; ++k)
+    {
+        const double* b = blocks + (std::size_t)k * 9;
+        const __m256d xb = _mm256_maskload_pd(x + (std::size_t)cols[k] * 3, mask);
+        a0 = _mm256_fmadd_pd(_mm256_maskload_pd(b, mask), xb, a0);
+        a1 = _mm256_fmadd_pd(_mm256_maskload_pd(b + 3, mask), xb, a1);
+        a2 = _mm256_fmadd_pd(_mm256_maskload_pd(b + 6, mask), xb, a2);
+    }
+    acc[0] = horizontalSum(a0);
+    acc[1] = horizontalSum(a1);
+    acc[2] = horizontalSum(a2);
+}
+
+/// The rows of a 6x6 block, and the chunks of x, are split in a 4-lane and a 2-lane register
+SOFA_BCSR_TARGET_AVX2 void avx2RowProduct6(const double* blocks, const sofa::Index* cols, sofa::Index count, const double* x, double* acc)
+{
+    __m256d lo[6];
+    __m128d hi[6];
+    for (int i = 0; i < 6; ++i)
+    {
+        lo[i] = _mm256_setzero_pd();
+        hi[i] = _mm_setzero_pd();
+    }
+    for (sofa::Index k = 0; k < count; ++k)
+    {
+        const double* b = blocks + (std::size_t)k * 36;
+        const double* xb = x + (std::size_t)cols[k] * 6;
+        const __m256d xlo = _mm256_loadu_pd(xb);
+        const __m128d xhi = _mm_loadu_pd(xb + 4);
+        for (int i = 0; i < 6; ++i)
+        {
+            lo[i] = _mm256_fmadd_pd(_mm256_loadu_pd(b + 6 * i), xlo, lo[i]);
+            hi[i] = _mm_fmadd_pd(_mm_loadu_pd(b + 6 * i + 4), xhi, hi[i]);
+        }
+    }
+    for (int i = 0; i < 6; ++i) acc[i] = horizontalSum(lo[i]) + horizontalSum(hi[i]);
+}
+
+/// y is updated with 2+1 lanes: masked stores would prevent the store forwarding between consecutive blocks
+SOFA_BCSR_TARGET_AVX2 void avx2RowTransposeProduct3(const double* blocks, const sofa::Index* cols, sofa::Index count, const double* v, double* y)
+{
+    const __m128d v0 = _mm_set1_pd(v[0]), v1 = _mm_set1_pd(v[1]), v2 = _mm_set1_pd(v[2]);
+    for (sofa::Index k = 0; k < count; ++k)
+    {
+        const double* b = blocks + (std::size_t)k * 9;
+        double* yb = y + (std::size_t)cols[k] * 3;
+        __m128d r01 = _mm_loadu_pd(yb);
+        __m128d r2 = _mm_load_sd(yb + 2);
+        r01 = _mm_fmadd_pd(_mm_loadu_pd(b), v0, r01);
+        r2 = _mm_fmadd_sd(_mm_load_sd(b + 2), v0, r2);
+        r01 = _mm_fmadd_pd(_mm_loadu_pd(b + 3), v1, r01);
+        r2 = _mm_fmadd_sd(_mm_load_sd(b + 5), v1, r2);
+        r01 = _mm_fmadd_pd(_mm_loadu_pd(b + 6), v2, r01);
+        r2 = _mm_fmadd_sd(_mm_load_sd(b + 8), v2, r2);
+        _mm_storeu_pd(yb, r01);
+        _mm_store_sd(yb + 2, r2);
+    }
+}
+
+SOFA_BCSR_TARGET_AVX2 void avx2RowTransposeProduct6(const double* blocks, const sofa::Index* cols, sofa::Index count, const double* v, double* y)
+{
+    for (sofa::Index k = 0; k < count; ++k)
+    {
+        const double* b = blocks + (std::size_t)k * 36;
+        double* yb = y + (std::size_t)cols[k] * 6;
+        __m256d lo = _mm256_loadu_pd(yb);
+        __m128d hi = _mm_loadu_pd(yb + 4);
+        for (int i = 0; i < 6; ++i)
+        {
+            lo = _mm256_fmadd_pd(_mm256_loadu_pd(b + 6 * i), _mm256_set1_pd(v[i]), lo);
+            hi = _mm_fmadd_pd(_mm_loadu_pd(b + 6 * i + 4), _mm_set1_pd(v[i]), hi);
+        }
+        _mm256_storeu_pd(yb, lo);
+        _mm_storeu_pd(yb + 4, hi);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+// AVX-512 kernels
+
+SOFA_BCSR_TARGET_AVX512 void avx512RowProduct1(const double* values, const sofa::Index* cols, sofa::Index count, const double* x, double* acc)
+{
+    __m512d sum = _mm512_setzero_pd();
+    sofa::Index k = 0;
+    for (; k + 8 <= count; k += 8)
+    {
+        const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cols + k));
+        sum = _mm512_fmadd_pd(_mm512_loadu_pd(values + k), _mm512_i32gather_pd(index, x, 8), sum);
+    }
+    if (k < count)
+    {
+        const __mmask8 mask = static_cast<__mmask8>((1u << (count - k)) - 1);
+        const __m256i index = _mm256_maskz_loadu_epi32(mask, cols + k);
+        const __m512d xk = _mm512_mask_i32gather_pd(_mm512_setzero_pd(), mask, index, x, 8);
+        sum = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, values + k), xk, sum);
+    }
+    acc[0] = _mm512_reduce_add_pd(sum);
+}
+
+/// A 3x3 block is 9 contiguous values: its 8 first values are multiplied at once by (x0 x1 x2 x0 x1 x2 x0 x1)
+SOFA_BCSR_TARGET_AVX512 void avx512RowProduct3(const double* blocks, const sofa::Index* cols, sofa::Index count, const double* x, double* acc)
+{
+    const __m512i repeat = _mm512_set_epi64(1, 0, 2, 1, 0, 2, 1, 0);
+    __m512d sum = _mm512_setzero_pd();
+    double last = 0.0;
+    for (sofa::Index k = 0; k < count; ++k)
+    {
+        const double* b = blocks + (std::size_t)k * 9;
+        const double* xb = x + (std::size_t)cols[k] * 3;
+        const __m512d xr = _mm512_permutexvar_pd(repeat, _mm512_castpd256_pd512(_mm256_maskz_loadu_pd(0x7, xb)));
+        sum = _mm512_fmadd_pd(_mm512_loadu_pd(b), xr, sum);
+        last += b[8] * xb[2];
+    }
+    alignas(64) double s[8];
+    _mm512_store_pd(s, sum);
+    acc[0] = s[0] + s[1] + s[2];
+    acc[1] = s[3] + s[4] + s[5];
+    acc[2] = s[6] + s[7] + last;
+}
+
+SOFA_BCSR_TARGET_AVX512 void avx512RowProduct6(const double* blocks, const sofa::Index* cols, sofa::Index count, const double* x, double* acc)
+{
+    __m512d a[6];
+    for (int i = 0; i < 6; ++i) a[i] = _mm512_setzero_pd();
+    for (sofa::Index k = 0; k < count; ++k)
+    {
+        const double* b = blocks + (std::size_t)k * 36;
+        const __m512d xb = _mm512_maskz_loadu_pd(0x3F, x + (std::size_t)cols[k] * 6);
+        for (int i = 0; i < 6; ++i)
+            a[i] = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(0x3F, b + 6 * i), xb, a[i]);
+    }
+    for (int i = 0; i < 6; ++i) acc[i] = _mm512_reduce_add_pd(a[i]);
+}
+
+/// The columns of a block row are distinct, so the scattered entries of y do not conflict
+SOFA_BCSR_TARGET_AVX512 void avx512RowTransposeProduct1(const double* values, const sofa::Index* cols, sofa::Index count, const double* v, double* y)
+{
+    const __m512d vk = _mm512_set1_pd(v[0]);
+    sofa::Index k = 0;
+    for (; k + 8 <= count; k += 8)
+    {
+        const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cols + k));
+        const __m512d yk = _mm512_i32gather_pd(index, y, 8);
+        _mm512_i32scatter_pd(y, index, _mm512_fmadd_pd(_mm512_loadu_pd(values + k), vk, yk), 8);
+    }
+    for (; k < count; ++k) y[cols[k]] += values[k] * v[0];
+}
+
+SOFA_BCSR_TARGET_AVX512 void avx512RowTransposeProduct6(const double* blocks, const sofa::Index* cols, sofa::Index count, const double* v, double* y)
+{
+    for (sofa::Index k = 0; k < count; ++k)
+    {
+        const double* b = blocks + (std::size_t)k * 36;
+        double* yb = y + (std::size_t)cols[k] * 6;
+        __m512d r = _mm512_maskz_loadu_pd(0x3F, yb);
+        for (int i = 0; i < 6; ++i)
+            r = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(0x3F, b + 6 * i), _mm512_set1_pd(v[i]), r);
+        _mm512_mask_storeu_pd(yb, 0x3F, r);
+    }
+}
+
+#endif // SOFA_BCSR_X86_KERNELS
+
+//////////////////////////////////////////////////////////////////////
+// Dispatch
+
+/// Row kernels of an instruction set, for the block sizes 1, 3 and 6
+struct RowKernels
+{
+    RowProduct product[3];
+    RowTransposeProduct transposeProduct[3];
+};
+
+const RowKernels& getRowKernels(InstructionSet instructionSet)
+{
+    static const RowKernels generic {
+        { genericRowProduct<1>, genericRowProduct<3>, genericRowProduct<6> },
+        { genericRowTransposeProduct<1>, genericRowTransposeProduct<3>, genericRowTransposeProduct<6> } };
+#ifdef SOFA_BCSR_X86_KERNELS
+    // the scalar transposed product cannot be vectorized without scatter instructions
+    static const RowKernels avx2 {
+        { avx2RowProduct1, avx2RowProduct3, avx2RowProduct6 },
+        { genericRowTransposeProduct<1>, avx2RowTransposeProduct3, avx2RowTransposeProduct6 } };
+    // the 3x3 transposed product only uses 3 lanes, the AVX2 kernel is as fast
+    static const RowKernels avx512 {
+        { avx512RowProduct1, avx512RowProduct3, avx512RowProduct6 },
+        { avx512RowTransposeProduct1, avx2RowTransposeProduct3, avx512RowTransposeProduct6 } };
+
+    switch (instructionSet)
+    {
+    case InstructionSet::AVX512: return avx512;
+    case InstructionSet::AVX2: return avx2;
+    default: break;
+    }
+#else
+    SOFA_UNUSED(instructionSet);
+#endif
+    return generic;
+}
+
+std::atomic<InstructionSet>& currentInstructionSet()
+{
+    static std::atomic<InstructionSet> instructionSet { detectInstructionSet() };
+    return instructionSet;
+}
+
+int blockSizeSlot(int blockSize)
+{
+    return blockSize == 1 ? 0 : (blockSize == 3 ? 1 : 2);
+}
+
+} // namespace
+
+InstructionSet detectInstructionSet()
+{
+#ifdef SOFA_BCSR_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl"))
+        return InstructionSet::AVX512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return InstructionSet::AVX2;
+#endif
+    return InstructionSet::Generic;
+}
+
+InstructionSet getInstructionSet()
+{
+    return currentInstructionSet().load(std::memory_order_relaxed);
+}
+
+InstructionSet setInstructionSet(InstructionSet instructionSet)
+{
+    const InstructionSet detected = detectInstructionSet();
+    if (static_cast<int>(instructionSet) > static_cast<int>(detected))
+        instructionSet = detected;
+    currentInstructionSet().store(instructionSet, std::memory_order_relaxed);
+    return instructionSet;
+}
+
+const char* getInstructionSetName(InstructionSet instructionSet)
+{
+    switch (instructionSet)
+    {
+    case InstructionSet::AVX512: return "AVX-512";
+    case InstructionSet::AVX2: return "AVX2";
+    default: return "generic";
+    }
+}
+
+void mulAdd(const MatrixView& A, const double* x, double* y, double alpha, double beta)
+{
+    const RowProduct rowProduct = getRowKernels(getInstructionSet()).product[blockSizeSlot(A.blockSize)];
+    switch (A.blockSize)
+    {
+    case 1: mulAddRows<1>(A, x, y, alpha, beta, rowProduct); break;
+    case 3: mulAddRows<3>(A, x, y, alpha, beta, rowProduct); break;
+    case 6: mulAddRows<6>(A, x, y, alpha, beta, rowProduct); break;
+    default: assert(false && "unsupported block size"); break;
+    }
+}
+
+void mulTransposeAdd(const MatrixView& A, const double* x, double* y, double alpha, double beta)
+{
+    const RowTransposeProduct rowProduct = getRowKernels(getInstructionSet()).transposeProduct[blockSizeSlot(A.blockSize)];
+    switch (A.blockSize)
+    {
+    case 1: mulTransposeAddRows<1>(A, x, y, alpha, beta, rowProduct); break;
+    case 3: mulTransposeAddRows<3>(A, x, y, alpha, beta, rowProduct); break;
+    case 6: mulTransposeAddRows<6>(A, x, y, alpha, beta, rowProduct); break;
+    default: assert(false && "unsupported block size"); break;
+    }
+}
+
+} // namespace sofa::component::linearsolver::bcsr
@@ -0,0 +1,88 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaBaseLinearSolver/config.h>
+
+#include <sofa/config.h>
+
+namespace sofa::component::linearsolver::bcsr
+{
+
+/**
+ * Matrix-vector product kernels for block compressed row (BCSR) matrices of double, with square blocks of size 1, 3 or 6.
+ *
+ * They work on the raw arrays of a CompressedRowSparseMatrix, avoiding the generic per-block templates and the
+ * virtual accessors of BaseMatrix. Each kernel has a generic version and, on x86 with GCC or Clang, vectorized
+ * versions using AVX2+FMA and AVX-512. The version is chosen at runtime according to the CPU.
+ *
+ * The vectorized kernels do not sum the terms in the same order as the generic ones, so the results can differ
+ * in the last bits.
+ */
+
+/// Instruction sets of the kernels, from the slowest to the fastest
+enum class InstructionSet
+{
+    Generic = 0,
+    AVX2 = 1,
+    AVX512 = 2
+};
+
+/// Best instruction set supported both by the compiler and by the CPU
+SOFA_SOFABASELINEARSOLVER_API InstructionSet detectInstructionSet();
+
+/// Instruction set used by the kernels, detectInstructionSet() by default
+SOFA_SOFABASELINEARSOLVER_API InstructionSet getInstructionSet();
+
+/// Force the instruction set used by the kernels, for testing or benchmarking.
+/// It cannot be higher than detectInstructionSet(): returns the instruction set actually used.
+SOFA_SOFABASELINEARSOLVER_API InstructionSet setInstructionSet(InstructionSet instructionSet);
+
+SOFA_SOFABASELINEARSOLVER_API const char* getInstructionSetName(InstructionSet instructionSet);
+
+/// Read-only view on a BCSR matrix, as stored by a compressed CompressedRowSparseMatrix:
+/// the blocks of the block row rowIndex[r] (r < nbNonEmptyRows) are values[rowBegin[r]..rowBegin[r+1]),
+/// stored row-major, in the block columns colsIndex[rowBegin[r]..rowBegin[r+1]).
+struct MatrixView
+{
+    int blockSize { 1 };
+    sofa::Index nbBlockRows { 0 };
+    sofa::Index nbBlockCols { 0 };
+    sofa::Index nbNonEmptyRows { 0 };
+    const sofa::Index* rowIndex { nullptr };
+    const sofa::Index* rowBegin { nullptr };
+    const sofa::Index* colsIndex { nullptr };
+    const double* values { nullptr };
+};
+
+/// Block sizes having dedicated kernels
+constexpr bool hasKernel(int blockSize)
+{
+    return blockSize == 1 || blockSize == 3 || blockSize == 6;
+}
+
+/// y = alpha * A * x + beta * y. If beta is 0, y is not read.
+SOFA_SOFABASELINEARSOLVER_API void mulAdd(const MatrixView& A, const double* x, double* y, double alpha = 1.0, double beta = 0.0);
+
+/// y = alpha * A^T * x + beta * y. If beta is 0, y is not read.
+SOFA_SOFABASELINEARSOLVER_API void mulTransposeAdd(const MatrixView& A, const double* x, double* y, double alpha = 1.0, double beta = 0.0);
+
+} // namespace sofa::component::linearsolver::bcsr
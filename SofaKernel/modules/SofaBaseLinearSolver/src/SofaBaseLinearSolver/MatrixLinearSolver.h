@@ -33,6 +33,9 @@
 #include <SofaBaseLinearSolver/DiagonalMatrix.h>
 #include <SofaBaseLinearSolver/RotationMatrix.h>
 
+#include <memory>
+#include <type_traits>
+
 #ifdef SOFA_SUPPORT_CRS_MATRIX
 #include <SofaBaseLinearSolver/CRSMultiMatrixAccessor.h>
 #else
@@ -157,6 +160,20 @@ private :
     JMatrixType J_local;
 };
 
+/// True if the sparsity pattern of the matrix can be locked between two assemblies (see CompressedRowSparseMatrix::setPatternLocked)
+template<class TMatrix, class = void>
+struct MatrixHasLockablePattern : std::false_type {};
+
+template<class TMatrix>
+struct MatrixHasLockablePattern<TMatrix, std::void_t<decltype(std::declval<TMatrix&>().setPatternLocked(true))> > : std::true_type {};
+
+/// True if the matrix can be assembled in parallel in assembly buffers (see CompressedRowSparseMatrix::setAssemblyBuffer)
+template<class TMatrix, class = void>
+struct MatrixHasAssemblyBuffer : std::false_type {};
+
+template<class TMatrix>
+struct MatrixHasAssemblyBuffer<TMatrix, std::void_t<decltype(std::declval<TMatrix&>().setAssemblyBuffer(true))> > : std::true_type {};
+
 template<class Matrix, class Vector, class ThreadManager = NoThreadManager>
 class MatrixLinearSolver;
 
@@ -173,6 +190,13 @@ public:
     typedef typename MatrixLinearSolverInternalData<Vector>::JMatrixType JMatrixType;
     typedef typename MatrixLinearSolverInternalData<Vector>::ResMatrixType ResMatrixType;
 
+    /// Keep the sparsity pattern of the system matrix from one assembly to the next (CompressedRowSparseMatrix only)
+    Data<bool> d_lockPattern;
+
+    /// Assemble the matrices of the force fields in parallel in buffers, which are then summed in the system matrix
+    /// in the same order as the sequential assembly (CompressedRowSparseMatrix only)
+    Data<bool> d_parallelAssembly;
+
     MatrixLinearSolver();
     ~MatrixLinearSolver() override ;
 
@@ -318,6 +342,25 @@ protected:
 
     virtual MatrixInvertData * createInvertData();
 
+    /// Lock the pattern of the system matrix if required, and rebuild it if a topology of the sub-graph changed
+    void updateSystemMatrixPattern();
+
+    /// Add the mass, damping and stiffness matrices of the force fields and apply the projective constraints
+    void addMBKToSystemMatrix(simulation::common::MechanicalOperations& mops, SReal mFact, SReal bFact, SReal kFact);
+
+    /// addMBKToSystemMatrix where each force field writes in its own assembly buffer, the force fields acting only
+    /// on non-mapped states being run in parallel
+    void parallelAddMBKToSystemMatrix(simulation::common::MechanicalOperations& mops, SReal mFact, SReal bFact, SReal kFact);
+
+    /// Assembly buffer of each force field, kept from one assembly to the next
+    type::vector<std::unique_ptr<Matrix> > m_assemblyBuffers;
+
+    /// Revisions of the topologies in the sub-graph of the solver, to detect the topological changes
+    type::vector<int> getTopologyRevisions() const;
+
+    /// Revisions of the topologies when the pattern of the system matrix was last updated
+    type::vector<int> m_topologyRevisions;
+
     struct LinearSystemData
     {
         bool needInvert;
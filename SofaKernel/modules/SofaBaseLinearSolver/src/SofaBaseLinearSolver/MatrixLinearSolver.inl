@@ -21,6 +21,14 @@
 ******************************************************************************/
 #pragma once
 #include <SofaBaseLinearSolver/MatrixLinearSolver.h>
+#include <SofaBaseLinearSolver/ParallelMatrixAssembly.h>
+#include <sofa/core/behavior/BaseForceField.h>
+#include <sofa/core/topology/BaseMeshTopology.h>
+#include <sofa/simulation/ParallelForEach.h>
+#include <sofa/simulation/VisitorExecuteFunc.h>
+
+#include <sofa/simulation/mechanicalvisitor/MechanicalApplyProjectiveConstraint_ToMatrixVisitor.h>
+using sofa::simulation::mechanicalvisitor::MechanicalApplyProjectiveConstraint_ToMatrixVisitor;
 
 #include <sofa/simulation/mechanicalvisitor/MechanicalGetConstraintJacobianVisitor.h>
 using sofa::simulation::mechanicalvisitor::MechanicalGetConstraintJacobianVisitor;
@@ -40,6 +48,8 @@ namespace sofa::component::linearsolver
 template<class Matrix, class Vector>
 MatrixLinearSolver<Matrix,Vector>::MatrixLinearSolver()
     : Inherit()
+    , d_lockPattern(initData(&d_lockPattern, false, "lockPattern", "Keep the sparsity pattern of the system matrix from one assembly to the next, and write the values directly in it. The pattern is rebuilt when the size of the system or a topology in the sub-graph changes (CompressedRowSparseMatrix only)"))
+    , d_parallelAssembly(initData(&d_parallelAssembly, false, "parallelAssembly", "Assemble the matrices of the force fields in parallel. The result is identical to the sequential assembly (CompressedRowSparseMatrix only)"))
     , invertData()
     , linearSystem()
     , currentMFactor(), currentBFactor(), currentKFactor()
@@ -97,6 +107,116 @@ void MatrixLinearSolver<Matrix,Vector>::resizeSystem(Size n)
     linearSystem.needInvert = true;
 }
 
+template<class Matrix, class Vector>
+void MatrixLinearSolver<Matrix,Vector>::updateSystemMatrixPattern()
+{
+    if constexpr (MatrixHasLockablePattern<Matrix>::value)
+    {
+        Matrix* matrix = linearSystem.systemMatrix;
+        const bool lock = d_lockPattern.getValue();
+        if (lock)
+        {
+            type::vector<int> revisions = getTopologyRevisions();
+            if (matrix->isPatternLocked() && revisions != m_topologyRevisions)
+            {
+                msg_info() << "Topological change: the pattern of the system matrix is rebuilt";
+                matrix->rebuildPattern();
+            }
+            m_topologyRevisions.swap(revisions);
+        }
+        matrix->setPatternLocked(lock);
+    }
+}
+
+template<class Matrix, class Vector>
+void MatrixLinearSolver<Matrix,Vector>::addMBKToSystemMatrix(simulation::common::MechanicalOperations& mops, SReal mFact, SReal bFact, SReal kFact)
+{
+    if constexpr (MatrixHasAssemblyBuffer<Matrix>::value)
+    {
+        if (d_parallelAssembly.getValue())
+        {
+            parallelAddMBKToSystemMatrix(mops, mFact, bFact, kFact);
+            return;
+        }
+    }
+    mops.addMBK_ToMatrix(&(linearSystem.matrixAccessor), mFact, bFact, kFact);
+}
+
+template<class Matrix, class Vector>
+void MatrixLinearSolver<Matrix,Vector>::parallelAddMBKToSystemMatrix(simulation::common::MechanicalOperations& mops, SReal mFact, SReal bFact, SReal kFact)
+{
+    if constexpr (MatrixHasAssemblyBuffer<Matrix>::value)
+    {
+        auto* taskScheduler = simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 1)
+        {
+            taskScheduler->init(0);
+            msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+        }
+
+        core::MechanicalParams* mparams = &mops.mparams;
+        mparams->setMFactor(mFact);
+        mparams->setBFactor(bFact);
+        mparams->setKFactor(kFact);
+
+        simulation::common::VisitorExecuteFunc execute(*this->getContext());
+        MechanicalGetMBKForceFieldsVisitor getForceFields(mparams, &linearSystem.matrixAccessor);
+        execute(&getForceFields);
+        const auto& forceFields = getForceFields.forceFields;
+
+        Matrix* matrix = linearSystem.systemMatrix;
+        while (m_assemblyBuffers.size() < forceFields.size())
+        {
+            m_assemblyBuffers.push_back(std::make_unique<Matrix>());
+            m_assemblyBuffers.back()->setAssemblyBuffer(true);
+        }
+
+        // The force fields which may use the matrices of the mapped states are run first, sequentially
+        type::vector<AssemblyBufferMatrixAccessor> accessors;
+        accessors.reserve(forceFields.size());
+        type::vector<std::size_t> parallelForceFields;
+        type::vector<const Matrix*> buffers;
+        for (std::size_t i = 0; i < forceFields.size(); ++i)
+        {
+            Matrix* buffer = m_assemblyBuffers[i].get();
+            buffer->resize(matrix->rowSize(), matrix->colSize());
+            buffers.push_back(buffer);
+            accessors.emplace_back(&linearSystem.matrixAccessor, matrix, buffer);
+            if (accessors.back().isThreadSafe(forceFields[i]))
+                parallelForceFields.push_back(i);
+            else
+                forceFields[i]->addMBKToMatrix(mparams, &accessors.back());
+        }
+
+        simulation::parallelForEach(std::size_t(0), parallelForceFields.size(), [&](std::size_t k)
+        {
+            const std::size_t i = parallelForceFields[k];
+            forceFields[i]->addMBKToMatrix(mparams, &accessors[i]);
+        }, 1);
+
+        matrix->addBuffers(buffers);
+
+        execute(MechanicalApplyProjectiveConstraint_ToMatrixVisitor(mparams, &linearSystem.matrixAccessor));
+    }
+    else
+    {
+        addMBKToSystemMatrix(mops, mFact, bFact, kFact);
+    }
+}
+
+template<class Matrix, class Vector>
+type::vector<int> MatrixLinearSolver<Matrix,Vector>::getTopologyRevisions() const
+{
+    type::vector<core::topology::BaseMeshTopology*> topologies;
+    this->getContext()->template get<core::topology::BaseMeshTopology>(&topologies, core::objectmodel::BaseContext::SearchDown);
+
+    type::vector<int> revisions;
+    revisions.reserve(topologies.size());
+    for (const auto* topology : topologies)
+        revisions.push_back(topology->getRevision());
+    return revisions;
+}
+
 template<class Matrix, class Vector>
 void MatrixLinearSolver<Matrix,Vector>::setSystemMatrix(Matrix * matrix)
 {
@@ -139,8 +259,9 @@ void MatrixLinearSolver<Matrix,Vector>::setSystemMBKMatrix(const core::Mechanica
 
         linearSystem.matrixAccessor.setupMatrices();
         resizeSystem(linearSystem.matrixAccessor.getGlobalDimension());
+        updateSystemMatrixPattern();
         linearSystem.systemMatrix->clear();
-        mops.addMBK_ToMatrix(&(linearSystem.matrixAccessor), mparams->mFactor(), sofa::core::mechanicalparams::bFactor(mparams), mparams->kFactor());
+        addMBKToSystemMatrix(mops, mparams->mFactor(), sofa::core::mechanicalparams::bFactor(mparams), mparams->kFactor());
         linearSystem.matrixAccessor.computeGlobalMatrix();
     }
 
@@ -162,8 +283,9 @@ void MatrixLinearSolver<Matrix,Vector>::rebuildSystem(double massFactor, double
         mops.getMatrixDimension(&(linearSystem.matrixAccessor));
         linearSystem.matrixAccessor.setupMatrices();
         resizeSystem(linearSystem.matrixAccessor.getGlobalDimension());
+        updateSystemMatrixPattern();
         linearSystem.systemMatrix->clear();
-        mops.addMBK_ToMatrix(&(linearSystem.matrixAccessor), mparams.mFactor(), mparams.bFactor(), mparams.kFactor());
+        addMBKToSystemMatrix(mops, mparams.mFactor(), mparams.bFactor(), mparams.kFactor());
         linearSystem.matrixAccessor.computeGlobalMatrix();
     }
 
@@ -0,0 +1,112 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaBaseLinearSolver/ParallelMatrixAssembly.h>
+
+#include <sofa/core/behavior/BaseForceField.h>
+#include <sofa/core/behavior/BaseInteractionForceField.h>
+#include <sofa/core/behavior/BaseMechanicalState.h>
+
+namespace sofa::component::linearsolver
+{
+
+MechanicalGetMBKForceFieldsVisitor::MechanicalGetMBKForceFieldsVisitor(const core::MechanicalParams* mparams, const core::behavior::MultiMatrixAccessor* matrix)
+    : MechanicalAddMBK_ToMatrixVisitor(mparams, matrix)
+{
+}
+
+simulation::Visitor::Result MechanicalGetMBKForceFieldsVisitor::fwdForceField(simulation::Node* /*node*/, core::behavior::BaseForceField* ff)
+{
+    if (matrix != nullptr)
+    {
+        forceFields.push_back(ff);
+    }
+    return RESULT_CONTINUE;
+}
+
+AssemblyBufferMatrixAccessor::AssemblyBufferMatrixAccessor(const core::behavior::MultiMatrixAccessor* accessor, const defaulttype::BaseMatrix* globalMatrix, defaulttype::BaseMatrix* buffer)
+    : m_accessor(accessor), m_globalMatrix(globalMatrix), m_buffer(buffer)
+{
+}
+
+AssemblyBufferMatrixAccessor::Index AssemblyBufferMatrixAccessor::getGlobalDimension() const
+{
+    return m_accessor->getGlobalDimension();
+}
+
+int AssemblyBufferMatrixAccessor::getGlobalOffset(const core::behavior::BaseMechanicalState* mstate) const
+{
+    return m_accessor->getGlobalOffset(mstate);
+}
+
+AssemblyBufferMatrixAccessor::MatrixRef AssemblyBufferMatrixAccessor::getMatrix(const core::behavior::BaseMechanicalState* mstate) const
+{
+    MatrixRef r;
+    const int offset = m_accessor->getGlobalOffset(mstate);
+    if (offset >= 0)
+    {
+        r.matrix = m_buffer;
+        r.offset = offset;
+        return r;
+    }
+
+    r = m_accessor->getMatrix(mstate);
+    if (r.matrix == m_globalMatrix)
+        r.matrix = m_buffer;
+    return r;
+}
+
+AssemblyBufferMatrixAccessor::InteractionMatrixRef AssemblyBufferMatrixAccessor::getMatrix(const core::behavior::BaseMechanicalState* mstate1, const core::behavior::BaseMechanicalState* mstate2) const
+{
+    InteractionMatrixRef r;
+    const int offset1 = m_accessor->getGlobalOffset(mstate1);
+    const int offset2 = m_accessor->getGlobalOffset(mstate2);
+    if (offset1 >= 0 && offset2 >= 0)
+    {
+        r.matrix = m_buffer;
+        r.offRow = offset1;
+        r.offCol = offset2;
+        return r;
+    }
+
+    r = m_accessor->getMatrix(mstate1, mstate2);
+    if (r.matrix == m_globalMatrix)
+        r.matrix = m_buffer;
+    return r;
+}
+
+bool AssemblyBufferMatrixAccessor::isThreadSafe(core::behavior::BaseForceField* ff) const
+{
+    if (auto* interaction = dynamic_cast<core::behavior::BaseInteractionForceField*>(ff))
+    {
+        return getGlobalOffset(interaction->getMechModel1()) >= 0 && getGlobalOffset(interaction->getMechModel2()) >= 0;
+    }
+
+    // the state of a force field is given by its link, or by its context by default
+    const core::behavior::BaseMechanicalState* mstate = nullptr;
+    if (const core::objectmodel::BaseLink* link = ff->findLink("mstate"))
+        mstate = dynamic_cast<const core::behavior::BaseMechanicalState*>(link->getLinkedBase());
+    if (mstate == nullptr)
+        mstate = ff->getContext()->getMechanicalState();
+    return mstate != nullptr && getGlobalOffset(mstate) >= 0;
+}
+
+} // namespace sofa::component::linearsolver
@@ -0,0 +1,72 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaBaseLinearSolver/config.h>
+
+#include <sofa/core/behavior/MultiMatrixAccessor.h>
+#include <sofa/simulation/mechanicalvisitor/MechanicalAddMBK_ToMatrixVisitor.h>
+
+namespace sofa::component::linearsolver
+{
+
+/** Collect the force fields whose mass, damping and stiffness matrices are added by MechanicalAddMBK_ToMatrixVisitor,
+ * in the same order, instead of calling them.
+ */
+class SOFA_SOFABASELINEARSOLVER_API MechanicalGetMBKForceFieldsVisitor : public simulation::mechanicalvisitor::MechanicalAddMBK_ToMatrixVisitor
+{
+public:
+    type::vector<core::behavior::BaseForceField*> forceFields;
+
+    MechanicalGetMBKForceFieldsVisitor(const core::MechanicalParams* mparams, const core::behavior::MultiMatrixAccessor* matrix);
+
+    const char* getClassName() const override { return "MechanicalGetMBKForceFieldsVisitor"; }
+
+    Result fwdForceField(simulation::Node* node, core::behavior::BaseForceField* ff) override;
+};
+
+/** MultiMatrixAccessor writing in an assembly buffer instead of the global matrix of another accessor.
+ *
+ * The submatrices of the non-mapped mechanical states are given directly in the buffer, from their global offsets,
+ * without calling the other accessor: several force fields only acting on non-mapped states can be assembled
+ * concurrently in different buffers (see CompressedRowSparseMatrix::setAssemblyBuffer). The other requests are
+ * forwarded to the other accessor, which is not thread-safe.
+ */
+class SOFA_SOFABASELINEARSOLVER_API AssemblyBufferMatrixAccessor : public core::behavior::MultiMatrixAccessor
+{
+public:
+    AssemblyBufferMatrixAccessor(const core::behavior::MultiMatrixAccessor* accessor, const defaulttype::BaseMatrix* globalMatrix, defaulttype::BaseMatrix* buffer);
+
+    Index getGlobalDimension() const override;
+    int getGlobalOffset(const core::behavior::BaseMechanicalState* mstate) const override;
+    MatrixRef getMatrix(const core::behavior::BaseMechanicalState* mstate) const override;
+    InteractionMatrixRef getMatrix(const core::behavior::BaseMechanicalState* mstate1, const core::behavior::BaseMechanicalState* mstate2) const override;
+
+    /// True if all the matrices of the force field are given in the buffer without calling the other accessor
+    bool isThreadSafe(core::behavior::BaseForceField* ff) const;
+
+protected:
+    const core::behavior::MultiMatrixAccessor* m_accessor;
+    const defaulttype::BaseMatrix* m_globalMatrix;
+    defaulttype::BaseMatrix* m_buffer;
+};
+
+} // namespace sofa::component::linearsolver
@@ -21,7 +21,9 @@
 ******************************************************************************/
 #include <SofaBaseMechanics/BarycentricMapping.h>
 #include <SofaBaseMechanics/BarycentricMappers/BarycentricMapperTriangleSetTopology.h>
+#include <SofaBaseMechanics/BarycentricMappers/BarycentricMapperTetrahedronSetTopology.h>
 using sofa::component::mapping::BarycentricMapperTriangleSetTopology;
+using sofa::component::mapping::BarycentricMapperTetrahedronSetTopology;
 using sofa::component::mapping::BarycentricMapping;
 
 #include <SofaBaseTopology/TriangleSetTopologyContainer.h>
@@ -51,6 +53,9 @@ using sofa::core::objectmodel::BaseData ;
 using sofa::component::container::MechanicalObject ;
 
 #include <sofa/simulation/Node.h>
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <random>
 
 using sofa::defaulttype::Vec3dTypes;
 
@@ -60,16 +65,9 @@ struct BarycentricMapperTriangleSetTopologyTest :  public BaseTest, public Baryc
     typedef BarycentricMapperTriangleSetTopology<In,Out> Inherit;
     typedef typename In::Real Real;
 
-    using Inherit::m_hashTable;
-    using Inherit::m_hashTableSize;
-    using Inherit::m_gridCellSize;
-    using Inherit::m_convFactor;
     using Inherit::m_fromTopology;
     using Inherit::d_map;
 
-    using Inherit::computeHashTable;
-    using Inherit::getGridIndices;
-    using Inherit::initHashing;
     using Inherit::init;
 
     typename In::VecCoord m_in;
@@ -88,8 +86,6 @@ struct BarycentricMapperTriangleSetTopologyTest :  public BaseTest, public Baryc
         m_topology = New<TriangleSetTopologyContainer>();
         m_fromTopology = m_topology.get();
         m_fromTopology->addTriangle(0, 1, 2);
-
-        initHashing(m_in);
     }
 
     void scene_test(){
@@ -121,14 +117,16 @@ struct BarycentricMapperTriangleSetTopologyTest :  public BaseTest, public Baryc
         EXPECT_EQ(d_map.getValue().size(),2);
     }
 
-    void initHashing_test()
+    void locatePoints_test()
     {
-        Real min =(m_in[0]-m_in[1]).norm();
-        Real max =(m_in[2]-m_in[1]).norm();
-        EXPECT_LE(m_gridCellSize,max);
-        EXPECT_GE(m_gridCellSize,min);
+        init(m_out,m_in);
+        ASSERT_EQ(d_map.getValue().size(),2);
 
-        EXPECT_EQ(m_convFactor,1./m_gridCellSize);
+        // the first point is the third vertex of the triangle, the second one is outside
+        EXPECT_EQ(d_map.getValue()[0].in_index,0);
+        EXPECT_NEAR(d_map.getValue()[0].baryCoords[0],0.,1e-12);
+        EXPECT_NEAR(d_map.getValue()[0].baryCoords[1],1.,1e-12);
+        EXPECT_EQ(d_map.getValue()[1].in_index,0);
     }
 };
 
@@ -141,9 +139,127 @@ TEST_F(BarycentricMapperTriangleSetTopologyTest_d, init)
     EXPECT_NO_THROW(init_test());
 }
 
-TEST_F(BarycentricMapperTriangleSetTopologyTest_d, initHashing)
+TEST_F(BarycentricMapperTriangleSetTopologyTest_d, locatePoints)
 {
-    initHashing_test();
+    locatePoints_test();
 }
 
 
+
+
+template <class In, class Out>
+struct BarycentricMapperTetrahedronSetTopologyTest :  public BaseTest, public BarycentricMapperTetrahedronSetTopology<In,Out>
+{
+    typedef BarycentricMapperTetrahedronSetTopology<In,Out> Inherit;
+    typedef typename Inherit::NearestParams NearestParams;
+
+    using Inherit::m_fromTopology;
+    using Inherit::m_fromContainer;
+    using Inherit::d_map;
+
+    using Inherit::init;
+    using Inherit::computeBasesAndCenters;
+    using Inherit::checkDistanceFromElement;
+
+    typename In::VecCoord m_in;
+    typename Out::VecCoord m_out;
+    TetrahedronSetTopologyContainer::SPtr m_topology;
+
+    BarycentricMapperTetrahedronSetTopologyTest() : Inherit(nullptr, nullptr) {}
+
+    void SetUp() override
+    {
+        // perturbed grid of n^3 cubes split in 6 tetrahedra
+        const int n = 6;
+        const int np = n + 1;
+        std::mt19937 random(7);
+        std::uniform_real_distribution<double> noise(-0.15, 0.15);
+        for (int k = 0; k < np; ++k)
+            for (int j = 0; j < np; ++j)
+                for (int i = 0; i < np; ++i)
+                    m_in.push_back(Vector3(i + noise(random), j + noise(random), k + noise(random)));
+
+        m_topology = New<TetrahedronSetTopologyContainer>();
+        m_fromTopology = m_topology.get();
+        m_fromContainer = m_topology.get();
+
+        auto index = [np](int i, int j, int k) { return sofa::Index(i + np * (j + np * k)); };
+        static const int cube[6][4] = { {0,5,1,6}, {0,1,2,6}, {0,2,3,6}, {0,3,7,6}, {0,7,4,6}, {0,4,5,6} };
+        for (int k = 0; k < n; ++k)
+            for (int j = 0; j < n; ++j)
+                for (int i = 0; i < n; ++i)
+                {
+                    const sofa::Index c[8] = { index(i,j,k), index(i+1,j,k), index(i+1,j+1,k), index(i,j+1,k),
+                                               index(i,j,k+1), index(i+1,j,k+1), index(i+1,j+1,k+1), index(i,j+1,k+1) };
+                    for (const auto& t : cube)
+                        m_topology->addTetra(c[t[0]], c[t[1]], c[t[2]], c[t[3]]);
+                }
+
+        // points inside and outside the grid, and on its vertices
+        std::uniform_real_distribution<double> position(-2., n + 2.);
+        for (int i = 0; i < 3000; ++i)
+            m_out.push_back(Vector3(position(random), position(random), position(random)));
+        for (std::size_t i = 0; i < m_in.size(); i += 5)
+            m_out.push_back(m_in[i]);
+    }
+
+    void locatePointsAsExhaustiveSearch_test()
+    {
+        init(m_out,m_in);
+        ASSERT_EQ(d_map.getValue().size(), m_out.size());
+
+        // reference: the nearest element among all of them
+        computeBasesAndCenters(m_in);
+        const auto& tetrahedra = m_topology->getTetrahedra();
+        for (std::size_t i = 0; i < m_out.size(); ++i)
+        {
+            NearestParams nearestParams;
+            for (unsigned int e = 0; e < tetrahedra.size(); ++e)
+                checkDistanceFromElement(e, m_out[i], m_in[tetrahedra[e][0]], nearestParams);
+
+            const auto& data = d_map.getValue()[i];
+            ASSERT_EQ(data.in_index, nearestParams.elementId) << "point " << i;
+            for (int k = 0; k < 3; ++k)
+                EXPECT_EQ(data.baryCoords[k], nearestParams.baryCoords[k]) << "point " << i;
+        }
+    }
+
+    void locatePointsInParallel_test()
+    {
+        using sofa::simulation::TaskScheduler;
+
+        // the sequential initialization does not create a task scheduler
+        const bool hasScheduler = TaskScheduler::getCurrentInstance() != nullptr;
+        this->setParallelInit(false);
+        init(m_out,m_in);
+        if (!hasScheduler)
+            EXPECT_EQ(TaskScheduler::getCurrentInstance(), nullptr);
+        const auto sequential = d_map.getValue();
+
+        TaskScheduler::getInstance()->init(4);
+        this->setParallelInit(true);
+        init(m_out,m_in);
+        TaskScheduler::getInstance()->stop();
+
+        const auto& parallel = d_map.getValue();
+        ASSERT_EQ(parallel.size(), sequential.size());
+        for (std::size_t i = 0; i < parallel.size(); ++i)
+        {
+            ASSERT_EQ(parallel[i].in_index, sequential[i].in_index) << "point " << i;
+            for (int k = 0; k < 3; ++k)
+                EXPECT_EQ(parallel[i].baryCoords[k], sequential[i].baryCoords[k]) << "point " << i;
+        }
+    }
+};
+
+typedef BarycentricMapperTetrahedronSetTopologyTest< Vec3dTypes, Vec3dTypes> BarycentricMapperTetrahedronSetTopologyTest_d;
+
+TEST_F(BarycentricMapperTetrahedronSetTopologyTest_d, locatePointsAsExhaustiveSearch)
+{
+    locatePointsAsExhaustiveSearch_test();
+}
+
+TEST_F(BarycentricMapperTetrahedronSetTopologyTest_d, locatePointsInParallel)
+{
+    locatePointsInParallel_test();
+}
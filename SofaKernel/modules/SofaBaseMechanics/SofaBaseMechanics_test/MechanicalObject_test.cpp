@@ -21,6 +21,7 @@
 ******************************************************************************/
 #include <SofaBaseMechanics/MechanicalObject.inl>
 
+#include <sofa/simulation/TaskScheduler.h>
 #include <sofa/testing/BaseTest.h>
 using sofa::testing::BaseTest;
 
@@ -110,6 +111,125 @@ TYPED_TEST(MechanicalObject_test, checkThatPositionDefaultValueIsAVectorOfValueI
     TestHelpers::CheckPosition(this->mechanicalObject);
 }
 
+TYPED_TEST(MechanicalObject_test, checkThatVMultiOpDotGivesTheSameResultsAsVMultiOpThenVDot)
+{
+    typedef typename TypeParam::Deriv Deriv;
+    typedef typename TypeParam::VecDeriv VecDeriv;
+    typedef core::behavior::BaseMechanicalState::VMultiOp VMultiOp;
+    typedef core::behavior::BaseMechanicalState::VMultiOpEntry VMultiOpEntry;
+    typedef core::behavior::BaseMechanicalState::VMultiDot VMultiDot;
+
+    // several blocks of values are needed to check the fused pass
+    const std::size_t n = 1000;
+    StubMechanicalObject<TypeParam> reference;
+    reference.resize(n);
+    this->mechanicalObject.resize(n);
+    for (StubMechanicalObject<TypeParam>* mo : { &reference, &this->mechanicalObject })
+    {
+        const core::VecDerivId ids[3] = { core::VecDerivId::velocity(), core::VecDerivId::force(), core::VecDerivId::dx() };
+        for (unsigned int v = 0; v < 3; ++v)
+        {
+            VecDeriv& values = *mo->write(ids[v])->beginEdit();
+            values.resize(n);
+            for (std::size_t i = 0; i < n; ++i)
+                for (std::size_t j = 0; j < Deriv::total_size; ++j)
+                    values[i][j] = std::sin(0.37 * i + 1.3 * j + v);
+            mo->write(ids[v])->endEdit();
+        }
+    }
+
+    const core::MultiVecDerivId v(core::VecDerivId::velocity());
+    const core::MultiVecDerivId f(core::VecDerivId::force());
+    const core::MultiVecDerivId dx(core::VecDerivId::dx());
+
+    VMultiOp ops;
+    ops.push_back(VMultiOpEntry(v, v, f, 0.5)); // v += f*0.5
+    ops.push_back(VMultiOpEntry(dx, dx, 2.0, v, -1.0)); // dx = dx*2 - v, using the updated v
+    ops.back().second.push_back(std::make_pair(core::ConstMultiVecId(f), 3.0));
+    VMultiDot dots;
+    dots.push_back(std::make_pair(core::ConstMultiVecId(v), core::ConstMultiVecId(dx)));
+    dots.push_back(std::make_pair(core::ConstMultiVecId(f), core::ConstMultiVecId(f)));
+
+    SReal referenceResults[2];
+    reference.core::behavior::BaseMechanicalState::vMultiOpDot(core::execparams::defaultInstance(), ops, dots, referenceResults);
+    SReal results[2];
+    this->mechanicalObject.vMultiOpDot(core::execparams::defaultInstance(), ops, dots, results);
+
+    const auto epsilon = std::numeric_limits<typename TypeParam::Real>::epsilon();
+    for (unsigned int i = 0; i < 2; ++i)
+        EXPECT_NEAR(referenceResults[i], results[i], 1e3 * epsilon * std::fabs(referenceResults[i]));
+
+    for (const core::VecDerivId id : { core::VecDerivId::velocity(), core::VecDerivId::dx() })
+    {
+        const VecDeriv& expected = reference.read(core::ConstVecDerivId(id))->getValue();
+        const VecDeriv& values = this->mechanicalObject.read(core::ConstVecDerivId(id))->getValue();
+        ASSERT_EQ(expected.size(), values.size());
+        for (std::size_t i = 0; i < n; ++i)
+            for (std::size_t j = 0; j < Deriv::total_size; ++j)
+                EXPECT_NEAR(expected[i][j], values[i][j], 10 * epsilon);
+    }
+}
+
+TYPED_TEST(MechanicalObject_test, checkThatParallelVectorOperationsDoNotDependOnTheNumberOfThreads)
+{
+    typedef typename TypeParam::Deriv Deriv;
+    typedef typename TypeParam::VecDeriv VecDeriv;
+
+    const std::size_t n = 5000;
+    const core::VecDerivId v = core::VecDerivId::velocity();
+    const core::VecDerivId f = core::VecDerivId::force();
+
+    // v = f*0.5 + v*0.25, v += f*3, then v.f and f.f
+    const auto compute = [&](StubMechanicalObject<TypeParam>& mo, VecDeriv& result, SReal* dots)
+    {
+        mo.resize(n);
+        for (const core::VecDerivId id : { v, f })
+        {
+            VecDeriv& values = *mo.write(id)->beginEdit();
+            values.resize(n);
+            for (std::size_t i = 0; i < n; ++i)
+                for (std::size_t j = 0; j < Deriv::total_size; ++j)
+                    values[i][j] = std::sin(0.37 * i + 1.3 * j + id.index);
+            mo.write(id)->endEdit();
+        }
+        mo.vOp(core::execparams::defaultInstance(), v, f, v, 0.5);
+        mo.vOp(core::execparams::defaultInstance(), v, v, f, 3.0);
+        dots[0] = mo.vDot(core::execparams::defaultInstance(), v, f);
+        dots[1] = mo.vDot(core::execparams::defaultInstance(), f, f);
+        result = mo.read(core::ConstVecDerivId(v))->getValue();
+    };
+
+    VecDeriv sequential;
+    SReal sequentialDots[2];
+    compute(this->mechanicalObject, sequential, sequentialDots);
+
+    auto* taskScheduler = simulation::TaskScheduler::getInstance();
+    VecDeriv parallel[2];
+    SReal parallelDots[2][2];
+    const unsigned int nbThreads[2] = { 1, 4 };
+    for (unsigned int t = 0; t < 2; ++t)
+    {
+        taskScheduler->init(nbThreads[t]);
+        StubMechanicalObject<TypeParam> mo;
+        mo.d_parallelThreshold.setValue(1000);
+        compute(mo, parallel[t], parallelDots[t]);
+    }
+
+    // the vector operations give the same values, and the dot products do not depend on the number of threads
+    const auto epsilon = std::numeric_limits<typename TypeParam::Real>::epsilon();
+    for (unsigned int t = 0; t < 2; ++t)
+    {
+        ASSERT_EQ(sequential.size(), parallel[t].size());
+        for (std::size_t i = 0; i < n; ++i)
+            for (std::size_t j = 0; j < Deriv::total_size; ++j)
+                EXPECT_EQ(sequential[i][j], parallel[t][i][j]);
+        for (unsigned int d = 0; d < 2; ++d)
+            EXPECT_NEAR(sequentialDots[d], parallelDots[t][d], 1e3 * epsilon * std::fabs(sequentialDots[d]));
+    }
+    EXPECT_EQ(parallelDots[0][0], parallelDots[1][0]);
+    EXPECT_EQ(parallelDots[0][1], parallelDots[1][1]);
+}
+
 } // namespace
 
 } // namespace sofa
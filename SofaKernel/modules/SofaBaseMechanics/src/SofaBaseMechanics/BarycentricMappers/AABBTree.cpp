@@ -0,0 +1,163 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaBaseMechanics/BarycentricMappers/AABBTree.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+
+namespace sofa::component::mapping
+{
+
+void AABBTree::clear()
+{
+    m_nodes.clear();
+    m_boxes.clear();
+    m_indices.clear();
+}
+
+type::vector<sofa::Index> AABBTree::spatialOrder(const type::vector<Vector3>& points)
+{
+    type::vector<sofa::Index> order(points.size());
+    std::iota(order.begin(), order.end(), sofa::Index(0));
+    if (points.empty()) return order;
+
+    Box bounds { points[0], points[0] };
+    for (const Vector3& p : points)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            bounds.min[k] = std::min(bounds.min[k], p[k]);
+            bounds.max[k] = std::max(bounds.max[k], p[k]);
+        }
+    }
+
+    // 10 bits per axis, spread with two zero bits between each of them
+    const auto expandBits = [](std::uint32_t v)
+    {
+        v = (v * 0x00010001u) & 0xFF0000FFu;
+        v = (v * 0x00000101u) & 0x0F00F00Fu;
+        v = (v * 0x00000011u) & 0xC30C30C3u;
+        v = (v * 0x00000005u) & 0x49249249u;
+        return v;
+    };
+
+    type::vector<std::uint32_t> codes(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        std::uint32_t code = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            const double extent = bounds.max[k] - bounds.min[k];
+            const double t = extent > 0 ? (points[i][k] - bounds.min[k]) / extent : 0.;
+            const auto cell = t > 0 ? std::uint32_t(std::min(t * 1024., 1023.)) : 0u; // also maps NaN to 0
+            code |= expandBits(cell) << (2 - k);
+        }
+        codes[i] = code;
+    }
+
+    std::sort(order.begin(), order.end(), [&codes](sofa::Index a, sofa::Index b)
+    {
+        return codes[a] < codes[b] || (codes[a] == codes[b] && a < b);
+    });
+    return order;
+}
+
+void AABBTree::build(const type::vector<Box>& boxes)
+{
+    clear();
+
+    type::vector<Vector3> centers(boxes.size());
+    for (std::size_t i = 0; i < boxes.size(); ++i)
+    {
+        centers[i] = (boxes[i].min + boxes[i].max) * 0.5;
+        if (std::isfinite(centers[i][0]) && std::isfinite(centers[i][1]) && std::isfinite(centers[i][2])
+            && std::isfinite(boxes[i].max[0] - boxes[i].min[0]) && std::isfinite(boxes[i].max[1] - boxes[i].min[1])
+            && std::isfinite(boxes[i].max[2] - boxes[i].min[2]))
+        {
+            m_indices.push_back(sofa::Index(i));
+        }
+    }
+    if (m_indices.empty()) return;
+
+    m_boxes = boxes;
+    m_nodes.reserve(2 * (m_indices.size() / LeafSize + 1));
+    m_nodes.emplace_back();
+    m_nodes[0].first = 0;
+    m_nodes[0].last = sofa::Index(m_indices.size());
+    buildNode(0, centers);
+
+    m_boxes.resize(m_indices.size());
+    for (std::size_t i = 0; i < m_indices.size(); ++i)
+        m_boxes[i] = boxes[m_indices[i]];
+}
+
+void AABBTree::buildNode(sofa::Index nodeIndex, const type::vector<Vector3>& centers)
+{
+    const sofa::Index first = m_nodes[nodeIndex].first;
+    const sofa::Index last = m_nodes[nodeIndex].last;
+
+    Box box = m_boxes[m_indices[first]];
+    Box centerBounds { centers[m_indices[first]], centers[m_indices[first]] };
+    for (sofa::Index i = first + 1; i < last; ++i)
+    {
+        const Box& b = m_boxes[m_indices[i]];
+        const Vector3& c = centers[m_indices[i]];
+        for (int k = 0; k < 3; ++k)
+        {
+            box.min[k] = std::min(box.min[k], b.min[k]);
+            box.max[k] = std::max(box.max[k], b.max[k]);
+            centerBounds.min[k] = std::min(centerBounds.min[k], c[k]);
+            centerBounds.max[k] = std::max(centerBounds.max[k], c[k]);
+        }
+    }
+    m_nodes[nodeIndex].box = box;
+
+    if (last - first <= LeafSize) return;
+
+    const Vector3 extent = centerBounds.max - centerBounds.min;
+    int axis = 0;
+    if (extent[1] > extent[axis]) axis = 1;
+    if (extent[2] > extent[axis]) axis = 2;
+
+    const sofa::Index middle = first + (last - first) / 2;
+    std::nth_element(m_indices.begin() + first, m_indices.begin() + middle, m_indices.begin() + last,
+        [&centers, axis](sofa::Index a, sofa::Index b)
+        {
+            return centers[a][axis] < centers[b][axis] || (centers[a][axis] == centers[b][axis] && a < b);
+        });
+
+    const sofa::Index children = sofa::Index(m_nodes.size());
+    m_nodes.emplace_back();
+    m_nodes.emplace_back();
+    m_nodes[nodeIndex].children = children;
+    m_nodes[children].first = first;
+    m_nodes[children].last = middle;
+    m_nodes[children + 1].first = middle;
+    m_nodes[children + 1].last = last;
+
+    buildNode(children, centers);
+    buildNode(children + 1, centers);
+}
+
+} // namespace sofa::component::mapping
@@ -0,0 +1,169 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaBaseMechanics/config.h>
+
+#include <sofa/type/Vec.h>
+#include <sofa/type/vector.h>
+
+#include <algorithm>
+
+namespace sofa::component::mapping
+{
+
+/**
+ * Bounding volume hierarchy of axis-aligned boxes, used to locate points among the elements of a mesh.
+ *
+ * The tree is built top-down, splitting the boxes at the median of their centers along the largest axis.
+ * Once built, it is only read by the queries, which can then be run concurrently.
+ */
+class SOFA_SOFABASEMECHANICS_API AABBTree
+{
+public:
+    using Vector3 = type::Vector3;
+
+    struct Box
+    {
+        Vector3 min;
+        Vector3 max;
+
+        bool contains(const Vector3& p) const
+        {
+            return p[0] >= min[0] && p[0] <= max[0]
+                && p[1] >= min[1] && p[1] <= max[1]
+                && p[2] >= min[2] && p[2] <= max[2];
+        }
+
+        /// Squared distance from p to the box, 0 if p is inside
+        double distance2(const Vector3& p) const
+        {
+            double d = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                const double outside = std::max(min[i] - p[i], p[i] - max[i]);
+                if (outside > 0) d += outside * outside;
+            }
+            return d;
+        }
+    };
+
+    /// Build the tree on the given boxes, whose indices are given to the queries. The boxes with non-finite bounds
+    /// are left out.
+    void build(const type::vector<Box>& boxes);
+
+    void clear();
+
+    /// Order of the points along a Morton (Z-order) curve, so that consecutive queries visit the same nodes
+    static type::vector<sofa::Index> spatialOrder(const type::vector<Vector3>& points);
+
+    bool empty() const { return m_nodes.empty(); }
+
+    /// Call f(index) for each box containing p
+    template<class Function>
+    void forEachBoxContaining(const Vector3& p, Function f) const
+    {
+        if (m_nodes.empty()) return;
+
+        sofa::Index stack[MaxDepth];
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0)
+        {
+            const Node& node = m_nodes[stack[--stackSize]];
+            if (!node.box.contains(p)) continue;
+
+            if (node.isLeaf())
+            {
+                for (sofa::Index i = node.first; i < node.last; ++i)
+                    if (m_boxes[i].contains(p)) f(m_indices[i]);
+            }
+            else
+            {
+                stack[stackSize++] = node.children;
+                stack[stackSize++] = node.children + 1;
+            }
+        }
+    }
+
+    /** Call f(index) for the boxes which may be at a squared distance up to maxDistance2 from p, nearest nodes
+     * first. f can decrease maxDistance2 to prune the remaining nodes, which gives a branch and bound search of
+     * the nearest box. Boxes at exactly maxDistance2 are still visited, so that ties can be resolved by f.
+     */
+    template<class Function>
+    void forEachBoxNear(const Vector3& p, double& maxDistance2, Function f) const
+    {
+        if (m_nodes.empty()) return;
+
+        sofa::Index stack[MaxDepth];
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize > 0)
+        {
+            const Node& node = m_nodes[stack[--stackSize]];
+            if (node.box.distance2(p) > maxDistance2) continue;
+
+            if (node.isLeaf())
+            {
+                for (sofa::Index i = node.first; i < node.last; ++i)
+                    if (m_boxes[i].distance2(p) <= maxDistance2) f(m_indices[i]);
+            }
+            else
+            {
+                // the nearest child is pushed last, so that it is visited first
+                const sofa::Index near = node.children, far = node.children + 1;
+                if (m_nodes[near].box.distance2(p) <= m_nodes[far].box.distance2(p))
+                {
+                    stack[stackSize++] = far;
+                    stack[stackSize++] = near;
+                }
+                else
+                {
+                    stack[stackSize++] = near;
+                    stack[stackSize++] = far;
+                }
+            }
+        }
+    }
+
+protected:
+    static constexpr sofa::Index LeafSize = 4;
+    /// Bound of the stack of the queries: the median split keeps the depth below log2 of the number of boxes
+    static constexpr int MaxDepth = 128;
+
+    struct Node
+    {
+        Box box;
+        sofa::Index first { 0 }; ///< range of the boxes of a leaf
+        sofa::Index last { 0 };
+        sofa::Index children { 0 }; ///< index of the first child, the second one follows; 0 for a leaf
+
+        bool isLeaf() const { return children == 0; }
+    };
+
+    void buildNode(sofa::Index nodeIndex, const type::vector<Vector3>& centers);
+
+    type::vector<Node> m_nodes;
+    type::vector<Box> m_boxes; ///< boxes sorted by leaf
+    type::vector<sofa::Index> m_indices; ///< initial index of the sorted boxes
+};
+
+} // namespace sofa::component::mapping
@@ -74,6 +74,9 @@ public:
     virtual void applyOnePoint( const Index& hexaId, typename Out::VecCoord& out, const typename In::VecCoord& in);
     virtual void clear( std::size_t reserve=0 ) =0;
 
+    /// Whether init() may locate the points in parallel on the task scheduler, for the mappers supporting it
+    void setParallelInit(bool parallelInit) { m_parallelInit = parallelInit; }
+
     inline friend std::istream& operator >> ( std::istream& in, BarycentricMapper< In, Out > & ) {return in;}
     inline friend std::ostream& operator << ( std::ostream& out, const BarycentricMapper< In, Out > &  ) { return out; }
 
@@ -81,6 +84,8 @@ public:
 protected:
     void addMatrixContrib(MatrixType* m, int row, int col, Real value);
 
+    bool m_parallelInit { false };
+
     template< int NC,  int NP>
     class MappingData
     {
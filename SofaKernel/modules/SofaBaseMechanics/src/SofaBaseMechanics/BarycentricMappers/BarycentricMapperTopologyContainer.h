@@ -21,9 +21,10 @@
 ******************************************************************************/
 #pragma once
 #include <SofaBaseMechanics/BarycentricMappers/TopologyBarycentricMapper.h>
+#include <SofaBaseMechanics/BarycentricMappers/AABBTree.h>
 
 #include <SofaBaseTopology/TopologyData.inl>
-#include <unordered_map>
+#include <type_traits>
 
 namespace sofa::component::mapping::_barycentricmappertopologycontainer_
 {
@@ -85,37 +86,6 @@ public:
 
 protected:
 
-    struct Key
-    {
-        Key(const int& xId, const int& yId, const int& zId)
-        {
-            this->xId=xId;
-            this->yId=yId;
-            this->zId=zId;
-        }
-
-        int xId,yId,zId; // cell indices
-    };
-
-    struct HashFunction
-    {
-        size_t operator()(const Key &key) const
-        {
-            // We use the large prime numbers proposed in paper:
-            // M.Teschner et al "Optimized Spatial Hashing for Collision Detection of Deformable Objects" (2003)
-            int h = (73856093*key.xId^19349663*key.yId^83492791*key.zId);
-            return size_t(h);
-        }
-    };
-
-    struct HashEqual
-    {
-        bool operator()(const Key &key1, const Key &key2) const
-        {
-            return ((key1.xId==key2.xId) && (key1.yId==key2.yId) && (key1.zId==key2.zId));
-        }
-    };
-
     struct NearestParams
     {
         NearestParams()
@@ -138,11 +108,13 @@ protected:
     type::vector<Mat3x3d> m_bases;
     type::vector<Vector3> m_centers;
 
-    // Spacial hashing utils
-    Real m_gridCellSize;
-    Real m_convFactor;
-    std::unordered_map<Key, type::vector<unsigned int>, HashFunction, HashEqual> m_hashTable;
-    std::size_t m_hashTableSize;
+    /// Number of barycentric coordinates of the elements: 2 for the surface elements, 3 for the volume elements
+    static constexpr int NbCoordinates = int(std::extent_v<decltype(MappingDataType::baryCoords)>);
+
+    // Point location utils
+    AABBTree m_elementTree; ///< bounding boxes of the regions where the points are considered inside the elements
+    AABBTree m_centerTree; ///< centers of the elements, to find the nearest one for the points outside all of them
+    type::vector<unsigned int> m_unboundedElements; ///< degenerate elements, which are checked for each point
 
 
     BarycentricMapperTopologyContainer(core::topology::BaseMeshTopology* fromTopology, topology::PointSetTopologyContainer* toTopology);
@@ -157,7 +129,7 @@ protected:
     virtual void computeDistance(double& d, const Vector3& v)=0;
 
     /// Compute the distance between outPos and the element e. If this distance is smaller than the previously stored one,
-    /// update nearestParams.
+    /// or equal with a smaller element id, update nearestParams.
     /// \param e id of the element
     /// \param outPos position of the point we want to compute the barycentric coordinates
     /// \param inPos position of one point of the element
@@ -172,13 +144,16 @@ protected:
     /// \param in is the vector of points
     void computeBasesAndCenters( const typename In::VecCoord& in );
 
-    // Spacial hashing following paper:
-    // M.Teschner et al "Optimized Spatial Hashing for Collision Detection of Deformable Objects" (2003)
-    type::Vec3i getGridIndices(const Vector3& pos);
-    void initHashing(const typename In::VecCoord& in);
-    void computeHashingCellSize(const typename In::VecCoord& in);
-    void computeHashTable(const typename In::VecCoord& in);
+    /// Build the trees locating the points in the elements, once the bases and centers are computed
+    void computeElementTrees(const typename In::VecCoord& in, const type::vector<Element>& elements);
+
+    /// Find the element giving the same result as checkDistanceFromElement on all the elements: the element containing
+    /// outPos, or the one with the nearest center if there is none.
+    NearestParams findNearestElement(const Vector3& outPos, const typename In::VecCoord& in, const type::vector<Element>& elements);
 
+    /// Call f(i) for each i in [0, n), on the task scheduler if the parallel initialization is requested
+    template<class Function>
+    void forEachIndex(std::size_t n, const Function& f) const;
 };
 
 #if !defined(SOFA_COMPONENT_MAPPING_BARYCENTRICMAPPERTOPOLOGYCONTAINER_CPP)
@@ -23,13 +23,15 @@
 #include <SofaBaseMechanics/BarycentricMappers/BarycentricMapperTopologyContainer.h>
 #include <sofa/core/State.h>
 #include <sofa/core/visual/VisualParams.h>
+#include <sofa/simulation/ParallelForEach.h>
+
+#include <cmath>
+#include <limits>
 
 namespace sofa::component::mapping::_barycentricmappertopologycontainer_
 {
 
 using type::Vec3d;
-using type::Vec3i;
-typedef typename core::topology::BaseMeshTopology::SeqEdges SeqEdges;
 
 template <class In, class Out, class MappingDataType, class Element>
 BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::BarycentricMapperTopologyContainer(core::topology::BaseMeshTopology* fromTopology,
@@ -53,143 +55,150 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::clear(s
 
 
 template <class In, class Out, class MappingDataType, class Element>
-void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::initHashing(const typename In::VecCoord& in)
+void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::init ( const typename Out::VecCoord& out, const typename In::VecCoord& in )
 {
-    computeHashingCellSize(in);
-    computeHashTable(in);
-}
+    this->clear ( int(out.size()) );
+    computeBasesAndCenters(in);
 
+    const type::vector<Element>& elements = getElements();
+    computeElementTrees(in, elements);
 
-template <class In, class Out, class MappingDataType, class Element>
-void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::computeHashingCellSize(const typename In::VecCoord& in )
-{
-    // The grid cell size is set to the average edge length of all elements
-    const SeqEdges& edges = m_fromTopology->getEdges();
-    Real averageLength=0.;
+    // Locate the points, possibly in parallel, then add them in order. Consecutive queries on close points are faster, as they
+    // visit the same nodes of the trees.
+    type::vector<Vector3> positions(out.size());
+    for (std::size_t i = 0; i < out.size(); ++i)
+        positions[i] = Out::getCPos(out[i]);
+    const type::vector<sofa::Index> order = AABBTree::spatialOrder(positions);
 
-    if(edges.size()>0)
+    type::vector<NearestParams> nearest(out.size());
+    forEachIndex(out.size(), [&](std::size_t i)
     {
-        for(unsigned int i=0; i<edges.size(); i++)
-        {
-            Edge edge = edges[i];
-            averageLength += (in[edge[0]]-in[edge[1]]).norm();
-        }
-        averageLength/=Real(edges.size());
-    }
-    else
-    {
-        const type::vector<Element>& elements = getElements();
-
-        for(unsigned int i=0; i<elements.size(); i++)
-        {
-            Element element = elements[i];
-            averageLength += (in[element[0]]-in[element[1]]).norm();
-        }
-        averageLength/=Real(elements.size());
-    }
+        const sofa::Index pointId = order[i];
+        nearest[pointId] = findNearestElement(positions[pointId], in, elements);
+    });
 
-    m_gridCellSize = averageLength;
-    m_convFactor = 1./Real(m_gridCellSize);
+    for (const NearestParams& nearestParams : nearest)
+        addPointInElement(nearestParams.elementId, nearestParams.baryCoords.ptr());
 }
 
 
 template <class In, class Out, class MappingDataType, class Element>
-void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::computeHashTable( const typename In::VecCoord& in )
+void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::computeElementTrees(const typename In::VecCoord& in,
+                                                                                             const type::vector<Element>& elements)
 {
-    const type::vector<Element>& elements = getElements();
-    m_hashTableSize = elements.size()*2; // Next prime number would be better
-    m_hashTable.clear();
-    if(m_hashTable.size()<m_hashTableSize)
-        m_hashTable.reserve(m_hashTableSize);
+    // A point is inside an element when its coordinates in the element basis are in the unit simplex or cube, up to a
+    // distance of 0.01 along the normal for the surface elements (see computeDistance). The bounding box of this region
+    // is the one of its corners, mapped back to the positions.
+    Vector3 minCoords, maxCoords;
+    for (int k = 0; k < 3; ++k)
+    {
+        minCoords[k] = k < NbCoordinates ? 0. : -0.01;
+        maxCoords[k] = k < NbCoordinates ? 1. : 0.01;
+    }
+
+    constexpr double infinity = std::numeric_limits<double>::infinity();
+    const AABBTree::Box unbounded { Vector3(infinity, infinity, infinity), Vector3(infinity, infinity, infinity) };
 
-    for(unsigned int i=0; i<elements.size(); i++)
+    type::vector<AABBTree::Box> regions(elements.size());
+    type::vector<AABBTree::Box> centers(elements.size());
+    forEachIndex(elements.size(), [&](std::size_t e)
     {
-        Element element = elements[i];
-        Vector3 min=in[element[0]], max=in[element[0]];
+        centers[e] = AABBTree::Box { m_centers[e], m_centers[e] };
 
-        for(unsigned int j=0; j<element.size(); j++)
+        Mat3x3d frame;
+        if (!frame.invert(m_bases[e]))
         {
-            unsigned int pointId = element[j];
-            for(int k=0; k<3; k++)
+            regions[e] = unbounded;
+            return;
+        }
+
+        const bool simplex = elements[e].size() == std::size_t(NbCoordinates + 1);
+        const Vector3 origin = in[elements[e][0]];
+        AABBTree::Box region { origin, origin };
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            // the corners of the unit simplex are the ones of the unit cube with at most one coordinate at 1
+            if (simplex && ((corner & 1) + ((corner >> 1) & 1) + (NbCoordinates > 2 ? (corner >> 2) & 1 : 0)) > 1)
+                continue;
+
+            const Vector3 coords((corner & 1) ? maxCoords[0] : minCoords[0],
+                                 (corner & 2) ? maxCoords[1] : minCoords[1],
+                                 (corner & 4) ? maxCoords[2] : minCoords[2]);
+            const Vector3 p = origin + frame * coords;
+            for (int k = 0; k < 3; ++k)
             {
-                if(in[pointId][k]<min[k]) min[k]=in[pointId][k];
-                if(in[pointId][k]>max[k]) max[k]=in[pointId][k];
+                region.min[k] = std::min(region.min[k], p[k]);
+                region.max[k] = std::max(region.max[k], p[k]);
             }
         }
 
-        Vec3i i_min=getGridIndices(min);
-        Vec3i i_max=getGridIndices(max);
+        // margin for the rounding errors of the barycentric coordinates
+        const double margin = 1e-9 * ((region.max - region.min).norm() + origin.norm());
+        for (int k = 0; k < 3; ++k)
+        {
+            region.min[k] -= margin;
+            region.max[k] += margin;
+        }
+        regions[e] = region;
+    });
+
+    m_elementTree.build(regions);
+    m_centerTree.build(centers);
 
-        for(int j=i_min[0]; j<=i_max[0]; j++)
-            for(int k=i_min[1]; k<=i_max[1]; k++)
-                for(int l=i_min[2]; l<=i_max[2]; l++)
-                    m_hashTable[Key(j,k,l)].push_back(i);
+    // the elements left out of the trees are checked for each point
+    m_unboundedElements.clear();
+    for (unsigned int e = 0; e < elements.size(); e++)
+    {
+        const AABBTree::Box& region = regions[e];
+        if (!std::isfinite((region.min + region.max).norm2()) || !std::isfinite((region.max - region.min).norm2())
+            || !std::isfinite(m_centers[e].norm2()))
+        {
+            m_unboundedElements.push_back(e);
+        }
     }
 }
 
 
 template <class In, class Out, class MappingDataType, class Element>
-void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::init ( const typename Out::VecCoord& out, const typename In::VecCoord& in )
+auto BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::findNearestElement(const Vector3& outPos,
+                                                                                            const typename In::VecCoord& in,
+                                                                                            const type::vector<Element>& elements) -> NearestParams
 {
-    initHashing(in);
-    this->clear ( int(out.size()) );
-    computeBasesAndCenters(in);
-
-    // Compute distances to get nearest element and corresponding bary coef
-    const type::vector<Element>& elements = getElements();
-    for ( unsigned int i=0; i<out.size(); i++ )
+    NearestParams nearestParams;
+    const auto check = [&](unsigned int e)
     {
-        Vector3 outPos = Out::getCPos(out[i]);
-        NearestParams nearestParams;
+        checkDistanceFromElement(e, outPos, in[elements[e][0]], nearestParams);
+    };
 
-        // Search nearest element in grid cell
-        Vec3i gridIds = getGridIndices(outPos);
-        Key key(gridIds[0],gridIds[1],gridIds[2]);
+    // Only the elements containing the point can have a distance lower or equal to 0
+    m_elementTree.forEachBoxContaining(outPos, check);
+    for (unsigned int e : m_unboundedElements)
+        check(e);
 
-        auto it_entries = m_hashTable.find(key);
-        if( it_entries != m_hashTable.end() )
-        {
-            for(auto entry : it_entries->second)
-            {
-                Vector3 inPos = in[elements[entry][0]];
-                checkDistanceFromElement(entry, outPos, inPos, nearestParams);
-            }
-        }
-
-        if(nearestParams.elementId==std::numeric_limits<unsigned int>::max()) // No element in grid cell, perform exhaustive search
-        {
-            for ( unsigned int e = 0; e < elements.size(); e++ )
-            {
-                Vector3 inPos = in[elements[e][0]];
-                checkDistanceFromElement(e, outPos, inPos, nearestParams);
-            }
-            addPointInElement(nearestParams.elementId, nearestParams.baryCoords.ptr());
-        }
-        else if(fabs(nearestParams.distance)>m_gridCellSize/2.) // Nearest element in grid cell may not be optimal, check neighbors
+    // Outside all the elements, the distance is the squared distance to the center of the element
+    if (!(nearestParams.distance <= 0))
+    {
+        double maxDistance2 = nearestParams.distance;
+        m_centerTree.forEachBoxNear(outPos, maxDistance2, [&](unsigned int e)
         {
-            Vec3i centerGridIds = gridIds;
-            for(int xId=-1; xId<=1; xId++)
-                for(int yId=-1; yId<=1; yId++)
-                    for(int zId=-1; zId<=1; zId++)
-                    {
-                        gridIds = Vec3i(centerGridIds[0]+xId,centerGridIds[1]+yId,centerGridIds[2]+zId);
-                        Key key(gridIds[0],gridIds[1],gridIds[2]);
-
-                        auto it_entries = m_hashTable.find(key);
-                        if( it_entries != m_hashTable.end() )
-                        {
-                            for(auto entry : it_entries->second)
-                            {
-                                Vector3 inPos = in[elements[entry][0]];
-                                checkDistanceFromElement(entry, outPos, inPos, nearestParams);
-                            }
-                        }
-                    }
-            addPointInElement(nearestParams.elementId, nearestParams.baryCoords.ptr());
-        }
-        else
-            addPointInElement(nearestParams.elementId, nearestParams.baryCoords.ptr());
+            check(e);
+            maxDistance2 = std::min(maxDistance2, nearestParams.distance);
+        });
     }
+
+    return nearestParams;
+}
+
+
+template <class In, class Out, class MappingDataType, class Element>
+template <class Function>
+void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::forEachIndex(std::size_t n, const Function& f) const
+{
+    if (this->m_parallelInit)
+        simulation::parallelForEach(std::size_t(0), n, f);
+    else
+        for (std::size_t i = 0; i < n; ++i)
+            f(i);
 }
 
 
@@ -200,9 +209,9 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::compute
     m_bases.resize ( elements.size() );
     m_centers.resize ( elements.size() );
 
-    for ( unsigned int e = 0; e < elements.size(); e++ )
+    forEachIndex(elements.size(), [&](std::size_t e)
     {
-        Element element = elements[e];
+        const Element& element = elements[e];
 
         Mat3x3d base;
         computeBase(base,in,element);
@@ -211,7 +220,7 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::compute
         Vector3 center;
         computeCenter(center,in,element);
         m_centers[e] = center;
-    }
+    });
 }
 
 
@@ -226,7 +235,7 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::checkDi
     computeDistance(dist, bary);
     if ( dist>0 )
         dist = ( outPos-m_centers[e] ).norm2();
-    if ( dist<nearestParams.distance )
+    if ( dist<nearestParams.distance || (dist==nearestParams.distance && e<nearestParams.elementId) )
     {
         nearestParams.baryCoords = bary;
         nearestParams.distance = dist;
@@ -409,17 +418,6 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::draw  (
 }
 
 
-template <class In, class Out, class MappingDataType, class Element>
-Vec3i BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::getGridIndices(const Vector3& pos)
-{
-    Vec3i i_x;
-    for(int i=0; i<3; i++)
-        i_x[i]=int(std::floor(Real(pos[i]*m_convFactor)));
-
-    return i_x;
-}
-
-
 template<class In, class Out, class MappingData, class Element>
 std::istream& operator >> ( std::istream& in, BarycentricMapperTopologyContainer<In, Out, MappingData, Element> &b )
 {
@@ -64,6 +64,7 @@ public:
 
 public:
     Data< bool > d_useRestPosition; ///< Use the rest position of the input and output models to initialize the mapping    
+    Data< bool > d_parallelInit; ///< Initialize the task scheduler if needed, to locate the mapped points in parallel
 
     SingleLink<BarycentricMapping<In,Out>,Mapper,BaseLink::FLAG_STRONGLINK> d_mapper;
     SingleLink<BarycentricMapping<In,Out>,BaseMeshTopology,BaseLink::FLAG_STRONGLINK> d_input_topology;
@@ -50,6 +50,7 @@
 #include <sofa/core/behavior/MechanicalState.h>
 #include <sofa/type/vector.h>
 #include <sofa/simulation/Simulation.h>
+#include <sofa/simulation/TaskScheduler.h>
 
 namespace sofa::component::mapping
 {
@@ -87,6 +88,7 @@ template <class TIn, class TOut>
 BarycentricMapping<TIn, TOut>::BarycentricMapping(core::State<In>* from, core::State<Out>* to, typename Mapper::SPtr mapper)
     : Inherit1 ( from, to )
     , d_useRestPosition(core::objectmodel::Base::initData(&d_useRestPosition, false, "useRestPosition", "Use the rest position of the input and output models to initialize the mapping"))
+    , d_parallelInit(core::objectmodel::Base::initData(&d_parallelInit, false, "parallelInit", "Initialize the task scheduler if needed, to locate the mapped points in parallel"))
     , d_mapper(initLink("mapper","Internal mapper created depending on the type of topology"), mapper)
     , d_input_topology(initLink("input_topology", "Input topology container (usually the surrounding domain)."))
     , d_output_topology(initLink("output_topology", "Output topology container (usually the immersed domain)."))
@@ -102,6 +104,7 @@ template <class TIn, class TOut>
 BarycentricMapping<TIn, TOut>::BarycentricMapping (core::State<In>* from, core::State<Out>* to, BaseMeshTopology * input_topology )
     : Inherit1 ( from, to )
     , d_useRestPosition(core::objectmodel::Base::initData(&d_useRestPosition, false, "useRestPosition", "Use the rest position of the input and output models to initialize the mapping"))
+    , d_parallelInit(core::objectmodel::Base::initData(&d_parallelInit, false, "parallelInit", "Initialize the task scheduler if needed, to locate the mapped points in parallel"))
     , d_mapper (initLink("mapper","Internal mapper created depending on the type of topology"))
     , d_input_topology(initLink("input_topology", "Input topology container (usually the surrounding domain)."))
     , d_output_topology(initLink("output_topology", "Output topology container (usually the immersed domain)."))
@@ -296,6 +299,17 @@ void BarycentricMapping<TIn, TOut>::initMapper()
 {
     if (d_mapper != nullptr && this->toModel != nullptr && this->fromModel != nullptr)
     {
+        if (d_parallelInit.getValue())
+        {
+            auto* taskScheduler = simulation::TaskScheduler::getInstance();
+            if (taskScheduler->getThreadCount() < 1)
+            {
+                taskScheduler->init(0);
+                msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+            }
+        }
+
+        d_mapper->setParallelInit(d_parallelInit.getValue());
         if (d_useRestPosition.getValue())
             d_mapper->init (((const core::State<Out> *)this->toModel)->read(core::ConstVecCoordId::restPosition())->getValue(), ((const core::State<In> *)this->fromModel)->read(core::ConstVecCoordId::restPosition())->getValue() );
         else
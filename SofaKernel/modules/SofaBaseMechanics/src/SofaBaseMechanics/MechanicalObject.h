@@ -63,6 +63,7 @@ public:
 
     typedef sofa::core::behavior::MechanicalState<DataTypes>      Inherited;
     typedef typename Inherited::VMultiOp    VMultiOp;
+    typedef typename Inherited::VMultiDot   VMultiDot;
     typedef typename Inherited::ForceMask   ForceMask;
     typedef typename DataTypes::Real        Real;
     typedef typename DataTypes::Coord       Coord;
@@ -139,6 +140,8 @@ public:
 
     Data< bool >  d_useTopology; ///< Shall this object rely on any active topology to initialize its size and positions
 
+    Data< unsigned int > d_parallelThreshold; ///< Number of DOFs from which the vector operations are run in parallel on the task scheduler (0 to disable)
+
     Data< bool >  showObject; ///< Show objects. (default=false)
     Data< float > showObjectScale; ///< Scale for object display. (default=0.1)
     Data< bool >  showIndices; ///< Show indices. (default=false)
@@ -333,6 +336,8 @@ public:
 
     void vMultiOp(const core::ExecParams* params, const VMultiOp& ops) override;
 
+    void vMultiOpDot(const core::ExecParams* params, const VMultiOp& ops, const VMultiDot& dots, SReal* results) override;
+
     void vThreshold(core::VecId a, SReal threshold ) override;
 
     SReal vDot(const core::ExecParams* params, core::ConstVecId a, core::ConstVecId b) override;
@@ -401,6 +406,10 @@ protected :
 
     bool m_initialized;
 
+    /// Whether the vector operations are run in parallel, depending only on the state size so that the
+    /// reduction trees of the dot products, hence their results, do not depend on the number of threads
+    bool useParallelVectorOperations() const;
+
     /// @name Integration-related data
     /// @{
 
@@ -31,6 +31,8 @@
 #include <sofa/defaulttype/DataTypeInfo.h>
 #include <sofa/helper/accessor.h>
 #include <sofa/simulation/Node.h>
+#include <sofa/simulation/ParallelForEach.h>
+#include <sofa/simulation/TaskScheduler.h>
 
 #ifdef SOFA_DUMP_VISITOR_INFO
 #include <sofa/simulation/Visitor.h>
@@ -60,6 +62,111 @@ void renumber(V* v, V* tmp, const sofa::type::vector< sofa::Index > &index )
         (*v)[i] = (*tmp)[index[i]];
 }
 
+/// Linear combination result = sum_j terms_j.first * terms_j.second over arrays of values
+template<class T, class Real>
+struct FusedLinearCombination
+{
+    T* result;
+    std::vector< std::pair<const T*, Real> > terms;
+};
+
+/// Call f(i) for each i in [0, n), in parallel on the task scheduler or in a plain loop
+template<class Function>
+void forEachIndex(bool parallel, std::size_t n, const Function& f)
+{
+    if (parallel)
+    {
+        sofa::simulation::parallelForEach(std::size_t(0), n, f);
+    }
+    else
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            f(i);
+    }
+}
+
+/// Number of values per block of the fused operations, small enough for the blocks to stay in the cache
+constexpr std::size_t FusedBlockSize = 256;
+
+/// Perform the linear combinations then the dot products on the values [begin, begin+size) of one block,
+/// so that each vector is loaded only once from the memory. The inner loops are simple enough to be vectorized.
+template<class T, class Real>
+void fusedMultiOpDotBlock(std::size_t begin, std::size_t size, const std::vector< FusedLinearCombination<T, Real> >& ops,
+                          const std::vector< std::pair<const T*, const T*> >& dots, Real* blockResults)
+{
+    T block[FusedBlockSize];
+
+    // the combination is computed in the block before being stored, as the result can also be an operand
+    for (const auto& op : ops)
+    {
+        if (op.terms.empty())
+        {
+            std::fill(block, block + size, T());
+        }
+        else
+        {
+            const T* v = op.terms[0].first + begin;
+            const Real f = op.terms[0].second;
+            for (std::size_t i = 0; i < size; ++i)
+                block[i] = v[i] * f;
+        }
+        for (std::size_t t = 1; t < op.terms.size(); ++t)
+        {
+            const T* v = op.terms[t].first + begin;
+            const Real f = op.terms[t].second;
+            for (std::size_t i = 0; i < size; ++i)
+                block[i] += v[i] * f;
+        }
+        std::copy(block, block + size, op.result + begin);
+    }
+
+    for (std::size_t d = 0; d < dots.size(); ++d)
+    {
+        const T* a = dots[d].first + begin;
+        const T* b = dots[d].second + begin;
+        Real r = 0;
+        for (std::size_t i = 0; i < size; ++i)
+            r += a[i] * b[i];
+        blockResults[d] = r;
+    }
+}
+
+/// Perform the fused operations block after block. In parallel, the blocks are processed by the task scheduler and
+/// the dot products of the blocks are summed with a pairwise reduction which does not depend on the number of threads.
+template<class T, class Real>
+void fusedMultiOpDot(bool parallel, std::size_t n, const std::vector< FusedLinearCombination<T, Real> >& ops,
+                     const std::vector< std::pair<const T*, const T*> >& dots, Real* results)
+{
+    const std::size_t nbDots = dots.size();
+    if (!parallel)
+    {
+        std::vector<Real> blockResults(nbDots);
+        std::fill(results, results + nbDots, Real(0));
+        for (std::size_t begin = 0; begin < n; begin += FusedBlockSize)
+        {
+            fusedMultiOpDotBlock(begin, std::min(FusedBlockSize, n - begin), ops, dots, blockResults.data());
+            for (std::size_t d = 0; d < nbDots; ++d)
+                results[d] += blockResults[d];
+        }
+        return;
+    }
+
+    const std::size_t nbBlocks = (n + FusedBlockSize - 1) / FusedBlockSize;
+    std::vector<Real> blockResults(nbBlocks * nbDots);
+    sofa::simulation::parallelForEach(std::size_t(0), nbBlocks, [&](std::size_t b)
+    {
+        const std::size_t begin = b * FusedBlockSize;
+        fusedMultiOpDotBlock(begin, std::min(FusedBlockSize, n - begin), ops, dots, blockResults.data() + b * nbDots);
+    });
+
+    for (std::size_t d = 0; d < nbDots; ++d)
+    {
+        results[d] = sofa::simulation::parallelReduce(std::size_t(0), nbBlocks, Real(0),
+            [&](std::size_t b) { return blockResults[b * nbDots + d]; },
+            [](Real r0, Real r1) { return r0 + r1; });
+    }
+}
+
 } // anonymous namespace
 
 
@@ -82,6 +189,7 @@ MechanicalObject<DataTypes>::MechanicalObject()
     , reset_velocity(initData(&reset_velocity, "reset_velocity", "reset velocity coordinates of the degrees of freedom"))
     , restScale(initData(&restScale, (SReal)1.0, "restScale", "optional scaling of rest position coordinates (to simulated pre-existing internal tension).(default = 1.0)"))
     , d_useTopology(initData(&d_useTopology, true, "useTopology", "Shall this object rely on any active topology to initialize its size and positions"))
+    , d_parallelThreshold(initData(&d_parallelThreshold, 0u, "parallelThreshold", "Number of DOFs from which the vector operations (vOp, vMultiOp, vDot) are run in parallel on the task scheduler (0 to disable)"))
     , showObject(initData(&showObject, (bool) false, "showObject", "Show objects. (default=false)"))
     , showObjectScale(initData(&showObjectScale, (float) 0.1, "showObjectScale", "Scale for object display. (default=0.1)"))
     , showIndices(initData(&showIndices, (bool) false, "showIndices", "Show indices. (default=false)"))
@@ -1240,6 +1348,16 @@ void MechanicalObject<DataTypes>::init()
 
     m_initialized = true;
 
+    if (d_parallelThreshold.getValue() > 0)
+    {
+        auto* taskScheduler = simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 1)
+        {
+            taskScheduler->init(0);
+            msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+        }
+    }
+
     if (f_reserve.getValue() > 0)
         reserve(f_reserve.getValue());
 
@@ -1806,6 +1924,8 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
 {
     SOFA_UNUSED(params);
 
+    const bool parallel = useParallelVectorOperations();
+
     if(v.isNull())
     {
         // ERROR
@@ -1821,15 +1941,19 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
             {
                 helper::WriteOnlyAccessor< Data<VecCoord> >vv( *this->write(core::VecCoordId(v)) );
                 vv.resize(d_size.getValue());
-                for (unsigned int i=0; i<vv.size(); i++)
+                forEachIndex(parallel, vv.size(), [&](std::size_t i)
+                {
                     vv[i] = Coord();
+                });
             }
             else
             {
                 helper::WriteOnlyAccessor< Data<VecDeriv> >vv( *this->write(core::VecDerivId(v)) );
                 vv.resize(d_size.getValue());
-                for (unsigned int i=0; i<vv.size(); i++)
+                forEachIndex(parallel, vv.size(), [&](std::size_t i)
+                {
                     vv[i] = Deriv();
+                });
             }
         }
         else
@@ -1846,14 +1970,18 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                 if (v.type == sofa::core::V_COORD)
                 {
                     helper::WriteAccessor< Data<VecCoord> >vv( *this->write(core::VecCoordId(v)) );
-                    for (unsigned int i=0; i<vv.size(); i++)
+                    forEachIndex(parallel, vv.size(), [&](std::size_t i)
+                    {
                         vv[i] *= (Real)f;
+                    });
                 }
                 else
                 {
                     helper::WriteAccessor< Data<VecDeriv> >vv( *this->write(core::VecDerivId(v)) );
-                    for (unsigned int i=0; i<vv.size(); i++)
+                    forEachIndex(parallel, vv.size(), [&](std::size_t i)
+                    {
                         vv[i] *= (Real)f;
+                    });
                 }
             }
             else
@@ -1864,16 +1992,20 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                     helper::WriteAccessor< Data<VecCoord> >vv( *this->write(core::VecCoordId(v)) );
                     helper::ReadAccessor< Data<VecCoord> > vb( *this->read(core::ConstVecCoordId(b)) );
                     vv.resize(vb.size());
-                    for (unsigned int i=0; i<vv.size(); i++)
+                    forEachIndex(parallel, vv.size(), [&](std::size_t i)
+                    {
                         vv[i] = vb[i] * (Real)f;
+                    });
                 }
                 else
                 {
                     helper::WriteAccessor< Data<VecDeriv> >vv( *this->write(core::VecDerivId(v)) );
                     helper::ReadAccessor< Data<VecDeriv> > vb( *this->read(core::ConstVecDerivId(b)) );
                     vv.resize(vb.size());
-                    for (unsigned int i=0; i<vv.size(); i++)
+                    forEachIndex(parallel, vv.size(), [&](std::size_t i)
+                    {
                         vv[i] = vb[i] * (Real)f;
+                    });
                 }
             }
         }
@@ -1894,16 +2026,20 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                 helper::WriteOnlyAccessor< Data<VecCoord> > vv(*this->write(core::VecCoordId(v)) );
                 helper::ReadAccessor< Data<VecCoord> > va(*this->read(core::ConstVecCoordId(a)) );
                 vv.resize(va.size());
-                for (unsigned int i=0; i<vv.size(); i++)
+                forEachIndex(parallel, vv.size(), [&](std::size_t i)
+                {
                     vv[i] = va[i];
+                });
             }
             else
             {
                 helper::WriteOnlyAccessor< Data<VecDeriv> > vv(*this->write(core::VecDerivId(v)) );
                 helper::ReadAccessor< Data<VecDeriv> > va(*this->read(core::ConstVecDerivId(a)) );
                 vv.resize(va.size());
-                for (unsigned int i=0; i<vv.size(); i++)
+                forEachIndex(parallel, vv.size(), [&](std::size_t i)
+                {
                     vv[i] = va[i];
+                });
             }
         }
         else
@@ -1923,8 +2059,10 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                             if (vb.size() > vv.size())
                                 vv.resize(vb.size());
 
-                            for (unsigned int i=0; i<vb.size(); i++)
+                            forEachIndex(parallel, vb.size(), [&](std::size_t i)
+                            {
                                 vv[i] += vb[i];
+                            });
                         }
                         else
                         {
@@ -1933,8 +2071,10 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                             if (vb.size() > vv.size())
                                 vv.resize(vb.size());
 
-                            for (unsigned int i=0; i<vb.size(); i++)
+                            forEachIndex(parallel, vb.size(), [&](std::size_t i)
+                            {
                                 vv[i] += vb[i];
+                            });
                         }
                     }
                     else if (b.type == sofa::core::V_DERIV)
@@ -1945,8 +2085,10 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                         if (vb.size() > vv.size())
                             vv.resize(vb.size());
 
-                        for (unsigned int i=0; i<vb.size(); i++)
+                        forEachIndex(parallel, vb.size(), [&](std::size_t i)
+                        {
                             vv[i] += vb[i];
+                        });
                     }
                     else
                     {
@@ -1968,8 +2110,10 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                             if (vb.size() > vv.size())
                                 vv.resize(vb.size());
 
-                            for (unsigned int i=0; i<vb.size(); i++)
+                            forEachIndex(parallel, vb.size(), [&](std::size_t i)
+                            {
                                 vv[i] += vb[i]*(Real)f;
+                            });
                         }
                         else
                         {
@@ -1978,8 +2122,10 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                             if (vb.size() > vv.size())
                                 vv.resize(vb.size());
 
-                            for (unsigned int i=0; i<vb.size(); i++)
+                            forEachIndex(parallel, vb.size(), [&](std::size_t i)
+                            {
                                 vv[i] += vb[i]*(Real)f;
+                            });
                         }
                     }
                     else if (b.type == sofa::core::V_DERIV)
@@ -1990,8 +2136,10 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                         if (vb.size() > vv.size())
                             vv.resize(vb.size());
 
-                        for (unsigned int i=0; i<vb.size(); i++)
+                        forEachIndex(parallel, vb.size(), [&](std::size_t i)
+                        {
                             vv[i] += vb[i]*(Real)f;
+                        });
                     }
                     else
                     {
@@ -2016,8 +2164,10 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                             if (va.size() > vv.size())
                                 vv.resize(va.size());
 
-                            for (unsigned int i=0; i<va.size(); i++)
+                            forEachIndex(parallel, va.size(), [&](std::size_t i)
+                            {
                                 vv[i] += va[i];
+                            });
                         }
                         else
                         {
@@ -2026,8 +2176,10 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                             if (va.size() > vv.size())
                                 vv.resize(va.size());
 
-                            for (unsigned int i=0; i<va.size(); i++)
+                            forEachIndex(parallel, va.size(), [&](std::size_t i)
+                            {
                                 vv[i] += va[i];
+                            });
                         }
                     }
                     else if (a.type == sofa::core::V_DERIV)
@@ -2038,8 +2190,10 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                         if (va.size() > vv.size())
                             vv.resize(va.size());
 
-                        for (unsigned int i=0; i<va.size(); i++)
+                        forEachIndex(parallel, va.size(), [&](std::size_t i)
+                        {
                             vv[i] += va[i];
+                        });
                     }
                     else
                     {
@@ -2056,22 +2210,22 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                         helper::WriteOnlyAccessor< Data<VecCoord> >vv( *this->write(core::VecCoordId(v)) );
                         helper::ReadAccessor< Data<VecCoord> > va( *this->read(core::ConstVecCoordId(a)) );
                         vv.resize(va.size());
-                        for (unsigned int i=0; i<vv.size(); i++)
+                        forEachIndex(parallel, vv.size(), [&](std::size_t i)
                         {
                             vv[i] *= (Real)f;
                             vv[i] += va[i];
-                        }
+                        });
                     }
                     else
                     {
                         helper::WriteOnlyAccessor< Data<VecDeriv> >vv( *this->write(core::VecDerivId(v)) );
                         helper::ReadAccessor< Data<VecDeriv> > va( *this->read(core::ConstVecDerivId(a)) );
                         vv.resize(va.size());
-                        for (unsigned int i=0; i<vv.size(); i++)
+                        forEachIndex(parallel, vv.size(), [&](std::size_t i)
                         {
                             vv[i] *= (Real)f;
                             vv[i] += va[i];
-                        }
+                        });
                     }
                 }
             }
@@ -2088,20 +2242,20 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                         if (b.type == sofa::core::V_COORD)
                         {
                             helper::ReadAccessor< Data<VecCoord> > vb( *this->read(core::ConstVecCoordId(b)) );
-                            for (unsigned int i=0; i<vv.size(); i++)
+                            forEachIndex(parallel, vv.size(), [&](std::size_t i)
                             {
                                 vv[i] = va[i];
                                 vv[i] += vb[i];
-                            }
+                            });
                         }
                         else
                         {
                             helper::ReadAccessor< Data<VecDeriv> > vb( *this->read(core::ConstVecDerivId(b)) );
-                            for (unsigned int i=0; i<vv.size(); i++)
+                            forEachIndex(parallel, vv.size(), [&](std::size_t i)
                             {
                                 vv[i] = va[i];
                                 vv[i] += vb[i];
-                            }
+                            });
                         }
                     }
                     else if (b.type == sofa::core::V_DERIV)
@@ -2110,11 +2264,11 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                         helper::ReadAccessor< Data<VecDeriv> > va( *this->read(core::ConstVecDerivId(a)) );
                         helper::ReadAccessor< Data<VecDeriv> > vb( *this->read(core::ConstVecDerivId(b)) );
                         vv.resize(va.size());
-                        for (unsigned int i=0; i<vv.size(); i++)
+                        forEachIndex(parallel, vv.size(), [&](std::size_t i)
                         {
                             vv[i] = va[i];
                             vv[i] += vb[i];
-                        }
+                        });
                     }
                     else
                     {
@@ -2134,20 +2288,20 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                         if (b.type == sofa::core::V_COORD)
                         {
                             helper::ReadAccessor< Data<VecCoord> > vb( *this->read(core::ConstVecCoordId(b)) );
-                            for (unsigned int i=0; i<vv.size(); i++)
+                            forEachIndex(parallel, vv.size(), [&](std::size_t i)
                             {
                                 vv[i] = va[i];
                                 vv[i] += vb[i]*(Real)f;
-                            }
+                            });
                         }
                         else
                         {
                             helper::ReadAccessor< Data<VecDeriv> > vb( *this->read(core::ConstVecDerivId(b)) );
-                            for (unsigned int i=0; i<vv.size(); i++)
+                            forEachIndex(parallel, vv.size(), [&](std::size_t i)
                             {
                                 vv[i] = va[i];
                                 vv[i] += vb[i]*(Real)f;
-                            }
+                            });
                         }
                     }
                     else if (b.type == sofa::core::V_DERIV)
@@ -2156,11 +2310,11 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
                         helper::ReadAccessor< Data<VecDeriv> > va( *this->read(core::ConstVecDerivId(a)) );
                         helper::ReadAccessor< Data<VecDeriv> > vb( *this->read(core::ConstVecDerivId(b)) );
                         vv.resize(va.size());
-                        for (unsigned int i=0; i<vv.size(); i++)
+                        forEachIndex(parallel, vv.size(), [&](std::size_t i)
                         {
                             vv[i] = va[i];
                             vv[i] += vb[i]*(Real)f;
-                        }
+                        });
                     }
                     else
                     {
@@ -2178,6 +2332,8 @@ void MechanicalObject<DataTypes>::vOp(const core::ExecParams* params, core::VecI
 template <class DataTypes>
 void MechanicalObject<DataTypes>::vMultiOp(const core::ExecParams* params, const VMultiOp& ops)
 {
+    const bool parallel = useParallelVectorOperations();
+
     // optimize common integration case: v += a*dt, x += v*dt
     if (ops.size() == 2
             && ops[0].second.size() == 2
@@ -2203,39 +2359,39 @@ void MechanicalObject<DataTypes>::vMultiOp(const core::ExecParams* params, const
         {
             if (f_v_a == 1.0) // used by euler implicit and other integrators that directly computes a*dt
             {
-                for (unsigned int i=0; i<n; ++i)
+                forEachIndex(parallel, n, [&](std::size_t i)
                 {
                     vv[i] += va[i];
                     vx[i] += vv[i]*f_x_v;
-                }
+                });
             }
             else
             {
-                for (unsigned int i=0; i<n; ++i)
+                forEachIndex(parallel, n, [&](std::size_t i)
                 {
                     vv[i] += va[i]*f_v_a;
                     vx[i] += vv[i]*f_x_v;
-                }
+                });
             }
         }
         else if (f_x_x == 1.0) // some damping is applied to v
         {
-            for (unsigned int i=0; i<n; ++i)
+            forEachIndex(parallel, n, [&](std::size_t i)
             {
                 vv[i] *= f_v_v;
                 vv[i] += va[i];
                 vx[i] += vv[i]*f_x_v;
-            }
+            });
         }
         else // general case
         {
-            for (unsigned int i=0; i<n; ++i)
+            forEachIndex(parallel, n, [&](std::size_t i)
             {
                 vv[i] *= f_v_v;
                 vv[i] += va[i]*f_v_a;
                 vx[i] *= f_x_x;
                 vx[i] += vv[i]*f_x_v;
-            }
+            });
         }
     }
     else if(ops.size()==2 //used in the ExplicitBDF solver only (Electrophysiology)
@@ -2257,18 +2413,89 @@ void MechanicalObject<DataTypes>::vMultiOp(const core::ExecParams* params, const
         const Real f_2 = (Real)(ops[1].second[1].second);
         const Real f_3 = (Real)(ops[1].second[2].second);
 
-        for (unsigned int i=0; i<n; ++i)
+        forEachIndex(parallel, n, [&](std::size_t i)
         {
             previousPos[i] = v11[i];
             newPos[i]  = v21[i]*f_1;
             newPos[i] += v22[i]*f_2;
             newPos[i] += v23[i]*f_3;
-        }
+        });
     }
     else // no optimization for now for other cases
         Inherited::vMultiOp(params, ops);
 }
 
+template <class DataTypes>
+void MechanicalObject<DataTypes>::vMultiOpDot(const core::ExecParams* params, const VMultiOp& ops, const VMultiDot& dots, SReal* results)
+{
+    // the operations are fused only on existing derivative vectors of the state size, the other cases are decomposed
+    const std::size_t n = getSize();
+    const auto isFusable = [this, n](core::ConstVecId v)
+    {
+        return v.type == sofa::core::V_DERIV && v.index < vectorsDeriv.size() && vectorsDeriv[v.index] != nullptr
+                && vectorsDeriv[v.index]->getValue().size() == n;
+    };
+    bool fusable = true;
+    for (const auto& op : ops)
+    {
+        fusable = fusable && isFusable(op.first.getId(this));
+        for (const auto& term : op.second)
+            fusable = fusable && isFusable(term.first.getId(this));
+    }
+    for (const auto& dot : dots)
+        fusable = fusable && isFusable(dot.first.getId(this)) && isFusable(dot.second.getId(this));
+
+    if (!fusable)
+    {
+        Inherited::vMultiOpDot(params, ops, dots, results);
+        return;
+    }
+
+    // the vectors are edited before being read, so that the read values are the edited ones
+    std::vector< Data<VecDeriv>* > edited;
+    const auto edit = [this, &edited](core::VecId v)
+    {
+        Data<VecDeriv>* d = this->write(core::VecDerivId(v));
+        if (std::find(edited.begin(), edited.end(), d) == edited.end())
+            edited.push_back(d);
+        return d->beginEdit()->data();
+    };
+    const auto values = [this](core::ConstVecId v)
+    {
+        return this->read(core::ConstVecDerivId(v))->getValue().data();
+    };
+
+    std::vector< Real > dotResults(dots.size());
+    const auto fuse = [&](auto scalar, std::size_t nbValuesPerDeriv)
+    {
+        using T = decltype(scalar);
+        std::vector< FusedLinearCombination<T, Real> > fusedOps(ops.size());
+        for (std::size_t i = 0; i < ops.size(); ++i)
+            fusedOps[i].result = reinterpret_cast<T*>(edit(ops[i].first.getId(this)));
+        for (std::size_t i = 0; i < ops.size(); ++i)
+            for (const auto& term : ops[i].second)
+                fusedOps[i].terms.emplace_back(reinterpret_cast<const T*>(values(term.first.getId(this))), Real(term.second));
+
+        std::vector< std::pair<const T*, const T*> > fusedDots;
+        for (const auto& dot : dots)
+            fusedDots.emplace_back(reinterpret_cast<const T*>(values(dot.first.getId(this))), reinterpret_cast<const T*>(values(dot.second.getId(this))));
+
+        fusedMultiOpDot(useParallelVectorOperations(), n * nbValuesPerDeriv, fusedOps, fusedDots, dotResults.data());
+    };
+
+    // when the derivatives are plain arrays of scalars, the operations are performed on the scalars
+    if constexpr (sizeof(Deriv) == sizeof(Real) * DataTypes::deriv_total_size)
+        fuse(Real(), DataTypes::deriv_total_size);
+    else
+        fuse(Deriv(), 1);
+
+    for (Data<VecDeriv>* d : edited)
+    {
+        d->endEdit();
+    }
+    std::copy(dotResults.begin(), dotResults.end(), results);
+}
+
 template <class T> inline void clear( T& t )
 {
     t.clear();
@@ -2308,25 +2535,37 @@ SReal MechanicalObject<DataTypes>::vDot(const core::ExecParams*, core::ConstVecI
 {
     Real r = 0.0;
 
-    if (a.type == sofa::core::V_COORD && b.type == sofa::core::V_COORD)
+    // above the threshold, the products are summed with a pairwise reduction tree depending only on the size
+    const auto dot = [this](const auto& va, const auto& vb)
     {
-        const VecCoord &va = this->read(core::ConstVecCoordId(a))->getValue();
-        const VecCoord &vb = this->read(core::ConstVecCoordId(b))->getValue();
+        if (useParallelVectorOperations())
+        {
+            return simulation::parallelReduce(std::size_t(0), va.size(), Real(0),
+                [&va, &vb](std::size_t i) { return Real(va[i] * vb[i]); },
+                [](Real r0, Real r1) { return r0 + r1; });
+        }
 
+        Real result = 0.0;
         for (unsigned int i=0; i<va.size(); i++)
         {
-            r += va[i] * vb[i];
+            result += va[i] * vb[i];
         }
+        return result;
+    };
+
+    if (a.type == sofa::core::V_COORD && b.type == sofa::core::V_COORD)
+    {
+        const VecCoord &va = this->read(core::ConstVecCoordId(a))->getValue();
+        const VecCoord &vb = this->read(core::ConstVecCoordId(b))->getValue();
+
+        r = dot(va, vb);
     }
     else if (a.type == sofa::core::V_DERIV && b.type == sofa::core::V_DERIV)
     {
         const VecDeriv &va = this->read(core::ConstVecDerivId(a))->getValue();
         const VecDeriv &vb = this->read(core::ConstVecDerivId(b))->getValue();
 
-        for (unsigned int i=0; i<va.size(); i++)
-        {
-            r += va[i] * vb[i];
-        }
+        r = dot(va, vb);
     }
     else
     {
@@ -2336,6 +2575,13 @@ SReal MechanicalObject<DataTypes>::vDot(const core::ExecParams*, core::ConstVecI
     return r;
 }
 
+template <class DataTypes>
+bool MechanicalObject<DataTypes>::useParallelVectorOperations() const
+{
+    const unsigned int threshold = d_parallelThreshold.getValue();
+    return threshold > 0 && getSize() >= threshold;
+}
+
 typedef std::size_t nat;
 
 template <class DataTypes>
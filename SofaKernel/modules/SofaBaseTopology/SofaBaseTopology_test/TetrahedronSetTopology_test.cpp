@@ -25,6 +25,10 @@
 #include <SofaBaseTopology/TetrahedronSetTopologyContainer.h>
 #include <SofaBaseTopology/TetrahedronSetGeometryAlgorithms.h>
 #include <sofa/helper/system/FileRepository.h>
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <filesystem>
+#include <map>
 
 using namespace sofa::component::topology;
 using namespace sofa::testing;
@@ -40,6 +44,9 @@ public:
     bool testVertexBuffers();
     bool checkTopology();
     bool testTetrahedronGeometry();
+    bool testBuffersOnGrid();
+    bool testTopologyCache();
+    bool testParallelBuffers();
 
     // ground truth from obj file;
     int nbrTetrahedron = 44;
@@ -442,6 +449,225 @@ bool TetrahedronSetTopology_test::testTetrahedronGeometry()
 }
 
 
+/// Add the tetrahedra of the cubes of a n*n*n grid, each one split in 6 positively oriented tetrahedra
+static void addGridTetrahedra(TetrahedronSetTopologyContainer* topoCon, int n)
+{
+    const auto vertexIndex = [n](int x, int y, int z) { return sofa::Index(x + (n + 1) * (y + (n + 1) * z)); };
+    const int axes[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+
+    for (int z = 0; z < n; ++z)
+        for (int y = 0; y < n; ++y)
+            for (int x = 0; x < n; ++x)
+                for (const auto& axis : axes)
+                {
+                    int p[4][3];
+                    p[0][0] = x; p[0][1] = y; p[0][2] = z;
+                    for (int k = 1; k < 4; ++k)
+                    {
+                        for (int c = 0; c < 3; ++c)
+                            p[k][c] = p[k - 1][c];
+                        if (k < 3) ++p[k][axis[k - 1]];
+                        else { p[k][0] = x + 1; p[k][1] = y + 1; p[k][2] = z + 1; }
+                    }
+                    int d[3][3];
+                    for (int k = 0; k < 3; ++k)
+                        for (int c = 0; c < 3; ++c)
+                            d[k][c] = p[k + 1][c] - p[0][c];
+                    const int volume = d[0][0] * (d[1][1] * d[2][2] - d[1][2] * d[2][1])
+                                     - d[0][1] * (d[1][0] * d[2][2] - d[1][2] * d[2][0])
+                                     + d[0][2] * (d[1][0] * d[2][1] - d[1][1] * d[2][0]);
+                    if (volume < 0)
+                        std::swap(p[2], p[3]);
+                    topoCon->addTetra(vertexIndex(p[0][0], p[0][1], p[0][2]), vertexIndex(p[1][0], p[1][1], p[1][2]),
+                                      vertexIndex(p[2][0], p[2][1], p[2][2]), vertexIndex(p[3][0], p[3][1], p[3][2]));
+                }
+}
+
+bool TetrahedronSetTopology_test::testBuffersOnGrid()
+{
+    using Tetrahedron = TetrahedronSetTopologyContainer::Tetrahedron;
+    using Edge = TetrahedronSetTopologyContainer::Edge;
+    using Triangle = TetrahedronSetTopologyContainer::Triangle;
+
+    const int n = 6;
+    TetrahedronSetTopologyContainer::SPtr topoCon = sofa::core::objectmodel::New< TetrahedronSetTopologyContainer >();
+    addGridTetrahedra(topoCon.get(), n);
+    topoCon->init();
+
+    const auto& tetrahedra = topoCon->getTetrahedronArray();
+    const auto& edges = topoCon->getEdgeArray();
+    const auto& triangles = topoCon->getTriangleArray();
+    const auto& edgesInTetra = topoCon->getEdgesInTetrahedronArray();
+    const auto& trianglesInTetra = topoCon->getTrianglesInTetrahedronArray();
+    EXPECT_EQ(tetrahedra.size(), size_t(6 * n * n * n));
+
+    // the edges and triangles are numbered in the order of their first occurrence in the tetrahedra
+    std::map<Edge, sofa::Index> edgeMap;
+    std::map<std::array<sofa::Index, 3>, sofa::Index> triangleMap;
+    for (size_t i = 0; i < tetrahedra.size(); ++i)
+    {
+        const Tetrahedron& t = tetrahedra[i];
+        for (unsigned int j = 0; j < 6; ++j)
+        {
+            const auto v1 = t[sofa::core::topology::edgesInTetrahedronArray[j][0]];
+            const auto v2 = t[sofa::core::topology::edgesInTetrahedronArray[j][1]];
+            const Edge e = (v1 < v2) ? Edge(v1, v2) : Edge(v2, v1);
+            const auto it = edgeMap.emplace(e, sofa::Index(edgeMap.size())).first;
+            EXPECT_EQ(edgesInTetra[i][j], it->second);
+        }
+        for (unsigned int j = 0; j < 4; ++j)
+        {
+            std::array<sofa::Index, 3> v { t[(j + 1) % 4], t[(j + 2) % 4], t[(j + 3) % 4] };
+            std::sort(v.begin(), v.end());
+            const auto it = triangleMap.emplace(v, sofa::Index(triangleMap.size())).first;
+            EXPECT_EQ(trianglesInTetra[i][j], it->second);
+        }
+    }
+    EXPECT_EQ(edges.size(), edgeMap.size());
+    EXPECT_EQ(triangles.size(), triangleMap.size());
+    for (const auto& e : edgeMap)
+    {
+        EXPECT_EQ(edges[e.second][0], e.first[0]);
+        EXPECT_EQ(edges[e.second][1], e.first[1]);
+    }
+    for (const auto& tr : triangleMap)
+    {
+        const Triangle& triangle = triangles[tr.second];
+        std::array<sofa::Index, 3> v { triangle[0], triangle[1], triangle[2] };
+        std::sort(v.begin(), v.end());
+        EXPECT_EQ(v, tr.first);
+    }
+
+    // the shells list the tetrahedra in increasing order
+    std::vector<std::vector<sofa::Index> > aroundVertex(topoCon->getNbPoints()), aroundEdge(edges.size()), aroundTriangle(triangles.size());
+    for (sofa::Index i = 0; i < tetrahedra.size(); ++i)
+    {
+        for (unsigned int j = 0; j < 4; ++j)
+        {
+            aroundVertex[tetrahedra[i][j]].push_back(i);
+            aroundTriangle[trianglesInTetra[i][j]].push_back(i);
+        }
+        for (unsigned int j = 0; j < 6; ++j)
+            aroundEdge[edgesInTetra[i][j]].push_back(i);
+    }
+    for (sofa::Index v = 0; v < aroundVertex.size(); ++v)
+        EXPECT_EQ(std::vector<sofa::Index>(topoCon->getTetrahedraAroundVertex(v).begin(), topoCon->getTetrahedraAroundVertex(v).end()), aroundVertex[v]);
+    for (sofa::Index e = 0; e < aroundEdge.size(); ++e)
+        EXPECT_EQ(std::vector<sofa::Index>(topoCon->getTetrahedraAroundEdge(e).begin(), topoCon->getTetrahedraAroundEdge(e).end()), aroundEdge[e]);
+    for (sofa::Index tr = 0; tr < aroundTriangle.size(); ++tr)
+        EXPECT_EQ(std::vector<sofa::Index>(topoCon->getTetrahedraAroundTriangle(tr).begin(), topoCon->getTetrahedraAroundTriangle(tr).end()), aroundTriangle[tr]);
+
+    return topoCon->checkTopology();
+}
+
+bool TetrahedronSetTopology_test::testTopologyCache()
+{
+    const std::string directory = (std::filesystem::temp_directory_path() / "TetrahedronSetTopology_test_cache").string();
+    std::filesystem::remove_all(directory);
+
+    // the first container computes the buffers and writes the cache, the second one reads it
+    TetrahedronSetTopologyContainer::SPtr computed = sofa::core::objectmodel::New< TetrahedronSetTopologyContainer >();
+    TetrahedronSetTopologyContainer::SPtr cached = sofa::core::objectmodel::New< TetrahedronSetTopologyContainer >();
+    for (const auto& topoCon : { computed, cached })
+    {
+        addGridTetrahedra(topoCon.get(), 3);
+        topoCon->d_cacheDirectory.setValue(directory);
+    }
+    computed->init();
+    {
+        // the buffers are reported as loaded from the cache
+        EXPECT_MSG_EMIT(Info);
+        cached->f_printLog.setValue(true);
+        cached->init();
+    }
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()), 1);
+
+    EXPECT_EQ(cached->getNbPoints(), computed->getNbPoints());
+    EXPECT_EQ(cached->getNbEdges(), computed->getNbEdges());
+    EXPECT_EQ(cached->getNbTriangles(), computed->getNbTriangles());
+    for (sofa::Index e = 0; e < computed->getNbEdges(); ++e)
+    {
+        EXPECT_EQ(cached->getEdge(e)[0], computed->getEdge(e)[0]);
+        EXPECT_EQ(cached->getEdge(e)[1], computed->getEdge(e)[1]);
+        EXPECT_EQ(cached->getTetrahedraAroundEdge(e), computed->getTetrahedraAroundEdge(e));
+        EXPECT_EQ(cached->getTrianglesAroundEdge(e), computed->getTrianglesAroundEdge(e));
+    }
+    for (sofa::Index tr = 0; tr < computed->getNbTriangles(); ++tr)
+    {
+        EXPECT_EQ(cached->getTetrahedraAroundTriangle(tr), computed->getTetrahedraAroundTriangle(tr));
+        for (unsigned int j = 0; j < 3; ++j)
+            EXPECT_EQ(cached->getEdgesInTriangle(tr)[j], computed->getEdgesInTriangle(tr)[j]);
+    }
+    for (sofa::Index v = 0; v < computed->getNbPoints(); ++v)
+    {
+        EXPECT_EQ(cached->getTetrahedraAroundVertex(v), computed->getTetrahedraAroundVertex(v));
+        EXPECT_EQ(cached->getTrianglesAroundVertex(v), computed->getTrianglesAroundVertex(v));
+        EXPECT_EQ(cached->getEdgesAroundVertex(v), computed->getEdgesAroundVertex(v));
+    }
+    for (sofa::Index i = 0; i < computed->getNbTetrahedra(); ++i)
+    {
+        for (unsigned int j = 0; j < 6; ++j)
+            EXPECT_EQ(cached->getEdgesInTetrahedron(i)[j], computed->getEdgesInTetrahedron(i)[j]);
+        for (unsigned int j = 0; j < 4; ++j)
+            EXPECT_EQ(cached->getTrianglesInTetrahedron(i)[j], computed->getTrianglesInTetrahedron(i)[j]);
+    }
+    EXPECT_TRUE(cached->checkTopology());
+
+    // another mesh gets its own cache file
+    TetrahedronSetTopologyContainer::SPtr other = sofa::core::objectmodel::New< TetrahedronSetTopologyContainer >();
+    addGridTetrahedra(other.get(), 2);
+    other->d_cacheDirectory.setValue(directory);
+    other->init();
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(directory), std::filesystem::directory_iterator()), 2);
+    EXPECT_EQ(other->getNbTetrahedra(), 6u * 2 * 2 * 2);
+    EXPECT_TRUE(other->checkTopology());
+
+    std::filesystem::remove_all(directory);
+    return true;
+}
+
+
+bool TetrahedronSetTopology_test::testParallelBuffers()
+{
+    using sofa::simulation::TaskScheduler;
+
+    // without a running task scheduler, the buffers are computed sequentially, without creating one
+    const bool hasScheduler = TaskScheduler::getCurrentInstance() != nullptr;
+    TetrahedronSetTopologyContainer::SPtr sequential = sofa::core::objectmodel::New< TetrahedronSetTopologyContainer >();
+    addGridTetrahedra(sequential.get(), 4);
+    sequential->init();
+    if (!hasScheduler)
+        EXPECT_EQ(TaskScheduler::getCurrentInstance(), nullptr);
+
+    // with a task scheduler initialized on several threads, the parallel computation gives the same buffers
+    TaskScheduler::getInstance()->init(4);
+    TetrahedronSetTopologyContainer::SPtr parallel = sofa::core::objectmodel::New< TetrahedronSetTopologyContainer >();
+    addGridTetrahedra(parallel.get(), 4);
+    parallel->init();
+    TaskScheduler::getInstance()->stop();
+
+    EXPECT_EQ(parallel->getNbEdges(), sequential->getNbEdges());
+    EXPECT_EQ(parallel->getNbTriangles(), sequential->getNbTriangles());
+    for (sofa::Index e = 0; e < sequential->getNbEdges(); ++e)
+    {
+        EXPECT_EQ(parallel->getEdge(e)[0], sequential->getEdge(e)[0]);
+        EXPECT_EQ(parallel->getEdge(e)[1], sequential->getEdge(e)[1]);
+        EXPECT_EQ(parallel->getTetrahedraAroundEdge(e), sequential->getTetrahedraAroundEdge(e));
+    }
+    for (sofa::Index tr = 0; tr < sequential->getNbTriangles(); ++tr)
+        EXPECT_EQ(parallel->getTetrahedraAroundTriangle(tr), sequential->getTetrahedraAroundTriangle(tr));
+    for (sofa::Index v = 0; v < sequential->getNbPoints(); ++v)
+        EXPECT_EQ(parallel->getTetrahedraAroundVertex(v), sequential->getTetrahedraAroundVertex(v));
+    for (sofa::Index i = 0; i < sequential->getNbTetrahedra(); ++i)
+    {
+        for (unsigned int j = 0; j < 6; ++j)
+            EXPECT_EQ(parallel->getEdgesInTetrahedron(i)[j], sequential->getEdgesInTetrahedron(i)[j]);
+        for (unsigned int j = 0; j < 4; ++j)
+            EXPECT_EQ(parallel->getTrianglesInTetrahedron(i)[j], sequential->getTrianglesInTetrahedron(i)[j]);
+    }
+    return parallel->checkTopology();
+}
+
 
 TEST_F(TetrahedronSetTopology_test, testEmptyContainer)
 {
@@ -478,6 +704,21 @@ TEST_F(TetrahedronSetTopology_test, testTetrahedronGeometry)
     ASSERT_TRUE(testTetrahedronGeometry());
 }
 
+TEST_F(TetrahedronSetTopology_test, testBuffersOnGrid)
+{
+    ASSERT_TRUE(testBuffersOnGrid());
+}
+
+TEST_F(TetrahedronSetTopology_test, testTopologyCache)
+{
+    ASSERT_TRUE(testTopologyCache());
+}
+
+TEST_F(TetrahedronSetTopology_test, testParallelBuffers)
+{
+    ASSERT_TRUE(testParallelBuffers());
+}
+
 
 
 // TODO epernod 2018-07-05: test element on Border
@@ -23,6 +23,14 @@
 #include <sofa/core/topology/TopologyHandler.h>
 
 #include <sofa/core/ObjectFactory.h>
+#include <sofa/simulation/ParallelForEach.h>
+#include <sofa/helper/io/ArrayCacheFile.h>
+#include <sofa/helper/system/FileSystem.h>
+
+#include <iomanip>
+#include <sstream>
+
+#include <numeric>
 
 namespace sofa::component::topology
 {
@@ -37,10 +45,211 @@ int TetrahedronSetTopologyContainerClass = core::RegisterObject("Tetrahedron set
 
 ///convention triangles in tetra (orientation interior)
 
+namespace
+{
+
+/// Call f(i) for each i in [0, n), in parallel if a task scheduler already runs on several threads:
+/// building a topology does not start one by itself
+template<class Function>
+void forEachIndex(std::size_t n, const Function& f)
+{
+    if (sofa::simulation::hasParallelTaskScheduler())
+    {
+        sofa::simulation::parallelForEach(std::size_t(0), n, f);
+        return;
+    }
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        f(i);
+    }
+}
+
+/// Compressed sparse row storage of a one-to-many relation: the items associated with the key k
+/// are items[offsets[k]] to items[offsets[k+1]-1], in increasing order.
+struct CompressedAdjacency
+{
+    sofa::type::vector<Index> offsets;
+    sofa::type::vector<Index> items;
+};
+
+/// Build the adjacency of the items [0, nbItems), the item i being associated with the key key(i) < nbKeys.
+/// A counting sort is used: the keys are counted, their offsets are given by a prefix sum, and the
+/// items are then scattered at their position, without any allocation per key.
+template<class KeyFunction>
+void buildCompressedAdjacency(CompressedAdjacency& adjacency, std::size_t nbKeys, std::size_t nbItems, const KeyFunction& key)
+{
+    adjacency.offsets.assign(nbKeys + 1, 0);
+    for (std::size_t i = 0; i < nbItems; ++i)
+    {
+        ++adjacency.offsets[key(i) + 1];
+    }
+    std::partial_sum(adjacency.offsets.begin(), adjacency.offsets.end(), adjacency.offsets.begin());
+
+    adjacency.items.resize(nbItems);
+    sofa::type::vector<Index> position(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    for (std::size_t i = 0; i < nbItems; ++i)
+    {
+        adjacency.items[position[key(i)]++] = Index(i);
+    }
+}
+
+/// Fill the shells of the keys of the adjacency, the items being the element indices multiplied by nbItemsPerElement
+template<class Shell>
+void fillShells(sofa::type::vector<Shell>& shells, const CompressedAdjacency& adjacency, Index nbItemsPerElement)
+{
+    shells.resize(adjacency.offsets.size() - 1);
+    forEachIndex(shells.size(), [&](std::size_t k)
+    {
+        Shell& shell = shells[k];
+        shell.resize(adjacency.offsets[k + 1] - adjacency.offsets[k]);
+        for (std::size_t p = 0; p < shell.size(); ++p)
+        {
+            shell[p] = adjacency.items[adjacency.offsets[k] + p] / nbItemsPerElement;
+        }
+    });
+}
+
+/// For each of the items [0, nbItems), the smallest item sharing the same bucket(i) < nbBuckets and the same key(i).
+/// The items are sorted per bucket, so that only the few items around a vertex are compared.
+template<class BucketFunction, class KeyFunction>
+sofa::type::vector<Index> findFirstOccurrences(std::size_t nbBuckets, std::size_t nbItems, const BucketFunction& bucket, const KeyFunction& key)
+{
+    CompressedAdjacency adjacency;
+    buildCompressedAdjacency(adjacency, nbBuckets, nbItems, bucket);
+
+    sofa::type::vector<Index> firstOccurrence(nbItems);
+    forEachIndex(nbBuckets, [&](std::size_t b)
+    {
+        const auto begin = adjacency.items.begin() + adjacency.offsets[b];
+        const auto end = adjacency.items.begin() + adjacency.offsets[b + 1];
+        std::sort(begin, end, [&key](Index i, Index j)
+        {
+            const auto ki = key(i);
+            const auto kj = key(j);
+            return ki < kj || (ki == kj && i < j);
+        });
+        for (auto it = begin; it != end; ++it)
+        {
+            firstOccurrence[*it] = (it != begin && key(*(it - 1)) == key(*it)) ? firstOccurrence[*(it - 1)] : *it;
+        }
+    });
+    return firstOccurrence;
+}
+
+/// Number of vertices referenced by the elements, at least nbPoints
+template<class Element>
+std::size_t getNbReferencedVertices(const sofa::type::vector<Element>& elements, std::size_t nbPoints)
+{
+    for (const Element& e : elements)
+    {
+        for (const Index v : e)
+        {
+            nbPoints = std::max(nbPoints, std::size_t(v) + 1);
+        }
+    }
+    return nbPoints;
+}
+
+/// The vertices of the triangle j of the tetrahedron t, rotated so that the first one is the smallest one
+sofa::topology::Triangle getTriangleInTetrahedron(const sofa::topology::Tetrahedron& t, unsigned int j)
+{
+    Index v[3];
+    for (unsigned int k = 0; k < 3; ++k)
+        v[k] = t[sofa::core::topology::trianglesOrientationInTetrahedronArray[j][k]];
+
+    while ((v[0] > v[1]) || (v[0] > v[2]))
+    {
+        const Index val = v[0];
+        v[0] = v[1];
+        v[1] = v[2];
+        v[2] = val;
+    }
+    return sofa::topology::Triangle(v[0], v[1], v[2]);
+}
+
+/// The vertices of a triangle in increasing order, to compare triangles whatever their orientation
+std::array<Index, 3> getSortedVertices(Index a, Index b, Index c)
+{
+    std::array<Index, 3> v { a, b, c };
+    std::sort(v.begin(), v.end());
+    return v;
+}
+
+/// For the edge j of the tetrahedron i, stored at 6*i+j, the index 6*i'+j' of the first occurrence of the same edge
+sofa::type::vector<Index> findTetrahedronEdgeOccurrences(const sofa::type::vector<sofa::topology::Tetrahedron>& tetrahedra)
+{
+    const auto vertex = [&tetrahedra](std::size_t k, unsigned int v)
+    {
+        return tetrahedra[k / 6][edgesInTetrahedronArray[k % 6][v]];
+    };
+    return findFirstOccurrences(getNbReferencedVertices(tetrahedra, 0), 6 * tetrahedra.size(),
+        [&vertex](std::size_t k) { return std::min(vertex(k, 0), vertex(k, 1)); },
+        [&vertex](std::size_t k) { return std::max(vertex(k, 0), vertex(k, 1)); });
+}
+
+/// For the triangle j of the tetrahedron i, stored at 4*i+j, the index 4*i'+j' of the first occurrence of the same triangle
+sofa::type::vector<Index> findTetrahedronTriangleOccurrences(const sofa::type::vector<sofa::topology::Tetrahedron>& tetrahedra)
+{
+    return findFirstOccurrences(getNbReferencedVertices(tetrahedra, 0), 4 * tetrahedra.size(),
+        [&tetrahedra](std::size_t k) { return getTriangleInTetrahedron(tetrahedra[k / 4], k % 4)[0]; },
+        [&tetrahedra](std::size_t k)
+        {
+            const auto tr = getTriangleInTetrahedron(tetrahedra[k / 4], k % 4);
+            return std::make_pair(std::min(tr[1], tr[2]), std::max(tr[1], tr[2]));
+        });
+}
+
+/// Write the shells as compressed arrays of offsets and indices
+template<class Shell>
+void addShells(sofa::helper::io::ArrayCacheWriter& writer, const std::string& name, const sofa::type::vector<Shell>& shells)
+{
+    sofa::type::vector<Index> offsets(shells.size() + 1, 0);
+    for (std::size_t k = 0; k < shells.size(); ++k)
+    {
+        offsets[k + 1] = offsets[k] + Index(shells[k].size());
+    }
+    sofa::type::vector<Index> items;
+    items.reserve(offsets.back());
+    for (const Shell& shell : shells)
+    {
+        items.insert(items.end(), shell.begin(), shell.end());
+    }
+    writer.add(name + ".offsets", offsets);
+    writer.add(name + ".items", items);
+}
+
+/// Read the shells written by addShells
+template<class Shell>
+bool readShells(const sofa::helper::io::ArrayCacheReader& reader, const std::string& name, sofa::type::vector<Shell>& shells)
+{
+    const Index* offsets = nullptr;
+    const Index* items = nullptr;
+    std::size_t nbOffsets = 0;
+    std::size_t nbItems = 0;
+    if (!reader.get(name + ".offsets", offsets, nbOffsets) || !reader.get(name + ".items", items, nbItems)
+        || nbOffsets == 0 || offsets[0] != 0 || offsets[nbOffsets - 1] != nbItems)
+        return false;
+    for (std::size_t k = 0; k + 1 < nbOffsets; ++k)
+    {
+        if (offsets[k] > offsets[k + 1])
+            return false;
+    }
+
+    shells.resize(nbOffsets - 1);
+    forEachIndex(shells.size(), [&](std::size_t k)
+    {
+        shells[k].assign(items + offsets[k], items + offsets[k + 1]);
+    });
+    return true;
+}
+
+} // anonymous namespace
+
 TetrahedronSetTopologyContainer::TetrahedronSetTopologyContainer()
     : TriangleSetTopologyContainer()
 	, d_createTriangleArray(initData(&d_createTriangleArray, bool(false),"createTriangleArray", "Force the creation of a set of triangles associated with each tetrahedron"))
     , d_tetrahedron(initData(&d_tetrahedron, "tetrahedra", "List of tetrahedron indices"))
+    , d_cacheDirectory(initData(&d_cacheDirectory, "cacheDirectory", "If not empty, directory where the neighborhood buffers are cached, to be loaded instead of recomputed when the same mesh is loaded again"))
 {
     addAlias(&d_tetrahedron, "tetras");
 }
@@ -81,6 +290,28 @@ void TetrahedronSetTopologyContainer::init()
 
 void TetrahedronSetTopologyContainer::initTopology()
 {
+    std::string cacheFilename;
+    std::uint64_t cacheKey = 0;
+    if (!d_cacheDirectory.getValue().empty())
+    {
+        const std::string& directory = d_cacheDirectory.getValue();
+        if (!helper::system::FileSystem::exists(directory) && helper::system::FileSystem::createDirectory(directory))
+        {
+            msg_warning() << "Cannot create the cache directory " << directory;
+        }
+
+        cacheKey = computeTopologyCacheKey();
+        std::ostringstream filename;
+        filename << directory << "/TetrahedronSetTopology_" << std::hex << std::setw(16) << std::setfill('0') << cacheKey << ".cache";
+        cacheFilename = filename.str();
+
+        if (loadTopologyCache(cacheFilename, cacheKey))
+        {
+            msg_info() << "Neighborhood buffers loaded from " << cacheFilename;
+            return;
+        }
+    }
+
     TriangleSetTopologyContainer::initTopology();
 
     // Create tetrahedron cross element buffers.
@@ -90,6 +321,101 @@ void TetrahedronSetTopologyContainer::initTopology()
     createTetrahedraAroundTriangleArray();
     createTetrahedraAroundEdgeArray();
     createTetrahedraAroundVertexArray();
+
+    if (!cacheFilename.empty() && !saveTopologyCache(cacheFilename, cacheKey))
+    {
+        msg_warning() << "Cannot write the topology cache " << cacheFilename;
+    }
+}
+
+std::uint64_t TetrahedronSetTopologyContainer::computeTopologyCacheKey() const
+{
+    using helper::io::ArrayCacheFile;
+
+    // the version of the algorithms building the buffers: to be incremented if they change
+    const std::string version = "TetrahedronSetTopologyContainer 1";
+    std::uint64_t key = ArrayCacheFile::hash(version.data(), version.size());
+
+    const std::uint64_t nbPoints = getNbPoints();
+    key = ArrayCacheFile::hash(&nbPoints, sizeof(nbPoints), key);
+    key = ArrayCacheFile::hash(d_tetrahedron.getValue(), key);
+    key = ArrayCacheFile::hash(d_edge.getValue(), key);
+    key = ArrayCacheFile::hash(d_triangle.getValue(), key);
+    return key;
+}
+
+bool TetrahedronSetTopologyContainer::loadTopologyCache(const std::string& filename, std::uint64_t key)
+{
+    helper::io::ArrayCacheReader reader;
+    if (!reader.open(filename, key))
+        return false;
+
+    // everything is read before the container is modified, so that an invalid cache has no effect
+    sofa::type::vector<Size> nbPoints;
+    sofa::type::vector<Edge> edges;
+    sofa::type::vector<Triangle> triangles;
+    sofa::type::vector<EdgesInTriangle> edgesInTriangle;
+    sofa::type::vector<EdgesInTetrahedron> edgesInTetrahedron;
+    sofa::type::vector<TrianglesInTetrahedron> trianglesInTetrahedron;
+    sofa::type::vector<EdgesAroundVertex> edgesAroundVertex;
+    sofa::type::vector<TrianglesAroundVertex> trianglesAroundVertex;
+    sofa::type::vector<TrianglesAroundEdge> trianglesAroundEdge;
+    sofa::type::vector<TetrahedraAroundVertex> tetrahedraAroundVertex;
+    sofa::type::vector<TetrahedraAroundEdge> tetrahedraAroundEdge;
+    sofa::type::vector<TetrahedraAroundTriangle> tetrahedraAroundTriangle;
+
+    const std::size_t nbTetrahedra = d_tetrahedron.getValue().size();
+    if (!reader.read("nbPoints", nbPoints) || nbPoints.size() != 1
+        || !reader.read("edges", edges)
+        || !reader.read("triangles", triangles)
+        || !reader.read("edgesInTriangle", edgesInTriangle)
+        || !reader.read("edgesInTetrahedron", edgesInTetrahedron)
+        || !reader.read("trianglesInTetrahedron", trianglesInTetrahedron)
+        || !readShells(reader, "edgesAroundVertex", edgesAroundVertex)
+        || !readShells(reader, "trianglesAroundVertex", trianglesAroundVertex)
+        || !readShells(reader, "trianglesAroundEdge", trianglesAroundEdge)
+        || !readShells(reader, "tetrahedraAroundVertex", tetrahedraAroundVertex)
+        || !readShells(reader, "tetrahedraAroundEdge", tetrahedraAroundEdge)
+        || !readShells(reader, "tetrahedraAroundTriangle", tetrahedraAroundTriangle)
+        || edgesInTetrahedron.size() != nbTetrahedra
+        || (!trianglesInTetrahedron.empty() && trianglesInTetrahedron.size() != nbTetrahedra))
+    {
+        msg_warning() << "Invalid topology cache " << filename << ", the neighborhood buffers are recomputed";
+        return false;
+    }
+
+    setNbPoints(nbPoints[0]);
+    d_edge.setValue(edges);
+    d_triangle.setValue(triangles);
+    m_edgesInTriangle.swap(edgesInTriangle);
+    m_edgesInTetrahedron.swap(edgesInTetrahedron);
+    m_trianglesInTetrahedron.swap(trianglesInTetrahedron);
+    m_edgesAroundVertex.swap(edgesAroundVertex);
+    m_trianglesAroundVertex.swap(trianglesAroundVertex);
+    m_trianglesAroundEdge.swap(trianglesAroundEdge);
+    m_tetrahedraAroundVertex.swap(tetrahedraAroundVertex);
+    m_tetrahedraAroundEdge.swap(tetrahedraAroundEdge);
+    m_tetrahedraAroundTriangle.swap(tetrahedraAroundTriangle);
+    return true;
+}
+
+bool TetrahedronSetTopologyContainer::saveTopologyCache(const std::string& filename, std::uint64_t key) const
+{
+    helper::io::ArrayCacheWriter writer;
+    const Size nbPoints = getNbPoints();
+    writer.add("nbPoints", &nbPoints, 1);
+    writer.add("edges", d_edge.getValue());
+    writer.add("triangles", d_triangle.getValue());
+    writer.add("edgesInTriangle", m_edgesInTriangle);
+    writer.add("edgesInTetrahedron", m_edgesInTetrahedron);
+    writer.add("trianglesInTetrahedron", m_trianglesInTetrahedron);
+    addShells(writer, "edgesAroundVertex", m_edgesAroundVertex);
+    addShells(writer, "trianglesAroundVertex", m_trianglesAroundVertex);
+    addShells(writer, "trianglesAroundEdge", m_trianglesAroundEdge);
+    addShells(writer, "tetrahedraAroundVertex", m_tetrahedraAroundVertex);
+    addShells(writer, "tetrahedraAroundEdge", m_tetrahedraAroundEdge);
+    addShells(writer, "tetrahedraAroundTriangle", m_tetrahedraAroundTriangle);
+    return writer.write(filename, key);
 }
 
 void TetrahedronSetTopologyContainer::createTetrahedronSetArray()
@@ -113,30 +439,19 @@ void TetrahedronSetTopologyContainer::createEdgeSetArray()
         clearTetrahedraAroundEdge();
     }
 
-    // create a temporary map to find redundant edges
-    std::map<Edge,EdgeID> edgeMap;
     helper::WriteAccessor< Data< sofa::type::vector<Edge> > > m_edge = d_edge;
     helper::ReadAccessor< Data< sofa::type::vector<Tetrahedron> > > m_tetrahedron = d_tetrahedron;
 
-    /// create the m_edge array at the same time than it fills the m_edgesInTetrahedron array
-    for (size_t i = 0; i < m_tetrahedron.size(); ++i)
+    // the edges are numbered in the order of their first occurrence in the tetrahedra
+    const sofa::type::vector<Index> firstOccurrence = findTetrahedronEdgeOccurrences(m_tetrahedron.ref());
+    for (std::size_t k = 0; k < firstOccurrence.size(); ++k)
     {
-        const Tetrahedron &t = m_tetrahedron[i];
-        for (EdgeID j=0; j<6; ++j)
+        if (firstOccurrence[k] == k)
         {
-            const PointID v1 = t[edgesInTetrahedronArray[j][0]];
-            const PointID v2 = t[edgesInTetrahedronArray[j][1]];
-
-            // sort vertices in lexicographic order
-            const Edge e((v1<v2) ? Edge(v1,v2) : Edge(v2,v1));
-
-            if (edgeMap.find(e)==edgeMap.end())
-            {
-                // edge not in edgeMap so create a new one
-                const size_t edgeIndex = edgeMap.size();
-                edgeMap[e] = (EdgeID)edgeIndex;
-                m_edge.push_back(e);
-            }
+            const Tetrahedron& t = m_tetrahedron[k / 6];
+            const PointID v1 = t[edgesInTetrahedronArray[k % 6][0]];
+            const PointID v2 = t[edgesInTetrahedronArray[k % 6][1]];
+            m_edge.push_back((v1 < v2) ? Edge(v1, v2) : Edge(v2, v1));
         }
     }
 }
@@ -155,43 +470,48 @@ void TetrahedronSetTopologyContainer::createEdgesInTetrahedronArray()
     bool foundEdge = true;
 
     helper::ReadAccessor< Data< sofa::type::vector<Tetrahedron> > > m_tetrahedron = d_tetrahedron;
+    const size_t numTetra = getNumberOfTetrahedra();
     if (hasEdges())
     {
-        /// there are already existing edges : must use an inefficient method. Parse all triangles and find the edge that match each triangle edge
-        const size_t numTetra = getNumberOfTetrahedra();
-        const EdgeID numEdges = (EdgeID)getNumberOfEdges();
+        /// there are already existing edges : find the edge matching each tetrahedron edge among the edges of its smallest vertex
         helper::ReadAccessor< Data< sofa::type::vector<Edge> > > m_edge = d_edge;
+        const std::size_t nbVertices = getNbReferencedVertices(m_edge.ref(), getNbReferencedVertices(m_tetrahedron.ref(), 0));
 
-        m_edgesInTetrahedron.resize(numTetra);
-        /// create a multi map where the key is a vertex index and the content is the indices of edges adjacent to that vertex.
-        std::multimap<PointID, EdgeID> edgesAroundVertexMap;
-        std::multimap<PointID, EdgeID>::iterator it;
-
-        for (EdgeID edge=0; edge<numEdges; ++edge)  //Todo: check if not better using multimap <PointID ,TriangleID> and for each edge, push each triangle present in both shell
+        CompressedAdjacency edgesAroundVertex;
+        buildCompressedAdjacency(edgesAroundVertex, nbVertices, m_edge.size(), [&m_edge](std::size_t e)
         {
-            edgesAroundVertexMap.insert(std::pair<PointID, EdgeID> (m_edge[edge][0],edge));
-            edgesAroundVertexMap.insert(std::pair<PointID, EdgeID> (m_edge[edge][1],edge));
-        }
-        for ( size_t i = 0 ; (i < numTetra) && (foundEdge == true) ; ++i )
+            return std::min(m_edge[e][0], m_edge[e][1]);
+        });
+
+        m_edgesInTetrahedron.resize(numTetra);
+        forEachIndex(numTetra, [&](std::size_t i)
         {
             const Tetrahedron &t = m_tetrahedron[i];
-            // adding edge i in the edge shell of both points
-            for ( EdgeID j = 0 ; (j < 6) && (foundEdge == true) ; ++j )
+            for (EdgeID j=0; j<6; ++j)
             {
+                const PointID v1 = t[edgesInTetrahedronArray[j][0]];
+                const PointID v2 = t[edgesInTetrahedronArray[j][1]];
+                const PointID vMin = std::min(v1, v2);
+                const PointID vMax = std::max(v1, v2);
 
-                //finding edge i in edge array
-                std::pair<std::multimap<PointID, EdgeID>::iterator, std::multimap<PointID, EdgeID>::iterator > itPair=edgesAroundVertexMap.equal_range(t[edgesInTetrahedronArray[j][0]]);
-
-                foundEdge=false;
-                for(it=itPair.first; (it!=itPair.second) && (foundEdge==false); ++it)
+                m_edgesInTetrahedron[i][j] = InvalidID;
+                for (Index p = edgesAroundVertex.offsets[vMin]; p < edgesAroundVertex.offsets[vMin + 1]; ++p)
                 {
-                    EdgeID edge = (*it).second;
-                    if ( (m_edge[edge][0] == t[edgesInTetrahedronArray[j][0]] && m_edge[edge][1] == t[edgesInTetrahedronArray[j][1]]) || (m_edge[edge][0] == t[edgesInTetrahedronArray[j][1]] && m_edge[edge][1] == t[edgesInTetrahedronArray[j][0]]))
+                    const EdgeID edge = edgesAroundVertex.items[p];
+                    if (std::max(m_edge[edge][0], m_edge[edge][1]) == vMax)
                     {
                         m_edgesInTetrahedron[i][j] = edge;
-                        foundEdge=true;
+                        break;
                     }
                 }
+            }
+        });
+
+        for (size_t i = 0; (i < numTetra) && (foundEdge == true); ++i)
+        {
+            for (EdgeID j = 0; (j < 6) && (foundEdge == true); ++j)
+            {
+                foundEdge = (m_edgesInTetrahedron[i][j] != InvalidID);
                 msg_warning_when(!foundEdge) << " In getTetrahedronArray, cannot find edge for tetrahedron " << i << "and edge "<< j;
             }
         }
@@ -199,35 +519,29 @@ void TetrahedronSetTopologyContainer::createEdgesInTetrahedronArray()
 
     if(!hasEdges() || foundEdge == false) // To optimize, this method should be called without creating edgesArray before.
     {
-        /// create edge array and triangle edge array at the same time
-        const size_t numTetra = getNumberOfTetrahedra();
+        /// create edge array and tetrahedron edge array at the same time
         m_edgesInTetrahedron.resize (numTetra);
-
-        // create a temporary map to find redundant edges
-        std::map<Edge,EdgeID> edgeMap;
         helper::WriteAccessor< Data< sofa::type::vector<Edge> > > m_edge = d_edge;
 
-        /// create the m_edge array at the same time than it fills the m_edgesInTetrahedron array
-        for (size_t i = 0; i < m_tetrahedron.size(); ++i)
+        // the edges are numbered in the order of their first occurrence in the tetrahedra
+        sofa::type::vector<Index> edgeIndex = findTetrahedronEdgeOccurrences(m_tetrahedron.ref());
+        EdgeID nbEdges = 0;
+        for (std::size_t k = 0; k < edgeIndex.size(); ++k)
         {
-            const Tetrahedron &t = m_tetrahedron[i];
-            for (EdgeID j=0; j<6; ++j)
+            if (edgeIndex[k] == k)
             {
-                const PointID v1 = t[edgesInTetrahedronArray[j][0]];
-                const PointID v2 = t[edgesInTetrahedronArray[j][1]];
-
-                // sort vertices in lexicographic order
-                const Edge e((v1<v2) ? Edge(v1,v2) : Edge(v2,v1));
-
-                if (edgeMap.find(e)==edgeMap.end())
-                {
-                    // edge not in edgeMap so create a new one
-                    const size_t edgeIndex = edgeMap.size();
-                    edgeMap[e] = (EdgeID)edgeIndex;
-                    m_edge.push_back(e);
-                }
-                m_edgesInTetrahedron[i][j] = edgeMap[e];
+                const Tetrahedron& t = m_tetrahedron[k / 6];
+                const PointID v1 = t[edgesInTetrahedronArray[k % 6][0]];
+                const PointID v2 = t[edgesInTetrahedronArray[k % 6][1]];
+                m_edge.push_back((v1 < v2) ? Edge(v1, v2) : Edge(v2, v1));
+                edgeIndex[k] = nbEdges++;
             }
+            else
+            {
+                // the first occurrence has already been replaced by its edge index
+                edgeIndex[k] = edgeIndex[edgeIndex[k]];
+            }
+            m_edgesInTetrahedron[k / 6][k % 6] = edgeIndex[k];
         }
     }
 
@@ -246,48 +560,22 @@ void TetrahedronSetTopologyContainer::createTriangleSetArray()
         clearTetrahedraAroundTriangle();
     }
 
-    // create a temporary map to find redundant triangles
-    std::map<Triangle,TriangleID> triangleMap;
     helper::WriteAccessor< Data< sofa::type::vector<Triangle> > > m_triangle = d_triangle;
     helper::ReadAccessor< Data< sofa::type::vector<Tetrahedron> > > m_tetrahedron = d_tetrahedron;
 
-    /// create the m_edge array at the same time than it fills the m_edgesInTetrahedron array
-    for (size_t i=0; i<m_tetrahedron.size(); ++i)
+    // the triangles are numbered in the order of their first occurrence in the tetrahedra, with its orientation
+    const sofa::type::vector<Index> firstOccurrence = findTetrahedronTriangleOccurrences(m_tetrahedron.ref());
+    for (std::size_t k = 0; k < firstOccurrence.size(); ++k)
     {
-        const Tetrahedron &t = m_tetrahedron[i];
-
-        for (TriangleID j=0; j<4; ++j)
+        const Triangle tr = getTriangleInTetrahedron(m_tetrahedron[k / 4], k % 4);
+        if (firstOccurrence[k] == k)
         {
-            PointID v[3];
-            for (PointID k=0; k<3; ++k)
-                v[k] = t[sofa::core::topology::trianglesOrientationInTetrahedronArray[j][k]];
-
-            // sort v such that v[0] is the smallest one
-            while ((v[0]>v[1]) || (v[0]>v[2]))
-            {
-                PointID val=v[0];
-                v[0]=v[1];
-                v[1]=v[2];
-                v[2]=val;
-            }
-
-            // check if a triangle with an opposite orientation already exists
-            Triangle tr = Triangle(v[0], v[2], v[1]);
-
-            if (triangleMap.find(tr) == triangleMap.end())
-            {
-                // triangle not in triangleMap so create a new one
-                tr = Triangle(v[0], v[1], v[2]);
-                if (triangleMap.find(tr) == triangleMap.end())
-                {
-                    triangleMap[tr] = (TriangleID)m_triangle.size();
-                    m_triangle.push_back(tr);
-                }
-                else
-                {
-					msg_error() << "Duplicate triangle " << tr << " in tetra " << i <<" : " << t;
-                }
-            }
+            m_triangle.push_back(tr);
+        }
+        else if (getTriangleInTetrahedron(m_tetrahedron[firstOccurrence[k] / 4], firstOccurrence[k] % 4)[1] == tr[1])
+        {
+            // a triangle shared by two tetrahedra must have opposite orientations
+            msg_error() << "Duplicate triangle " << tr << " in tetra " << k / 4 <<" : " << m_tetrahedron[k / 4];
         }
     }
 }
@@ -303,29 +591,54 @@ void TetrahedronSetTopologyContainer::createTrianglesInTetrahedronArray()
     if(hasTrianglesInTetrahedron()) // created by upper topology
         return;
 
-    m_trianglesInTetrahedron.resize( getNumberOfTetrahedra());
     helper::ReadAccessor< Data< sofa::type::vector<Tetrahedron> > > m_tetrahedron = d_tetrahedron;
-    for(size_t i = 0; i < m_tetrahedron.size(); ++i)
+    helper::ReadAccessor< Data< sofa::type::vector<Triangle> > > m_triangle = d_triangle;
+    const std::size_t nbVertices = getNbReferencedVertices(m_triangle.ref(), getNbReferencedVertices(m_tetrahedron.ref(), 0));
+
+    // find each triangle of the tetrahedra among the triangles of its smallest vertex
+    CompressedAdjacency trianglesAroundVertex;
+    buildCompressedAdjacency(trianglesAroundVertex, nbVertices, m_triangle.size(), [&m_triangle](std::size_t tr)
+    {
+        return std::min({ m_triangle[tr][0], m_triangle[tr][1], m_triangle[tr][2] });
+    });
+
+    m_trianglesInTetrahedron.resize( getNumberOfTetrahedra());
+    forEachIndex(m_tetrahedron.size(), [&](std::size_t i)
     {
         const Tetrahedron &t=m_tetrahedron[i];
 
         // adding triangles in the triangle list of the ith tetrahedron  i
         for (TriangleID j=0; j<4; ++j)
         {
-            TriangleID triangleIndex = getTriangleIndex(t[(j+1)%4], t[(j+2)%4], t[(j+3)%4]);
-            if (triangleIndex != InvalidID){
-                   m_trianglesInTetrahedron[i][j] = triangleIndex;
+            const auto v = getSortedVertices(t[(j+1)%4], t[(j+2)%4], t[(j+3)%4]);
+            m_trianglesInTetrahedron[i][j] = InvalidID;
+            for (Index p = trianglesAroundVertex.offsets[v[0]]; p < trianglesAroundVertex.offsets[v[0] + 1]; ++p)
+            {
+                const TriangleID triangleIndex = trianglesAroundVertex.items[p];
+                const Triangle& tr = m_triangle[triangleIndex];
+                if (getSortedVertices(tr[0], tr[1], tr[2]) == v)
+                {
+                    m_trianglesInTetrahedron[i][j] = triangleIndex;
+                    break;
+                }
             }
-            else
+        }
+    });
+
+    for (size_t i = 0; i < m_tetrahedron.size(); ++i)
+    {
+        const Tetrahedron &t=m_tetrahedron[i];
+        for (TriangleID j=0; j<4; ++j)
+        {
+            if (m_trianglesInTetrahedron[i][j] == InvalidID)
             {
                 msg_error() << "Cannot find triangle " << j
-                    << " [" << t[(j + 1) % 4] << ", " << t[(j + 2) % 4] << ", " << t[(j + 3) % 4] << "]"                     
+                    << " [" << t[(j + 1) % 4] << ", " << t[(j + 2) % 4] << ", " << t[(j + 3) % 4] << "]"
                     << " in tetrahedron " << i;
 
                 m_trianglesInTetrahedron.clear();
                 return;
             }
-
         }
     }
 }
@@ -338,17 +651,13 @@ void TetrahedronSetTopologyContainer::createTetrahedraAroundVertexArray()
     if (getNbPoints() == 0) // in case only Data have been copied and not going thourgh AddTriangle methods.
         this->setNbPoints(sofa::Size(d_initPoints.getValue().size()));
 
-    m_tetrahedraAroundVertex.resize( getNbPoints() );
     helper::ReadAccessor< Data< sofa::type::vector<Tetrahedron> > > m_tetrahedron = d_tetrahedron;
 
-    for (size_t i = 0; i < getNumberOfTetrahedra(); ++i)
-    {
-        // adding edge i in the edge shell of both points
-        for (PointID j=0; j<4; ++j)
-        {
-            m_tetrahedraAroundVertex[ m_tetrahedron[i][j]  ].push_back( (TetrahedronID)i );
-        }
-    }
+    // the vertex j of the tetrahedron i is the item 4*i+j
+    CompressedAdjacency adjacency;
+    buildCompressedAdjacency(adjacency, getNbReferencedVertices(m_tetrahedron.ref(), getNbPoints()), 4 * m_tetrahedron.size(),
+        [&m_tetrahedron](std::size_t k) { return m_tetrahedron[k / 4][k % 4]; });
+    fillShells(m_tetrahedraAroundVertex, adjacency, 4);
 }
 
 void TetrahedronSetTopologyContainer::createTetrahedraAroundEdgeArray ()
@@ -359,15 +668,10 @@ void TetrahedronSetTopologyContainer::createTetrahedraAroundEdgeArray ()
     if(!hasEdgesInTetrahedron())
         createEdgesInTetrahedronArray();
 
-    m_tetrahedraAroundEdge.resize(getNumberOfEdges());
-    for (size_t i=0; i< getNumberOfTetrahedra(); ++i)
-    {
-        // adding edge i in the edge shell of both points
-        for (EdgeID j=0; j<6; ++j)
-        {
-            m_tetrahedraAroundEdge[ m_edgesInTetrahedron[i][j] ].push_back( (TetrahedronID)i );
-        }
-    }
+    CompressedAdjacency adjacency;
+    buildCompressedAdjacency(adjacency, getNumberOfEdges(), 6 * m_edgesInTetrahedron.size(),
+        [this](std::size_t k) { return m_edgesInTetrahedron[k / 6][k % 6]; });
+    fillShells(m_tetrahedraAroundEdge, adjacency, 6);
 }
 
 void TetrahedronSetTopologyContainer::createTetrahedraAroundTriangleArray ()
@@ -408,16 +712,10 @@ void TetrahedronSetTopologyContainer::createTetrahedraAroundTriangleArray ()
         return;
     }
 
-    m_tetrahedraAroundTriangle.resize(numTriangles);
-
-    for (size_t i=0; i<numTetra; ++i)
-    {
-        // adding tetrahedron i in the shell of all neighbors triangles
-        for (TriangleID j=0; j<4; ++j)
-        {
-            m_tetrahedraAroundTriangle[ m_trianglesInTetrahedron[i][j] ].push_back( (TetrahedronID)i );
-        }
-    }
+    CompressedAdjacency adjacency;
+    buildCompressedAdjacency(adjacency, numTriangles, 4 * numTetra,
+        [this](std::size_t k) { return m_trianglesInTetrahedron[k / 4][k % 4]; });
+    fillShells(m_tetrahedraAroundTriangle, adjacency, 4);
 }
 
 const sofa::type::vector<TetrahedronSetTopologyContainer::Tetrahedron> &TetrahedronSetTopologyContainer::getTetrahedronArray()
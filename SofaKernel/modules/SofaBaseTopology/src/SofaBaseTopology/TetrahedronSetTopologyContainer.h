@@ -369,6 +369,15 @@ protected:
 
     void clearTetrahedraAroundTriangle();
 
+    /// Key of the topology cache: a hash of the tetrahedra and of the edges and triangles given as input
+    std::uint64_t computeTopologyCacheKey() const;
+
+    /// Fill all the neighborhood buffers from the cache file computed for the given key, return false if it is missing or invalid
+    bool loadTopologyCache(const std::string& filename, std::uint64_t key);
+
+    /// Write all the neighborhood buffers in a cache file
+    bool saveTopologyCache(const std::string& filename, std::uint64_t key) const;
+
 
 protected:
 
@@ -412,6 +421,9 @@ public:
 
     /// provides the set of tetrahedra.
     Data< sofa::type::vector<Tetrahedron> > d_tetrahedron;
+
+    /// directory where the neighborhood buffers are cached, to be loaded instead of recomputed for the same mesh
+    Data< std::string > d_cacheDirectory;
 protected:
     /// provides the set of edges for each tetrahedron.
     sofa::type::vector<EdgesInTetrahedron> m_edgesInTetrahedron;
@@ -0,0 +1,150 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+
+/**
+ * Micro-benchmark of the dirtiness propagation of DDGNode, on a chain of DataEngines and on
+ * engines sharing the same input, such as the ROI engines reading the positions of a loader.
+ *
+ * For each graph, it measures the time of:
+ *  - a getValue() on an output which is up to date,
+ *  - a change of the source followed by a getValue() on the outputs,
+ *  - a change of the source which is not read.
+ *
+ * Usage: SofaCore_bench [chainDepth] [nbSharingEngines] [repetitions]
+ */
+
+#include <sofa/core/DataEngine.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using sofa::core::objectmodel::Data;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+
+class AddOneEngine : public sofa::core::DataEngine
+{
+public:
+    SOFA_CLASS(AddOneEngine, sofa::core::DataEngine);
+
+    Data<double> d_input;
+    Data<double> d_output;
+
+    AddOneEngine()
+        : d_input(initData(&d_input, 0.0, "input", "input"))
+        , d_output(initData(&d_output, 0.0, "output", "input + 1"))
+    {
+        addInput(&d_input);
+        addOutput(&d_output);
+    }
+
+    void doUpdate() override
+    {
+        d_output.setValue(d_input.getValue() + 1.0);
+    }
+};
+
+/// best time of the repetitions, in nanoseconds per iteration
+template<class Function>
+double timeIt(int repetitions, int iterations, Function f)
+{
+    f(); // warm-up
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        const auto start = Clock::now();
+        for (int i = 0; i < iterations; ++i)
+            f();
+        best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations);
+    }
+    return best;
+}
+
+void print(const std::string& graph, double cleanRead, double changeAndRead, double change)
+{
+    std::cout << std::left << std::setw(28) << graph << std::right << std::fixed << std::setprecision(1)
+              << std::setw(18) << cleanRead << std::setw(18) << changeAndRead << std::setw(18) << change << "\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    const int depth = (argc > 1) ? std::atoi(argv[1]) : 100;
+    const int width = (argc > 2) ? std::atoi(argv[2]) : 20;
+    const int repetitions = (argc > 3) ? std::atoi(argv[3]) : 10;
+
+    std::cout << std::left << std::setw(28) << "graph" << std::right
+              << std::setw(18) << "clean read" << std::setw(18) << "change + read" << std::setw(18) << "change" << "   (ns)\n";
+
+    // each engine reads the output of the previous one
+    {
+        Data<double> source(0.0, "source");
+        std::vector<std::unique_ptr<AddOneEngine> > chain;
+        for (int i = 0; i < depth; ++i)
+        {
+            chain.push_back(std::make_unique<AddOneEngine>());
+            chain.back()->d_input.setParent(i == 0 ? &source : &chain[i - 1]->d_output);
+        }
+        const Data<double>& end = chain.back()->d_output;
+        double value = 0.0;
+
+        const double cleanRead = timeIt(repetitions, 10000, [&] { value += end.getValue(); });
+        const double changeAndRead = timeIt(repetitions, 100, [&] { source.setValue(value); value += end.getValue(); });
+        const double change = timeIt(repetitions, 10000, [&] { source.setValue(value); value += 1.0; });
+        print("chain of " + std::to_string(depth), cleanRead, changeAndRead, change);
+        if (value < 0) std::cout << value << "\n";
+    }
+
+    // all the engines read the same source
+    {
+        Data<double> source(0.0, "source");
+        std::vector<std::unique_ptr<AddOneEngine> > engines;
+        for (int i = 0; i < width; ++i)
+        {
+            engines.push_back(std::make_unique<AddOneEngine>());
+            engines.back()->d_input.setParent(&source);
+        }
+        double value = 0.0;
+        const auto readAll = [&]
+        {
+            for (const auto& engine : engines)
+                value += engine->d_output.getValue();
+        };
+
+        const double cleanRead = timeIt(repetitions, 10000, readAll);
+        const double changeAndRead = timeIt(repetitions, 1000, [&] { source.setValue(value); readAll(); });
+        const double change = timeIt(repetitions, 10000, [&] { source.setValue(value); value += 1.0; });
+        print(std::to_string(width) + " engines sharing a source", cleanRead, changeAndRead, change);
+        if (value < 0) std::cout << value << "\n";
+    }
+
+    return 0;
+}
@@ -26,6 +26,9 @@ using sofa::testing::BaseTest ;
 #include <sofa/core/objectmodel/DDGNode.h>
 using sofa::core::objectmodel::DDGNode;
 
+#include <atomic>
+#include <thread>
+
 class DDGNodeTestClass : public DDGNode
 {
 public:
@@ -183,3 +186,118 @@ TEST_F(DDGNode_test, propagationScenario3)
     EXPECT_EQ(m_ddgnode1.m_cpt, 1);
     EXPECT_EQ(m_ddgnode2.m_cpt, 1);
 }
+
+class DDGNodeCountingTestClass : public DDGNode
+{
+public:
+    int m_cptSetDirtyValue {0};
+
+    void update() override
+    {
+        for (DDGNode* input : getInputs())
+            input->updateIfDirty();
+        cleanDirty();
+    }
+    void setDirtyValue() override
+    {
+        m_cptSetDirtyValue++;
+        DDGNode::setDirtyValue();
+    }
+};
+
+TEST_F(DDGNode_test, batchedPropagation)
+{
+    DDGNodeCountingTestClass source, middle, sink;
+    middle.addInput(&source);
+    sink.addInput(&middle);
+    sink.updateIfDirty();
+    EXPECT_FALSE(middle.isDirty());
+    EXPECT_FALSE(sink.isDirty());
+    middle.m_cptSetDirtyValue = 0;
+    sink.m_cptSetDirtyValue = 0;
+    const auto sourceGeneration = source.getGeneration();
+    const auto middleGeneration = middle.getGeneration();
+    const auto sinkGeneration = sink.getGeneration();
+
+    // the outputs are walked by the first change only, until they are read
+    source.setDirtyOutputs();
+    source.setDirtyOutputs();
+    EXPECT_EQ(middle.m_cptSetDirtyValue, 1);
+    EXPECT_EQ(sink.m_cptSetDirtyValue, 1);
+    EXPECT_TRUE(middle.isDirty());
+    EXPECT_TRUE(sink.isDirty());
+    EXPECT_EQ(source.getGeneration(), sourceGeneration + 2);
+    EXPECT_EQ(middle.getGeneration(), middleGeneration + 1);
+    EXPECT_EQ(sink.getGeneration(), sinkGeneration + 1);
+
+    sink.updateIfDirty();
+    EXPECT_FALSE(middle.isDirty());
+    EXPECT_FALSE(sink.isDirty());
+
+    source.setDirtyOutputs();
+    EXPECT_EQ(middle.m_cptSetDirtyValue, 2);
+    EXPECT_EQ(sink.m_cptSetDirtyValue, 2);
+    EXPECT_TRUE(sink.isDirty());
+    EXPECT_EQ(sink.getGeneration(), sinkGeneration + 2);
+
+    // an explicitly dirty input makes its outputs dirty
+    sink.updateIfDirty();
+    middle.setDirtyValue();
+    EXPECT_TRUE(sink.isDirty());
+    sink.updateIfDirty();
+    EXPECT_FALSE(sink.isDirty());
+}
+
+TEST_F(DDGNode_test, cycle)
+{
+    DDGNodeCountingTestClass source, first, second;
+    first.addInput(&source);
+    first.addInput(&second);
+    second.addInput(&first);
+    first.cleanDirty();
+    second.cleanDirty();
+    EXPECT_FALSE(first.isDirty());
+    EXPECT_FALSE(second.isDirty());
+
+    // the propagation stops on the cycle, and the change reaches both nodes
+    source.setDirtyOutputs();
+    EXPECT_TRUE(second.isDirty());
+    EXPECT_TRUE(first.isDirty());
+}
+
+TEST_F(DDGNode_test, concurrentReads)
+{
+    constexpr std::size_t nbNodes = 16;
+    DDGNodeCountingTestClass source;
+    std::vector<DDGNodeCountingTestClass> chain(nbNodes);
+    chain[0].addInput(&source);
+    for (std::size_t i = 1; i < nbNodes; ++i)
+        chain[i].addInput(&chain[i-1]);
+
+    // the nodes of the chain are read concurrently, from its end and from its beginning:
+    // a node must never be seen clean while the dirtiness of another one is evaluated
+    std::atomic<int> nbCleanReads {0};
+    for (int round = 0; round < 200; ++round)
+    {
+        for (DDGNodeCountingTestClass& node : chain)
+            node.cleanDirty();
+        source.setDirtyOutputs();
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&chain, &nbCleanReads, t]()
+            {
+                for (std::size_t i = 0; i < nbNodes; ++i)
+                {
+                    const std::size_t n = (t % 2) ? i : nbNodes - 1 - i;
+                    if (!chain[n].isDirty())
+                        ++nbCleanReads;
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+    EXPECT_EQ(0, nbCleanReads.load());
+}
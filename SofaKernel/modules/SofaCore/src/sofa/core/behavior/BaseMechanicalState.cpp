@@ -84,6 +84,15 @@ void BaseMechanicalState::vMultiOp(const ExecParams* params, const VMultiOp& ops
     }
 }
 
+void BaseMechanicalState::vMultiOpDot(const ExecParams* params, const VMultiOp& ops, const VMultiDot& dots, SReal* results)
+{
+    vMultiOp(params, ops);
+    for (size_t i = 0; i < dots.size(); ++i)
+    {
+        results[i] = vDot(params, dots[i].first.getId(this), dots[i].second.getId(this));
+    }
+}
+
 /// Handle state Changes from a given Topology
 void BaseMechanicalState::handleStateChange(core::topology::Topology* /*t*/)
 {
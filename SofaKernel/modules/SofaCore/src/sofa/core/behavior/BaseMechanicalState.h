@@ -165,6 +165,16 @@ public:
     /// By default this method decompose the computation into multiple vOp calls.
     virtual void vMultiOp(const ExecParams* params, const VMultiOp& ops);
 
+    /// Pairs of vectors whose scalar products are computed by vMultiOpDot
+    typedef type::vector< std::pair< ConstMultiVecId, ConstMultiVecId > > VMultiDot;
+
+    /// \brief Perform a sequence of linear vector accumulation operations (see vMultiOp), then compute the scalar products
+    /// of the given pairs of vectors, stored in results.
+    ///
+    /// This is used to update the vectors of an iterative solver and compute the norm of its residual in one step.
+    /// By default this method calls vMultiOp then vDot, but the operations can be fused into a single pass over the vectors.
+    virtual void vMultiOpDot(const ExecParams* params, const VMultiOp& ops, const VMultiDot& dots, SReal* results);
+
     /// Compute the scalar products between two vectors.
     virtual SReal vDot(const ExecParams* params, ConstVecId a, ConstVecId b) = 0;
 
@@ -56,6 +56,9 @@ void DDGNode::setDirtyValue()
 
 void DDGNode::setDirtyOutputs()
 {
+    ++m_generation;
+
+    // the outputs are only walked on the first change since they were read
     bool& dirtyOutputs = dirtyFlags.dirtyOutputs;
     if (!dirtyOutputs)
     {
@@ -85,8 +88,13 @@ void DDGNode::notifyEndEdit()
 
 void DDGNode::cleanDirtyOutputsOfInputs()
 {
+    // the flag is only written if it is set, so that the engines sharing an input which was already
+    // cleaned can be updated concurrently (see DataEngineScheduler)
     for(auto it : inputs)
-        it->dirtyFlags.dirtyOutputs = false;
+    {
+        if (it->dirtyFlags.dirtyOutputs)
+            it->dirtyFlags.dirtyOutputs = false;
+    }
 }
 
 void DDGNode::addInput(DDGNode* n)
@@ -23,6 +23,7 @@
 
 #include <sofa/core/config.h>
 #include <sofa/core/fwd.h>
+#include <cstdint>
 #include <vector>
 
 namespace sofa::core::objectmodel
@@ -35,6 +36,12 @@ class DDGNode;
  * The data dependency graph is used to update the data when
  * some of other changes and it is at the root of the implementation
  * of the data update mecanisme as well as DataEngines.
+ *
+ * A change of a node sets its outputs dirty, recursively. The propagation stops on the nodes which are
+ * already dirty, and on the nodes whose outputs were already notified since they were last read, so that
+ * the changes of a node between two reads only walk its outputs once. isDirty() only reads a flag.
+ * Each node also counts its changes in a generation counter, incremented along the outputs when they are
+ * set dirty, so that a reader can tell whether a node changed since it last read it.
  */
 class SOFA_CORE_API DDGNode
 {
@@ -74,6 +81,10 @@ public:
     bool isDirty(const core::ExecParams*) const = delete;
     bool isDirty() const { return dirtyFlags.dirtyValue; }
 
+    /// Number of changes of this node, incremented when its value changes (see setDirtyOutputs), or when
+    /// it is set dirty by one of its inputs
+    std::uint64_t getGeneration() const { return m_generation; }
+
     /// Indicate the value needs to be updated
     SOFA_ATTRIBUTE_DISABLED__ASPECT_EXECPARAMS()
     virtual void setDirtyValue(const core::ExecParams*) final = delete;
@@ -99,6 +110,11 @@ public:
     void updateIfDirty(const core::ExecParams*) const = delete;
     void updateIfDirty() const;
 
+    /// the dirtyOutputs flags of all the inputs will be set to false
+    SOFA_ATTRIBUTE_DISABLED__ASPECT_EXECPARAMS()
+    void cleanDirtyOutputsOfInputs(const core::ExecParams*) = delete;
+    void cleanDirtyOutputsOfInputs();
+
 protected:
     DDGLinkContainer inputs;
     DDGLinkContainer outputs;
@@ -108,19 +124,16 @@ protected:
     virtual void doAddOutput(DDGNode* n);
     virtual void doDelOutput(DDGNode* n);
 
-    /// the dirtyOutputs flags of all the inputs will be set to false
-    SOFA_ATTRIBUTE_DISABLED__ASPECT_EXECPARAMS()
-    void cleanDirtyOutputsOfInputs(const core::ExecParams*) = delete;
-    void cleanDirtyOutputsOfInputs();
-
 private:
 
     struct DirtyFlags
     {
-        bool dirtyValue {false};
-        bool dirtyOutputs {false};
+        bool dirtyValue {false};    ///< the value needs to be updated
+        bool dirtyOutputs {false};  ///< the outputs were notified of a change, and not read since
     };
     DirtyFlags dirtyFlags;
+
+    std::uint64_t m_generation {0}; ///< see getGeneration
 };
 
 } // namespace sofa::core::objectmodel
@@ -0,0 +1,113 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/testing/BaseTest.h>
+using sofa::testing::BaseTest;
+
+#include <sofa/helper/io/ArrayCacheFile.h>
+using sofa::helper::io::ArrayCacheFile;
+using sofa::helper::io::ArrayCacheReader;
+using sofa::helper::io::ArrayCacheWriter;
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+
+class ArrayCacheFile_test : public BaseTest
+{
+protected:
+    std::string m_filename;
+
+    void onSetUp() override
+    {
+        m_filename = (std::filesystem::temp_directory_path() / "ArrayCacheFile_test.cache").string();
+    }
+
+    void onTearDown() override
+    {
+        std::filesystem::remove(m_filename);
+    }
+};
+
+TEST_F(ArrayCacheFile_test, readWrittenArrays)
+{
+    const std::vector<std::array<unsigned int, 2> > edges { {0, 1}, {1, 2}, {2, 0} };
+    const std::vector<double> weights { 0.25, 0.5, 0.25, 1.0, 0.0 };
+    const std::vector<int> empty;
+    const std::uint64_t key = ArrayCacheFile::hash(weights, ArrayCacheFile::hash(edges, 0));
+
+    ArrayCacheWriter writer;
+    writer.add("edges", edges);
+    writer.add("weights", weights);
+    writer.add("empty", empty);
+    ASSERT_TRUE(writer.write(m_filename, key));
+
+    ArrayCacheReader reader;
+    ASSERT_TRUE(reader.open(m_filename, key));
+
+    std::vector<std::array<unsigned int, 2> > readEdges;
+    ASSERT_TRUE(reader.read("edges", readEdges));
+    EXPECT_EQ(readEdges, edges);
+
+    const double* readWeights = nullptr;
+    std::size_t count = 0;
+    ASSERT_TRUE(reader.get("weights", readWeights, count));
+    ASSERT_EQ(count, weights.size());
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(readWeights) % alignof(double), 0u);
+    EXPECT_EQ(std::vector<double>(readWeights, readWeights + count), weights);
+
+    std::vector<int> readEmpty { 1 };
+    ASSERT_TRUE(reader.read("empty", readEmpty));
+    EXPECT_TRUE(readEmpty.empty());
+
+    // missing array, or array read with another element type
+    std::vector<int> missing;
+    EXPECT_FALSE(reader.read("missing", missing));
+    std::vector<float> wrongType;
+    EXPECT_FALSE(reader.read("weights", wrongType));
+}
+
+TEST_F(ArrayCacheFile_test, rejectOtherKeysAndInvalidFiles)
+{
+    const std::vector<int> values { 1, 2, 3 };
+    const std::uint64_t key = ArrayCacheFile::hash(values, 0);
+    EXPECT_NE(key, ArrayCacheFile::hash(std::vector<int>{ 1, 2, 4 }, 0));
+
+    ArrayCacheWriter writer;
+    writer.add("values", values);
+    ASSERT_TRUE(writer.write(m_filename, key));
+
+    ArrayCacheReader reader;
+    EXPECT_FALSE(reader.open(m_filename, key + 1));
+    EXPECT_FALSE(reader.isOpen());
+    EXPECT_FALSE(reader.open(m_filename + ".missing", key));
+
+    {
+        std::ofstream file(m_filename, std::ios::binary | std::ios::trunc);
+        file << "not a cache";
+    }
+    EXPECT_FALSE(reader.open(m_filename, key));
+}
+
+} // namespace
@@ -0,0 +1,148 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/testing/BaseTest.h>
+using sofa::testing::BaseTest;
+
+#include <sofa/helper/io/AsciiParser.h>
+namespace ascii = sofa::helper::io::ascii;
+
+#include <clocale>
+#include <cmath>
+#include <string>
+
+namespace
+{
+
+class AsciiParser_test : public BaseTest
+{
+};
+
+TEST_F(AsciiParser_test, readNumbers)
+{
+    const std::string text = "  1.5 -2e3\t+0.25\r\n  7 nan abc";
+    const char* cursor = text.data();
+    const char* end = text.data() + text.size();
+
+    double values[4];
+    EXPECT_EQ(ascii::readNumbers(cursor, end, values, 4), 4u);
+    EXPECT_EQ(values[0], 1.5);
+    EXPECT_EQ(values[1], -2000.0);
+    EXPECT_EQ(values[2], 0.25);
+    EXPECT_EQ(values[3], 7.0);
+
+    double value;
+    EXPECT_TRUE(ascii::readNumber(cursor, end, value));
+    EXPECT_TRUE(std::isnan(value));
+    // the cursor is left on the first token which is not a number
+    EXPECT_FALSE(ascii::readNumber(cursor, end, value));
+    EXPECT_EQ(ascii::readToken(cursor, end), "abc");
+    EXPECT_EQ(cursor, end);
+}
+
+TEST_F(AsciiParser_test, readIntegersStopsAtSeparators)
+{
+    const std::string text = "12/-3//4";
+    const char* cursor = text.data();
+    const char* end = text.data() + text.size();
+
+    int value = 0;
+    EXPECT_TRUE(ascii::readNumber(cursor, end, value));
+    EXPECT_EQ(value, 12);
+    EXPECT_EQ(*cursor, '/');
+    ++cursor;
+    EXPECT_TRUE(ascii::readNumber(cursor, end, value));
+    EXPECT_EQ(value, -3);
+    ++cursor;
+    EXPECT_FALSE(ascii::readNumber(cursor, end, value));
+}
+
+TEST_F(AsciiParser_test, numbersDoNotDependOnTheLocale)
+{
+    const std::string previousLocale = std::setlocale(LC_NUMERIC, nullptr);
+    if (std::setlocale(LC_NUMERIC, "fr_FR.UTF-8") == nullptr)
+    {
+        std::setlocale(LC_NUMERIC, "de_DE.UTF-8");
+    }
+
+    const std::string text = "3.25";
+    const char* cursor = text.data();
+    float value = 0.f;
+    EXPECT_TRUE(ascii::readNumber(cursor, text.data() + text.size(), value));
+    EXPECT_EQ(value, 3.25f);
+
+    std::setlocale(LC_NUMERIC, previousLocale.c_str());
+}
+
+TEST_F(AsciiParser_test, readLines)
+{
+    const std::string text = "first line\r\n\nlast";
+    const char* cursor = text.data();
+    const char* end = text.data() + text.size();
+
+    EXPECT_EQ(ascii::readLine(cursor, end), "first line");
+    EXPECT_EQ(ascii::readLine(cursor, end), "");
+    EXPECT_EQ(ascii::readLine(cursor, end), "last");
+    EXPECT_EQ(cursor, end);
+}
+
+TEST_F(AsciiParser_test, splitLinesAtLineStarts)
+{
+    std::string text;
+    for (int i = 0; i < 1000; ++i)
+    {
+        text += "v " + std::to_string(i) + " " + std::to_string(i * 0.5) + "\n";
+    }
+    const char* begin = text.data();
+    const char* end = text.data() + text.size();
+
+    const auto boundaries = ascii::splitLines(begin, end, 100);
+    ASSERT_GT(boundaries.size(), 2u);
+    EXPECT_EQ(boundaries.front(), begin);
+    EXPECT_EQ(boundaries.back(), end);
+
+    std::size_t nbTokens = 0;
+    for (std::size_t c = 0; c + 1 < boundaries.size(); ++c)
+    {
+        EXPECT_LT(boundaries[c], boundaries[c + 1]);
+        EXPECT_EQ(*boundaries[c], 'v');
+        nbTokens += ascii::countTokens(boundaries[c], boundaries[c + 1]);
+    }
+    EXPECT_EQ(nbTokens, 3000u);
+
+    // a chunk larger than the buffer gives a single chunk, an empty buffer none
+    EXPECT_EQ(ascii::splitLines(begin, end, text.size()).size(), 2u);
+    EXPECT_EQ(ascii::splitLines(begin, begin).size(), 1u);
+}
+
+TEST_F(AsciiParser_test, findEndOfNumbers)
+{
+    const std::string text = "1 2 3\n\n  -4.5 inf\n+6\nCELL_TYPES 2\n1 1\n";
+    const char* begin = text.data();
+    const char* end = text.data() + text.size();
+
+    const char* blockEnd = ascii::findEndOfNumbers(begin, end);
+    EXPECT_EQ(std::string(blockEnd, 10), "CELL_TYPES");
+    EXPECT_EQ(ascii::countTokens(begin, blockEnd), 6u);
+    EXPECT_EQ(ascii::findEndOfNumbers(blockEnd + 10, end), end);
+}
+
+} // namespace
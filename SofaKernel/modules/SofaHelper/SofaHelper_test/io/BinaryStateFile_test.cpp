@@ -0,0 +1,216 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/testing/BaseTest.h>
+using sofa::testing::BaseTest;
+
+#include <sofa/helper/io/BinaryStateFile.h>
+using sofa::helper::io::BinaryStateFile;
+using sofa::helper::io::BinaryStateFrame;
+using sofa::helper::io::BinaryStateReader;
+using sofa::helper::io::BinaryStateWriter;
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <random>
+
+namespace
+{
+
+class BinaryStateFile_test : public BaseTest
+{
+protected:
+    std::string m_filename;
+
+    void onSetUp() override
+    {
+        m_filename = (std::filesystem::temp_directory_path() / "BinaryStateFile_test.bin").string();
+    }
+
+    void onTearDown() override
+    {
+        std::filesystem::remove(m_filename);
+    }
+
+    /// Positions of a wave travelling along a line of nodes
+    static BinaryStateFrame makeFrame(double time, std::size_t nbNodes)
+    {
+        BinaryStateFrame frame;
+        frame.time = time;
+        frame.vectors.resize(2);
+        frame.vectors[0].name = "X";
+        frame.vectors[0].stride = 3;
+        frame.vectors[1].name = "V";
+        frame.vectors[1].stride = 3;
+        for (std::size_t i = 0; i < nbNodes; ++i)
+        {
+            const double s = 0.01 * double(i);
+            frame.vectors[0].values.insert(frame.vectors[0].values.end(), { s, std::sin(s + time), 0.0 });
+            frame.vectors[1].values.insert(frame.vectors[1].values.end(), { 0.0, std::cos(s + time), 0.0 });
+        }
+        return frame;
+    }
+
+    static bool sameBits(const std::vector<double>& a, const std::vector<double>& b)
+    {
+        return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0;
+    }
+
+    void writeFrames(const std::vector<double>& times, bool compress)
+    {
+        BinaryStateWriter writer;
+        ASSERT_TRUE(writer.open(m_filename, compress));
+        writer.maxPendingFrames = 2;
+        for (double t : times)
+            writer.write(makeFrame(t, 500));
+        writer.close();
+        EXPECT_FALSE(writer.hasFailed());
+    }
+
+    void checkFrames(const std::vector<double>& times)
+    {
+        BinaryStateReader reader;
+        ASSERT_TRUE(reader.open(m_filename));
+        ASSERT_EQ(reader.getNbFrames(), times.size());
+
+        // read in reverse order to check random access
+        BinaryStateFrame frame;
+        for (std::size_t i = times.size(); i-- > 0;)
+        {
+            ASSERT_TRUE(reader.readFrame(i, frame));
+            const BinaryStateFrame expected = makeFrame(times[i], 500);
+            EXPECT_EQ(frame.time, times[i]);
+            ASSERT_NE(frame.find("X"), nullptr);
+            ASSERT_NE(frame.find("V"), nullptr);
+            EXPECT_EQ(frame.find("F"), nullptr);
+            EXPECT_EQ(frame.find("X")->stride, 3u);
+            EXPECT_TRUE(sameBits(frame.find("X")->values, expected.vectors[0].values));
+            EXPECT_TRUE(sameBits(frame.find("V")->values, expected.vectors[1].values));
+        }
+    }
+
+    std::uintmax_t fileSize() const
+    {
+        return std::filesystem::file_size(m_filename);
+    }
+};
+
+TEST_F(BinaryStateFile_test, writeAndRead)
+{
+    std::vector<double> times;
+    for (int i = 0; i < 50; ++i)
+        times.push_back(0.01 * i);
+
+    writeFrames(times, false);
+    EXPECT_TRUE(BinaryStateFile::isBinaryStateFile(m_filename));
+    checkFrames(times);
+}
+
+TEST_F(BinaryStateFile_test, compressedIsLosslessAndSmaller)
+{
+    std::vector<double> times;
+    for (int i = 0; i < 50; ++i)
+        times.push_back(0.01 * i);
+
+    writeFrames(times, false);
+    const auto rawSize = fileSize();
+
+    writeFrames(times, true);
+    EXPECT_LT(fileSize(), rawSize);
+    checkFrames(times);
+}
+
+TEST_F(BinaryStateFile_test, findFrame)
+{
+    const std::vector<double> regular = { 0.0, 0.01, 0.02, 0.03, 0.04 };
+    const std::vector<double> irregular = { 0.5, 0.75, 2.0, 2.5 };
+
+    writeFrames(regular, false);
+    {
+        BinaryStateReader reader;
+        ASSERT_TRUE(reader.open(m_filename));
+        EXPECT_EQ(reader.findFrame(-0.01), BinaryStateReader::InvalidFrame);
+        for (std::size_t i = 0; i < regular.size(); ++i)
+        {
+            EXPECT_EQ(reader.findFrame(regular[i]), i);
+            EXPECT_EQ(reader.findFrame(regular[i] + 0.005), i);
+        }
+        EXPECT_EQ(reader.findFrame(10.0), regular.size() - 1);
+    }
+
+    writeFrames(irregular, true);
+    {
+        BinaryStateReader reader;
+        ASSERT_TRUE(reader.open(m_filename));
+        EXPECT_EQ(reader.findFrame(0.4), BinaryStateReader::InvalidFrame);
+        EXPECT_EQ(reader.findFrame(0.5), 0u);
+        EXPECT_EQ(reader.findFrame(1.9), 1u);
+        EXPECT_EQ(reader.findFrame(2.0), 2u);
+        EXPECT_EQ(reader.findFrame(3.0), 3u);
+    }
+}
+
+TEST_F(BinaryStateFile_test, interruptedRecording)
+{
+    const std::vector<double> times = { 0.0, 0.1, 0.2, 0.3 };
+    writeFrames(times, true);
+
+    // drop the index (16 bytes per frame), the footer (24 bytes) and the end of the last frame
+    const std::uintmax_t indexOffset = fileSize() - times.size() * 16 - 24;
+    std::filesystem::resize_file(m_filename, indexOffset - 10);
+
+    checkFrames({ 0.0, 0.1, 0.2 });
+}
+
+TEST_F(BinaryStateFile_test, invalidFile)
+{
+    {
+        std::ofstream file(m_filename);
+        file << "T= 0\n  X= 0 0 0\n";
+    }
+    EXPECT_FALSE(BinaryStateFile::isBinaryStateFile(m_filename));
+
+    BinaryStateReader reader;
+    EXPECT_FALSE(reader.open(m_filename));
+    EXPECT_FALSE(reader.isOpen());
+}
+
+TEST_F(BinaryStateFile_test, incompressibleValues)
+{
+    std::mt19937_64 generator(42);
+    std::vector<double> values(300);
+    for (auto& v : values)
+    {
+        const std::uint64_t bits = generator();
+        std::memcpy(&v, &bits, sizeof(double));
+    }
+    std::vector<char> encoded;
+    EXPECT_FALSE(BinaryStateFile::compress(values, 3, encoded));
+
+    std::vector<double> zeros(300, 0.0);
+    ASSERT_TRUE(BinaryStateFile::compress(zeros, 3, encoded));
+    std::vector<double> decoded(300, 1.0);
+    ASSERT_TRUE(BinaryStateFile::decompress(encoded.data(), encoded.size(), decoded.size(), 3, decoded.data()));
+    EXPECT_TRUE(sameBits(decoded, zeros));
+}
+
+} // namespace
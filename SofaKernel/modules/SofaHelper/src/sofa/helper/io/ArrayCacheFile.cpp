@@ -0,0 +1,187 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/io/ArrayCacheFile.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace sofa::helper::io
+{
+
+namespace
+{
+
+constexpr std::size_t Alignment = 16;
+
+struct FileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t nbArrays;
+    std::uint64_t key;
+};
+
+struct ArrayEntry
+{
+    char name[ArrayCacheFile::MaxNameLength + 1];
+    std::uint32_t elementSize;
+    std::uint32_t reserved;
+    std::uint64_t offset;
+    std::uint64_t count;
+};
+
+std::uint64_t align(std::uint64_t offset)
+{
+    return (offset + Alignment - 1) / Alignment * Alignment;
+}
+
+} // namespace
+
+std::uint64_t ArrayCacheFile::hash(const void* data, std::size_t size, std::uint64_t seed)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::uint64_t h = seed;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        h ^= bytes[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+void ArrayCacheWriter::addBytes(const std::string& name, const void* values, std::size_t elementSize, std::size_t count)
+{
+    Array array;
+    array.name = name.substr(0, ArrayCacheFile::MaxNameLength);
+    array.elementSize = static_cast<std::uint32_t>(elementSize);
+    array.count = count;
+    array.bytes.resize(elementSize * count);
+    if (!array.bytes.empty())
+        std::memcpy(array.bytes.data(), values, array.bytes.size());
+    m_arrays.push_back(std::move(array));
+}
+
+bool ArrayCacheWriter::write(const std::string& filename, std::uint64_t key) const
+{
+    FileHeader header {};
+    std::memcpy(header.magic, ArrayCacheFile::Magic, sizeof(header.magic));
+    header.version = ArrayCacheFile::Version;
+    header.nbArrays = static_cast<std::uint32_t>(m_arrays.size());
+    header.key = key;
+
+    std::vector<ArrayEntry> entries(m_arrays.size());
+    std::uint64_t offset = align(sizeof(FileHeader) + entries.size() * sizeof(ArrayEntry));
+    for (std::size_t i = 0; i < m_arrays.size(); ++i)
+    {
+        std::memset(&entries[i], 0, sizeof(ArrayEntry));
+        std::memcpy(entries[i].name, m_arrays[i].name.c_str(), m_arrays[i].name.size());
+        entries[i].elementSize = m_arrays[i].elementSize;
+        entries[i].offset = offset;
+        entries[i].count = m_arrays[i].count;
+        offset = align(offset + m_arrays[i].bytes.size());
+    }
+
+    const std::string temporaryFilename = filename + ".tmp";
+    {
+        std::ofstream file(temporaryFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        const char padding[Alignment] = {};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(entries.data()), std::streamsize(entries.size() * sizeof(ArrayEntry)));
+        std::uint64_t position = sizeof(FileHeader) + entries.size() * sizeof(ArrayEntry);
+        for (std::size_t i = 0; i < m_arrays.size(); ++i)
+        {
+            file.write(padding, std::streamsize(entries[i].offset - position));
+            file.write(m_arrays[i].bytes.data(), std::streamsize(m_arrays[i].bytes.size()));
+            position = entries[i].offset + m_arrays[i].bytes.size();
+        }
+        if (!file.good())
+        {
+            file.close();
+            std::remove(temporaryFilename.c_str());
+            return false;
+        }
+    }
+
+    std::remove(filename.c_str());
+    return std::rename(temporaryFilename.c_str(), filename.c_str()) == 0;
+}
+
+bool ArrayCacheReader::open(const std::string& filename, std::uint64_t key)
+{
+    close();
+    if (!m_file.open(filename))
+        return false;
+
+    FileHeader header;
+    if (m_file.size() < sizeof(FileHeader))
+    {
+        close();
+        return false;
+    }
+    std::memcpy(&header, m_file.data(), sizeof(FileHeader));
+    if (std::memcmp(header.magic, ArrayCacheFile::Magic, sizeof(header.magic)) != 0
+        || header.version != ArrayCacheFile::Version
+        || header.key != key
+        || header.nbArrays > (m_file.size() - sizeof(FileHeader)) / sizeof(ArrayEntry))
+    {
+        close();
+        return false;
+    }
+    m_nbArrays = header.nbArrays;
+    return true;
+}
+
+void ArrayCacheReader::close()
+{
+    m_file.close();
+    m_nbArrays = 0;
+}
+
+bool ArrayCacheReader::getBytes(const std::string& name, std::size_t elementSize, const void*& data, std::size_t& count) const
+{
+    if (!m_file.isOpen())
+        return false;
+
+    for (std::uint32_t i = 0; i < m_nbArrays; ++i)
+    {
+        ArrayEntry entry;
+        std::memcpy(&entry, m_file.data() + sizeof(FileHeader) + i * sizeof(ArrayEntry), sizeof(ArrayEntry));
+        entry.name[ArrayCacheFile::MaxNameLength] = '\0';
+        if (name != entry.name)
+            continue;
+
+        if (entry.elementSize != elementSize || entry.offset > m_file.size()
+            || entry.count > (m_file.size() - entry.offset) / elementSize)
+            return false;
+
+        data = m_file.data() + entry.offset;
+        count = static_cast<std::size_t>(entry.count);
+        return true;
+    }
+    return false;
+}
+
+} // namespace sofa::helper::io
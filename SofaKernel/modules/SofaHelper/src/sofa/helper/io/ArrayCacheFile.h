@@ -0,0 +1,138 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/helper/config.h>
+#include <sofa/helper/io/MappedFile.h>
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace sofa::helper::io
+{
+
+/// @brief Binary file caching named arrays of plain elements, identified by a key.
+///
+/// The key is typically a hash of the data the arrays were computed from (see hash()):
+/// a cache is only read back if its key matches, so that a stale file is ignored.
+/// The file is made of a header, a table of contents, then the arrays, each one
+/// aligned on 16 bytes so that it can be used in place from a mapped file:
+///     FileHeader | ArrayEntry * n | array 0 | ... | array n-1
+/// Values are stored in the native byte order.
+class SOFA_HELPER_API ArrayCacheFile
+{
+public:
+    static constexpr char Magic[8] = {'S','O','F','A','C','A','C','H'};
+    static constexpr std::uint32_t Version = 1;
+    static constexpr std::size_t MaxNameLength = 47;
+
+    /// 64-bit FNV-1a hash of a buffer, which can be chained through seed.
+    static std::uint64_t hash(const void* data, std::size_t size, std::uint64_t seed = 14695981039346656037ull);
+
+    template<class T>
+    static std::uint64_t hash(const std::vector<T>& values, std::uint64_t seed)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "only arrays of plain elements can be hashed");
+        const std::uint64_t count = values.size();
+        return hash(values.data(), values.size() * sizeof(T), hash(&count, sizeof(count), seed));
+    }
+};
+
+/// @brief Collect arrays and write them in an ArrayCacheFile.
+class SOFA_HELPER_API ArrayCacheWriter
+{
+public:
+    /// Copy an array to be written under the given name.
+    template<class T>
+    void add(const std::string& name, const T* values, std::size_t count)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "only arrays of plain elements can be cached");
+        addBytes(name, values, sizeof(T), count);
+    }
+
+    template<class T>
+    void add(const std::string& name, const std::vector<T>& values)
+    {
+        add(name, values.data(), values.size());
+    }
+
+    /// Write the arrays. The file is written under a temporary name then renamed,
+    /// so that a reader never sees a partially written cache.
+    bool write(const std::string& filename, std::uint64_t key) const;
+
+protected:
+    void addBytes(const std::string& name, const void* values, std::size_t elementSize, std::size_t count);
+
+    struct Array
+    {
+        std::string name;
+        std::uint32_t elementSize;
+        std::uint64_t count;
+        std::vector<char> bytes;
+    };
+    std::vector<Array> m_arrays;
+};
+
+/// @brief Access the arrays of an ArrayCacheFile mapped in memory.
+class SOFA_HELPER_API ArrayCacheReader
+{
+public:
+    /// Map the file. Return false if it is missing, invalid or computed for another key.
+    bool open(const std::string& filename, std::uint64_t key);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    /// Point to the array of the given name, in the mapped file.
+    /// Return false if there is no such array or if its elements are not of the size of T.
+    template<class T>
+    bool get(const std::string& name, const T*& values, std::size_t& count) const
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "only arrays of plain elements can be cached");
+        const void* data = nullptr;
+        if (!getBytes(name, sizeof(T), data, count))
+            return false;
+        values = static_cast<const T*>(data);
+        return true;
+    }
+
+    /// Copy the array of the given name.
+    template<class Container>
+    bool read(const std::string& name, Container& values) const
+    {
+        const typename Container::value_type* data = nullptr;
+        std::size_t count = 0;
+        if (!get(name, data, count))
+            return false;
+        values.assign(data, data + count);
+        return true;
+    }
+
+protected:
+    bool getBytes(const std::string& name, std::size_t elementSize, const void*& data, std::size_t& count) const;
+
+    MappedFile m_file;
+    std::uint32_t m_nbArrays {0};
+};
+
+} // namespace sofa::helper::io
@@ -0,0 +1,121 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/io/AsciiParser.h>
+
+#include <locale>
+#include <sstream>
+#include <string>
+
+namespace sofa::helper::io::ascii
+{
+
+namespace
+{
+
+template<class T>
+const char* parseRealWithClassicLocale(const char* first, const char* last, T& value)
+{
+    const char* tokenEnd = findEndOfToken(first, last);
+    std::istringstream stream(std::string(first, tokenEnd));
+    stream.imbue(std::locale::classic());
+    stream >> value;
+    if (stream.fail())
+    {
+        return nullptr;
+    }
+    const auto consumed = stream.eof() ? static_cast<std::ptrdiff_t>(tokenEnd - first)
+                                       : static_cast<std::ptrdiff_t>(stream.tellg());
+    return first + consumed;
+}
+
+} // namespace
+
+const char* parseRealFallback(const char* first, const char* last, double& value)
+{
+    return parseRealWithClassicLocale(first, last, value);
+}
+
+const char* parseRealFallback(const char* first, const char* last, float& value)
+{
+    return parseRealWithClassicLocale(first, last, value);
+}
+
+std::vector<const char*> splitLines(const char* begin, const char* end, std::size_t chunkSize)
+{
+    std::vector<const char*> boundaries { begin };
+    if (chunkSize == 0)
+    {
+        chunkSize = DefaultChunkSize;
+    }
+
+    const char* cursor = begin;
+    while (static_cast<std::size_t>(end - cursor) > chunkSize)
+    {
+        cursor = skipLine(cursor + chunkSize - 1, end);
+        if (cursor == end)
+        {
+            break;
+        }
+        boundaries.push_back(cursor);
+    }
+
+    if (begin != end)
+    {
+        boundaries.push_back(end);
+    }
+    return boundaries;
+}
+
+std::size_t countTokens(const char* begin, const char* end)
+{
+    std::size_t count = 0;
+    const char* cursor = skipSpaces(begin, end);
+    while (cursor != end)
+    {
+        ++count;
+        cursor = skipSpaces(findEndOfToken(cursor, end), end);
+    }
+    return count;
+}
+
+const char* findEndOfNumbers(const char* begin, const char* end)
+{
+    const char* line = begin;
+    while (line != end)
+    {
+        const char* first = skipBlanks(line, end);
+        if (first != end && *first != '\n')
+        {
+            const char c = *first;
+            const bool numberStart = (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.';
+            double value;
+            if (!numberStart && !readNumber(first, end, value)) // e.g. nan or inf
+            {
+                return line;
+            }
+        }
+        line = skipLine(line, end);
+    }
+    return end;
+}
+
+} // namespace sofa::helper::io::ascii
@@ -0,0 +1,231 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/helper/config.h>
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace sofa::helper::io::ascii
+{
+
+/**
+ * Locale-independent parsing of text files held in memory (typically a MappedFile).
+ *
+ * The functions work on a [cursor, end) range of characters and advance the cursor on success.
+ * Numbers are converted with std::from_chars when the standard library provides it, so that
+ * they do not depend on the global locale (contrary to operator>> and strtod).
+ *
+ * Large buffers can be split with splitLines() into chunks starting at the beginning of a line,
+ * so that a loader can parse the chunks in parallel and merge their results in chunk order.
+ */
+
+/// Size of the chunks built by splitLines when none is given
+inline constexpr std::size_t DefaultChunkSize = std::size_t(1) << 20;
+
+/// Space characters separating the tokens of a line
+inline bool isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline bool isSpace(char c)
+{
+    return c == '\n' || isBlank(c);
+}
+
+/// Skip the blanks of the current line. The returned position is a token, an end of line or end.
+inline const char* skipBlanks(const char* cursor, const char* end)
+{
+    while (cursor != end && isBlank(*cursor))
+    {
+        ++cursor;
+    }
+    return cursor;
+}
+
+/// Skip the blanks and the ends of line.
+inline const char* skipSpaces(const char* cursor, const char* end)
+{
+    while (cursor != end && isSpace(*cursor))
+    {
+        ++cursor;
+    }
+    return cursor;
+}
+
+/// Position of the end of line character of the current line, or end.
+inline const char* findEndOfLine(const char* cursor, const char* end)
+{
+    const void* eol = std::memchr(cursor, '\n', static_cast<std::size_t>(end - cursor));
+    return eol ? static_cast<const char*>(eol) : end;
+}
+
+/// Beginning of the next line, or end.
+inline const char* skipLine(const char* cursor, const char* end)
+{
+    const char* eol = findEndOfLine(cursor, end);
+    return eol == end ? end : eol + 1;
+}
+
+inline const char* findEndOfToken(const char* cursor, const char* end)
+{
+    while (cursor != end && !isSpace(*cursor))
+    {
+        ++cursor;
+    }
+    return cursor;
+}
+
+/// Read the next token of the current line. The token is empty at the end of the line.
+inline std::string_view readToken(const char*& cursor, const char* end)
+{
+    const char* first = skipBlanks(cursor, end);
+    cursor = findEndOfToken(first, end);
+    return std::string_view(first, static_cast<std::size_t>(cursor - first));
+}
+
+/// Read the current line, without its end of line characters, and move the cursor to the next one.
+inline std::string_view readLine(const char*& cursor, const char* end)
+{
+    const char* first = cursor;
+    const char* last = findEndOfLine(cursor, end);
+    cursor = last == end ? end : last + 1;
+    if (last != first && *(last - 1) == '\r')
+    {
+        --last;
+    }
+    return std::string_view(first, static_cast<std::size_t>(last - first));
+}
+
+/// Conversion of a floating-point number without std::from_chars, using the "C" locale.
+SOFA_HELPER_API const char* parseRealFallback(const char* first, const char* last, double& value);
+SOFA_HELPER_API const char* parseRealFallback(const char* first, const char* last, float& value);
+
+/**
+ * Parse the number starting at cursor, after the blanks of the current line.
+ * On success, the cursor is moved after the number. An explicit '+' sign is accepted.
+ * The characters following the number are not checked, e.g. "3/4" is parsed as 3.
+ */
+template<class T>
+bool readNumber(const char*& cursor, const char* end, T& value)
+{
+    static_assert(std::is_arithmetic_v<T>, "readNumber only parses arithmetic types");
+
+    const char* first = skipBlanks(cursor, end);
+    if (first != end && *first == '+' && first + 1 != end && *(first + 1) != '-')
+    {
+        ++first;
+    }
+
+    const char* last = nullptr;
+    if constexpr (std::is_integral_v<T>)
+    {
+        const auto result = std::from_chars(first, end, value);
+        if (result.ec != std::errc())
+        {
+            return false;
+        }
+        last = result.ptr;
+    }
+    else
+    {
+#if defined(__cpp_lib_to_chars)
+        auto result = std::from_chars(first, end, value);
+        if (result.ec == std::errc::result_out_of_range)
+        {
+            // under- or overflow of a float: let the conversion of the double round it
+            double d = 0.0;
+            result = std::from_chars(first, end, d);
+            value = static_cast<T>(d);
+        }
+        if (result.ec != std::errc())
+        {
+            return false;
+        }
+        last = result.ptr;
+#else
+        if constexpr (std::is_same_v<T, float>)
+        {
+            last = parseRealFallback(first, end, value);
+        }
+        else
+        {
+            double d = 0.0;
+            last = parseRealFallback(first, end, d);
+            value = static_cast<T>(d);
+        }
+        if (last == nullptr)
+        {
+            return false;
+        }
+#endif
+    }
+
+    cursor = last;
+    return true;
+}
+
+/**
+ * Parse count numbers separated by spaces or ends of line.
+ * Return the number of values read, which is less than count if a token is not a number
+ * or if the end of the range is reached.
+ */
+template<class T>
+std::size_t readNumbers(const char*& cursor, const char* end, T* values, std::size_t count)
+{
+    std::size_t i = 0;
+    while (i < count)
+    {
+        cursor = skipSpaces(cursor, end);
+        if (cursor == end || !readNumber(cursor, end, values[i]))
+        {
+            break;
+        }
+        ++i;
+    }
+    return i;
+}
+
+/**
+ * Split [begin, end) into consecutive chunks of about chunkSize characters, each one starting
+ * at the beginning of a line. The returned boundaries are begin, ..., end, so that there are
+ * size()-1 chunks. They only depend on the content and on chunkSize.
+ */
+SOFA_HELPER_API std::vector<const char*> splitLines(const char* begin, const char* end,
+                                                    std::size_t chunkSize = DefaultChunkSize);
+
+/// Number of tokens separated by spaces or ends of line in [begin, end).
+SOFA_HELPER_API std::size_t countTokens(const char* begin, const char* end);
+
+/**
+ * Find the end of a block of numbers starting at begin: it is the beginning of the first line
+ * whose first token is not a number (typically a keyword), or end.
+ */
+SOFA_HELPER_API const char* findEndOfNumbers(const char* begin, const char* end);
+
+} // namespace sofa::helper::io::ascii
@@ -0,0 +1,560 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/io/BinaryStateFile.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace sofa::helper::io
+{
+
+namespace
+{
+
+constexpr std::uint32_t FrameMagic = 0x454d5246; // "FRME"
+
+struct FileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t flags;
+};
+
+struct FrameHeader
+{
+    std::uint32_t magic;
+    std::uint32_t nbVectors;
+    double time;
+    std::uint64_t size; ///< size in bytes of the vectors following the header
+};
+
+struct VectorHeader
+{
+    char name[8];
+    std::uint32_t encoding;
+    std::uint32_t stride;
+    std::uint64_t nbValues;
+    std::uint64_t nbBytes;
+};
+
+struct IndexEntry
+{
+    double time;
+    std::uint64_t offset;
+};
+
+struct Footer
+{
+    std::uint64_t indexOffset;
+    std::uint64_t nbFrames;
+    char magic[8];
+};
+
+template<class T>
+void append(std::vector<char>& buffer, const T& value)
+{
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template<class T>
+T load(const char* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+std::uint64_t toBits(double v)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(double));
+    return bits;
+}
+
+double fromBits(std::uint64_t bits)
+{
+    double v;
+    std::memcpy(&v, &bits, sizeof(double));
+    return v;
+}
+
+} // namespace
+
+const BinaryStateVector* BinaryStateFrame::find(const std::string& name) const
+{
+    for (const auto& v : vectors)
+    {
+        if (v.name == name)
+            return &v;
+    }
+    return nullptr;
+}
+
+bool BinaryStateFile::isBinaryStateFile(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(Magic)];
+    if (!file.read(magic, sizeof(magic)))
+        return false;
+    return std::memcmp(magic, Magic, sizeof(Magic)) == 0;
+}
+
+bool BinaryStateFile::compress(const std::vector<double>& values, unsigned int stride, std::vector<char>& out)
+{
+    const std::size_t n = values.size();
+    const std::size_t nbBytes = n * sizeof(double);
+    if (stride == 0)
+        stride = 1;
+
+    // Predict each value by the same component of the previous DOF and regroup
+    // the bytes of the residuals by significance: the high-order planes are
+    // then mostly made of zeros.
+    std::vector<unsigned char> planes(nbBytes);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        std::uint64_t bits = toBits(values[i]);
+        if (i >= stride)
+            bits ^= toBits(values[i - stride]);
+        for (std::size_t b = 0; b < sizeof(double); ++b)
+            planes[b * n + i] = static_cast<unsigned char>(bits >> (8 * b));
+    }
+
+    // Run-length encoding of the zeros. A control byte c is followed by c+1
+    // literal bytes if c < 128, and stands for (c & 127) + 1 zeros otherwise.
+    out.clear();
+    out.reserve(nbBytes / 2);
+    std::size_t i = 0;
+    while (i < nbBytes)
+    {
+        if (out.size() >= nbBytes)
+            return false;
+
+        if (planes[i] == 0)
+        {
+            std::size_t j = i + 1;
+            while (j < nbBytes && j - i < 128 && planes[j] == 0)
+                ++j;
+            out.push_back(static_cast<char>(0x80 | (j - i - 1)));
+            i = j;
+        }
+        else
+        {
+            std::size_t j = i + 1;
+            while (j < nbBytes && j - i < 128 && !(planes[j] == 0 && j + 1 < nbBytes && planes[j + 1] == 0))
+                ++j;
+            out.push_back(static_cast<char>(j - i - 1));
+            out.insert(out.end(), planes.begin() + i, planes.begin() + j);
+            i = j;
+        }
+    }
+    return out.size() < nbBytes;
+}
+
+bool BinaryStateFile::decompress(const char* data, std::size_t size, std::size_t n, unsigned int stride, double* out)
+{
+    const std::size_t nbBytes = n * sizeof(double);
+    if (stride == 0)
+        stride = 1;
+
+    std::vector<unsigned char> planes(nbBytes);
+    std::size_t i = 0;
+    std::size_t pos = 0;
+    while (pos < size && i < nbBytes)
+    {
+        const unsigned char c = static_cast<unsigned char>(data[pos++]);
+        const std::size_t length = std::size_t(c & 0x7f) + 1;
+        if (i + length > nbBytes)
+            return false;
+        if (c & 0x80)
+        {
+            std::fill(planes.begin() + i, planes.begin() + i + length, 0);
+        }
+        else
+        {
+            if (pos + length > size)
+                return false;
+            std::memcpy(planes.data() + i, data + pos, length);
+            pos += length;
+        }
+        i += length;
+    }
+    if (i != nbBytes || pos != size)
+        return false;
+
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        std::uint64_t bits = 0;
+        for (std::size_t b = 0; b < sizeof(double); ++b)
+            bits |= std::uint64_t(planes[b * n + k]) << (8 * b);
+        if (k >= stride)
+            bits ^= toBits(out[k - stride]);
+        out[k] = fromBits(bits);
+    }
+    return true;
+}
+
+
+BinaryStateWriter::BinaryStateWriter()
+{
+}
+
+BinaryStateWriter::~BinaryStateWriter()
+{
+    close();
+}
+
+bool BinaryStateWriter::open(const std::string& filename, bool compress)
+{
+    close();
+
+    m_file.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open())
+        return false;
+
+    FileHeader header;
+    std::memcpy(header.magic, BinaryStateFile::Magic, sizeof(header.magic));
+    header.version = BinaryStateFile::Version;
+    header.flags = 0;
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    m_compress = compress;
+    m_closing = false;
+    m_failed = !m_file.good();
+    m_index.clear();
+    m_thread = std::thread(&BinaryStateWriter::run, this);
+    return true;
+}
+
+void BinaryStateWriter::close()
+{
+    if (!m_thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closing = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+
+    const std::uint64_t indexOffset = static_cast<std::uint64_t>(m_file.tellp());
+    m_buffer.clear();
+    for (const auto& entry : m_index)
+        append(m_buffer, IndexEntry{ entry.first, entry.second });
+    Footer footer;
+    footer.indexOffset = indexOffset;
+    footer.nbFrames = m_index.size();
+    std::memcpy(footer.magic, BinaryStateFile::IndexMagic, sizeof(footer.magic));
+    append(m_buffer, footer);
+    m_file.write(m_buffer.data(), std::streamsize(m_buffer.size()));
+    if (!m_file.good())
+        m_failed = true;
+
+    m_file.close();
+    m_index.clear();
+    m_buffer.clear();
+}
+
+void BinaryStateWriter::write(BinaryStateFrame frame)
+{
+    if (!m_thread.joinable())
+        return;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]{ return m_pending.size() < maxPendingFrames || m_failed; });
+    if (m_failed)
+        return;
+    m_pending.push_back(std::move(frame));
+    lock.unlock();
+    m_condition.notify_all();
+}
+
+void BinaryStateWriter::flush()
+{
+    if (!m_thread.joinable())
+        return;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]{ return (m_pending.empty() && !m_writing) || m_failed; });
+    lock.unlock();
+    m_file.flush();
+}
+
+void BinaryStateWriter::run()
+{
+    for (;;)
+    {
+        BinaryStateFrame frame;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]{ return !m_pending.empty() || m_closing; });
+            if (m_pending.empty())
+                break;
+            frame = std::move(m_pending.front());
+            m_pending.pop_front();
+            m_writing = true;
+        }
+
+        const bool written = writeFrame(frame);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_writing = false;
+            if (!written)
+            {
+                m_failed = true;
+                m_pending.clear();
+            }
+        }
+        m_condition.notify_all();
+    }
+}
+
+bool BinaryStateWriter::writeFrame(const BinaryStateFrame& frame)
+{
+    m_buffer.clear();
+    m_buffer.resize(sizeof(FrameHeader));
+
+    std::vector<char> encoded;
+    for (const auto& v : frame.vectors)
+    {
+        VectorHeader header;
+        std::memset(header.name, 0, sizeof(header.name));
+        std::memcpy(header.name, v.name.data(), std::min(v.name.size(), sizeof(header.name)));
+        header.stride = v.stride;
+        header.nbValues = v.values.size();
+
+        if (m_compress && BinaryStateFile::compress(v.values, v.stride, encoded))
+        {
+            header.encoding = BinaryStateFile::XOR_SHUFFLE_RLE;
+            header.nbBytes = encoded.size();
+            append(m_buffer, header);
+            m_buffer.insert(m_buffer.end(), encoded.begin(), encoded.end());
+        }
+        else
+        {
+            header.encoding = BinaryStateFile::RAW;
+            header.nbBytes = v.values.size() * sizeof(double);
+            append(m_buffer, header);
+            const char* bytes = reinterpret_cast<const char*>(v.values.data());
+            m_buffer.insert(m_buffer.end(), bytes, bytes + header.nbBytes);
+        }
+    }
+
+    FrameHeader header;
+    header.magic = FrameMagic;
+    header.nbVectors = static_cast<std::uint32_t>(frame.vectors.size());
+    header.time = frame.time;
+    header.size = m_buffer.size() - sizeof(FrameHeader);
+    std::memcpy(m_buffer.data(), &header, sizeof(header));
+
+    const std::uint64_t offset = static_cast<std::uint64_t>(m_file.tellp());
+    m_file.write(m_buffer.data(), std::streamsize(m_buffer.size()));
+    if (!m_file.good())
+        return false;
+    m_index.emplace_back(frame.time, offset);
+    return true;
+}
+
+
+BinaryStateReader::BinaryStateReader()
+{
+}
+
+BinaryStateReader::~BinaryStateReader()
+{
+    close();
+}
+
+bool BinaryStateReader::open(const std::string& filename)
+{
+    close();
+
+    if (!m_file.open(filename))
+        return false;
+    m_data = m_file.data();
+    m_size = m_file.size();
+
+    if (!buildIndex())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void BinaryStateReader::close()
+{
+    m_file.close();
+    m_data = nullptr;
+    m_size = 0;
+    m_times.clear();
+    m_offsets.clear();
+    m_period = 0.0;
+}
+
+bool BinaryStateReader::buildIndex()
+{
+    if (m_size < sizeof(FileHeader))
+        return false;
+    const FileHeader header = load<FileHeader>(m_data);
+    if (std::memcmp(header.magic, BinaryStateFile::Magic, sizeof(header.magic)) != 0
+        || header.version != BinaryStateFile::Version)
+        return false;
+
+    if (!readIndex() && !scanFrames())
+        return false;
+
+    // detect regularly spaced frames to find them without searching
+    m_period = 0.0;
+    const std::size_t n = m_times.size();
+    if (n >= 2)
+    {
+        const double period = (m_times[n - 1] - m_times[0]) / double(n - 1);
+        bool regular = period > 0;
+        for (std::size_t i = 0; i < n && regular; ++i)
+            regular = std::abs(m_times[i] - (m_times[0] + double(i) * period)) <= 1e-6 * period;
+        if (regular)
+            m_period = period;
+    }
+    return true;
+}
+
+bool BinaryStateReader::readIndex()
+{
+    if (m_size < sizeof(FileHeader) + sizeof(Footer))
+        return false;
+    const Footer footer = load<Footer>(m_data + m_size - sizeof(Footer));
+    if (std::memcmp(footer.magic, BinaryStateFile::IndexMagic, sizeof(footer.magic)) != 0)
+        return false;
+    if (footer.indexOffset < sizeof(FileHeader)
+        || footer.indexOffset + footer.nbFrames * sizeof(IndexEntry) + sizeof(Footer) != m_size)
+        return false;
+
+    m_times.resize(footer.nbFrames);
+    m_offsets.resize(footer.nbFrames);
+    const char* entries = m_data + footer.indexOffset;
+    for (std::size_t i = 0; i < footer.nbFrames; ++i)
+    {
+        const IndexEntry entry = load<IndexEntry>(entries + i * sizeof(IndexEntry));
+        if (entry.offset + sizeof(FrameHeader) > footer.indexOffset)
+        {
+            m_times.clear();
+            m_offsets.clear();
+            return false;
+        }
+        m_times[i] = entry.time;
+        m_offsets[i] = entry.offset;
+    }
+    return true;
+}
+
+bool BinaryStateReader::scanFrames()
+{
+    m_times.clear();
+    m_offsets.clear();
+    std::size_t offset = sizeof(FileHeader);
+    while (offset + sizeof(FrameHeader) <= m_size)
+    {
+        const FrameHeader header = load<FrameHeader>(m_data + offset);
+        if (header.magic != FrameMagic || header.size > m_size - offset - sizeof(FrameHeader))
+            break; // truncated recording
+        m_times.push_back(header.time);
+        m_offsets.push_back(offset);
+        offset += sizeof(FrameHeader) + header.size;
+    }
+    return true;
+}
+
+std::size_t BinaryStateReader::findFrame(double time) const
+{
+    const std::size_t n = m_times.size();
+    if (n == 0 || time < m_times[0])
+        return InvalidFrame;
+
+    std::size_t i;
+    if (m_period > 0)
+    {
+        const double guess = std::floor((time - m_times[0]) / m_period);
+        i = std::min(n - 1, static_cast<std::size_t>(guess));
+        // correct the rounding errors of the guess
+        while (i + 1 < n && m_times[i + 1] <= time)
+            ++i;
+        while (i > 0 && m_times[i] > time)
+            --i;
+    }
+    else
+    {
+        i = static_cast<std::size_t>(std::upper_bound(m_times.begin(), m_times.end(), time) - m_times.begin()) - 1;
+    }
+    return i;
+}
+
+bool BinaryStateReader::readFrame(std::size_t frame, BinaryStateFrame& out) const
+{
+    if (frame >= m_offsets.size())
+        return false;
+
+    const std::size_t begin = m_offsets[frame];
+    const FrameHeader header = load<FrameHeader>(m_data + begin);
+    if (header.magic != FrameMagic || header.size > m_size - begin - sizeof(FrameHeader))
+        return false;
+    const std::size_t end = begin + sizeof(FrameHeader) + header.size;
+
+    out.time = header.time;
+    out.vectors.resize(header.nbVectors);
+    std::size_t offset = begin + sizeof(FrameHeader);
+    for (auto& v : out.vectors)
+    {
+        if (offset + sizeof(VectorHeader) > end)
+            return false;
+        const VectorHeader vh = load<VectorHeader>(m_data + offset);
+        offset += sizeof(VectorHeader);
+        if (vh.nbBytes > end - offset || vh.nbValues * sizeof(double) > vh.nbBytes * 128)
+            return false;
+
+        v.name.assign(vh.name, strnlen(vh.name, sizeof(vh.name)));
+        v.stride = vh.stride;
+        v.values.resize(vh.nbValues);
+        if (vh.encoding == BinaryStateFile::RAW)
+        {
+            if (vh.nbBytes != vh.nbValues * sizeof(double))
+                return false;
+            std::memcpy(v.values.data(), m_data + offset, vh.nbBytes);
+        }
+        else if (vh.encoding == BinaryStateFile::XOR_SHUFFLE_RLE)
+        {
+            if (!BinaryStateFile::decompress(m_data + offset, vh.nbBytes, vh.nbValues, vh.stride, v.values.data()))
+                return false;
+        }
+        else
+        {
+            return false;
+        }
+        offset += vh.nbBytes;
+    }
+    return true;
+}
+
+} // namespace sofa::helper::io
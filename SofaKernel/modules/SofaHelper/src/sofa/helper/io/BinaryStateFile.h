@@ -0,0 +1,187 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/helper/config.h>
+#include <sofa/helper/io/MappedFile.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sofa::helper::io
+{
+
+/// @brief One named vector of a recorded state (e.g. "X" or "V"), stored as a flat list of scalars.
+struct BinaryStateVector
+{
+    std::string name;             ///< name of the vector, at most 8 characters
+    unsigned int stride {1};      ///< number of scalars per DOF, used by the compression predictor
+    std::vector<double> values;
+};
+
+/// @brief All the vectors recorded at a given time.
+struct SOFA_HELPER_API BinaryStateFrame
+{
+    double time {0.0};
+    std::vector<BinaryStateVector> vectors;
+
+    /// Return the vector of the given name, or nullptr if it was not recorded.
+    const BinaryStateVector* find(const std::string& name) const;
+};
+
+/// @brief Chunked binary file format to record mechanical state vectors over time.
+///
+/// The file is made of a header, one chunk per recorded frame and a footer
+/// holding a time index of the chunks:
+///     FileHeader | Frame 0 | ... | Frame n-1 | IndexEntry * n | Footer
+/// Each chunk can be losslessly compressed: every value is xor-ed with the
+/// same component of the previous DOF, then the bytes are regrouped by
+/// significance and the runs of zeros are encoded.
+/// If the footer is missing (e.g. the recording was interrupted), the index is
+/// rebuilt from the chunk headers when the file is opened.
+/// Values are stored in the native byte order.
+class SOFA_HELPER_API BinaryStateFile
+{
+public:
+    static constexpr char Magic[8] = {'S','O','F','A','S','T','A','T'};
+    static constexpr char IndexMagic[8] = {'S','O','F','A','I','D','X','\0'};
+    static constexpr std::uint32_t Version = 1;
+
+    enum Encoding : std::uint32_t
+    {
+        RAW = 0,
+        XOR_SHUFFLE_RLE = 1
+    };
+
+    /// Return true if the file starts with the signature of the binary state format.
+    static bool isBinaryStateFile(const std::string& filename);
+
+    /// Losslessly encode values. Return false if the encoding does not reduce the size.
+    static bool compress(const std::vector<double>& values, unsigned int stride, std::vector<char>& out);
+
+    /// Decode n values encoded by compress.
+    static bool decompress(const char* data, std::size_t size, std::size_t n, unsigned int stride, double* out);
+};
+
+/// @brief Write a BinaryStateFile from a background thread.
+///
+/// Frames are queued by write() and encoded and written by a dedicated thread,
+/// so that the simulation does not wait for the disk. The queue is bounded:
+/// write() blocks if the writing thread falls too far behind.
+class SOFA_HELPER_API BinaryStateWriter
+{
+public:
+    BinaryStateWriter();
+    ~BinaryStateWriter();
+
+    BinaryStateWriter(const BinaryStateWriter&) = delete;
+    BinaryStateWriter& operator=(const BinaryStateWriter&) = delete;
+
+    /// Create the file and start the writing thread.
+    bool open(const std::string& filename, bool compress);
+
+    /// Wait for the queued frames to be written, write the time index and close the file.
+    void close();
+
+    bool isOpen() const { return m_thread.joinable(); }
+
+    /// Return true if an error occurred while writing.
+    bool hasFailed() const { return m_failed; }
+
+    /// Queue a frame to be written.
+    void write(BinaryStateFrame frame);
+
+    /// Block until all the queued frames are written.
+    void flush();
+
+    /// Maximum number of frames waiting to be written.
+    std::size_t maxPendingFrames {8};
+
+protected:
+    void run();
+    bool writeFrame(const BinaryStateFrame& frame);
+
+    std::ofstream m_file;
+    bool m_compress {false};
+    bool m_closing {false};
+    std::atomic<bool> m_failed {false};
+    bool m_writing {false};
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<BinaryStateFrame> m_pending;
+
+    std::vector<std::pair<double, std::uint64_t> > m_index;
+    std::vector<char> m_buffer;
+};
+
+/// @brief Random access to the frames of a BinaryStateFile mapped in memory.
+///
+/// Seeking a frame is done with the time index: a frame is found in constant
+/// time if the frames are regularly spaced, by binary search otherwise.
+class SOFA_HELPER_API BinaryStateReader
+{
+public:
+    static constexpr std::size_t InvalidFrame = std::size_t(-1);
+
+    BinaryStateReader();
+    ~BinaryStateReader();
+
+    BinaryStateReader(const BinaryStateReader&) = delete;
+    BinaryStateReader& operator=(const BinaryStateReader&) = delete;
+
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    std::size_t getNbFrames() const { return m_times.size(); }
+    double getFrameTime(std::size_t frame) const { return m_times[frame]; }
+
+    /// Return the last frame recorded at or before the given time, or InvalidFrame.
+    std::size_t findFrame(double time) const;
+
+    /// Decode all the vectors of a frame.
+    bool readFrame(std::size_t frame, BinaryStateFrame& out) const;
+
+protected:
+    bool buildIndex();
+    bool readIndex();
+    bool scanFrames();
+
+    MappedFile m_file;
+    const char* m_data {nullptr};
+    std::size_t m_size {0};
+
+    std::vector<double> m_times;
+    std::vector<std::uint64_t> m_offsets;
+    double m_period {0.0}; ///< time between frames if they are regularly spaced, 0 otherwise
+};
+
+} // namespace sofa::helper::io
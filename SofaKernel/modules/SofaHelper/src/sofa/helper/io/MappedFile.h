@@ -0,0 +1,62 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/helper/config.h>
+
+#include <cstddef>
+#include <string>
+
+namespace sofa::helper::io
+{
+
+/// @brief Read-only view of a whole file mapped in memory.
+///
+/// The pages are loaded by the system when they are accessed, so that opening
+/// a large file is immediate and only the parts which are read cost I/O.
+class SOFA_HELPER_API MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Map the file in memory. Return false if it cannot be read. An empty file gives an empty view.
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    const char* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+
+protected:
+    const char* m_data {nullptr};
+    std::size_t m_size {0};
+#ifdef WIN32
+    void* m_fileHandle {nullptr};
+    void* m_mappingHandle {nullptr};
+#endif
+};
+
+} // namespace sofa::helper::io
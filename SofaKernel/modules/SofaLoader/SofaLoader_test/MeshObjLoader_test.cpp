@@ -28,6 +28,11 @@
 #include <sofa/helper/BackTrace.h>
 using sofa::helper::BackTrace ;
 
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <filesystem>
+#include <fstream>
+
 using namespace sofa::component::loader;
 
 namespace sofa
@@ -97,5 +102,109 @@ TEST_F(MeshObjLoader_test, LoadCall)
     loadTest("mesh/torus.obj", 800, 0, 1600,  0, 0, 0, 0, 0, 0, 861, 0);
 }
 
+/** An empty file is a valid OBJ file describing an empty mesh
+ */
+TEST_F(MeshObjLoader_test, EmptyFile)
+{
+    const std::string filename = (std::filesystem::temp_directory_path() / "MeshObjLoader_test_empty.obj").string();
+    std::ofstream(filename).close();
+
+    this->setFilename(filename);
+    EXPECT_TRUE(this->load());
+    EXPECT_TRUE(d_positions.getValue().empty());
+    EXPECT_TRUE(d_triangles.getValue().empty());
+    EXPECT_TRUE(d_edges.getValue().empty());
+
+    std::filesystem::remove(filename);
+}
+
+/** The file is larger than a parsing chunk: the faces using relative indices and the groups
+ * must be the same whether the chunks are parsed sequentially or in parallel.
+ */
+TEST_F(MeshObjLoader_test, ParallelParsing)
+{
+    const std::string filename = (std::filesystem::temp_directory_path() / "MeshObjLoader_test_large.obj").string();
+    const int n = 150;
+    {
+        std::ofstream file(filename);
+        file << "g first group\r\n";
+        for (int i = 0; i < n; ++i)
+        {
+            for (int j = 0; j < n; ++j)
+            {
+                file << "v " << i * 0.125 << " " << -j * 1.5e-3 << " " << i * j << "\r\n";
+                file << "vt " << i / double(n) << " " << j / double(n) << "\n";
+            }
+            if (i % 40 == 0)
+            {
+                file << "g group" << i << "\n";
+            }
+            // relative indices of the last row of vertices
+            for (int j = 1; j < n; ++j)
+            {
+                file << "f " << j - n - 1 << "/-1 " << j - n << " " << j - 2 * n << "\n";
+            }
+            file << "l -1 -2\n";
+        }
+    }
+
+    struct Result
+    {
+        type::vector<type::Vector3> positions;
+        type::vector<Triangle> triangles;
+        type::vector<Edge> edges;
+        type::SVector<type::SVector<int> > texIndices;
+        type::vector<core::loader::PrimitiveGroup> groups;
+    };
+    const auto loadFile = [this, &filename]()
+    {
+        this->setFilename(filename);
+        EXPECT_TRUE(this->load());
+        return Result { d_positions.getValue(), d_triangles.getValue(), d_edges.getValue(),
+                        d_texIndexList.getValue(), d_trianglesGroups.getValue() };
+    };
+
+    // parallelParsing is false: the chunks are parsed inline, without creating a task scheduler
+    const bool hasScheduler = simulation::TaskScheduler::getCurrentInstance() != nullptr;
+    const Result sequential = loadFile();
+    if (!hasScheduler)
+        EXPECT_EQ(simulation::TaskScheduler::getCurrentInstance(), nullptr);
+    ASSERT_EQ(sequential.positions.size(), std::size_t(n * n));
+    EXPECT_EQ(sequential.positions[n * n - 1], type::Vector3((n - 1) * 0.125, -(n - 1) * 1.5e-3, (n - 1) * (n - 1)));
+    ASSERT_EQ(sequential.triangles.size(), std::size_t(n * (n - 1)));
+    EXPECT_EQ(sequential.triangles.back()[0], sofa::Index(n * n - 2));
+    EXPECT_EQ(sequential.triangles.back()[1], sofa::Index(n * n - 1));
+    EXPECT_EQ(sequential.triangles.back()[2], sofa::Index(n * n - n - 1));
+    EXPECT_EQ(sequential.texIndices[sequential.texIndices.size() - 2][0], n * n - 1);
+    EXPECT_EQ(sequential.edges.size(), std::size_t(n));
+    ASSERT_EQ(sequential.groups.size(), 4u);
+    EXPECT_EQ(sequential.groups[0].groupName, "group0");
+    EXPECT_EQ(sequential.groups[1].p0, 40 * (n - 1));
+
+    simulation::TaskScheduler::getInstance()->init(4);
+    d_parallelParsing.setValue(true);
+    const Result parallel = loadFile();
+    simulation::TaskScheduler::getInstance()->stop();
+
+    EXPECT_EQ(parallel.positions, sequential.positions);
+    const auto sameElements = [](const auto& a, const auto& b)
+    {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                          [](const auto& x, const auto& y) { return !(x < y) && !(y < x); });
+    };
+    EXPECT_TRUE(sameElements(parallel.triangles, sequential.triangles));
+    EXPECT_TRUE(sameElements(parallel.edges, sequential.edges));
+    EXPECT_EQ(parallel.texIndices, sequential.texIndices);
+    ASSERT_EQ(parallel.groups.size(), sequential.groups.size());
+    for (std::size_t g = 0; g < parallel.groups.size(); ++g)
+    {
+        EXPECT_EQ(parallel.groups[g].groupName, sequential.groups[g].groupName);
+        EXPECT_EQ(parallel.groups[g].p0, sequential.groups[g].p0);
+        EXPECT_EQ(parallel.groups[g].nbp, sequential.groups[g].nbp);
+    }
+
+    std::filesystem::remove(filename);
+}
+
 } // namespace meshobjloader_test
 } // namespace sofa
@@ -32,6 +32,11 @@ using sofa::helper::BackTrace ;
 #include <sofa/testing/BaseTest.h>
 using sofa::testing::BaseTest ;
 
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <filesystem>
+#include <fstream>
+
 namespace sofa
 {
 namespace meshvtkloader_test
@@ -125,6 +130,68 @@ TEST_F(MeshVTKLoaderTest, loadLegacy_binary)
     EXPECT_TRUE(dynamic_cast<Data<type::vector<type::Vec3f>>*>(vect2) != nullptr);
 }
 
+/// The blocks of numbers are larger than a parsing chunk, and the file ends without an end of line
+TEST_F(MeshVTKLoaderTest, loadLegacy_asciiInParallel)
+{
+    const std::string filename = (std::filesystem::temp_directory_path() / "MeshVTKLoader_test_large.vtk").string();
+    const unsigned int nbPoints = 60000;
+    {
+        std::ofstream file(filename);
+        file.precision(17);
+        file << "# vtk DataFile Version 3.0\nlarge\nASCII\n\nDATASET UNSTRUCTURED_GRID\n";
+        file << "POINTS " << nbPoints << " double\n";
+        for (unsigned int i = 0; i < nbPoints; ++i)
+        {
+            file << i * 0.25 << " " << -1e-3 * i << " " << i % 7 << ((i % 3 == 2) ? "\r\n" : " ");
+        }
+        file << "\nCELLS " << nbPoints - 2 << " " << 4 * (nbPoints - 2) << "\n";
+        for (unsigned int i = 0; i + 2 < nbPoints; ++i)
+        {
+            file << "3 " << i << " " << i + 1 << " " << i + 2 << "\n";
+        }
+        file << "CELL_TYPES " << nbPoints - 2 << "\n";
+        for (unsigned int i = 0; i + 2 < nbPoints; ++i)
+        {
+            file << "5\n";
+        }
+        file << "POINT_DATA " << nbPoints << "\nSCALARS temperature float\nLOOKUP_TABLE default\n";
+        for (unsigned int i = 0; i < nbPoints; ++i)
+        {
+            file << i * 0.5f << (i + 1 < nbPoints ? "\n" : "");
+        }
+    }
+
+    // parallelParsing is false: the blocks are parsed inline, without creating a task scheduler
+    const bool hasScheduler = simulation::TaskScheduler::getCurrentInstance() != nullptr;
+    testLoad(filename, nbPoints, 0, nbPoints - 2, 0, 0, 0, 0);
+    if (!hasScheduler)
+        EXPECT_EQ(simulation::TaskScheduler::getCurrentInstance(), nullptr);
+    const auto sequentialPositions = d_positions.getValue();
+    const auto sequentialTriangles = d_triangles.getValue();
+
+    simulation::TaskScheduler::getInstance()->init(4);
+    d_parallelParsing.setValue(true);
+    testLoad(filename, nbPoints, 0, nbPoints - 2, 0, 0, 0, 0);
+    simulation::TaskScheduler::getInstance()->stop();
+
+    const auto& positions = d_positions.getValue();
+    ASSERT_EQ(positions.size(), nbPoints);
+    EXPECT_EQ(positions[nbPoints - 1], type::Vector3((nbPoints - 1) * 0.25, -1e-3 * (nbPoints - 1), (nbPoints - 1) % 7));
+    EXPECT_EQ(positions, sequentialPositions);
+    EXPECT_EQ(d_triangles.getValue().back()[2], nbPoints - 1);
+    ASSERT_EQ(d_triangles.getValue().size(), sequentialTriangles.size());
+    for (std::size_t i = 0; i < sequentialTriangles.size(); ++i)
+        for (int j = 0; j < 3; ++j)
+            EXPECT_EQ(d_triangles.getValue()[i][j], sequentialTriangles[i][j]);
+
+    const auto* temperature = dynamic_cast<Data<type::vector<float> >*>(this->findData("temperature"));
+    ASSERT_TRUE(temperature != nullptr);
+    ASSERT_EQ(temperature->getValue().size(), nbPoints);
+    EXPECT_EQ(temperature->getValue().back(), (nbPoints - 1) * 0.5f);
+
+    std::filesystem::remove(filename);
+}
+
 TEST_F(MeshVTKLoaderTest, loadInvalidFilenames)
 {
     EXPECT_MSG_EMIT(Error) ;
@@ -33,56 +33,59 @@ namespace sofa::component::loader::basevtkreader
 
 
 BaseVTKReader::BaseVTKReader(): inputPoints (nullptr), inputNormals (nullptr), inputPolygons(nullptr), inputCells(nullptr),
-    inputCellOffsets(nullptr), inputCellTypes(nullptr),
+    inputCellOffsets(nullptr), inputCellTypes(nullptr), parallelParsing(false),
     numberOfPoints(0), numberOfCells(0)
 {}
 
 BaseVTKReader::BaseVTKDataIO* BaseVTKReader::newVTKDataIO(const string& typestr)
 {
+    BaseVTKDataIO* result = nullptr;
     if  (!strcasecmp(typestr.c_str(), "char") || !strcasecmp(typestr.c_str(), "Int8"))
     {
-        return new VTKDataIO<char>;
+        result = new VTKDataIO<char>;
     }
     else if (!strcasecmp(typestr.c_str(), "unsigned_char") || !strcasecmp(typestr.c_str(), "UInt8"))
     {
-        return new VTKDataIO<std::uint8_t>;
+        result = new VTKDataIO<std::uint8_t>;
     }
     else if (!strcasecmp(typestr.c_str(), "short") || !strcasecmp(typestr.c_str(), "Int16"))
     {
-        return new VTKDataIO<std::int16_t>;
+        result = new VTKDataIO<std::int16_t>;
     }
     else if (!strcasecmp(typestr.c_str(), "unsigned_short") || !strcasecmp(typestr.c_str(), "UInt16"))
     {
-        return new VTKDataIO<std::uint16_t>;
+        result = new VTKDataIO<std::uint16_t>;
     }
     else if (!strcasecmp(typestr.c_str(), "int") || !strcasecmp(typestr.c_str(), "Int32"))
     {
-        return new VTKDataIO<std::int32_t>;
+        result = new VTKDataIO<std::int32_t>;
     }
     else if (!strcasecmp(typestr.c_str(), "unsigned_int") || !strcasecmp(typestr.c_str(), "UInt32"))
     {
-        return new VTKDataIO<std::uint32_t>;
+        result = new VTKDataIO<std::uint32_t>;
     }
     else if (!strcasecmp(typestr.c_str(), "long") || !strcasecmp(typestr.c_str(), "Int64"))
     {
-        return new VTKDataIO<std::int64_t>;
+        result = new VTKDataIO<std::int64_t>;
     }
     else if (!strcasecmp(typestr.c_str(), "unsigned_long") || !strcasecmp(typestr.c_str(), "UInt64"))
     {
-        return new VTKDataIO<std::uint64_t>;
+        result = new VTKDataIO<std::uint64_t>;
     }
     else if (!strcasecmp(typestr.c_str(), "float") || !strcasecmp(typestr.c_str(), "Float32"))
     {
-        return new VTKDataIO<float>;
+        result = new VTKDataIO<float>;
     }
     else if (!strcasecmp(typestr.c_str(), "double") || !strcasecmp(typestr.c_str(), "Float64"))
     {
-        return new VTKDataIO<double>;
+        result = new VTKDataIO<double>;
     }
     else
     {
         return nullptr;
     }
+    result->parallelParsing = parallelParsing;
+    return result;
 }
 
 BaseVTKReader::BaseVTKDataIO* BaseVTKReader::newVTKDataIO(const string& typestr, int num)
@@ -275,6 +278,7 @@ BaseVTKReader::BaseVTKDataIO* BaseVTKReader::newVTKDataIO(const string& typestr,
         }
     }
     result->nestedDataSize = num;
+    result->parallelParsing = parallelParsing;
     return result;
 }
 
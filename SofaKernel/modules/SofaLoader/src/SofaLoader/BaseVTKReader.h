@@ -58,10 +58,15 @@ public:
         string name;
         int dataSize;
         int nestedDataSize;
-        BaseVTKDataIO() : dataSize(0), nestedDataSize(1) {}
+        /// Whether the ASCII values are parsed in parallel on the task scheduler
+        bool parallelParsing;
+        BaseVTKDataIO() : dataSize(0), nestedDataSize(1), parallelParsing(false) {}
         ~BaseVTKDataIO() override {}
         virtual void resize(int n) = 0;
         virtual bool read(istream& f, int n, int binary) = 0;
+        /// Read n values from the buffer [cursor, end) and move the cursor after them.
+        /// In ASCII, the rest of the line of the last value is skipped.
+        virtual bool read(const char*& cursor, const char* end, int n, int binary) = 0;
         virtual bool read(const string& s, int n, int binary) = 0;
         virtual bool read(const string& s, int binary) = 0;
         virtual bool write(ofstream& f, int n, int groups, int binary) = 0;
@@ -91,6 +96,7 @@ public:
         virtual bool read(const string& s, int n, int binary) override;
         virtual bool read(const string& s, int binary) override;
         virtual bool read(istream& in, int n, int binary) override;
+        virtual bool read(const char*& cursor, const char* end, int n, int binary) override;
         virtual bool write(ofstream& out, int n, int groups, int binary) override;
         BaseData* createSofaData() override ;
     };
@@ -107,6 +113,8 @@ public:
     type::vector<BaseVTKDataIO*> inputPointDataVector;
     type::vector<BaseVTKDataIO*> inputCellDataVector;
     bool isLittleEndian;
+    /// Whether the data created by newVTKDataIO parse their ASCII values in parallel
+    bool parallelParsing;
 
     int numberOfPoints, numberOfCells, numberOfLines;
 
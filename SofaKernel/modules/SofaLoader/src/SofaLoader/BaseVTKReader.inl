@@ -21,9 +21,15 @@
 ******************************************************************************/
 #pragma once
 #include <SofaLoader/BaseVTKReader.h>
+#include <sofa/helper/io/AsciiParser.h>
+#include <sofa/simulation/ParallelForEach.h>
 
+#include <algorithm>
+#include <cstring>
 #include <istream>
 #include <fstream>
+#include <numeric>
+#include <type_traits>
 
 namespace sofa::component::loader::basevtkreader
 {
@@ -31,6 +37,90 @@ namespace sofa::component::loader::basevtkreader
 using std::istringstream ;
 using sofa::type::Vec ;
 
+/// Values of a VTKDataIO, made of size numbers of type Scalar
+template<class T>
+struct AsciiValue
+{
+    using Scalar = T;
+    static constexpr std::size_t size = 1;
+};
+
+template<sofa::Size N, class V>
+struct AsciiValue<Vec<N, V> >
+{
+    using Scalar = V;
+    static constexpr std::size_t size = N;
+};
+
+/// Whether the values are parsed as numbers with helper::io::ascii, the characters types being read
+/// as characters (operator>>)
+template<class T>
+inline constexpr bool isAsciiNumber = std::is_arithmetic_v<typename AsciiValue<T>::Scalar>
+                                      && sizeof(typename AsciiValue<T>::Scalar) > 1;
+
+/**
+ * Parse count numbers from the block of numbers starting at cursor. The block is split in chunks
+ * of lines, whose numbers are counted then parsed, in parallel if requested. The cursor is moved
+ * to the line following the last value.
+ */
+template<class Scalar>
+bool readAsciiNumbers(const char*& cursor, const char* end, Scalar* values, std::size_t count, bool parallel)
+{
+    namespace ascii = sofa::helper::io::ascii;
+
+    if (count == 0)
+    {
+        return true;
+    }
+
+    const std::vector<const char*> boundaries = ascii::splitLines(cursor, ascii::findEndOfNumbers(cursor, end));
+    const std::size_t nbChunks = boundaries.size() - 1;
+    const auto forEachChunk = [parallel](std::size_t n, const auto& f)
+    {
+        if (parallel)
+        {
+            simulation::parallelForEach(std::size_t(0), n, f, 1);
+            return;
+        }
+        for (std::size_t c = 0; c < n; ++c)
+        {
+            f(c);
+        }
+    };
+
+    std::vector<std::size_t> firstValues(nbChunks + 1, 0);
+    forEachChunk(nbChunks, [&](std::size_t c)
+    {
+        firstValues[c + 1] = ascii::countTokens(boundaries[c], boundaries[c + 1]);
+    });
+    std::partial_sum(firstValues.begin(), firstValues.end(), firstValues.begin());
+    if (firstValues.back() < count)
+    {
+        return false;
+    }
+
+    const std::size_t lastChunk = std::upper_bound(firstValues.begin(), firstValues.end(), count - 1) - firstValues.begin() - 1;
+    std::vector<char> parsed(lastChunk + 1, 0);
+    const char* lastValueEnd = nullptr;
+    forEachChunk(lastChunk + 1, [&](std::size_t c)
+    {
+        const std::size_t chunkCount = std::min(firstValues[c + 1], count) - firstValues[c];
+        const char* chunkCursor = boundaries[c];
+        parsed[c] = ascii::readNumbers(chunkCursor, boundaries[c + 1], values + firstValues[c], chunkCount) == chunkCount;
+        if (c == lastChunk)
+        {
+            lastValueEnd = chunkCursor;
+        }
+    });
+
+    if (std::find(parsed.begin(), parsed.end(), 0) != parsed.end())
+    {
+        return false;
+    }
+    cursor = ascii::skipLine(lastValueEnd, end);
+    return true;
+}
+
 template<class T>
 const void* BaseVTKReader::VTKDataIO<T>::getData()
 {
@@ -157,6 +247,55 @@ bool BaseVTKReader::VTKDataIO<T>::read(istream& in, int n, int binary)
     return true;
 }
 
+template<class T>
+bool BaseVTKReader::VTKDataIO<T>::read(const char*& cursor, const char* end, int n, int binary)
+{
+    resize(n);
+    if (binary)
+    {
+        const std::size_t size = std::size_t(n) * sizeof(T);
+        if (std::size_t(end - cursor) < size)
+        {
+            resize(0);
+            return false;
+        }
+        std::memcpy((void*)data, cursor, size);
+        cursor += size;
+        if (binary == 2) // swap bytes
+        {
+            for (int i=0; i<n; ++i)
+            {
+                data[i] = swapT(data[i], nestedDataSize);
+            }
+        }
+    }
+    else if constexpr (isAsciiNumber<T>)
+    {
+        using Scalar = typename AsciiValue<T>::Scalar;
+        if (!readAsciiNumbers(cursor, end, reinterpret_cast<Scalar*>(data), std::size_t(n) * AsciiValue<T>::size, this->parallelParsing))
+        {
+            resize(0);
+            return false;
+        }
+    }
+    else
+    {
+        int i = 0;
+        while (i < n && cursor != end)
+        {
+            istringstream ln(string(sofa::helper::io::ascii::readLine(cursor, end)));
+            while (i < n && ln >> data[i])
+                ++i;
+        }
+        if (i < n)
+        {
+            resize(0);
+            return false;
+        }
+    }
+    return true;
+}
+
 template<class T>
 bool BaseVTKReader::VTKDataIO<T>::write(ofstream& out, int n, int groups, int binary)
 {
@@ -25,7 +25,13 @@
 #include <sofa/helper/system/SetDirectory.h>
 #include <fstream>
 #include <sofa/helper/accessor.h>
+#include <sofa/helper/io/AsciiParser.h>
+#include <sofa/helper/io/MappedFile.h>
 #include <sofa/helper/system/Locale.h>
+#include <sofa/simulation/ParallelForEach.h>
+
+#include <array>
+#include <cstring>
 
 namespace sofa::component::loader
 {
@@ -55,6 +61,7 @@ MeshObjLoader::MeshObjLoader()
     , d_computeMaterialFaces(initData(&d_computeMaterialFaces, false, "computeMaterialFaces", "True to activate export of Data instances containing list of face indices for each material"))
     , d_vertPosIdx      (initData   (&d_vertPosIdx, "vertPosIdx", "If vertices have multiple normals/texcoords stores vertices position indices"))
     , d_vertNormIdx     (initData   (&d_vertNormIdx, "vertNormIdx", "If vertices have multiple normals/texcoords stores vertices normal indices"))
+    , d_parallelParsing(initData(&d_parallelParsing, false, "parallelParsing", "Parse the file in parallel on the task scheduler, which is initialized if needed"))
 {
     addAlias(&d_material, "material");
 
@@ -86,23 +93,28 @@ bool MeshObjLoader::doLoad()
 {
     dmsg_info() << "Loading OBJ file: " << d_filename;
 
-    bool fileRead = false;
-
     // -- Loading file
     const char* filename = d_filename.getFullPath().c_str();
-    std::ifstream file(filename);
+    helper::io::MappedFile file;
 
-    if (!file.good())
+    if (!file.open(filename))
     {
         msg_error() << "Cannot read file '" << d_filename << "'.";
         return false;
     }
 
-    // -- Reading file
-    fileRead = readOBJ (file,filename);
-    file.close();
+    if (d_parallelParsing.getValue())
+    {
+        auto* taskScheduler = simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 1)
+        {
+            taskScheduler->init(0);
+            msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+        }
+    }
 
-    return fileRead;
+    // -- Reading file
+    return readOBJ(file.data(), file.data() + file.size(), filename);
 }
 
 ///
@@ -145,7 +157,147 @@ void MeshObjLoader::addGroup (const PrimitiveGroup& g)
     }
 }
 
-bool MeshObjLoader::readOBJ (std::ifstream &file, const char* filename)
+namespace
+{
+
+namespace ascii = sofa::helper::io::ascii;
+
+/// A mtllib, usemtl or g statement, replayed in order with the faces when the chunks are merged
+struct ObjStatement
+{
+    std::size_t face; ///< number of faces of the chunk before the statement
+    std::string keyword;
+    std::vector<std::string> arguments;
+};
+
+/// Content of a chunk of lines of an OBJ file
+struct ObjChunk
+{
+    type::vector<Vector3> positions;
+    type::vector<Vector3> normals;
+    type::vector<Vector2> texCoords;
+
+    /// Indices (position, texcoord, normal) of the corners of the faces, which are stored
+    /// between faceOffsets[f] and faceOffsets[f+1]
+    std::vector<std::array<int, 3> > corners;
+    std::vector<std::size_t> faceOffsets {0};
+
+    /// Corners and components whose index is relative to the end of the previous chunk
+    std::vector<std::pair<std::size_t, int> > relativeIndices;
+
+    std::vector<ObjStatement> statements;
+    std::vector<std::string> invalidIndices;
+
+    std::size_t nbFaces() const { return faceOffsets.size() - 1; }
+};
+
+/// Parse a face corner v, v/t, v//n or v/t/n. The indices are 0-based, -1 when missing or invalid.
+void parseObjCorner(const char* cursor, const char* end, ObjChunk& chunk)
+{
+    std::array<int, 3> corner {-1, -1, -1};
+    const std::size_t counts[3] = { chunk.positions.size(), chunk.texCoords.size(), chunk.normals.size() };
+
+    for (int j = 0; j < 3 && cursor != end; ++j)
+    {
+        const char* slash = static_cast<const char*>(std::memchr(cursor, '/', std::size_t(end - cursor)));
+        const char* last = slash ? slash : end;
+        if (last != cursor)
+        {
+            int index = 0;
+            const char* first = cursor;
+            if (!ascii::readNumber(first, last, index))
+            {
+                index = 0;
+            }
+
+            if (index >= 1)
+            {
+                corner[j] = index - 1; // -1 because the numerotation begins at 1 and a vector begins at 0
+            }
+            else if (index < 0)
+            {
+                corner[j] = index + int(counts[j]);
+                chunk.relativeIndices.emplace_back(chunk.corners.size(), j);
+            }
+            else
+            {
+                chunk.invalidIndices.emplace_back(cursor, last);
+            }
+        }
+        cursor = slash ? slash + 1 : end;
+    }
+
+    chunk.corners.push_back(corner);
+}
+
+void parseObjChunk(const char* cursor, const char* end, ObjChunk& chunk)
+{
+    while (cursor != end)
+    {
+        const char* lineEnd = ascii::findEndOfLine(cursor, end);
+        const std::string_view keyword = ascii::readToken(cursor, lineEnd);
+
+        if (keyword == "v")
+        {
+            Vector3 position;
+            ascii::readNumbers(cursor, lineEnd, position.ptr(), 3);
+            chunk.positions.push_back(position);
+        }
+        else if (keyword == "vn")
+        {
+            Vector3 normal;
+            ascii::readNumbers(cursor, lineEnd, normal.ptr(), 3);
+            chunk.normals.push_back(normal);
+        }
+        else if (keyword == "vt")
+        {
+            Vector2 texCoord;
+            ascii::readNumbers(cursor, lineEnd, texCoord.ptr(), 2);
+            chunk.texCoords.push_back(texCoord);
+        }
+        else if (keyword == "f" || keyword == "l")
+        {
+            for (std::string_view corner = ascii::readToken(cursor, lineEnd); !corner.empty();
+                 corner = ascii::readToken(cursor, lineEnd))
+            {
+                parseObjCorner(corner.data(), corner.data() + corner.size(), chunk);
+            }
+            chunk.faceOffsets.push_back(chunk.corners.size());
+        }
+        else if (keyword == "mtllib" || keyword == "usemtl" || keyword == "g")
+        {
+            ObjStatement statement { chunk.nbFaces(), std::string(keyword), {} };
+            for (std::string_view argument = ascii::readToken(cursor, lineEnd); !argument.empty();
+                 argument = ascii::readToken(cursor, lineEnd))
+            {
+                statement.arguments.emplace_back(argument);
+            }
+            chunk.statements.push_back(std::move(statement));
+        }
+
+        cursor = lineEnd == end ? end : lineEnd + 1;
+    }
+}
+
+
+/// Call f(c) for each chunk c in [0, nbChunks): on the task scheduler if the parsing is parallel, inline otherwise
+template<class Function>
+void forEachChunk(std::size_t nbChunks, bool parallel, const Function& f)
+{
+    if (parallel)
+    {
+        simulation::parallelForEach(std::size_t(0), nbChunks, f, 1);
+        return;
+    }
+    for (std::size_t c = 0; c < nbChunks; ++c)
+    {
+        f(c);
+    }
+}
+
+} // namespace
+
+bool MeshObjLoader::readOBJ (const char* begin, const char* end, const char* filename)
 {
     // Make sure that fscanf() uses a dot '.' as the decimal separator.
     sofa::helper::system::TemporaryLocale locale(LC_NUMERIC, "C");
@@ -160,7 +312,6 @@ bool MeshObjLoader::readOBJ (std::ifstream &file, const char* filename)
     auto my_faceList = getWriteOnlyAccessor(d_faceList);
     auto my_normalsList = getWriteOnlyAccessor(d_normalsIndexList);
     auto my_texturesList  = getWriteOnlyAccessor(d_texIndexList);
-    type::vector<int> nodes, nIndices, tIndices;
 
     auto my_edges = getWriteOnlyAccessor(d_edges);
     auto my_triangles = getWriteOnlyAccessor(d_triangles);
@@ -183,8 +334,64 @@ bool MeshObjLoader::readOBJ (std::ifstream &file, const char* filename)
     getWriteOnlyAccessor(d_trianglesGroups).clear();
     getWriteOnlyAccessor(d_quadsGroups).clear();
 
-    int vtn[3];
-    Vector3 result;
+    // The chunks of lines are parsed independently, possibly in parallel, then merged in the
+    // order of the file: the result does not depend on the number of threads.
+    const std::vector<const char*> boundaries = ascii::splitLines(begin, end);
+    std::vector<ObjChunk> chunks(boundaries.size() - 1);
+    forEachChunk(chunks.size(), d_parallelParsing.getValue(), [&](std::size_t c)
+    {
+        parseObjChunk(boundaries[c], boundaries[c + 1], chunks[c]);
+    });
+
+    // first elements of each chunk in the merged arrays
+    std::vector<std::array<std::size_t, 4> > chunkStarts(chunks.size() + 1, {0, 0, 0, 0}); // positions, texcoords, normals, faces
+    for (std::size_t c = 0; c < chunks.size(); ++c)
+    {
+        chunkStarts[c + 1][0] = chunkStarts[c][0] + chunks[c].positions.size();
+        chunkStarts[c + 1][1] = chunkStarts[c][1] + chunks[c].texCoords.size();
+        chunkStarts[c + 1][2] = chunkStarts[c][2] + chunks[c].normals.size();
+        chunkStarts[c + 1][3] = chunkStarts[c][3] + chunks[c].nbFaces();
+
+        for (const std::string& index : chunks[c].invalidIndices)
+        {
+            msg_error() << "Invalid index " << index;
+        }
+    }
+
+    my_positions.resize(chunkStarts.back()[0]);
+    my_texCoords.resize(chunkStarts.back()[1]);
+    my_normals.resize(chunkStarts.back()[2]);
+    my_faceList->resize(chunkStarts.back()[3]);
+    my_normalsList->resize(chunkStarts.back()[3]);
+    my_texturesList->resize(chunkStarts.back()[3]);
+
+    forEachChunk(chunks.size(), d_parallelParsing.getValue(), [&](std::size_t c)
+    {
+        ObjChunk& chunk = chunks[c];
+        const auto& start = chunkStarts[c];
+        std::copy(chunk.positions.begin(), chunk.positions.end(), my_positions.begin() + start[0]);
+        std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), my_texCoords.begin() + start[1]);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), my_normals.begin() + start[2]);
+
+        for (const auto& [corner, j] : chunk.relativeIndices)
+        {
+            chunk.corners[corner][j] += int(start[j]);
+        }
+
+        for (std::size_t f = 0; f < chunk.nbFaces(); ++f)
+        {
+            type::SVector<int>& nodes = (*my_faceList)[start[3] + f];
+            type::SVector<int>& nIndices = (*my_normalsList)[start[3] + f];
+            type::SVector<int>& tIndices = (*my_texturesList)[start[3] + f];
+            for (std::size_t i = chunk.faceOffsets[f]; i < chunk.faceOffsets[f + 1]; ++i)
+            {
+                nodes.push_back(chunk.corners[i][0]);
+                tIndices.push_back(chunk.corners[i][1]);
+                nIndices.push_back(chunk.corners[i][2]);
+            }
+        }
+    });
+
     helper::WriteOnlyAccessor<Data<type::vector< PrimitiveGroup> > > my_faceGroups[NBFACETYPE] =
     {
         d_edgesGroups,
@@ -196,171 +403,110 @@ bool MeshObjLoader::readOBJ (std::ifstream &file, const char* filename)
     int curMaterialId = -1;
     int nbFaces[NBFACETYPE] = {0}; // number of edges, triangles, quads
     int groupF0[NBFACETYPE] = {0}; // first primitives indices in current group for edges, triangles, quads
-    std::string line;
-    while( std::getline(file,line) )
-    {
-        if (line.empty()) continue;
-        std::istringstream values(line);
-        std::string token;
-        values >> token;
 
-        if (token == "#")
-        {
-            // comment
-        }
-        else if (token == "v")
-        {
-            // vertex
-            values >> result[0] >> result[1] >> result[2];
-            my_positions.push_back(Vector3(result[0],result[1], result[2]));
-        }
-        else if (token == "vn")
-        {
-            // normal
-            values >> result[0] >> result[1] >> result[2];
-            my_normals.push_back(Vector3(result[0],result[1], result[2]));
-        }
-        else if (token == "vt")
-        {
-            // texcoord
-            values >> result[0] >> result[1];
-            my_texCoords.push_back(Vector2(result[0],result[1]));
-        }
-        else if ((token == "mtllib") && d_loadMaterial.getValue())
+    const auto applyStatement = [&](const ObjStatement& statement)
+    {
+        if (statement.keyword == "mtllib")
         {
-            while (!values.eof())
+            if (d_loadMaterial.getValue())
             {
-                std::string materialLibaryName;
-                values >> materialLibaryName;
-                std::string mtlfile = sofa::helper::system::SetDirectory::GetRelativeFromFile(materialLibaryName.c_str(), filename);
-                this->readMTL(mtlfile.c_str(), my_materials.wref());
-            }
-        }
-        else if (token == "usemtl" || token == "g")
-        {
-            // end of current group
-            //curGroup.nbp = nbf - curGroup.p0;
-            for (int ft = 0; ft < NBFACETYPE; ++ft)
-                if (nbFaces[ft] > groupF0[ft])
+                for (const std::string& materialLibaryName : statement.arguments)
                 {
-                    my_faceGroups[ft].push_back(PrimitiveGroup(groupF0[ft], nbFaces[ft]-groupF0[ft], curMaterialName, curGroupName, curMaterialId));
-                    groupF0[ft] = nbFaces[ft];
+                    std::string mtlfile = sofa::helper::system::SetDirectory::GetRelativeFromFile(materialLibaryName.c_str(), filename);
+                    this->readMTL(mtlfile.c_str(), my_materials.wref());
                 }
-            if (token == "usemtl")
+            }
+            return;
+        }
+
+        // end of current group
+        for (int ft = 0; ft < NBFACETYPE; ++ft)
+            if (nbFaces[ft] > groupF0[ft])
             {
-                values >> curMaterialName;
-                curMaterialId = -1;
-                type::vector<Material>::iterator it = my_materials.begin();
-                type::vector<Material>::iterator itEnd = my_materials.end();
-                for (; it != itEnd; ++it)
-                {
-                    if (it->name == curMaterialName)
-                    {
-                        (*it).activated = true;
-                        if (!material->activated)
-                            material.wref() = *it;
-                        curMaterialId = int(it - my_materials.begin());
-                        break;
-                    }
-                }
+                my_faceGroups[ft].push_back(PrimitiveGroup(groupF0[ft], nbFaces[ft]-groupF0[ft], curMaterialName, curGroupName, curMaterialId));
+                groupF0[ft] = nbFaces[ft];
             }
-            else if (token == "g")
+        if (statement.keyword == "usemtl")
+        {
+            if (!statement.arguments.empty())
+                curMaterialName = statement.arguments.front();
+            curMaterialId = -1;
+            type::vector<Material>::iterator it = my_materials.begin();
+            type::vector<Material>::iterator itEnd = my_materials.end();
+            for (; it != itEnd; ++it)
             {
-                curGroupName.clear();
-                while (!values.eof())
+                if (it->name == curMaterialName)
                 {
-                    std::string g;
-                    values >> g;
-                    if (!curGroupName.empty())
-                        curGroupName += " ";
-                    curGroupName += g;
+                    (*it).activated = true;
+                    if (!material->activated)
+                        material.wref() = *it;
+                    curMaterialId = int(it - my_materials.begin());
+                    break;
                 }
             }
         }
-        else if (token == "l" || token == "f")
+        else // g
         {
-            // face
-            nodes.clear();
-            nIndices.clear();
-            tIndices.clear();
-
-            while (!values.eof())
+            curGroupName.clear();
+            for (const std::string& g : statement.arguments)
             {
-                std::string face;
-                values >> face;
-                if (face.empty()) continue;
-                for (int j = 0; j < 3; j++)
-                {
-                    vtn[j] = -1;
-                    std::string::size_type pos = face.find('/');
-                    std::string tmp = face.substr(0, pos);
-                    if (pos == std::string::npos)
-                        face = "";
-                    else
-                    {
-                        face = face.substr(pos + 1);
-                    }
-
-                    if (!tmp.empty())
-                    {
-                        vtn[j] = atoi(tmp.c_str());
-                        if (vtn[j] >= 1)
-                            vtn[j] -=1; // -1 because the numerotation begins at 1 and a vector begins at 0
-                        else if (vtn[j] < 0)
-                            vtn[j] += (j==0) ? sofa::Size(my_positions.size()) : (j==1) ? sofa::Size(my_texCoords.size()) : sofa::Size(my_normals.size());
-                        else
-                        {
-                            msg_error() << "Invalid index " << tmp;
-                            vtn[j] = -1;
-                        }
-                    }
-                }
-
-                nodes.push_back(vtn[0]);
-                tIndices.push_back(vtn[1]);
-                nIndices.push_back(vtn[2]);
+                if (!curGroupName.empty())
+                    curGroupName += " ";
+                curGroupName += g;
             }
+        }
+    };
 
-            my_faceList->push_back(nodes);
-            my_normalsList->push_back(nIndices);
-            my_texturesList->push_back(tIndices);
-
-            if (nodes.size() == 2) // Edge
+    const auto addFace = [&](const type::SVector<int>& nodes)
+    {
+        if (nodes.size() == 2) // Edge
+        {
+            if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
             {
-                if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
-                {
-                    if (nodes[0]<nodes[1])
-                        addEdge(my_edges.wref(), Edge(nodes[0], nodes[1]));
-                    else
-                        addEdge(my_edges.wref(), Edge(nodes[1], nodes[0]));
-                }
-                ++nbFaces[MeshObjLoader::EDGE];
-                faceType = MeshObjLoader::EDGE;
+                if (nodes[0]<nodes[1])
+                    addEdge(my_edges.wref(), Edge(nodes[0], nodes[1]));
+                else
+                    addEdge(my_edges.wref(), Edge(nodes[1], nodes[0]));
             }
-            else if (nodes.size()==4 && !this->d_triangulate.getValue()) // Quad
+            ++nbFaces[MeshObjLoader::EDGE];
+            faceType = MeshObjLoader::EDGE;
+        }
+        else if (nodes.size()==4 && !this->d_triangulate.getValue()) // Quad
+        {
+            if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
             {
-                if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
-                {
-                    addQuad(my_quads.wref(), Quad(nodes[0], nodes[1], nodes[2], nodes[3]));
-                }
-                ++nbFaces[MeshObjLoader::QUAD];
-                faceType = MeshObjLoader::QUAD;
+                addQuad(my_quads.wref(), Quad(nodes[0], nodes[1], nodes[2], nodes[3]));
             }
-            else // Triangulate
+            ++nbFaces[MeshObjLoader::QUAD];
+            faceType = MeshObjLoader::QUAD;
+        }
+        else // Triangulate
+        {
+            if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
             {
-                if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
-                {
-                    for (size_t j=2; j<nodes.size(); j++)
-                        addTriangle(my_triangles.wref(), Triangle(nodes[0], nodes[j-1], nodes[j]));
-                }
-                ++nbFaces[MeshObjLoader::TRIANGLE];
-                faceType = MeshObjLoader::TRIANGLE;
+                for (size_t j=2; j<nodes.size(); j++)
+                    addTriangle(my_triangles.wref(), Triangle(nodes[0], nodes[j-1], nodes[j]));
             }
-
+            ++nbFaces[MeshObjLoader::TRIANGLE];
+            faceType = MeshObjLoader::TRIANGLE;
         }
-        else
-        {
+    };
 
+    // replay the statements and the faces in the order of the file
+    for (std::size_t c = 0; c < chunks.size(); ++c)
+    {
+        const ObjChunk& chunk = chunks[c];
+        auto statement = chunk.statements.begin();
+        for (std::size_t f = 0; f <= chunk.nbFaces(); ++f)
+        {
+            for (; statement != chunk.statements.end() && statement->face == f; ++statement)
+            {
+                applyStatement(*statement);
+            }
+            if (f < chunk.nbFaces())
+            {
+                addFace((*my_faceList)[chunkStarts[c][3] + f]);
+            }
         }
     }
 
@@ -44,7 +44,9 @@ public:
     bool doLoad() override;
 
 protected:
-    bool readOBJ (std::ifstream &file, const char* filename);
+    /// Parse the content of the file [begin, end). The file is split in chunks of lines which are
+    /// parsed in parallel, then merged in the order of the file.
+    bool readOBJ (const char* begin, const char* end, const char* filename);
     bool readMTL (const char* filename, type::vector<sofa::type::Material>& d_materials);
     void addGroup (const sofa::core::loader::PrimitiveGroup& g);
     void doClearBuffers() override;
@@ -76,6 +78,8 @@ public:
     /// If it is empty then each vertex correspond to one normal
     Data< type::vector<int> > d_vertNormIdx;
 
+    Data<bool> d_parallelParsing; ///< parse the file in parallel on the task scheduler
+
     virtual std::string type() { return "The format of this mesh is OBJ."; }
 };
 
@@ -27,6 +27,8 @@
 
 #include <sofa/core/ObjectFactory.h>
 #include <sofa/core/visual/VisualParams.h>
+#include <sofa/helper/io/AsciiParser.h>
+#include <sofa/helper/io/MappedFile.h>
 
 #include <SofaLoader/BaseVTKReader.h>
 using sofa::component::loader::BaseVTKReader ;
@@ -57,6 +59,7 @@ using std::istream;
 using std::ofstream;
 using std::string;
 using type::vector;
+namespace ascii = sofa::helper::io::ascii;
 
 class LegacyVTKReader : public BaseVTKReader
 {
@@ -83,6 +86,7 @@ protected:
 ////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////// MeshVTKLoader IMPLEMENTATION //////////////////////////////////
 MeshVTKLoader::MeshVTKLoader() : MeshLoader()
+  , d_parallelParsing(initData(&d_parallelParsing, false, "parallelParsing", "Parse the ASCII blocks of legacy files in parallel on the task scheduler, which is initialized if needed"))
   , reader(nullptr)
 {
 }
@@ -156,12 +160,23 @@ bool MeshVTKLoader::doLoad()
         return false;
     }
 
+    if (d_parallelParsing.getValue())
+    {
+        auto* taskScheduler = simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 1)
+        {
+            taskScheduler->init(0);
+            msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+        }
+    }
+
     // -- Reading file
     if(!canLoad())
     {
         return false;
     }
 
+    reader->parallelParsing = d_parallelParsing.getValue();
     fileRead = reader->readVTK (filename);
     this->setInputsMesh();
     this->setInputsData();
@@ -561,16 +576,23 @@ void MeshVTKLoader::doClearBuffers()
 //Legacy VTK Loader
 bool LegacyVTKReader::readFile(const char* filename)
 {
-    std::ifstream inVTKFile(filename, std::ifstream::in | std::ifstream::binary);
-    if( !inVTKFile.is_open() )
+    helper::io::MappedFile inVTKFile;
+    if( !inVTKFile.open(filename) )
     {
         return false;
     }
 
+    const char* cursor = inVTKFile.data();
+    const char* end = inVTKFile.data() + inVTKFile.size();
+    const auto nextLine = [&cursor, end](string& line)
+    {
+        line = ascii::readLine(cursor, end);
+    };
+
     string line;
 
     // Part 1
-    std::getline(inVTKFile, line);
+    nextLine(line);
     if (string(line, 0, 23) != "# vtk DataFile Version ")
     {
         msg_error() << "Error: Unrecognized header in file '" << filename << "'." ;
@@ -580,10 +602,10 @@ bool LegacyVTKReader::readFile(const char* filename)
 
     // Part 2
     string header;
-    std::getline(inVTKFile, header);
+    nextLine(header);
 
     // Part 3
-    std::getline(inVTKFile, line);
+    nextLine(line);
 
     int binary;
     if (line == "BINARY" || line == "BINARY\r" )
@@ -609,9 +631,9 @@ bool LegacyVTKReader::readFile(const char* filename)
     // Part 4
     do
     {
-        std::getline(inVTKFile, line);
+        nextLine(line);
     }
-    while (line.empty());
+    while (cursor != end && line.empty());
     if (line != "DATASET POLYDATA" && line != "DATASET UNSTRUCTURED_GRID"
             && line != "DATASET POLYDATA\r" && line != "DATASET UNSTRUCTURED_GRID\r" )
     {
@@ -625,13 +647,13 @@ bool LegacyVTKReader::readFile(const char* filename)
     VTKDataIO<int>* inputCellTypesInt = nullptr;
     inputCellOffsets = nullptr;
 
-    while(!inVTKFile.eof())
+    while(cursor != end)
     {
         do
         {
-            std::getline(inVTKFile, line);
+            nextLine(line);
         }
-        while (!inVTKFile.eof() && line.empty());
+        while (cursor != end && line.empty());
 
         istringstream ln(line);
         string kw;
@@ -647,7 +669,7 @@ bool LegacyVTKReader::readFile(const char* filename)
             {
                 return false;
             }
-            if (!inputPoints->read(inVTKFile, 3 * n, binary))
+            if (!inputPoints->read(cursor, end, 3 * n, binary))
             {
                 return false;
             }
@@ -660,7 +682,7 @@ bool LegacyVTKReader::readFile(const char* filename)
             msg_info() << n << " polygons ( " << (ni - 3 * n) << " triangles )" ;
             inputPolygons = new VTKDataIO<int>;
             inputPolygonsInt = dynamic_cast<VTKDataIO<int>* > (inputPolygons);
-            if (!inputPolygons->read(inVTKFile, ni, binary))
+            if (!inputPolygons->read(cursor, end, ni, binary))
             {
                 return false;
             }
@@ -672,7 +694,7 @@ bool LegacyVTKReader::readFile(const char* filename)
             msg_info() << "Found " << n << " cells" ;
             inputCells = new VTKDataIO<int>;
             inputCellsInt = dynamic_cast<VTKDataIO<int>* > (inputCells);
-            if (!inputCells->read(inVTKFile, ni, binary))
+            if (!inputCells->read(cursor, end, ni, binary))
             {
                 return false;
             }
@@ -685,7 +707,7 @@ bool LegacyVTKReader::readFile(const char* filename)
             msg_info() << "Found " << n << " lines" ;
             inputCells = new VTKDataIO<int>;
             inputCellsInt = dynamic_cast<VTKDataIO<int>* > (inputCellsInt);
-            if (!inputCells->read(inVTKFile, ni, binary))
+            if (!inputCells->read(cursor, end, ni, binary))
             {
                 return false;
             }
@@ -705,7 +727,7 @@ bool LegacyVTKReader::readFile(const char* filename)
             ln >> n;
             inputCellTypes = new VTKDataIO<int>;
             inputCellTypesInt = dynamic_cast<VTKDataIO<int>* > (inputCellTypes);
-            if (!inputCellTypes->read(inVTKFile, n, binary))
+            if (!inputCellTypes->read(cursor, end, n, binary))
             {
                 return false;
             }
@@ -716,15 +738,15 @@ bool LegacyVTKReader::readFile(const char* filename)
             type::vector<BaseVTKDataIO*>& inputDataVector = cellData ? inputCellDataVector : inputPointDataVector;
             int nb_ele;
             ln >> nb_ele;
-            while (!inVTKFile.eof())
+            while (cursor != end)
             {
-                std::ifstream::pos_type previousPos = inVTKFile.tellg();
+                const char* previousPos = cursor;
                 /// line defines the type and name such as SCALAR dataset
                 do
                 {
-                    std::getline(inVTKFile, line);
+                    nextLine(line);
                 }
-                while (!inVTKFile.eof() && line.empty());
+                while (cursor != end && line.empty());
 
                 if (line.empty())
                 {
@@ -745,10 +767,10 @@ bool LegacyVTKReader::readFile(const char* filename)
                     {
                         {
                             // skip lookup_table if present
-                            const std::ifstream::pos_type positionBeforeLookupTable = inVTKFile.tellg();
+                            const char* positionBeforeLookupTable = cursor;
                             std::string lookupTable;
                             std::string lookupTableName;
-                            std::getline(inVTKFile, line);
+                            nextLine(line);
                             istringstream lnDataLookup(line);
                             lnDataLookup >> lookupTable >> lookupTableName;
                             if (lookupTable == "LOOKUP_TABLE")
@@ -757,10 +779,10 @@ bool LegacyVTKReader::readFile(const char* filename)
                             }
                             else
                             {
-                                inVTKFile.seekg(positionBeforeLookupTable);
+                                cursor = positionBeforeLookupTable;
                             }
                         }
-                        if (data->read(inVTKFile, nb_ele, binary))
+                        if (data->read(cursor, end, nb_ele, binary))
                         {
                             inputDataVector.push_back(data);
                             data->name = dataName;
@@ -790,7 +812,7 @@ bool LegacyVTKReader::readFile(const char* filename)
                     {
                         return false;
                     }
-                    if (!inputNormals->read(inVTKFile, 3 * nb_ele, binary))
+                    if (!inputNormals->read(cursor, end, 3 * nb_ele, binary))
                     {
                         return false;
                     }
@@ -802,7 +824,7 @@ bool LegacyVTKReader::readFile(const char* filename)
                     BaseVTKDataIO*  data = newVTKDataIO(dataType, 3);
                     if (data != nullptr)
                     {
-                        if (data->read(inVTKFile, nb_ele, binary))
+                        if (data->read(cursor, end, nb_ele, binary))
                         {
                             inputDataVector.push_back(data);
                             data->name = dataName;
@@ -831,9 +853,9 @@ bool LegacyVTKReader::readFile(const char* filename)
                     {
                         do
                         {
-                            std::getline(inVTKFile, line);
+                            nextLine(line);
                         }
-                        while (line.empty());
+                        while (cursor != end && line.empty());
                         istringstream lnData(line);
                         std::string dataName;
                         int nbData;
@@ -844,7 +866,7 @@ bool LegacyVTKReader::readFile(const char* filename)
                         BaseVTKDataIO*  data = newVTKDataIO(dataType, nbComponents);
                         if (data != nullptr)
                         {
-                            if (data->read(inVTKFile, nbData, binary))
+                            if (data->read(cursor, end, nbData, binary))
                             {
                                 inputDataVector.push_back(data);
                                 data->name = dataName;
@@ -866,7 +888,7 @@ bool LegacyVTKReader::readFile(const char* filename)
                         BaseVTKDataIO* data = newVTKDataIO("UInt8", 4); // in the binary case there will be 4 unsigned chars per table entry
                         if (data)
                         {
-                            data->read(inVTKFile, nb_ele, binary);
+                            data->read(cursor, end, nb_ele, binary);
                         }
                         delete data;
                     }
@@ -875,14 +897,14 @@ bool LegacyVTKReader::readFile(const char* filename)
                         BaseVTKDataIO* data = newVTKDataIO("Float32", 4);
                         if (data)
                         {
-                            data->read(inVTKFile, nb_ele, binary);    // in the ascii case there will be 4 float32 per table entry
+                            data->read(cursor, end, nb_ele, binary);    // in the ascii case there will be 4 float32 per table entry
                         }
                         delete data;
                     }
                 }
                 else     /// TODO
                 {
-                    inVTKFile.seekg(previousPos);
+                    cursor = previousPos;
                     break;
                 }
             }
@@ -50,6 +50,8 @@ public:
     core::objectmodel::BaseData* tetrasData;
     core::objectmodel::BaseData* hexasData;
 
+    Data<bool> d_parallelParsing; ///< parse the ASCII blocks of legacy files in parallel on the task scheduler
+
     bool doLoad() override;
 
 protected:
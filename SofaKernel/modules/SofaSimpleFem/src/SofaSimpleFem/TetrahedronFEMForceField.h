@@ -32,6 +32,8 @@
 
 #include <sofa/helper/ColorMap.h>
 
+#include <tuple>
+
 // corotational tetrahedron from
 // @InProceedings{NPF05,
 //   author       = "Nesme, Matthieu and Payan, Yohan and Faure, Fran\c{c}ois",
@@ -314,6 +316,11 @@ protected:
             sofa::component::linearsolver::CompressedRowSparseMatrix<type::Mat<3,3,BlocReal>,  type::vector<type::Mat<3,3,BlocReal> >, type::vector<sofa::Index> > *crsmat,
             SReal k, unsigned int &offset);
 
+    /// Per-chunk buffers of the parallel assembly of addKToBlocMatrix, kept to reuse their memory between assemblies
+    template<class BlocReal>
+    using ChunkBuffers = type::vector< sofa::component::linearsolver::CompressedRowSparseMatrix<type::Mat<3,3,BlocReal>,  type::vector<type::Mat<3,3,BlocReal> >, type::vector<sofa::Index> > >;
+    std::tuple< ChunkBuffers<double>, ChunkBuffers<float> > chunkBuffers;
+
     void applyStiffnessCorotational( Vector& f, const Vector& x, Index i=0, Index a=0,Index b=1,Index c=2,Index d=3, SReal fact=1.0  );
 
     void handleTopologyChange() override { needUpdateTopology = true; }
@@ -27,6 +27,8 @@
 #include <SofaBaseTopology/GridTopology.h>
 #include <sofa/helper/decompose.h>
 #include <SofaBaseLinearSolver/CompressedRowSparseMatrix.h>
+#include <sofa/simulation/ParallelForEach.h>
+#include <sofa/simulation/TaskScheduler.h>
 #include <sofa/simulation/AnimateBeginEvent.h>
 #include <sofa/simulation/AnimateEndEvent.h>
 
@@ -2005,55 +2007,80 @@ void TetrahedronFEMForceField<DataTypes>::addKToBlocMatrix(
         sofa::component::linearsolver::CompressedRowSparseMatrix<type::Mat<3,3,BlocReal>,  type::vector<type::Mat<3,3,BlocReal> >, type::vector<sofa::Index> > *crsmat,
         SReal k, unsigned int &offset)
 {
-    int IT;
-    typename VecElement::const_iterator it;
-    StiffnessMatrix JKJt,tmp;
+    using Matrix = sofa::component::linearsolver::CompressedRowSparseMatrix<type::Mat<3,3,BlocReal>,  type::vector<type::Mat<3,3,BlocReal> >, type::vector<sofa::Index> >;
 
-    int offd3 = offset/3;
-
-    Transformation Rot;
-    Rot.identity(); //set the transformation to identity
+    const int offd3 = offset/3;
 
-    for(it = _indexedElements->begin(), IT=0 ; it != _indexedElements->end() ; ++it,++IT)
+    const auto addElements = [this, k, offd3](Matrix* mat, std::size_t begin, std::size_t end)
     {
-        if (method == SMALL) computeStiffnessMatrix(JKJt,tmp,materialsStiffnesses[IT], strainDisplacements[IT],Rot);
-        else computeStiffnessMatrix(JKJt,tmp,materialsStiffnesses[IT], strainDisplacements[IT],rotations[IT]);
+        StiffnessMatrix JKJt,tmp;
 
-        type::Mat<3,3,double> tmpBlock[4][4];
-        // find index of node 1
-        for (int n1=0; n1<4; n1++)
+        Transformation Rot;
+        Rot.identity(); //set the transformation to identity
+
+        for (std::size_t IT = begin; IT < end; ++IT)
         {
-            for(int i=0; i<3; i++)
+            const Element& element = (*_indexedElements)[IT];
+            if (method == SMALL) computeStiffnessMatrix(JKJt,tmp,materialsStiffnesses[IT], strainDisplacements[IT],Rot);
+            else computeStiffnessMatrix(JKJt,tmp,materialsStiffnesses[IT], strainDisplacements[IT],rotations[IT]);
+
+            type::Mat<3,3,double> tmpBlock[4][4];
+            // find index of node 1
+            for (int n1=0; n1<4; n1++)
             {
-                for (int n2=0; n2<4; n2++)
+                for(int i=0; i<3; i++)
                 {
-                    for (int j=0; j<3; j++)
+                    for (int n2=0; n2<4; n2++)
                     {
-                        tmpBlock[n1][n2][i][j] = - tmp[n1*3+i][n2*3+j]*k;
+                        for (int j=0; j<3; j++)
+                        {
+                            tmpBlock[n1][n2][i][j] = - tmp[n1*3+i][n2*3+j]*k;
+                        }
                     }
                 }
             }
+            for (int n1=0; n1<4; n1++)
+            {
+                for (int n2=0; n2<4; n2++)
+                {
+                    *mat->wbloc(offd3 + element[n1], offd3 + element[n2],true) += tmpBlock[n1][n2];
+                }
+            }
         }
-        *crsmat->wbloc(offd3 + (*it)[0], offd3 + (*it)[0],true) += tmpBlock[0][0];
-        *crsmat->wbloc(offd3 + (*it)[0], offd3 + (*it)[1],true) += tmpBlock[0][1];
-        *crsmat->wbloc(offd3 + (*it)[0], offd3 + (*it)[2],true) += tmpBlock[0][2];
-        *crsmat->wbloc(offd3 + (*it)[0], offd3 + (*it)[3],true) += tmpBlock[0][3];
-
-        *crsmat->wbloc(offd3 + (*it)[1], offd3 + (*it)[0],true) += tmpBlock[1][0];
-        *crsmat->wbloc(offd3 + (*it)[1], offd3 + (*it)[1],true) += tmpBlock[1][1];
-        *crsmat->wbloc(offd3 + (*it)[1], offd3 + (*it)[2],true) += tmpBlock[1][2];
-        *crsmat->wbloc(offd3 + (*it)[1], offd3 + (*it)[3],true) += tmpBlock[1][3];
-
-        *crsmat->wbloc(offd3 + (*it)[2], offd3 + (*it)[0],true) += tmpBlock[2][0];
-        *crsmat->wbloc(offd3 + (*it)[2], offd3 + (*it)[1],true) += tmpBlock[2][1];
-        *crsmat->wbloc(offd3 + (*it)[2], offd3 + (*it)[2],true) += tmpBlock[2][2];
-        *crsmat->wbloc(offd3 + (*it)[2], offd3 + (*it)[3],true) += tmpBlock[2][3];
-
-        *crsmat->wbloc(offd3 + (*it)[3], offd3 + (*it)[0],true) += tmpBlock[3][0];
-        *crsmat->wbloc(offd3 + (*it)[3], offd3 + (*it)[1],true) += tmpBlock[3][1];
-        *crsmat->wbloc(offd3 + (*it)[3], offd3 + (*it)[2],true) += tmpBlock[3][2];
-        *crsmat->wbloc(offd3 + (*it)[3], offd3 + (*it)[3],true) += tmpBlock[3][3];
+    };
+
+    const std::size_t nbElements = _indexedElements->size();
+    if (!crsmat->isAssemblyBuffer() || nbElements < 2)
+    {
+        addElements(crsmat, 0, nbElements);
+        return;
     }
+
+    // The matrix is an assembly buffer, so its assembly was requested to be parallel, and the task scheduler is initialized
+    const std::size_t nbThreads = std::max(1u, simulation::TaskScheduler::getInstance()->getThreadCount());
+    if (nbThreads < 2)
+    {
+        addElements(crsmat, 0, nbElements);
+        return;
+    }
+
+    // The elements are split in consecutive chunks assembled in parallel in their own buffers,
+    // which are appended to the matrix in the order of the elements
+    const std::size_t nbChunks = std::min(nbElements, 4 * nbThreads);
+    ChunkBuffers<BlocReal>& buffersOfChunks = std::get<ChunkBuffers<BlocReal> >(chunkBuffers);
+    buffersOfChunks.resize(nbChunks);
+    simulation::parallelForEach(std::size_t(0), nbChunks, [&](std::size_t c)
+    {
+        Matrix& buffer = buffersOfChunks[c];
+        buffer.setAssemblyBuffer(true);
+        buffer.resize(crsmat->rowSize(), crsmat->colSize());
+        addElements(&buffer, c * nbElements / nbChunks, (c + 1) * nbElements / nbChunks);
+    }, 1);
+
+    type::vector<const Matrix*> buffers;
+    for (const Matrix& buffer : buffersOfChunks)
+        buffers.push_back(&buffer);
+    crsmat->addBuffers(buffers);
 }
 
 template<class DataTypes>
@@ -0,0 +1,243 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+
+/**
+ * Micro-benchmark of the task schedulers registered in TaskScheduler.
+ *
+ * For each scheduler and thread count, it measures:
+ *  - the throughput of recursive fine-grained tasks (binary split of an integer range),
+ *  - the throughput of a flat batch of small tasks pushed by the main thread,
+ *  - the latency between the push of a task by the main thread and its start on a thief.
+ *
+ * Usage: SofaSimulationCore_bench [maxThreadCount] [repetitions]
+ */
+
+#include <sofa/simulation/CpuTask.h>
+#include <sofa/simulation/DefaultTaskScheduler.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/WorkStealingTaskScheduler.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using sofa::simulation::CpuTask;
+using sofa::simulation::Task;
+using sofa::simulation::TaskScheduler;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+
+// some work which cannot be optimized out
+std::uint64_t spin(std::uint64_t n)
+{
+    volatile std::uint64_t x = 0;
+    for (std::uint64_t i = 0; i < n; ++i)
+    {
+        x = x + i;
+    }
+    return x;
+}
+
+class RangeTask : public CpuTask
+{
+public:
+    RangeTask(std::int64_t first, std::int64_t last, std::atomic<std::uint64_t>* counter, CpuTask::Status* status)
+        : CpuTask(status), m_first(first), m_last(last), m_counter(counter)
+    {}
+
+    MemoryAlloc run() final
+    {
+        if (m_last - m_first <= 1)
+        {
+            spin(64);
+            m_counter->fetch_add(1, std::memory_order_relaxed);
+            return MemoryAlloc::Stack;
+        }
+
+        const std::int64_t mid = m_first + (m_last - m_first) / 2;
+        CpuTask::Status status;
+        RangeTask task0(m_first, mid, m_counter, &status);
+        RangeTask task1(mid, m_last, m_counter, &status);
+
+        TaskScheduler* scheduler = TaskScheduler::getInstance();
+        scheduler->addTask(&task0);
+        scheduler->addTask(&task1);
+        scheduler->workUntilDone(&status);
+        return MemoryAlloc::Stack;
+    }
+
+private:
+    const std::int64_t m_first;
+    const std::int64_t m_last;
+    std::atomic<std::uint64_t>* m_counter;
+};
+
+class StampedTask : public CpuTask
+{
+public:
+    StampedTask(std::thread::id owner, CpuTask::Status* status)
+        : CpuTask(status), m_owner(owner)
+    {}
+
+    void stampPush() { m_pushTime = Clock::now(); }
+
+    MemoryAlloc run() final
+    {
+        m_startTime = Clock::now();
+        m_stolen = (std::this_thread::get_id() != m_owner);
+        spin(256);
+        return MemoryAlloc::Stack;
+    }
+
+    bool isStolen() const { return m_stolen; }
+
+    double latencyInNs() const
+    {
+        return double(std::chrono::duration_cast<std::chrono::nanoseconds>(m_startTime - m_pushTime).count());
+    }
+
+private:
+    const std::thread::id m_owner;
+    Clock::time_point m_pushTime;
+    Clock::time_point m_startTime;
+    bool m_stolen { false };
+};
+
+struct Result
+{
+    double recursiveTasksPerSecond { 0 };
+    double flatTasksPerSecond { 0 };
+    double meanStealLatencyInNs { 0 };
+    double stolenRatio { 0 };
+};
+
+Result runBenchmark(const char* schedulerName, unsigned int nbThreads, int repetitions)
+{
+    TaskScheduler* scheduler = TaskScheduler::create(schedulerName);
+    scheduler->init(nbThreads);
+
+    Result result;
+
+    // recursive fine-grained tasks
+    {
+        const std::int64_t nbLeaves = 1 << 16;
+        double bestTime = 1e30;
+        for (int r = 0; r < repetitions; ++r)
+        {
+            std::atomic<std::uint64_t> counter(0);
+            CpuTask::Status status;
+            RangeTask root(0, nbLeaves, &counter, &status);
+
+            const auto begin = Clock::now();
+            scheduler->addTask(&root);
+            scheduler->workUntilDone(&status);
+            const std::chrono::duration<double> elapsed = Clock::now() - begin;
+            bestTime = std::min(bestTime, elapsed.count());
+        }
+        // a binary tree with n leaves has 2n-1 tasks
+        result.recursiveTasksPerSecond = double(2 * nbLeaves - 1) / bestTime;
+    }
+
+    // flat batch of tasks pushed by the main thread, also used to measure the steal latency
+    {
+        const std::size_t nbTasks = 4096;
+        double bestTime = 1e30;
+        double latencySum = 0;
+        std::size_t nbStolen = 0;
+        for (int r = 0; r < repetitions; ++r)
+        {
+            CpuTask::Status status;
+            std::vector<StampedTask> tasks(nbTasks, StampedTask(std::this_thread::get_id(), &status));
+
+            const auto begin = Clock::now();
+            for (auto& task : tasks)
+            {
+                task.stampPush();
+                scheduler->addTask(&task);
+            }
+            scheduler->workUntilDone(&status);
+            const std::chrono::duration<double> elapsed = Clock::now() - begin;
+            bestTime = std::min(bestTime, elapsed.count());
+
+            for (const auto& task : tasks)
+            {
+                if (task.isStolen())
+                {
+                    latencySum += task.latencyInNs();
+                    ++nbStolen;
+                }
+            }
+        }
+        result.flatTasksPerSecond = double(nbTasks) / bestTime;
+        result.meanStealLatencyInNs = nbStolen ? latencySum / double(nbStolen) : 0.0;
+        result.stolenRatio = double(nbStolen) / double(nbTasks * std::size_t(repetitions));
+    }
+
+    scheduler->stop();
+    return result;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    const unsigned int maxThreads = (argc > 1) ? unsigned(std::atoi(argv[1])) : std::max(1u, std::thread::hardware_concurrency());
+    const int repetitions = (argc > 2) ? std::atoi(argv[2]) : 10;
+
+    const char* schedulers[] = {
+        sofa::simulation::DefaultTaskScheduler::name(),
+        sofa::simulation::WorkStealingTaskScheduler::name()
+    };
+
+    std::cout << std::left
+              << std::setw(16) << "scheduler"
+              << std::setw(10) << "threads"
+              << std::setw(22) << "recursive tasks/s"
+              << std::setw(20) << "flat tasks/s"
+              << std::setw(22) << "steal latency (ns)"
+              << std::setw(12) << "stolen %" << std::endl;
+
+    for (unsigned int nbThreads = 1; nbThreads <= maxThreads; nbThreads *= 2)
+    {
+        for (const char* name : schedulers)
+        {
+            const Result result = runBenchmark(name, nbThreads, repetitions);
+            std::cout << std::left
+                      << std::setw(16) << name
+                      << std::setw(10) << nbThreads
+                      << std::setw(22) << std::fixed << std::setprecision(0) << result.recursiveTasksPerSecond
+                      << std::setw(20) << result.flatTasksPerSecond
+                      << std::setw(22) << result.meanStealLatencyInNs
+                      << std::setw(12) << std::setprecision(1) << 100.0 * result.stolenRatio << std::endl;
+        }
+    }
+
+    return 0;
+}
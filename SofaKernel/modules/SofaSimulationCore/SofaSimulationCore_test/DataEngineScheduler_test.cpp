@@ -0,0 +1,175 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/DataEngineScheduler.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/core/DataEngine.h>
+#include <sofa/testing/BaseTest.h>
+
+#include <atomic>
+
+namespace sofa
+{
+
+namespace
+{
+
+/// sum = a + b, counting the updates
+class SumEngine : public core::DataEngine
+{
+public:
+    SOFA_CLASS(SumEngine, core::DataEngine);
+
+    Data<int> a;
+    Data<int> b;
+    Data<int> sum;
+    int nbUpdates {0};
+
+    SumEngine()
+        : a(initData(&a, 0, "a", "first term"))
+        , b(initData(&b, 0, "b", "second term"))
+        , sum(initData(&sum, 0, "sum", "a + b"))
+    {}
+
+    void init() override
+    {
+        addInput(&a);
+        addInput(&b);
+        addOutput(&sum);
+    }
+
+    void doUpdate() override
+    {
+        ++nbUpdates;
+        sum.setValue(a.getValue() + b.getValue());
+    }
+};
+
+class DataEngineScheduler_test : public sofa::testing::BaseTest
+{
+public:
+    SumEngine::SPtr e1, e2, e3, e4, unlinked;
+    Data<int> result;
+    std::vector<core::DataEngine*> engines;
+    simulation::DataEngineScheduler scheduler;
+
+    void onSetUp() override
+    {
+        simulation::TaskScheduler::getInstance()->init(4);
+
+        // e1 -> (e2, e3) -> e4 -> result
+        e1 = core::objectmodel::New<SumEngine>();
+        e2 = core::objectmodel::New<SumEngine>();
+        e3 = core::objectmodel::New<SumEngine>();
+        e4 = core::objectmodel::New<SumEngine>();
+        unlinked = core::objectmodel::New<SumEngine>();
+        for (SumEngine* e : { e1.get(), e2.get(), e3.get(), e4.get(), unlinked.get() })
+        {
+            e->init();
+        }
+        e1->a.setValue(1);
+        e1->b.setValue(2);
+        e2->a.setParent(&e1->sum);
+        e2->b.setValue(10);
+        e3->a.setParent(&e1->sum);
+        e3->b.setValue(20);
+        e4->a.setParent(&e2->sum);
+        e4->b.setParent(&e3->sum);
+        result.setParent(&e4->sum);
+
+        // given in an order which is not the dependency order
+        engines = { e4.get(), unlinked.get(), e3.get(), e2.get(), e1.get() };
+    }
+
+    void onTearDown() override
+    {
+        simulation::TaskScheduler::getInstance()->stop();
+    }
+};
+
+TEST_F(DataEngineScheduler_test, updateInDependencyOrder)
+{
+    scheduler.updateDirtyEngines(engines);
+
+    const auto& levels = scheduler.getLevels();
+    ASSERT_EQ(levels.size(), 3u);
+    EXPECT_EQ(levels[0], std::vector<core::DataEngine*>({ e1.get() }));
+    EXPECT_EQ(levels[1].size(), 2u);
+    EXPECT_EQ(levels[2], std::vector<core::DataEngine*>({ e4.get() }));
+
+    for (SumEngine* e : { e1.get(), e2.get(), e3.get(), e4.get() })
+    {
+        EXPECT_FALSE(e->isDirty());
+        EXPECT_EQ(e->nbUpdates, 1);
+    }
+    EXPECT_EQ(result.getValue(), 36);
+
+    // the engines whose outputs are not read are left to the lazy evaluation
+    EXPECT_TRUE(unlinked->isDirty());
+    EXPECT_EQ(unlinked->nbUpdates, 0);
+}
+
+TEST_F(DataEngineScheduler_test, updateOnlyDirtyEngines)
+{
+    scheduler.updateDirtyEngines(engines);
+
+    e3->b.setValue(30);
+    scheduler.updateDirtyEngines(engines);
+
+    const auto& levels = scheduler.getLevels();
+    ASSERT_EQ(levels.size(), 2u);
+    EXPECT_EQ(levels[0], std::vector<core::DataEngine*>({ e3.get() }));
+    EXPECT_EQ(levels[1], std::vector<core::DataEngine*>({ e4.get() }));
+    EXPECT_EQ(e1->nbUpdates, 1);
+    EXPECT_EQ(e2->nbUpdates, 1);
+    EXPECT_EQ(e3->nbUpdates, 2);
+    EXPECT_EQ(e4->nbUpdates, 2);
+    EXPECT_EQ(result.getValue(), 46);
+
+    scheduler.updateDirtyEngines(engines);
+    EXPECT_TRUE(scheduler.getLevels().empty());
+}
+
+TEST_F(DataEngineScheduler_test, sharedInput)
+{
+    // e2 and e3 read the same Data, and are updated in the same level
+    Data<int> shared(1, "shared");
+    e2->addInput(&shared);
+    e3->addInput(&shared);
+    scheduler.updateDirtyEngines(engines);
+    ASSERT_EQ(scheduler.getLevels().size(), 3u);
+    EXPECT_EQ(scheduler.getLevels()[1].size(), 2u);
+    EXPECT_FALSE(e2->isDirty());
+    EXPECT_FALSE(e3->isDirty());
+
+    // the change of the shared input still reaches both engines
+    shared.setValue(2);
+    EXPECT_TRUE(e2->isDirty());
+    EXPECT_TRUE(e3->isDirty());
+    scheduler.updateDirtyEngines(engines);
+    EXPECT_EQ(e2->nbUpdates, 2);
+    EXPECT_EQ(e3->nbUpdates, 2);
+    EXPECT_EQ(result.getValue(), 36);
+}
+
+} // namespace
+
+} // namespace sofa
@@ -0,0 +1,158 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/ParallelForEach.h>
+#include <sofa/simulation/DefaultTaskScheduler.h>
+#include <sofa/simulation/WorkStealingTaskScheduler.h>
+#include <sofa/testing/BaseTest.h>
+
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+namespace sofa
+{
+
+class ParallelForEachTest : public ::testing::TestWithParam<const char*>
+{
+protected:
+    void initScheduler(unsigned int nbThreads)
+    {
+        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(GetParam());
+        scheduler->init(nbThreads);
+    }
+
+    void TearDown() override
+    {
+        simulation::TaskScheduler::getInstance()->stop();
+    }
+};
+
+TEST_P(ParallelForEachTest, ForEachVisitsEachIndexOnce)
+{
+    for (const unsigned int nbThreads : {1u, 4u})
+    {
+        initScheduler(nbThreads);
+
+        const std::size_t n = 10007;
+        std::vector<std::atomic<int> > visits(n);
+        for (auto& v : visits)
+        {
+            v.store(0);
+        }
+
+        simulation::parallelForEach(std::size_t(0), n, [&](std::size_t i)
+        {
+            visits[i].fetch_add(1);
+        });
+
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            ASSERT_EQ(visits[i].load(), 1) << "index " << i << " with " << nbThreads << " threads";
+        }
+    }
+}
+
+TEST_P(ParallelForEachTest, ForEachRangeRespectsGrainSize)
+{
+    initScheduler(4);
+
+    const int n = 1000;
+    const std::size_t grainSize = 10;
+    std::vector<int> values(n, 0);
+    std::atomic<bool> tooLarge(false);
+
+    simulation::parallelForEachRange(0, n, [&](int first, int last)
+    {
+        if (static_cast<std::size_t>(last - first) > grainSize)
+        {
+            tooLarge.store(true);
+        }
+        for (int i = first; i < last; ++i)
+        {
+            values[i] = i;
+        }
+    }, grainSize);
+
+    EXPECT_FALSE(tooLarge.load());
+    for (int i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(values[i], i);
+    }
+}
+
+TEST_P(ParallelForEachTest, EmptyRange)
+{
+    initScheduler(4);
+
+    bool called = false;
+    simulation::parallelForEach(5, 5, [&](int) { called = true; });
+    EXPECT_FALSE(called);
+
+    const int sum = simulation::parallelReduce(5, 3, 42, [](int i) { return i; }, [](int a, int b) { return a + b; });
+    EXPECT_EQ(sum, 42);
+}
+
+TEST_P(ParallelForEachTest, ReduceSum)
+{
+    initScheduler(4);
+
+    const std::int64_t n = 1 << 16;
+    const std::int64_t sum = simulation::parallelReduce(std::int64_t(1), n + 1, std::int64_t(0),
+        [](std::int64_t i) { return i; },
+        [](std::int64_t a, std::int64_t b) { return a + b; });
+    EXPECT_EQ(sum, n * (n + 1) / 2);
+}
+
+// the floating-point result must not depend on the number of threads
+TEST_P(ParallelForEachTest, ReduceIsDeterministic)
+{
+    const std::size_t n = 100003;
+    std::vector<double> values(n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        values[i] = std::sin(double(i)) * 1e3 + 1.0 / double(i + 1);
+    }
+
+    const auto computeSum = [&values]()
+    {
+        return simulation::parallelReduce(std::size_t(0), values.size(), 0.0,
+            [&values](std::size_t i) { return values[i]; },
+            [](double a, double b) { return a + b; });
+    };
+
+    initScheduler(1);
+    const double reference = computeSum();
+
+    for (const unsigned int nbThreads : {2u, 3u, 4u})
+    {
+        initScheduler(nbThreads);
+        for (int repeat = 0; repeat < 5; ++repeat)
+        {
+            EXPECT_EQ(computeSum(), reference) << nbThreads << " threads";
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(TaskSchedulers, ParallelForEachTest,
+    ::testing::Values(simulation::DefaultTaskScheduler::name(), simulation::WorkStealingTaskScheduler::name()));
+
+} // namespace sofa
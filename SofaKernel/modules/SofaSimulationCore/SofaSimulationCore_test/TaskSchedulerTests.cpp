@@ -3,14 +3,15 @@
 #include <sofa/simulation/TaskScheduler.h>
 #include <sofa/simulation/CpuTask.h>
 #include <sofa/simulation/DefaultTaskScheduler.h>
+#include <sofa/simulation/WorkStealingTaskScheduler.h>
 #include <sofa/testing/BaseTest.h>
 
 namespace sofa
 {
     // compute the Fibonacci number for input N
-    static int64_t Fibonacci(int64_t N, int nbThread = 0)
+    static int64_t Fibonacci(int64_t N, int nbThread = 0, const char* schedulerName = simulation::DefaultTaskScheduler::name())
     {
-        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(simulation::DefaultTaskScheduler::name());
+        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(schedulerName);
         scheduler->init(nbThread);
         
         simulation::CpuTask::Status status;
@@ -26,9 +27,9 @@ namespace sofa
     
     
     // compute the sum of integers from 1 to N
-    static int64_t IntSum1ToN(const int64_t N, int nbThread = 0)
+    static int64_t IntSum1ToN(const int64_t N, int nbThread = 0, const char* schedulerName = simulation::DefaultTaskScheduler::name())
     {
-        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(simulation::DefaultTaskScheduler::name());
+        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(schedulerName);
         scheduler->init(nbThread);
         
         simulation::CpuTask::Status status;
@@ -97,6 +98,35 @@ namespace sofa
         EXPECT_EQ(res, (N)*(N + 1) / 2);
         return;
     }
-    
+
+    // an unknown name falls back on the default task scheduler
+    TEST(TaskSchedulerTests, UnknownSchedulerName)
+    {
+        simulation::TaskScheduler::create("notARegisteredScheduler");
+        EXPECT_EQ(simulation::TaskScheduler::getCurrentName(), simulation::DefaultTaskScheduler::name());
+    }
+
+    // compute the Fibonacci single thread with the lock-free work-stealing scheduler
+    TEST(TaskSchedulerTests, WorkStealingFibonacciSingle)
+    {
+        const int64_t res = Fibonacci(27, 1, simulation::WorkStealingTaskScheduler::name());
+        EXPECT_EQ(res, 196418);
+    }
+
+    // compute the Fibonacci multi thread with the lock-free work-stealing scheduler
+    TEST(TaskSchedulerTests, WorkStealingFibonacciMulti)
+    {
+        const int64_t res = Fibonacci(27, 4, simulation::WorkStealingTaskScheduler::name());
+        EXPECT_EQ(res, 196418);
+    }
+
+    // compute the sum of integers from 1 to N multi thread with the lock-free work-stealing scheduler
+    TEST(TaskSchedulerTests, WorkStealingIntSumMulti)
+    {
+        const int64_t N = 1 << 20;
+        const int64_t res = IntSum1ToN(N, 4, simulation::WorkStealingTaskScheduler::name());
+        EXPECT_EQ(res, (N)*(N + 1) / 2);
+    }
+
 
 } // namespace sofa
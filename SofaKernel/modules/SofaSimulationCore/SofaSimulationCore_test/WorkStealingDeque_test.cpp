@@ -0,0 +1,137 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/WorkStealingDeque.h>
+#include <sofa/testing/BaseTest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace sofa
+{
+
+using simulation::WorkStealingDeque;
+
+TEST(WorkStealingDequeTest, OwnerIsLifoThiefIsFifo)
+{
+    WorkStealingDeque<int> deque(4);
+    for (int i = 0; i < 4; ++i)
+    {
+        deque.push(i);
+    }
+    EXPECT_EQ(deque.size(), 4);
+
+    int value = -1;
+    ASSERT_TRUE(deque.pop(value));
+    EXPECT_EQ(value, 3);
+    ASSERT_TRUE(deque.steal(value));
+    EXPECT_EQ(value, 0);
+    ASSERT_TRUE(deque.pop(value));
+    EXPECT_EQ(value, 2);
+    ASSERT_TRUE(deque.steal(value));
+    EXPECT_EQ(value, 1);
+
+    EXPECT_FALSE(deque.pop(value));
+    EXPECT_FALSE(deque.steal(value));
+    EXPECT_TRUE(deque.empty());
+}
+
+TEST(WorkStealingDequeTest, Grow)
+{
+    WorkStealingDeque<int> deque(2);
+    const int nbItems = 1000;
+    for (int i = 0; i < nbItems; ++i)
+    {
+        deque.push(i);
+    }
+    EXPECT_EQ(deque.size(), nbItems);
+
+    for (int i = 0; i < nbItems; ++i)
+    {
+        int value = -1;
+        ASSERT_TRUE(deque.steal(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_TRUE(deque.empty());
+}
+
+// every pushed item must be taken exactly once, either by the owner or by one of the thieves
+TEST(WorkStealingDequeTest, ConcurrentSteal)
+{
+    const int nbItems = 100000;
+    const int nbThieves = 3;
+
+    WorkStealingDeque<int> deque(16);
+    std::vector<std::atomic<int> > taken(nbItems);
+    for (auto& t : taken)
+    {
+        t.store(0);
+    }
+
+    std::atomic<bool> done(false);
+    std::vector<std::thread> thieves;
+    for (int i = 0; i < nbThieves; ++i)
+    {
+        thieves.emplace_back([&]()
+        {
+            int value;
+            while (!done.load())
+            {
+                if (deque.steal(value))
+                {
+                    taken[value].fetch_add(1);
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    int value;
+    for (int i = 0; i < nbItems; ++i)
+    {
+        deque.push(i);
+        if (i % 3 == 0 && deque.pop(value))
+        {
+            taken[value].fetch_add(1);
+        }
+    }
+    while (deque.pop(value))
+    {
+        taken[value].fetch_add(1);
+    }
+
+    done.store(true);
+    for (auto& thief : thieves)
+    {
+        thief.join();
+    }
+
+    for (int i = 0; i < nbItems; ++i)
+    {
+        EXPECT_EQ(taken[i].load(), 1) << "item " << i;
+    }
+}
+
+} // namespace sofa
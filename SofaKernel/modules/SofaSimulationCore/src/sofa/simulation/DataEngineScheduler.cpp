@@ -0,0 +1,155 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/DataEngineScheduler.h>
+
+#include <sofa/core/DataEngine.h>
+#include <sofa/simulation/ParallelForEach.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace sofa::simulation
+{
+
+namespace
+{
+
+/// whether one of the outputs of the engine is read by another node of the graph
+bool hasLinkedOutput(sofa::core::DataEngine* engine)
+{
+    const auto& outputs = engine->getOutputs();
+    return std::any_of(outputs.begin(), outputs.end(), [](sofa::core::objectmodel::DDGNode* output)
+    {
+        return !output->getOutputs().empty();
+    });
+}
+
+} // anonymous namespace
+
+void DataEngineScheduler::updateDirtyEngines(const std::vector<sofa::core::DataEngine*>& engines)
+{
+    computeLevels(engines);
+
+    for (const auto& level : m_levels)
+    {
+        // the shared inputs are updated and their dirtyOutputs flags cleared first, so that the engines
+        // neither pull nor clean them concurrently
+        for (sofa::core::DataEngine* engine : level)
+        {
+            for (sofa::core::objectmodel::DDGNode* input : engine->getInputs())
+            {
+                input->updateIfDirty();
+            }
+            engine->cleanDirtyOutputsOfInputs();
+        }
+
+        parallelForEach(std::size_t(0), level.size(), [&level](std::size_t i)
+        {
+            level[i]->updateIfDirty();
+        }, 1);
+    }
+}
+
+void DataEngineScheduler::computeLevels(const std::vector<sofa::core::DataEngine*>& engines)
+{
+    m_levels.clear();
+
+    std::vector<sofa::core::DataEngine*> dirtyEngines;
+    std::unordered_map<sofa::core::DataEngine*, std::size_t> index;
+    for (sofa::core::DataEngine* engine : engines)
+    {
+        if (engine->isDirty() && hasLinkedOutput(engine) && index.emplace(engine, dirtyEngines.size()).second)
+        {
+            dirtyEngines.push_back(engine);
+        }
+    }
+    if (dirtyEngines.empty())
+    {
+        return;
+    }
+
+    // edges from each engine to the engines depending on it
+    std::vector< std::vector<std::size_t> > dependents(dirtyEngines.size());
+    std::vector<std::size_t> nbDependencies(dirtyEngines.size(), 0);
+    std::vector<sofa::core::DataEngine*> reached;
+    std::unordered_set<sofa::core::objectmodel::DDGNode*> visited;
+    for (std::size_t i = 0; i < dirtyEngines.size(); ++i)
+    {
+        reached.clear();
+        visited.clear();
+        findDependentEngines(dirtyEngines[i], reached, visited);
+        for (sofa::core::DataEngine* engine : reached)
+        {
+            const auto it = index.find(engine);
+            if (it != index.end() && it->second != i)
+            {
+                dependents[i].push_back(it->second);
+                ++nbDependencies[it->second];
+            }
+        }
+    }
+
+    std::vector<std::size_t> current;
+    for (std::size_t i = 0; i < dirtyEngines.size(); ++i)
+    {
+        if (nbDependencies[i] == 0)
+            current.push_back(i);
+    }
+
+    std::vector<std::size_t> next;
+    while (!current.empty())
+    {
+        m_levels.emplace_back();
+        next.clear();
+        for (const std::size_t i : current)
+        {
+            m_levels.back().push_back(dirtyEngines[i]);
+            for (const std::size_t d : dependents[i])
+            {
+                if (--nbDependencies[d] == 0)
+                    next.push_back(d);
+            }
+        }
+        current.swap(next);
+    }
+}
+
+void DataEngineScheduler::findDependentEngines(sofa::core::objectmodel::DDGNode* node, std::vector<sofa::core::DataEngine*>& dependents,
+                                               std::unordered_set<sofa::core::objectmodel::DDGNode*>& visited)
+{
+    for (sofa::core::objectmodel::DDGNode* output : node->getOutputs())
+    {
+        if (!visited.insert(output).second)
+            continue;
+
+        if (auto* engine = dynamic_cast<sofa::core::DataEngine*>(output))
+        {
+            dependents.push_back(engine);
+        }
+        else
+        {
+            findDependentEngines(output, dependents, visited);
+        }
+    }
+}
+
+} // namespace sofa::simulation
@@ -0,0 +1,75 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/simulation/config.h>
+
+#include <unordered_set>
+#include <vector>
+
+namespace sofa::core
+{
+class DataEngine;
+}
+
+namespace sofa::core::objectmodel
+{
+class DDGNode;
+}
+
+namespace sofa::simulation
+{
+
+/**
+ * Update the dirty DataEngines among a set of engines, running the independent ones concurrently
+ * on the TaskScheduler instead of lazily and serially when their outputs are read.
+ *
+ * The engines are sorted in levels following the DDGNode input/output edges: an engine is placed
+ * after all the engines it depends on, directly or through Data links. The engines of a level do not
+ * depend on each other. Their inputs are updated and cleaned sequentially, then the engines are updated
+ * in parallel.
+ *
+ * Only the engines having an output linked to another Data or engine are evaluated: their outputs
+ * will be pulled by the graph. The others, as well as the engines in a dependency cycle, are still
+ * updated lazily when their outputs are read.
+ */
+class SOFA_SIMULATION_CORE_API DataEngineScheduler
+{
+public:
+    /// Update the dirty engines among the given ones
+    void updateDirtyEngines(const std::vector<sofa::core::DataEngine*>& engines);
+
+    /// The engines updated by the last call to updateDirtyEngines, per level
+    const std::vector< std::vector<sofa::core::DataEngine*> >& getLevels() const { return m_levels; }
+
+protected:
+    /// Sort the dirty engines in levels of independent engines
+    void computeLevels(const std::vector<sofa::core::DataEngine*>& engines);
+
+    /// Add to dependents the engines reached from the outputs of node, through nodes which are not engines
+    static void findDependentEngines(sofa::core::objectmodel::DDGNode* node, std::vector<sofa::core::DataEngine*>& dependents,
+                                     std::unordered_set<sofa::core::objectmodel::DDGNode*>& visited);
+
+    std::vector< std::vector<sofa::core::DataEngine*> > m_levels;
+};
+
+} // namespace sofa::simulation
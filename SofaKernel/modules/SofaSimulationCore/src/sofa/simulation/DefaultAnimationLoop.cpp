@@ -33,6 +33,9 @@
 #include <sofa/simulation/AnimateEndEvent.h>
 #include <sofa/simulation/UpdateMappingEndEvent.h>
 #include <sofa/simulation/UpdateBoundingBoxVisitor.h>
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <sofa/core/DataEngine.h>
 
 #include <sofa/helper/system/SetDirectory.h>
 #include <sofa/helper/ScopedAdvancedTimer.h>
@@ -61,6 +64,7 @@ This loop do the following steps:
 
 DefaultAnimationLoop::DefaultAnimationLoop(simulation::Node* _gnode)
     : Inherit()
+    , d_parallelDataEngines(initData(&d_parallelDataEngines, false, "parallelDataEngines", "update the dirty DataEngines at the beginning of each step, running the independent ones in parallel on the TaskScheduler"))
     , gnode(_gnode)
 {
     //assert(gnode);
@@ -75,6 +79,16 @@ void DefaultAnimationLoop::init()
 {
     if (!gnode)
         gnode = dynamic_cast<simulation::Node*>(this->getContext());
+
+    if (d_parallelDataEngines.getValue())
+    {
+        auto* taskScheduler = TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 1)
+        {
+            taskScheduler->init(0);
+            msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+        }
+    }
 }
 
 void DefaultAnimationLoop::setNode( simulation::Node* n )
@@ -112,6 +126,14 @@ void DefaultAnimationLoop::step(const core::ExecParams* params, SReal dt)
     gnode->execute ( uid );
     sofa::helper::AdvancedTimer::stepEnd("UpdateInternalDataVisitor");
 
+    if (d_parallelDataEngines.getValue())
+    {
+        sofa::helper::ScopedAdvancedTimer timer("UpdateDataEngines");
+        sofa::type::vector<core::DataEngine*> engines;
+        gnode->getTreeObjects<core::DataEngine>(&engines);
+        m_dataEngineScheduler.updateDirtyEngines(engines);
+    }
+
 
     sofa::helper::AdvancedTimer::stepBegin("AnimateVisitor");
     AnimateVisitor act(params, dt);
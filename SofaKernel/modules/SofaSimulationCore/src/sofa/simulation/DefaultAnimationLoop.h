@@ -26,6 +26,7 @@
 #include <sofa/core/behavior/BaseAnimationLoop.h>
 
 #include <sofa/simulation/fwd.h>
+#include <sofa/simulation/DataEngineScheduler.h>
 
 namespace sofa {
 namespace core {
@@ -53,6 +54,8 @@ public:
     typedef sofa::core::objectmodel::BaseContext BaseContext;
     typedef sofa::core::objectmodel::BaseObjectDescription BaseObjectDescription;
     SOFA_CLASS(DefaultAnimationLoop,sofa::core::behavior::BaseAnimationLoop);
+
+    Data<bool> d_parallelDataEngines; ///< update the dirty DataEngines at the beginning of each step, running the independent ones in parallel
 protected:
     DefaultAnimationLoop(simulation::Node* gnode = nullptr);
 
@@ -83,6 +86,8 @@ protected :
 
     simulation::Node* gnode;  ///< the node controlled by the loop
 
+    DataEngineScheduler m_dataEngineScheduler;
+
 };
 
 } // namespace simulation
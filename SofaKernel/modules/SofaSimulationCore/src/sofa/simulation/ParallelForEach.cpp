@@ -0,0 +1,38 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/ParallelForEach.h>
+
+namespace sofa::simulation::parallelforeach
+{
+
+std::size_t computeForEachGrainSize(const std::size_t rangeSize, const unsigned int nbThreads)
+{
+    const std::size_t nbRanges = RangesPerThread * std::max(1u, nbThreads);
+    return std::max(MinimumGrainSize, (rangeSize + nbRanges - 1) / nbRanges);
+}
+
+std::size_t computeReduceGrainSize(const std::size_t rangeSize)
+{
+    return std::max(MinimumGrainSize, (rangeSize + ReduceLeafCount - 1) / ReduceLeafCount);
+}
+
+} // namespace sofa::simulation::parallelforeach
@@ -0,0 +1,276 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/simulation/config.h>
+
+#include <sofa/simulation/CpuTask.h>
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <algorithm>
+#include <type_traits>
+
+namespace sofa::simulation
+{
+
+/**
+ * Generic data-parallel loops running on the current TaskScheduler (TaskScheduler::getInstance()).
+ *
+ * The index range [first, last) is split recursively in two halves until the size of a
+ * sub-range is not greater than the grain size. The two halves are pushed as tasks, so that
+ * idle threads steal the largest remaining pieces of work.
+ *
+ * When the grain size is 0 (default), it is chosen automatically:
+ * - parallelForEach and parallelForEachRange aim at a few sub-ranges per thread, to balance
+ *   the load while keeping the task overhead low;
+ * - parallelReduce uses a grain size depending only on the size of the range, so that the
+ *   reduction tree, hence the result of a floating-point reduction, does not depend on the
+ *   number of threads nor on the order the tasks are run.
+ *
+ * With a single thread, the loops are run inline without creating any task.
+ *
+ * Example:
+ * \code
+ *     sofa::simulation::parallelForEach(std::size_t(0), positions.size(), [&](std::size_t i)
+ *     {
+ *         velocities[i] += dt * forces[i] / masses[i];
+ *     });
+ *
+ *     const double energy = sofa::simulation::parallelReduce(std::size_t(0), springs.size(), 0.0,
+ *         [&](std::size_t i) { return springs[i].energy(); },
+ *         [](double a, double b) { return a + b; });
+ * \endcode
+ */
+
+namespace parallelforeach
+{
+
+/// Minimum number of indices per sub-range for the automatic grain size
+inline constexpr std::size_t MinimumGrainSize = 32;
+
+/// Number of sub-ranges per thread targeted by the automatic grain size of parallelForEach
+inline constexpr std::size_t RangesPerThread = 8;
+
+/// Number of leaves targeted by the automatic grain size of parallelReduce, independent of the number of threads
+inline constexpr std::size_t ReduceLeafCount = 256;
+
+/// Grain size used by parallelForEach when none is given
+SOFA_SIMULATION_CORE_API std::size_t computeForEachGrainSize(std::size_t rangeSize, unsigned int nbThreads);
+
+/// Grain size used by parallelReduce when none is given. It only depends on the range size.
+SOFA_SIMULATION_CORE_API std::size_t computeReduceGrainSize(std::size_t rangeSize);
+
+/// Recursively split [first, last) and call f(subFirst, subLast) on the leaves
+template<class Index, class RangeFunction>
+class ForEachRangeTask : public CpuTask
+{
+public:
+    ForEachRangeTask(Index first, Index last, std::size_t grainSize, const RangeFunction& f, CpuTask::Status* status)
+        : CpuTask(status), m_first(first), m_last(last), m_grainSize(grainSize), m_f(f)
+    {}
+
+    MemoryAlloc run() final
+    {
+        runRange(m_first, m_last, m_grainSize, m_f);
+        return MemoryAlloc::Stack;
+    }
+
+    static void runRange(Index first, Index last, std::size_t grainSize, const RangeFunction& f)
+    {
+        if (static_cast<std::size_t>(last - first) <= grainSize)
+        {
+            f(first, last);
+            return;
+        }
+
+        const Index middle = first + (last - first) / 2;
+
+        CpuTask::Status status;
+        ForEachRangeTask task0(first, middle, grainSize, f, &status);
+        ForEachRangeTask task1(middle, last, grainSize, f, &status);
+
+        TaskScheduler* scheduler = TaskScheduler::getInstance();
+        scheduler->addTask(&task0);
+        scheduler->addTask(&task1);
+        scheduler->workUntilDone(&status);
+    }
+
+private:
+    const Index m_first;
+    const Index m_last;
+    const std::size_t m_grainSize;
+    const RangeFunction& m_f;
+};
+
+/// Recursively split [first, last), reduce the leaves sequentially and combine the two halves of each node
+template<class Index, class T, class MapFunction, class ReduceFunction>
+class ReduceTask : public CpuTask
+{
+public:
+    ReduceTask(Index first, Index last, std::size_t grainSize, const T& identity,
+               const MapFunction& map, const ReduceFunction& reduce, T* result, CpuTask::Status* status)
+        : CpuTask(status), m_first(first), m_last(last), m_grainSize(grainSize), m_identity(identity)
+        , m_map(map), m_reduce(reduce), m_result(result)
+    {}
+
+    MemoryAlloc run() final
+    {
+        *m_result = runRange(m_first, m_last, m_grainSize, m_identity, m_map, m_reduce, true);
+        return MemoryAlloc::Stack;
+    }
+
+    /// The tree is the same whether the nodes are run as tasks (parallel) or not
+    static T runRange(Index first, Index last, std::size_t grainSize, const T& identity,
+                      const MapFunction& map, const ReduceFunction& reduce, bool parallel)
+    {
+        if (static_cast<std::size_t>(last - first) <= grainSize)
+        {
+            T result = identity;
+            for (Index i = first; i < last; ++i)
+            {
+                result = reduce(result, map(i));
+            }
+            return result;
+        }
+
+        const Index middle = first + (last - first) / 2;
+
+        if (!parallel)
+        {
+            const T left = runRange(first, middle, grainSize, identity, map, reduce, false);
+            const T right = runRange(middle, last, grainSize, identity, map, reduce, false);
+            return reduce(left, right);
+        }
+
+        T left = identity;
+        T right = identity;
+
+        CpuTask::Status status;
+        ReduceTask task0(first, middle, grainSize, identity, map, reduce, &left, &status);
+        ReduceTask task1(middle, last, grainSize, identity, map, reduce, &right, &status);
+
+        TaskScheduler* scheduler = TaskScheduler::getInstance();
+        scheduler->addTask(&task0);
+        scheduler->addTask(&task1);
+        scheduler->workUntilDone(&status);
+
+        return reduce(left, right);
+    }
+
+private:
+    const Index m_first;
+    const Index m_last;
+    const std::size_t m_grainSize;
+    const T& m_identity;
+    const MapFunction& m_map;
+    const ReduceFunction& m_reduce;
+    T* m_result;
+};
+
+} // namespace parallelforeach
+
+/**
+ * Whether the current TaskScheduler is initialized on several threads. Unlike TaskScheduler::getInstance(),
+ * it never creates a scheduler: the code which is not explicitly requested to be parallel (e.g. the
+ * initialization of a component) can use it to run its loops in parallel only when the scene already runs tasks.
+ */
+inline bool hasParallelTaskScheduler()
+{
+    const TaskScheduler* scheduler = TaskScheduler::getCurrentInstance();
+    return scheduler != nullptr && scheduler->getThreadCount() > 1;
+}
+
+/**
+ * Call f(subFirst, subLast) on disjoint sub-ranges covering [first, last), in parallel.
+ * Useful when some work can be shared between the indices of a sub-range (e.g. a local accumulator).
+ */
+template<class Index, class RangeFunction>
+void parallelForEachRange(Index first, Index last, const RangeFunction& f, std::size_t grainSize = 0)
+{
+    static_assert(std::is_integral_v<Index>, "parallelForEachRange requires an integral index type");
+    if (last <= first)
+    {
+        return;
+    }
+
+    TaskScheduler* scheduler = TaskScheduler::getInstance();
+    const std::size_t rangeSize = static_cast<std::size_t>(last - first);
+    const unsigned int nbThreads = scheduler->getThreadCount();
+
+    if (nbThreads < 2)
+    {
+        f(first, last);
+        return;
+    }
+
+    if (grainSize == 0)
+    {
+        grainSize = parallelforeach::computeForEachGrainSize(rangeSize, nbThreads);
+    }
+
+    parallelforeach::ForEachRangeTask<Index, RangeFunction>::runRange(first, last, grainSize, f);
+}
+
+/**
+ * Call f(i) for each i in [first, last), in parallel.
+ * The calls must be independent: f must not write data read or written by another index.
+ */
+template<class Index, class Function>
+void parallelForEach(Index first, Index last, const Function& f, std::size_t grainSize = 0)
+{
+    parallelForEachRange(first, last, [&f](Index subFirst, Index subLast)
+    {
+        for (Index i = subFirst; i < subLast; ++i)
+        {
+            f(i);
+        }
+    }, grainSize);
+}
+
+/**
+ * Compute reduce(...reduce(reduce(identity, map(first)), map(first+1))..., map(last-1)) in parallel.
+ *
+ * reduce must be associative and identity must be its neutral element. The reduction tree only
+ * depends on the range size and on the grain size: for a given grain size, the result is
+ * bit-identical whatever the number of threads.
+ */
+template<class Index, class T, class MapFunction, class ReduceFunction>
+T parallelReduce(Index first, Index last, const T& identity, const MapFunction& map, const ReduceFunction& reduce, std::size_t grainSize = 0)
+{
+    static_assert(std::is_integral_v<Index>, "parallelReduce requires an integral index type");
+    if (last <= first)
+    {
+        return identity;
+    }
+
+    const std::size_t rangeSize = static_cast<std::size_t>(last - first);
+    if (grainSize == 0)
+    {
+        grainSize = parallelforeach::computeReduceGrainSize(rangeSize);
+    }
+
+    const bool parallel = TaskScheduler::getInstance()->getThreadCount() > 1;
+    return parallelforeach::ReduceTask<Index, T, MapFunction, ReduceFunction>::runRange(
+        first, last, grainSize, identity, map, reduce, parallel);
+}
+
+} // namespace sofa::simulation
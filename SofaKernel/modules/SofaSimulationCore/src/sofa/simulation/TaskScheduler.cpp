@@ -1,6 +1,7 @@
 #include <sofa/simulation/TaskScheduler.h>
 
 #include <sofa/simulation/DefaultTaskScheduler.h>
+#include <sofa/simulation/WorkStealingTaskScheduler.h>
 
 //#include <sofa/helper/system/thread/CTime.h>
 
@@ -20,6 +21,7 @@ namespace sofa
         
         // register default task scheduler
         const bool DefaultTaskScheduler::isRegistered = TaskScheduler::registerScheduler(DefaultTaskScheduler::name(), &DefaultTaskScheduler::create);
+        const bool WorkStealingTaskScheduler::isRegistered = TaskScheduler::registerScheduler(WorkStealingTaskScheduler::name(), &WorkStealingTaskScheduler::create);
         
         
         TaskScheduler* TaskScheduler::create(const char* name)
@@ -34,8 +36,7 @@ namespace sofa
             {
                 // error scheduler not registered
                 // create the default task scheduler
-                iter = _schedulers.end();
-                --iter;
+                iter = _schedulers.find(DefaultTaskScheduler::name());
             }
             
             if (_currentScheduler != nullptr)
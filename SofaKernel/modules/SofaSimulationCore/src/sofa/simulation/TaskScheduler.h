@@ -79,6 +79,13 @@ namespace sofa
              */
             static TaskScheduler* getInstance();
 
+            /**
+             * Get the current TaskScheduler instance, without creating it.
+             *
+             * @return The current TaskScheduler instance, or nullptr if none has been created yet
+             */
+            static TaskScheduler* getCurrentInstance() { return _currentScheduler; }
+
             /**
              * Get the name of the current TaskScheduler instance
              * @return The name of the current TaskScheduler instance
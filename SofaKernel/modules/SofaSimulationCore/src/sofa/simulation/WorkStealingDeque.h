@@ -0,0 +1,182 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/simulation/config.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sofa::simulation
+{
+
+/**
+ * Lock-free single-owner / multiple-thieves deque (Chase & Lev, "Dynamic Circular
+ * Work-Stealing Deque", SPAA 2005), with the memory orderings of Le et al.,
+ * "Correct and Efficient Work-Stealing for Weak Memory Models", PPoPP 2013.
+ *
+ * Only the owner thread may call push() and pop(), which work on the bottom end
+ * of the deque (LIFO). Any thread may call steal(), which takes from the top
+ * end (FIFO). The circular buffer grows when full; retired buffers are kept
+ * until the deque is destroyed since a thief may still be reading from them.
+ *
+ * T must be a trivially copyable type (typically a pointer).
+ */
+template<class T>
+class WorkStealingDeque
+{
+public:
+
+    explicit WorkStealingDeque(std::int64_t capacity = 256)
+        : m_top(0)
+        , m_bottom(0)
+    {
+        std::int64_t powerOfTwo = 1;
+        while (powerOfTwo < capacity)
+        {
+            powerOfTwo <<= 1;
+        }
+        m_buffers.emplace_back(new CircularArray(powerOfTwo));
+        m_array.store(m_buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    /// Owner only: add an item at the bottom of the deque
+    void push(T item)
+    {
+        const std::int64_t b = m_bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = m_top.load(std::memory_order_acquire);
+        CircularArray* array = m_array.load(std::memory_order_relaxed);
+
+        if (b - t > array->capacity() - 1)
+        {
+            array = grow(array, b, t);
+        }
+
+        array->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /// Owner only: remove the most recently pushed item. Return false if the deque is empty.
+    bool pop(T& item)
+    {
+        const std::int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+        CircularArray* array = m_array.load(std::memory_order_relaxed);
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = m_top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            // empty deque
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        item = array->get(b);
+        if (t == b)
+        {
+            // last item: race against thieves
+            const bool won = m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /// Any thread: remove the oldest item. Return false if the deque is empty or if another thread won the race.
+    bool steal(T& item)
+    {
+        std::int64_t t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = m_bottom.load(std::memory_order_acquire);
+
+        if (t >= b)
+        {
+            return false;
+        }
+
+        CircularArray* array = m_array.load(std::memory_order_acquire);
+        item = array->get(t);
+        return m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    /// Approximate number of items, only exact when called from the owner with no concurrent thief
+    std::int64_t size() const
+    {
+        const std::int64_t b = m_bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = m_top.load(std::memory_order_relaxed);
+        return b > t ? b - t : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+private:
+
+    class CircularArray
+    {
+    public:
+        explicit CircularArray(std::int64_t capacity)
+            : m_capacity(capacity)
+            , m_mask(capacity - 1)
+            , m_items(new std::atomic<T>[static_cast<std::size_t>(capacity)])
+        {}
+
+        std::int64_t capacity() const { return m_capacity; }
+
+        T get(std::int64_t i) const { return m_items[i & m_mask].load(std::memory_order_relaxed); }
+
+        void put(std::int64_t i, T item) { m_items[i & m_mask].store(item, std::memory_order_relaxed); }
+
+    private:
+        const std::int64_t m_capacity;
+        const std::int64_t m_mask;
+        std::unique_ptr<std::atomic<T>[]> m_items;
+    };
+
+    CircularArray* grow(CircularArray* array, std::int64_t b, std::int64_t t)
+    {
+        CircularArray* newArray = new CircularArray(array->capacity() * 2);
+        for (std::int64_t i = t; i < b; ++i)
+        {
+            newArray->put(i, array->get(i));
+        }
+        m_buffers.emplace_back(newArray);
+        m_array.store(newArray, std::memory_order_release);
+        return newArray;
+    }
+
+    // top and bottom are written by different threads: keep them on separate cache lines
+    alignas(64) std::atomic<std::int64_t> m_top;
+    alignas(64) std::atomic<std::int64_t> m_bottom;
+    alignas(64) std::atomic<CircularArray*> m_array;
+
+    // owned buffers, including the retired ones (only accessed by the owner)
+    std::vector<std::unique_ptr<CircularArray> > m_buffers;
+};
+
+} // namespace sofa::simulation
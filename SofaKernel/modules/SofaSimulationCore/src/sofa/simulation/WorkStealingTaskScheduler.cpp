@@ -0,0 +1,415 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/WorkStealingTaskScheduler.h>
+
+#include <sofa/simulation/WorkStealingDeque.h>
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <thread>
+
+namespace sofa::simulation
+{
+
+class WorkStealingTaskAllocator : public Task::Allocator
+{
+public:
+
+    void* allocate(std::size_t sz) final
+    {
+        return ::operator new(sz);
+    }
+
+    void free(void* ptr, std::size_t sz) final
+    {
+        SOFA_UNUSED(sz);
+        ::operator delete(ptr);
+    }
+};
+
+static WorkStealingTaskAllocator workStealingTaskAllocator;
+
+
+class WorkStealingWorkerThread
+{
+public:
+
+    WorkStealingWorkerThread(WorkStealingTaskScheduler* scheduler, unsigned int index, const std::string& name)
+        : m_name(name + std::to_string(index))
+        , m_index(index)
+        , m_tasks(Max_TasksPerThread)
+        , m_currentStatus(nullptr)
+        , m_taskScheduler(scheduler)
+        , m_finished(false)
+    {
+        assert(scheduler);
+    }
+
+    ~WorkStealingWorkerThread()
+    {
+        join();
+    }
+
+    /// Return the WorkStealingWorkerThread corresponding to the current thread
+    static WorkStealingWorkerThread* getCurrent() { return s_current; }
+
+    static void setCurrent(WorkStealingWorkerThread* thread) { s_current = thread; }
+
+    const char* getName() const { return m_name.c_str(); }
+
+    void start()
+    {
+        m_stdThread = std::thread(&WorkStealingWorkerThread::run, this);
+    }
+
+    void join()
+    {
+        if (m_stdThread.joinable())
+        {
+            m_stdThread.join();
+        }
+    }
+
+    bool isFinished() const { return m_finished.load(std::memory_order_acquire); }
+
+    // queue task if there are worker threads, and run it otherwise
+    bool addTask(Task* task)
+    {
+        if (pushTask(task))
+        {
+            return true;
+        }
+
+        // we are single thread: run the task
+        task->getStatus()->setBusy(true);
+        runTask(task);
+        return false;
+    }
+
+    void workUntilDone(Task::Status* status)
+    {
+        while (status->isBusy())
+        {
+            if (!doWork(status))
+            {
+                // nothing to run nor to steal: the remaining tasks are being run by other threads
+                std::this_thread::yield();
+            }
+        }
+
+        const Task::Status* mainStatus = status;
+        if (m_taskScheduler->m_mainTaskStatus.compare_exchange_strong(mainStatus, nullptr, std::memory_order_acq_rel))
+        {
+            m_taskScheduler->putWorkersToSleep();
+        }
+    }
+
+private:
+
+    enum
+    {
+        Max_TasksPerThread = 256
+    };
+
+    // thread main loop
+    void run()
+    {
+        setCurrent(this);
+
+        while (!m_taskScheduler->isClosing())
+        {
+            m_taskScheduler->waitForWork();
+
+            while (m_taskScheduler->m_mainTaskStatus.load(std::memory_order_acquire) != nullptr
+                && !m_taskScheduler->isClosing())
+            {
+                if (!doWork(nullptr))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        m_finished.store(true, std::memory_order_release);
+    }
+
+    bool pushTask(Task* task)
+    {
+        // if we're single threaded return false
+        if (m_taskScheduler->getThreadCount() < 2)
+        {
+            return false;
+        }
+
+        task->m_id = task->getStatus()->setBusy(true);
+        m_tasks.push(task);
+
+        const Task::Status* noStatus = nullptr;
+        if (m_taskScheduler->m_mainTaskStatus.compare_exchange_strong(noStatus, task->getStatus(), std::memory_order_acq_rel))
+        {
+            m_taskScheduler->wakeUpWorkers();
+        }
+
+        return true;
+    }
+
+    /// Run the local tasks, then try to steal one. Return false if no task was found.
+    bool doWork(Task::Status* status)
+    {
+        bool hasWorked = false;
+        for (;;)
+        {
+            Task* task = nullptr;
+
+            while (m_tasks.pop(task))
+            {
+                runTask(task);
+                hasWorked = true;
+
+                if (status && !status->isBusy())
+                    return true;
+            }
+
+            // check if main work is finished
+            if (m_taskScheduler->m_mainTaskStatus.load(std::memory_order_acquire) == nullptr)
+                return hasWorked;
+
+            if (!stealTask(&task))
+                return hasWorked;
+
+            // run the stolen task
+            runTask(task);
+            hasWorked = true;
+
+            if (status && !status->isBusy())
+                return true;
+        }
+    }
+
+    // steal a task from another thread, visiting the victims in a round-robin order
+    bool stealTask(Task** task)
+    {
+        const auto& workers = m_taskScheduler->m_workers;
+        const std::size_t nbWorkers = workers.size();
+
+        for (std::size_t i = 1; i < nbWorkers; ++i)
+        {
+            m_lastVictim = (m_lastVictim + 1) % nbWorkers;
+            if (m_lastVictim == m_index)
+            {
+                m_lastVictim = (m_lastVictim + 1) % nbWorkers;
+            }
+
+            if (workers[m_lastVictim]->m_tasks.steal(*task))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void runTask(Task* task)
+    {
+        Task::Status* prevStatus = m_currentStatus;
+        m_currentStatus = task->getStatus();
+
+        if (task->run() & Task::MemoryAlloc::Dynamic)
+        {
+            // pooled memory: call destructor and free
+            task->operator delete(task, sizeof(*task));
+        }
+
+        m_currentStatus->setBusy(false);
+        m_currentStatus = prevStatus;
+    }
+
+private:
+
+    static thread_local WorkStealingWorkerThread* s_current;
+
+    const std::string m_name;
+
+    const std::size_t m_index;
+
+    std::size_t m_lastVictim { 0 };
+
+    WorkStealingDeque<Task*> m_tasks;
+
+    std::thread m_stdThread;
+
+    Task::Status* m_currentStatus;
+
+    WorkStealingTaskScheduler* m_taskScheduler;
+
+    std::atomic<bool> m_finished;
+};
+
+thread_local WorkStealingWorkerThread* WorkStealingWorkerThread::s_current = nullptr;
+
+
+WorkStealingTaskScheduler* WorkStealingTaskScheduler::create()
+{
+    return new WorkStealingTaskScheduler();
+}
+
+WorkStealingTaskScheduler::WorkStealingTaskScheduler()
+    : TaskScheduler()
+    , m_mainTaskStatus(nullptr)
+    , m_workerThreadsIdle(true)
+    , m_isClosing(false)
+    , m_isInitialized(false)
+    , m_threadCount(0)
+{
+    m_workers.emplace_back(new WorkStealingWorkerThread(this, 0, "Main  "));
+    WorkStealingWorkerThread::setCurrent(m_workers.front().get());
+}
+
+WorkStealingTaskScheduler::~WorkStealingTaskScheduler()
+{
+    if (m_isInitialized)
+    {
+        stop();
+    }
+
+    if (WorkStealingWorkerThread::getCurrent() == m_workers.front().get())
+    {
+        WorkStealingWorkerThread::setCurrent(nullptr);
+    }
+}
+
+unsigned WorkStealingTaskScheduler::GetHardwareThreadsCount()
+{
+    return std::max(1u, std::thread::hardware_concurrency() / 2);
+}
+
+Task::Allocator* WorkStealingTaskScheduler::getTaskAllocator()
+{
+    return &workStealingTaskAllocator;
+}
+
+void WorkStealingTaskScheduler::init(const unsigned int nbThread)
+{
+    if (m_isInitialized)
+    {
+        if ((nbThread == m_threadCount) || (nbThread == 0 && m_threadCount == GetHardwareThreadsCount()))
+        {
+            return;
+        }
+        stop();
+    }
+
+    start(nbThread);
+}
+
+void WorkStealingTaskScheduler::start(const unsigned int nbThread)
+{
+    stop();
+
+    m_isClosing.store(false, std::memory_order_release);
+    m_mainTaskStatus.store(nullptr, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> guard(m_wakeUpMutex);
+        m_workerThreadsIdle = true;
+    }
+
+    m_threadCount = (nbThread > 0) ? nbThread : GetHardwareThreadsCount();
+
+    // all the workers must be created before any of them starts stealing
+    for (unsigned int i = 1; i < m_threadCount; ++i)
+    {
+        m_workers.emplace_back(new WorkStealingWorkerThread(this, i, "Worker"));
+    }
+    for (unsigned int i = 1; i < m_threadCount; ++i)
+    {
+        m_workers[i]->start();
+    }
+
+    m_isInitialized = true;
+}
+
+void WorkStealingTaskScheduler::stop()
+{
+    m_isClosing.store(true, std::memory_order_release);
+
+    if (m_isInitialized)
+    {
+        wakeUpWorkers();
+        m_isInitialized = false;
+
+        // a worker may still be looking for a victim: join all of them before freeing any
+        for (std::size_t i = 1; i < m_workers.size(); ++i)
+        {
+            m_workers[i]->join();
+        }
+        m_workers.resize(1);
+
+        m_threadCount = 1;
+    }
+}
+
+const char* WorkStealingTaskScheduler::getCurrentThreadName()
+{
+    WorkStealingWorkerThread* thread = WorkStealingWorkerThread::getCurrent();
+    return thread->getName();
+}
+
+int WorkStealingTaskScheduler::getCurrentThreadType()
+{
+    return 0;
+}
+
+bool WorkStealingTaskScheduler::addTask(Task* task)
+{
+    WorkStealingWorkerThread* thread = WorkStealingWorkerThread::getCurrent();
+    return thread->addTask(task);
+}
+
+void WorkStealingTaskScheduler::workUntilDone(Task::Status* status)
+{
+    WorkStealingWorkerThread* thread = WorkStealingWorkerThread::getCurrent();
+    thread->workUntilDone(status);
+}
+
+void WorkStealingTaskScheduler::wakeUpWorkers()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_wakeUpMutex);
+        m_workerThreadsIdle = false;
+    }
+    m_wakeUpEvent.notify_all();
+}
+
+void WorkStealingTaskScheduler::putWorkersToSleep()
+{
+    std::lock_guard<std::mutex> guard(m_wakeUpMutex);
+    m_workerThreadsIdle = true;
+}
+
+void WorkStealingTaskScheduler::waitForWork()
+{
+    std::unique_lock<std::mutex> lock(m_wakeUpMutex);
+    // cpu free wait
+    m_wakeUpEvent.wait(lock, [&] { return !m_workerThreadsIdle || isClosing(); });
+}
+
+} // namespace sofa::simulation
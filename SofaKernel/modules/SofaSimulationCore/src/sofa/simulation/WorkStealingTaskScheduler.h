@@ -0,0 +1,127 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/simulation/config.h>
+
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace sofa::simulation
+{
+
+class WorkStealingWorkerThread;
+
+/**
+ * TaskScheduler where each thread owns a lock-free Chase-Lev deque (see WorkStealingDeque).
+ *
+ * The owner pushes and pops its tasks without any lock, idle threads steal the oldest
+ * task of the other threads with a single compare-and-swap. Compared to DefaultTaskScheduler,
+ * which guards each queue with a SpinLock, this avoids contention between workers when many
+ * fine-grained tasks are spawned on a large number of cores.
+ *
+ * Select it with TaskScheduler::create(WorkStealingTaskScheduler::name()).
+ */
+class SOFA_SIMULATION_CORE_API WorkStealingTaskScheduler : public TaskScheduler
+{
+public:
+
+    /**
+     * Call stop() and start() if not already initialized
+     * @param nbThread number of threads including the main thread. 0 means the number of CPU cores.
+     */
+    void init(const unsigned int nbThread = 0) final;
+
+    /**
+     * Wait and destroy worker threads
+     */
+    void stop(void) final;
+    unsigned int getThreadCount(void) const final { return m_threadCount; }
+    const char* getCurrentThreadName() final;
+    int getCurrentThreadType() final;
+
+    // queue task if there is space, and run it otherwise
+    bool addTask(Task* task) final;
+    void workUntilDone(Task::Status* status) final;
+    Task::Allocator* getTaskAllocator() final;
+
+public:
+
+    // factory methods: name, creator function
+    static const char* name() { return "_workstealing"; }
+
+    static WorkStealingTaskScheduler* create();
+
+    static const bool isRegistered;
+
+private:
+
+    WorkStealingTaskScheduler();
+
+    WorkStealingTaskScheduler(const WorkStealingTaskScheduler&) = delete;
+
+    ~WorkStealingTaskScheduler() override;
+
+    void start(unsigned int nbThread);
+
+    bool isClosing() const { return m_isClosing.load(std::memory_order_acquire); }
+
+    void wakeUpWorkers();
+
+    void putWorkersToSleep();
+
+    void waitForWork();
+
+    /**
+     * Assuming 2 concurrent threads by CPU core, return the number of CPU core on the system
+     */
+    static unsigned GetHardwareThreadsCount();
+
+private:
+
+    // index 0 is the thread which created the scheduler
+    std::vector<std::unique_ptr<WorkStealingWorkerThread> > m_workers;
+
+    // status of the first task pushed while the workers were idle
+    std::atomic<const Task::Status*> m_mainTaskStatus;
+
+    std::mutex m_wakeUpMutex;
+
+    std::condition_variable m_wakeUpEvent;
+
+    bool m_workerThreadsIdle;
+
+    std::atomic<bool> m_isClosing;
+
+    bool m_isInitialized;
+
+    unsigned m_threadCount;
+
+    friend class WorkStealingWorkerThread;
+};
+
+} // namespace sofa::simulation
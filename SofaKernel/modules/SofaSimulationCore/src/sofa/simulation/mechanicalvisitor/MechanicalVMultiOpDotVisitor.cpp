@@ -0,0 +1,53 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/mechanicalvisitor/MechanicalVMultiOpDotVisitor.h>
+
+namespace sofa::simulation::mechanicalvisitor
+{
+
+MechanicalVMultiOpDotVisitor::MechanicalVMultiOpDotVisitor(const sofa::core::ExecParams* params, const VMultiOp& ops, const VMultiDot& dots, SReal* results)
+    : BaseMechanicalVisitor(params), ops(ops), dots(dots), results(results), stateResults(dots.size())
+{
+#ifdef SOFA_DUMP_VISITOR_INFO
+    setReadWriteVectors();
+#endif
+    std::fill(results, results + dots.size(), SReal(0));
+}
+
+Visitor::Result MechanicalVMultiOpDotVisitor::fwdMechanicalState(VisitorContext* /*ctx*/, core::behavior::BaseMechanicalState* mm)
+{
+    mm->vMultiOpDot(this->params, ops, dots, stateResults.data());
+    for (std::size_t i = 0; i < dots.size(); ++i)
+        results[i] += stateResults[i];
+    return RESULT_CONTINUE;
+}
+
+std::string MechanicalVMultiOpDotVisitor::getInfos() const
+{
+    std::ostringstream out;
+    out << ops.size() << " operations";
+    for (const auto& dot : dots)
+        out << " ;   " << dot.first.getName() << "*" << dot.second.getName();
+    return out.str();
+}
+
+}
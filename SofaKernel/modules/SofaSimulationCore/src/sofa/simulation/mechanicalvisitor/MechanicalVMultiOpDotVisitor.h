@@ -0,0 +1,89 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/simulation/BaseMechanicalVisitor.h>
+
+#include <sofa/core/behavior/BaseMechanicalState.h>
+
+namespace sofa::simulation::mechanicalvisitor
+{
+
+/** Perform a sequence of linear vector accumulation operations (see MechanicalVMultiOpVisitor), then compute
+*   the scalar products of pairs of vectors, in a single traversal.
+*
+*   The mechanical states may fuse the operations and the scalar products into one pass over their vectors
+*   (see BaseMechanicalState::vMultiOpDot). The scalar products are summed over the non-mapped states.
+*
+*   It is used by CGLinearSolver to update x and r and compute r.r in one traversal. The ODE solvers, such as
+*   EulerImplicitSolver or RungeKutta4Solver, already group their updates in single VMultiOp traversals and
+*   compute no scalar product, so they have nothing to fuse.
+*/
+class SOFA_SIMULATION_CORE_API MechanicalVMultiOpDotVisitor : public BaseMechanicalVisitor
+{
+public:
+    typedef sofa::core::behavior::BaseMechanicalState::VMultiOp VMultiOp;
+    typedef sofa::core::behavior::BaseMechanicalState::VMultiDot VMultiDot;
+
+    /// @param results array of dots.size() values, receiving the scalar products
+    MechanicalVMultiOpDotVisitor(const sofa::core::ExecParams* params, const VMultiOp& ops, const VMultiDot& dots, SReal* results);
+
+    Result fwdMechanicalState(VisitorContext* ctx,sofa::core::behavior::BaseMechanicalState* mm) override;
+
+    const char* getClassName() const override { return "MechanicalVMultiOpDotVisitor"; }
+    std::string getInfos() const override;
+
+    bool readNodeData() const override
+    {
+        return true;
+    }
+    bool writeNodeData() const override
+    {
+        return true;
+    }
+#ifdef SOFA_DUMP_VISITOR_INFO
+    void setReadWriteVectors() override
+    {
+        for (unsigned int i=0; i<ops.size(); ++i)
+        {
+            addWriteVector(ops[i].first);
+            for (unsigned int j=0; j<ops[i].second.size(); ++j)
+            {
+                addReadVector(ops[i].second[j].first);
+            }
+        }
+        for (unsigned int i=0; i<dots.size(); ++i)
+        {
+            addReadVector(dots[i].first);
+            addReadVector(dots[i].second);
+        }
+    }
+#endif
+
+protected:
+    VMultiOp ops;
+    VMultiDot dots;
+    SReal* results;
+    type::vector<SReal> stateResults;
+};
+
+}
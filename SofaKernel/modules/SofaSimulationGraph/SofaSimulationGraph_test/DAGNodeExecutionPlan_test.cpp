@@ -0,0 +1,156 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/testing/BaseTest.h>
+using sofa::testing::BaseTest;
+
+#include <SofaSimulationGraph/DAGNode.h>
+#include <sofa/core/ExecParams.h>
+#include <sofa/simulation/BaseMechanicalVisitor.h>
+
+using namespace sofa;
+using namespace simulation::graph;
+
+namespace
+{
+
+/// Visitor recording the order of the node traversals, and pruning the nodes named "pruned"
+template<class TVisitor>
+class RecordingVisitor : public TVisitor
+{
+public:
+    RecordingVisitor() : TVisitor(core::ExecParams::defaultInstance())
+    {
+        this->canAccessSleepingNode = false;
+    }
+
+    simulation::Visitor::Result processNodeTopDown(simulation::Node* node) override
+    {
+        topDown.push_back(node->getName());
+        return node->getName() == "pruned" ? simulation::Visitor::RESULT_PRUNE : simulation::Visitor::RESULT_CONTINUE;
+    }
+
+    void processNodeBottomUp(simulation::Node* node) override
+    {
+        bottomUp.push_back(node->getName());
+    }
+
+    bool childOrderReversed(simulation::Node* node) override { return reversed && node->getName() == "node1"; }
+
+    std::vector<std::string> topDown;
+    std::vector<std::string> bottomUp;
+    bool reversed { false };
+};
+
+}
+
+/// The mechanical visitors follow the cached execution plan, which must give the same traversal as the generic one
+struct DAGNodeExecutionPlan_test : public BaseTest
+{
+    DAGNode::SPtr root;
+
+    void onSetUp() override
+    {
+        root = core::objectmodel::New<DAGNode>("root");
+        DAGNode::SPtr node1 = addChild(root, "node1");
+        addChild(node1, "node11");
+        addChild(addChild(node1, "node12"), "node121");
+        addChild(addChild(root, "pruned"), "node21");
+        DAGNode::SPtr node3 = addChild(root, "node3");
+        addChild(node3, "node31");
+        addChild(node3, "node32");
+    }
+
+    DAGNode::SPtr addChild(DAGNode::SPtr parent, const std::string& name)
+    {
+        DAGNode::SPtr node = core::objectmodel::New<DAGNode>(name);
+        parent->addChild(node);
+        return node;
+    }
+
+    void checkSameTraversal(DAGNode* from, bool reversed = false)
+    {
+        RecordingVisitor<simulation::Visitor> visitor;
+        visitor.reversed = reversed;
+        from->executeVisitor(&visitor);
+
+        RecordingVisitor<simulation::BaseMechanicalVisitor> mechanicalVisitor;
+        mechanicalVisitor.reversed = reversed;
+        from->executeVisitor(&mechanicalVisitor);
+
+        EXPECT_EQ(visitor.topDown, mechanicalVisitor.topDown);
+        EXPECT_EQ(visitor.bottomUp, mechanicalVisitor.bottomUp);
+    }
+
+    void test_tree()
+    {
+        checkSameTraversal(root.get());
+        checkSameTraversal(root.get(), true);
+        checkSameTraversal(static_cast<DAGNode*>(root->getChild("node1")));
+
+        RecordingVisitor<simulation::BaseMechanicalVisitor> visitor;
+        root->executeVisitor(&visitor);
+        EXPECT_EQ(9u, visitor.topDown.size());
+    }
+
+    void test_graphModification()
+    {
+        checkSameTraversal(root.get());
+
+        DAGNode* node3 = static_cast<DAGNode*>(root->getChild("node3"));
+        addChild(static_cast<DAGNode*>(node3->getChild("node31")), "node311");
+        checkSameTraversal(root.get());
+
+        node3->removeChild(node3->getChild("node32"));
+        checkSameTraversal(root.get());
+
+        RecordingVisitor<simulation::BaseMechanicalVisitor> visitor;
+        root->executeVisitor(&visitor);
+        EXPECT_NE(visitor.topDown.end(), std::find(visitor.topDown.begin(), visitor.topDown.end(), "node311"));
+        EXPECT_EQ(visitor.topDown.end(), std::find(visitor.topDown.begin(), visitor.topDown.end(), "node32"));
+    }
+
+    void test_inactiveAndSleepingNodes()
+    {
+        root->getChild("node3")->setActive(false);
+        checkSameTraversal(root.get());
+
+        root->getChild("node3")->setActive(true);
+        static_cast<DAGNode*>(root->getChild("node1"))->setSleeping(true);
+        checkSameTraversal(root.get());
+    }
+
+    void test_multipleParents()
+    {
+        // the execution plan is not used on a DAG, whose traversal depends on the parents status
+        DAGNode::SPtr node1 = static_cast<DAGNode*>(root->getChild("node1"));
+        DAGNode::SPtr node3 = static_cast<DAGNode*>(root->getChild("node3"));
+        node3->addChild(node1->getChild("node11"));
+        root->getChild("pruned")->addChild(node3->getChild("node31"));
+        checkSameTraversal(root.get());
+        checkSameTraversal(node3.get());
+    }
+};
+
+TEST_F(DAGNodeExecutionPlan_test, test_tree) { test_tree(); }
+TEST_F(DAGNodeExecutionPlan_test, test_graphModification) { test_graphModification(); }
+TEST_F(DAGNodeExecutionPlan_test, test_inactiveAndSleepingNodes) { test_inactiveAndSleepingNodes(); }
+TEST_F(DAGNodeExecutionPlan_test, test_multipleParents) { test_multipleParents(); }
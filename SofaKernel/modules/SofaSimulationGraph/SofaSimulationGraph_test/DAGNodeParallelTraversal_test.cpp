@@ -0,0 +1,357 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/testing/BaseTest.h>
+using sofa::testing::BaseTest;
+
+#include <SofaSimulationGraph/DAGNode.h>
+#include <sofa/core/ExecParams.h>
+#include <sofa/simulation/BaseMechanicalVisitor.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <SofaBaseMechanics/MechanicalObject.h>
+#include <SofaBaseMechanics/IdentityMapping.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace sofa;
+using namespace simulation::graph;
+
+namespace
+{
+
+/// Mechanical visitor recording the order of the node traversals
+class RecordingVisitor : public simulation::BaseMechanicalVisitor
+{
+public:
+    RecordingVisitor() : simulation::BaseMechanicalVisitor(core::ExecParams::defaultInstance()) {}
+
+    Result processNodeTopDown(simulation::Node* node) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        topDown.push_back(node->getName());
+        return RESULT_CONTINUE;
+    }
+
+    void processNodeBottomUp(simulation::Node* node) override
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        bottomUp.push_back(node->getName());
+    }
+
+    bool isThreadSafe() const override { return true; }
+
+    std::vector<std::string> topDown;
+    std::vector<std::string> bottomUp;
+
+private:
+    std::mutex m_mutex;
+};
+
+/// Mechanical visitor waiting in the top-down traversal of the given nodes until several of them are traversed
+/// at the same time (or until a timeout), recording the number of concurrent traversals and the threads
+class ConcurrencyVisitor : public simulation::BaseMechanicalVisitor
+{
+public:
+    explicit ConcurrencyVisitor(std::set<std::string> waitingNodes, std::chrono::milliseconds timeout = std::chrono::seconds(5))
+        : simulation::BaseMechanicalVisitor(core::ExecParams::defaultInstance())
+        , m_waitingNodes(std::move(waitingNodes))
+        , m_timeout(timeout)
+    {}
+
+    Result processNodeTopDown(simulation::Node* node) override
+    {
+        if (m_waitingNodes.count(node->getName()) == 0)
+            return RESULT_CONTINUE;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        threads.insert(std::this_thread::get_id());
+        maxConcurrentNodes = std::max(maxConcurrentNodes, ++m_concurrentNodes);
+        m_condition.notify_all();
+        m_condition.wait_for(lock, m_timeout, [this] { return maxConcurrentNodes > 1; });
+        --m_concurrentNodes;
+        return RESULT_CONTINUE;
+    }
+
+    bool isThreadSafe() const override { return true; }
+
+    std::size_t maxConcurrentNodes { 0 };
+    std::set<std::thread::id> threads;
+
+private:
+    std::set<std::string> m_waitingNodes;
+    std::chrono::milliseconds m_timeout;
+    std::size_t m_concurrentNodes { 0 };
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+};
+
+std::size_t position(const std::vector<std::string>& events, const std::string& name)
+{
+    return std::size_t(std::find(events.begin(), events.end(), name) - events.begin());
+}
+
+}
+
+struct DAGNodeParallelTraversal_test : public BaseTest
+{
+    DAGNode::SPtr root;
+
+    void onSetUp() override
+    {
+        simulation::TaskScheduler* taskScheduler = simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 2)
+            taskScheduler->init(4);
+
+        root = core::objectmodel::New<DAGNode>("root");
+        root->d_parallelTraversal.setValue(true);
+    }
+
+    DAGNode::SPtr addChild(DAGNode::SPtr parent, const std::string& name)
+    {
+        DAGNode::SPtr node = core::objectmodel::New<DAGNode>(name);
+        parent->addChild(node);
+        return node;
+    }
+
+    /// every node is traversed once, the parents before their children in the top-down traversal,
+    /// and after them in the bottom-up traversal
+    void checkTraversal(const RecordingVisitor& visitor, const std::vector<std::pair<std::string, std::string> >& edges, std::size_t nbNodes)
+    {
+        ASSERT_EQ(nbNodes, visitor.topDown.size());
+        ASSERT_EQ(nbNodes, visitor.bottomUp.size());
+        for (const std::string& name : visitor.topDown)
+            EXPECT_EQ(1, std::count(visitor.topDown.begin(), visitor.topDown.end(), name)) << name;
+
+        for (const auto& edge : edges)
+        {
+            EXPECT_LT(position(visitor.topDown, edge.first), position(visitor.topDown, edge.second)) << edge.first << " -> " << edge.second;
+            EXPECT_GT(position(visitor.bottomUp, edge.first), position(visitor.bottomUp, edge.second)) << edge.first << " -> " << edge.second;
+        }
+    }
+
+    void test_independentSubtrees()
+    {
+        std::vector<std::pair<std::string, std::string> > edges;
+        for (unsigned int i = 0; i < 8; ++i)
+        {
+            const std::string name = "node" + std::to_string(i);
+            DAGNode::SPtr node = addChild(root, name);
+            DAGNode::SPtr child1 = addChild(node, name + "_1");
+            addChild(child1, name + "_11");
+            addChild(node, name + "_2");
+
+            edges.push_back({ "root", name });
+            edges.push_back({ name, name + "_1" });
+            edges.push_back({ name + "_1", name + "_11" });
+            edges.push_back({ name, name + "_2" });
+        }
+
+        RecordingVisitor visitor;
+        root->executeVisitor(&visitor);
+        checkTraversal(visitor, edges, 33);
+    }
+
+    void test_multipleParents()
+    {
+        DAGNode::SPtr node1 = addChild(root, "node1");
+        DAGNode::SPtr node2 = addChild(root, "node2");
+        addChild(root, "node3");
+        addChild(root, "node4");
+        DAGNode::SPtr shared = addChild(node1, "shared");
+        node2->addChild(shared);
+
+        RecordingVisitor visitor;
+        root->executeVisitor(&visitor);
+        checkTraversal(visitor, { {"root", "node1"}, {"root", "node2"}, {"root", "node3"}, {"root", "node4"},
+                                  {"node1", "shared"}, {"node2", "shared"} }, 6);
+
+        // the subtrees sharing a node are traversed sequentially
+        EXPECT_LT(position(visitor.topDown, "node1"), position(visitor.topDown, "node2"));
+        EXPECT_LT(position(visitor.topDown, "node2"), position(visitor.topDown, "shared"));
+    }
+
+    void test_mappedSubtrees()
+    {
+        using MechanicalObject3 = component::container::MechanicalObject<defaulttype::Vec3Types>;
+        using IdentityMapping3 = component::mapping::IdentityMapping<defaulttype::Vec3Types, defaulttype::Vec3Types>;
+
+        DAGNode::SPtr node1 = addChild(root, "node1");
+        DAGNode::SPtr node11 = addChild(node1, "node11");
+        DAGNode::SPtr node2 = addChild(root, "node2");
+        DAGNode::SPtr node21 = addChild(node2, "node21");
+        addChild(root, "node3");
+        addChild(root, "node4");
+
+        MechanicalObject3::SPtr from = core::objectmodel::New<MechanicalObject3>();
+        node11->addObject(from);
+        MechanicalObject3::SPtr to = core::objectmodel::New<MechanicalObject3>();
+        node21->addObject(to);
+        IdentityMapping3::SPtr mapping = core::objectmodel::New<IdentityMapping3>();
+        mapping->setModels(from.get(), to.get());
+        node21->addObject(mapping);
+
+        RecordingVisitor visitor;
+        root->executeVisitor(&visitor);
+        checkTraversal(visitor, { {"root", "node1"}, {"root", "node2"}, {"root", "node3"}, {"root", "node4"},
+                                  {"node1", "node11"}, {"node2", "node21"} }, 7);
+
+        // the subtrees linked by the mapping are traversed sequentially
+        EXPECT_LT(position(visitor.topDown, "node11"), position(visitor.topDown, "node2"));
+        EXPECT_LT(position(visitor.bottomUp, "node21"), position(visitor.bottomUp, "node1"));
+    }
+
+    void test_concurrentSubtrees()
+    {
+        std::set<std::string> subtrees;
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            const std::string name = "node" + std::to_string(i);
+            addChild(addChild(root, name), name + "_1");
+            subtrees.insert(name);
+        }
+
+        // each subtree waits for another one to be traversed at the same time
+        ConcurrencyVisitor visitor(subtrees);
+        root->executeVisitor(&visitor);
+        EXPECT_GT(visitor.maxConcurrentNodes, 1u);
+        EXPECT_GT(visitor.threads.size(), 1u);
+
+        // without parallel traversal, the subtrees are traversed one after the other by the calling thread
+        root->d_parallelTraversal.setValue(false);
+        ConcurrencyVisitor sequentialVisitor(subtrees, std::chrono::milliseconds(0));
+        root->executeVisitor(&sequentialVisitor);
+        EXPECT_EQ(1u, sequentialVisitor.maxConcurrentNodes);
+        EXPECT_EQ(1u, sequentialVisitor.threads.size());
+        EXPECT_EQ(1u, sequentialVisitor.threads.count(std::this_thread::get_id()));
+    }
+
+    void test_linkAddedAfterTraversal()
+    {
+        using MechanicalObject3 = component::container::MechanicalObject<defaulttype::Vec3Types>;
+        using IdentityMapping3 = component::mapping::IdentityMapping<defaulttype::Vec3Types, defaulttype::Vec3Types>;
+
+        DAGNode::SPtr node1 = addChild(root, "node1");
+        DAGNode::SPtr node11 = addChild(node1, "node11");
+        DAGNode::SPtr node2 = addChild(root, "node2");
+        DAGNode::SPtr node21 = addChild(node2, "node21");
+        addChild(root, "node3");
+        addChild(root, "node4");
+
+        MechanicalObject3::SPtr from = core::objectmodel::New<MechanicalObject3>();
+        node11->addObject(from);
+        MechanicalObject3::SPtr to = core::objectmodel::New<MechanicalObject3>();
+        node21->addObject(to);
+
+        // the independent subtrees are computed and cached by a first traversal
+        ConcurrencyVisitor concurrentVisitor({ "node1", "node2" });
+        root->executeVisitor(&concurrentVisitor);
+        EXPECT_GT(concurrentVisitor.maxConcurrentNodes, 1u);
+
+        // adding the mapping invalidates the cached subtrees
+        IdentityMapping3::SPtr mapping = core::objectmodel::New<IdentityMapping3>();
+        mapping->setModels(from.get(), to.get());
+        node21->addObject(mapping);
+
+        RecordingVisitor visitor;
+        root->executeVisitor(&visitor);
+        checkTraversal(visitor, { {"root", "node1"}, {"root", "node2"}, {"root", "node3"}, {"root", "node4"},
+                                  {"node1", "node11"}, {"node2", "node21"} }, 7);
+        EXPECT_LT(position(visitor.topDown, "node11"), position(visitor.topDown, "node2"));
+        EXPECT_LT(position(visitor.bottomUp, "node21"), position(visitor.bottomUp, "node1"));
+    }
+
+    void test_dataLinkedSubtrees()
+    {
+        using MechanicalObject3 = component::container::MechanicalObject<defaulttype::Vec3Types>;
+
+        DAGNode::SPtr node1 = addChild(root, "node1");
+        DAGNode::SPtr node11 = addChild(node1, "node11");
+        DAGNode::SPtr node2 = addChild(root, "node2");
+        DAGNode::SPtr node21 = addChild(node2, "node21");
+        addChild(root, "node3");
+        addChild(root, "node4");
+
+        MechanicalObject3::SPtr from = core::objectmodel::New<MechanicalObject3>();
+        node11->addObject(from);
+        MechanicalObject3::SPtr to = core::objectmodel::New<MechanicalObject3>();
+        node21->addObject(to);
+        to->x.setParent(&from->x);
+
+        // the subtrees linked by the Data are traversed one after the other, in the same task
+        RecordingVisitor visitor;
+        root->executeVisitor(&visitor);
+        checkTraversal(visitor, { {"root", "node1"}, {"root", "node2"}, {"root", "node3"}, {"root", "node4"},
+                                  {"node1", "node11"}, {"node2", "node21"} }, 7);
+        EXPECT_LT(position(visitor.topDown, "node11"), position(visitor.topDown, "node2"));
+
+        ConcurrencyVisitor linkedVisitor({ "node1", "node2" }, std::chrono::milliseconds(100));
+        root->executeVisitor(&linkedVisitor);
+        EXPECT_EQ(1u, linkedVisitor.maxConcurrentNodes);
+
+        // the other subtrees are still traversed concurrently
+        ConcurrencyVisitor otherVisitor({ "node1", "node3", "node4" });
+        root->executeVisitor(&otherVisitor);
+        EXPECT_GT(otherVisitor.maxConcurrentNodes, 1u);
+    }
+
+    void test_sharedDataDependency()
+    {
+        using MechanicalObject3 = component::container::MechanicalObject<defaulttype::Vec3Types>;
+
+        MechanicalObject3::SPtr source = core::objectmodel::New<MechanicalObject3>();
+        root->addObject(source);
+
+        std::set<std::string> readers;
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            const std::string name = "node" + std::to_string(i);
+            DAGNode::SPtr node = addChild(root, name);
+            if (i < 2)
+            {
+                MechanicalObject3::SPtr reader = core::objectmodel::New<MechanicalObject3>();
+                addChild(node, name + "_1")->addObject(reader);
+                reader->x.setParent(&source->x);
+                readers.insert(name);
+            }
+        }
+
+        // the subtrees reading the same Data outside of them are not traversed concurrently
+        ConcurrencyVisitor sharedVisitor(readers, std::chrono::milliseconds(100));
+        root->executeVisitor(&sharedVisitor);
+        EXPECT_EQ(1u, sharedVisitor.maxConcurrentNodes);
+
+        ConcurrencyVisitor otherVisitor({ "node0", "node2", "node3" });
+        root->executeVisitor(&otherVisitor);
+        EXPECT_GT(otherVisitor.maxConcurrentNodes, 1u);
+    }
+};
+
+TEST_F(DAGNodeParallelTraversal_test, test_independentSubtrees) { test_independentSubtrees(); }
+TEST_F(DAGNodeParallelTraversal_test, test_multipleParents) { test_multipleParents(); }
+TEST_F(DAGNodeParallelTraversal_test, test_mappedSubtrees) { test_mappedSubtrees(); }
+TEST_F(DAGNodeParallelTraversal_test, test_concurrentSubtrees) { test_concurrentSubtrees(); }
+TEST_F(DAGNodeParallelTraversal_test, test_linkAddedAfterTraversal) { test_linkAddedAfterTraversal(); }
+TEST_F(DAGNodeParallelTraversal_test, test_dataLinkedSubtrees) { test_dataLinkedSubtrees(); }
+TEST_F(DAGNodeParallelTraversal_test, test_sharedDataDependency) { test_sharedDataDependency(); }
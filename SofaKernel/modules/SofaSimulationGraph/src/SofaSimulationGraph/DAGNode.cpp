@@ -23,6 +23,15 @@
 #include <SofaSimulationCommon/xml/NodeElement.h>
 #include <sofa/helper/Factory.inl>
 #include <sofa/core/Mapping.h>
+#include <sofa/core/behavior/BaseInteractionConstraint.h>
+#include <sofa/core/behavior/BaseInteractionForceField.h>
+#include <sofa/core/behavior/BaseInteractionProjectiveConstraintSet.h>
+#include <sofa/simulation/BaseMechanicalVisitor.h>
+#include <sofa/simulation/ParallelForEach.h>
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <algorithm>
+#include <functional>
 
 namespace sofa::simulation::graph
 {
@@ -121,6 +130,7 @@ GetUpObjectsVisitor::~GetUpObjectsVisitor(){}
 
 DAGNode::DAGNode(const std::string& name, DAGNode* parent)
     : simulation::Node(name)
+    , d_parallelTraversal(initData(&d_parallelTraversal, false, "parallelTraversal", "run the thread-safe mechanical visitors in parallel on the child subtrees which are independent from the rest of the graph"))
     , l_parents(initLink("parents", "Parents nodes in the graph"))
 {
     if( parent )
@@ -204,6 +214,20 @@ void DAGNode::doRemoveChild(BaseNode::SPtr node)
     dagnode->l_parents.remove(this);
 }
 
+/// Add an object, which may link the independent subtrees
+bool DAGNode::doAddObject(sofa::core::objectmodel::BaseObject::SPtr obj)
+{
+    ++s_graphRevision;
+    return Node::doAddObject(obj);
+}
+
+/// Remove an object, which may link the independent subtrees
+bool DAGNode::doRemoveObject(sofa::core::objectmodel::BaseObject::SPtr obj)
+{
+    ++s_graphRevision;
+    return Node::doRemoveObject(obj);
+}
+
 /// Move a node from another node
 void DAGNode::doMoveChild(BaseNode::SPtr node, BaseNode::SPtr previous_parent)
 {
@@ -601,12 +625,26 @@ void DAGNode::doExecuteVisitor(simulation::Visitor* action, bool precomputedOrde
             // that can have ancestors in another branch that is not pruned...
             // An already pruned node is ignored.
 
-            NodeList executedNodes;
+            // The mechanical visitors do not modify the graph and are run many times per time step:
+            // on a tree, they follow the cached execution plan instead of maintaining the traversal flags.
+
+            std::shared_ptr<const ExecutionPlan> plan;
+            if( dynamic_cast<BaseMechanicalVisitor*>(action) )
+                plan = getExecutionPlan();
+
+            if( plan && plan->isTree )
             {
-                StatusMap statusMap;
-                executeVisitorTopDown( action, executedNodes, statusMap, this );
+                executeVisitorWithPlan( action, *plan );
+            }
+            else
+            {
+                NodeList executedNodes;
+                {
+                    StatusMap statusMap;
+                    executeVisitorTopDown( action, executedNodes, statusMap, this );
+                }
+                executeVisitorBottomUp( action, executedNodes );
             }
-            executeVisitorBottomUp( action, executedNodes );
         }
     }
 }
@@ -689,6 +727,10 @@ void DAGNode::executeVisitorTopDown(simulation::Visitor* action, NodeList& execu
 
         executedNodes.push_back(this);
 
+        // the independent subtrees are traversed first, in parallel
+        if( result != simulation::Visitor::RESULT_PRUNE && canTraverseChildrenInParallel(action) )
+            executeVisitorOnIndependentChildren(action, statusMap);
+
         // ... and continue the recursion
         if( action->childOrderReversed(this) )
             for(unsigned int i = unsigned(child.size()); i>0;)
@@ -714,9 +756,366 @@ void DAGNode::executeVisitorBottomUp( simulation::Visitor* action, NodeList& exe
 }
 
 
+bool DAGNode::canTraverseChildrenInParallel(simulation::Visitor* action)
+{
+    if( !d_parallelTraversal.getValue() || child.size() < 2 || !action->isThreadSafe() )
+        return false;
+
+    // only the mechanical visitors are considered, except those reducing a value along the traversal (e.g. a dot product)
+    const BaseMechanicalVisitor* mechanicalVisitor = dynamic_cast<const BaseMechanicalVisitor*>(action);
+    if( !mechanicalVisitor || mechanicalVisitor->writeNodeData() )
+        return false;
+
+    TaskScheduler* taskScheduler = TaskScheduler::getInstance();
+    if( taskScheduler->getThreadCount() < 1 )
+    {
+        taskScheduler->init(0);
+        msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+    }
+    return taskScheduler->getThreadCount() > 1;
+}
+
+
+void DAGNode::executeVisitorOnIndependentChildren(simulation::Visitor* action, StatusMap& statusMap)
+{
+    std::vector<DAGNode*> subtrees;
+    executeVisitorOnIndependentChildren(action, subtrees);
+
+    for( DAGNode* dagnode : subtrees )
+        statusMap[dagnode] = VISITED;
+}
+
+
+void DAGNode::executeVisitorOnIndependentChildren(simulation::Visitor* action, std::vector<DAGNode*>& subtrees)
+{
+    const std::vector<int>& groupIndices = findIndependentChildren();
+
+    // an independent child has no other parent, so that it cannot have been visited yet
+    subtrees.clear();
+    std::vector< std::vector<DAGNode*> > groups;
+    for(unsigned int i = 0; i<child.size(); ++i)
+    {
+        const int group = groupIndices[i];
+        if( group < 0 )
+            continue;
+        if( group >= int(groups.size()) )
+            groups.resize(group + 1);
+        groups[group].push_back(static_cast<DAGNode*>(child[i].get()));
+        subtrees.push_back(static_cast<DAGNode*>(child[i].get()));
+    }
+    if( groups.size() < 2 )
+    {
+        subtrees.clear();
+        return;
+    }
+
+    // the descendancy is lazily computed during the traversal: make sure it is up to date before the concurrent traversals
+    updateDescendancy();
+
+    // the groups of subtrees are not linked to each other nor to the rest of the graph, so that their complete
+    // traversals can be run in any order. The subtrees of a group share a dependency and are traversed one after the other.
+    parallelForEach(std::size_t(0), groups.size(), [action, &groups](std::size_t i)
+    {
+        for( DAGNode* subtree : groups[i] )
+        {
+            NodeList executedNodes;
+            StatusMap statusMap;
+            subtree->executeVisitorTopDown(action, executedNodes, statusMap, subtree);
+            subtree->executeVisitorBottomUp(action, executedNodes);
+        }
+    }, 1);
+}
+
+
+std::shared_ptr<const DAGNode::ExecutionPlan> DAGNode::getExecutionPlan()
+{
+    if( !_executionPlan )
+    {
+        updateDescendancy();
+
+        auto plan = std::make_shared<ExecutionPlan>();
+        plan->entries.reserve(_descendancy.size() + 1);
+        plan->children.reserve(_descendancy.size());
+        plan->isTree = addToExecutionPlan(*plan, this, _descendancy.size() + 1);
+        if( !plan->isTree )
+        {
+            plan->entries.clear();
+            plan->children.clear();
+        }
+        _executionPlan = plan;
+    }
+    return _executionPlan;
+}
+
+
+bool DAGNode::addToExecutionPlan(ExecutionPlan& plan, DAGNode* node, std::size_t maxSize)
+{
+    // a node reached twice has several parents in the sub-graph
+    if( plan.entries.size() == maxSize )
+        return false;
+
+    const std::size_t index = plan.entries.size();
+    plan.entries.push_back({ node, 0, 0 });
+
+    std::vector<unsigned int> children;
+    children.reserve(node->child.size());
+    for(unsigned int i = 0; i<node->child.size(); ++i)
+    {
+        children.push_back(unsigned(plan.entries.size()));
+        if( !addToExecutionPlan(plan, static_cast<DAGNode*>(node->child[i].get()), maxSize) )
+            return false;
+    }
+
+    plan.entries[index].childBegin = unsigned(plan.children.size());
+    plan.children.insert(plan.children.end(), children.begin(), children.end());
+    plan.entries[index].childEnd = unsigned(plan.children.size());
+    return true;
+}
+
+
+void DAGNode::executeVisitorWithPlan(simulation::Visitor* action, const ExecutionPlan& plan)
+{
+    // in a tree, the DAG traversal is a depth-first traversal where a pruned node prunes its whole sub-graph
+    std::vector<DAGNode*> executedNodes;
+    executedNodes.reserve(plan.entries.size());
+    std::vector<unsigned int> stack;
+    stack.reserve(plan.entries.size());
+    stack.push_back(0);
+
+    std::vector<DAGNode*> parallelSubtrees;
+    while( !stack.empty() )
+    {
+        const ExecutionPlan::Entry& entry = plan.entries[stack.back()];
+        stack.pop_back();
+
+        DAGNode* node = entry.node;
+        if( !node->isActive() || ( node->isSleeping() && !action->canAccessSleepingNode ) )
+            continue;
+
+        const Visitor::Result result = action->processNodeTopDown(node);
+        executedNodes.push_back(node);
+        if( result == simulation::Visitor::RESULT_PRUNE )
+            continue;
+
+        parallelSubtrees.clear();
+        if( node->canTraverseChildrenInParallel(action) )
+            node->executeVisitorOnIndependentChildren(action, parallelSubtrees);
+
+        // the children are pushed in the reverse order of their traversal
+        const auto push = [&](unsigned int i)
+        {
+            const unsigned int childIndex = plan.children[i];
+            if( parallelSubtrees.empty() || std::find(parallelSubtrees.begin(), parallelSubtrees.end(), plan.entries[childIndex].node) == parallelSubtrees.end() )
+                stack.push_back(childIndex);
+        };
+        if( action->childOrderReversed(node) )
+            for(unsigned int i = entry.childBegin; i<entry.childEnd; ++i)
+                push(i);
+        else
+            for(unsigned int i = entry.childEnd; i>entry.childBegin;)
+                push(--i);
+    }
+
+    for( auto it = executedNodes.rbegin(), itend = executedNodes.rend() ; it != itend ; ++it )
+        action->processNodeBottomUp( *it );
+}
+
+
+std::atomic<std::size_t> DAGNode::s_graphRevision { 1 };
+
+
+const std::vector<int>& DAGNode::findIndependentChildren()
+{
+    const std::size_t revision = s_graphRevision.load();
+    if( _independentChildrenRevision != revision || _independentChildren.size() != child.size() )
+    {
+        computeIndependentChildren(_independentChildren);
+        _independentChildrenRevision = revision;
+    }
+    return _independentChildren;
+}
+
+
+void DAGNode::computeIndependentChildren(std::vector<int>& groups)
+{
+    std::vector<bool> independent(child.size(), true);
+
+    updateDescendancy();
+    std::map<const DAGNode*, int> childIndex;
+    for(unsigned int i = 0; i<child.size(); ++i)
+    {
+        DAGNode* dagnode = static_cast<DAGNode*>(child[i].get());
+        childIndex[dagnode] = int(i);
+
+        // every node of the subtree must only have parents in the subtree
+        if( dagnode->getNbParents() != 1 )
+        {
+            independent[i] = false;
+            continue;
+        }
+        for( DAGNode* descendant : dagnode->_descendancy )
+        {
+            for( DAGNode* parent : descendant->l_parents.getValue() )
+            {
+                if( parent != dagnode && dagnode->_descendancy.find(parent) == dagnode->_descendancy.end() )
+                    independent[i] = false;
+            }
+        }
+    }
+
+    // index of the child subtree containing a given node, -1 if outside of the subtrees
+    std::map<const core::objectmodel::BaseContext*, int> subtreeIndex;
+    const auto findSubtree = [this, &childIndex, &subtreeIndex](const core::objectmodel::BaseContext* context)
+    {
+        const auto it = subtreeIndex.find(context);
+        if( it != subtreeIndex.end() )
+            return it->second;
+
+        int index = -1;
+        const DAGNode* node = dynamic_cast<const DAGNode*>(context);
+        while( node && node != this )
+        {
+            const auto c = childIndex.find(node);
+            if( c != childIndex.end() )
+            {
+                index = c->second;
+                break;
+            }
+            node = static_cast<const DAGNode*>(node->getFirstParent());
+        }
+        subtreeIndex[context] = index;
+        return index;
+    };
+
+    // a component linking several subtrees, or a subtree and the rest of the graph, makes them dependent
+    const auto checkLink = [&independent, &findSubtree](const core::objectmodel::BaseObject* component, const type::vector<core::behavior::BaseMechanicalState*>& states)
+    {
+        std::vector<int> indices;
+        indices.push_back(findSubtree(component->getContext()));
+        for( const core::behavior::BaseMechanicalState* state : states )
+        {
+            if( state )
+                indices.push_back(findSubtree(state->getContext()));
+        }
+        if( std::adjacent_find(indices.begin(), indices.end(), std::not_equal_to<int>()) != indices.end() )
+        {
+            for( int index : indices )
+            {
+                if( index >= 0 )
+                    independent[index] = false;
+            }
+        }
+    };
+
+    // the links are searched in the whole graph, as any component may be linked with the subtrees
+    DAGNode* root = this;
+    while( root->getFirstParent() )
+        root = static_cast<DAGNode*>(root->getFirstParent());
+    root->updateDescendancy();
+
+    // a component reading a Data, or linking an object, of another subtree, or of a node outside of the subtrees
+    // also read by other subtrees, makes the subtrees share a dependency: they are grouped, to be traversed sequentially.
+    // The units are the subtrees, followed by the nodes outside of them, and are merged in a union-find.
+    std::vector<int> unitParent(child.size());
+    for(unsigned int i = 0; i<child.size(); ++i)
+        unitParent[i] = int(i);
+    std::map<const core::objectmodel::BaseContext*, int> externalUnit;
+    const auto findUnit = [&unitParent](int unit)
+    {
+        while( unitParent[unit] != unit )
+            unit = unitParent[unit] = unitParent[unitParent[unit]];
+        return unit;
+    };
+    const auto getUnit = [&findSubtree, &unitParent, &externalUnit](const core::objectmodel::BaseContext* context)
+    {
+        const int index = findSubtree(context);
+        if( index >= 0 )
+            return index;
+        const auto it = externalUnit.emplace(context, int(unitParent.size()));
+        if( it.second )
+            unitParent.push_back(it.first->second);
+        return it.first->second;
+    };
+    const auto contextOf = [](const core::objectmodel::Base* base) -> const core::objectmodel::BaseContext*
+    {
+        if( const auto* object = dynamic_cast<const core::objectmodel::BaseObject*>(base) )
+            return object->getContext();
+        return dynamic_cast<const core::objectmodel::BaseContext*>(base);
+    };
+    const auto addDependency = [&findUnit, &getUnit, &unitParent](const core::objectmodel::BaseContext* reader, const core::objectmodel::BaseContext* dependency)
+    {
+        if( !reader || !dependency || reader == dependency )
+            return;
+        const int a = findUnit(getUnit(reader));
+        const int b = findUnit(getUnit(dependency));
+        if( a != b )
+            unitParent[std::max(a, b)] = std::min(a, b);
+    };
+    const auto checkDependencies = [&addDependency, &contextOf](core::objectmodel::BaseObject* object)
+    {
+        const core::objectmodel::BaseContext* context = object->getContext();
+        for( core::objectmodel::BaseData* data : object->getDataFields() )
+        {
+            // the Data links (@path.data) and the inputs of the engines
+            for( core::objectmodel::DDGNode* input : data->getInputs() )
+            {
+                if( const auto* inputData = dynamic_cast<const core::objectmodel::BaseData*>(input) )
+                    addDependency(context, contextOf(inputData->getOwner()));
+            }
+        }
+        for( core::objectmodel::BaseLink* link : object->getLinks() )
+        {
+            for( std::size_t i = 0; i<link->getSize(); ++i )
+                addDependency(context, contextOf(link->getLinkedBase(i)));
+        }
+    };
+
+    const auto checkNode = [&checkLink, &checkDependencies](DAGNode* node)
+    {
+        for( const core::objectmodel::BaseObject::SPtr& object : node->object )
+            checkDependencies(object.get());
+
+        for( core::behavior::BaseInteractionForceField* ff : node->interactionForceField )
+            checkLink(ff, { ff->getMechModel1(), ff->getMechModel2() });
+        for( core::behavior::BaseConstraintSet* c : node->constraintSet )
+        {
+            if( auto* interaction = dynamic_cast<core::behavior::BaseInteractionConstraint*>(c) )
+                checkLink(c, { interaction->getMechModel1(), interaction->getMechModel2() });
+        }
+        for( core::behavior::BaseProjectiveConstraintSet* c : node->projectiveConstraintSet )
+        {
+            if( auto* interaction = dynamic_cast<core::behavior::BaseInteractionProjectiveConstraintSet*>(c) )
+                checkLink(c, { interaction->getMechModel1(), interaction->getMechModel2() });
+        }
+        if( core::BaseMapping* mapping = node->mechanicalMapping.get() )
+        {
+            type::vector<core::behavior::BaseMechanicalState*> states = mapping->getMechFrom();
+            const type::vector<core::behavior::BaseMechanicalState*> to = mapping->getMechTo();
+            states.insert(states.end(), to.begin(), to.end());
+            checkLink(mapping, states);
+        }
+    };
+
+    checkNode(root);
+    for( DAGNode* node : root->_descendancy )
+        checkNode(node);
+
+    // dense indices of the groups of independent subtrees
+    groups.assign(child.size(), -1);
+    std::map<int, int> groupIndex;
+    for(unsigned int i = 0; i<child.size(); ++i)
+    {
+        if( independent[i] )
+            groups[i] = groupIndex.emplace(findUnit(int(i)), int(groupIndex.size())).first->second;
+    }
+}
+
+
 void DAGNode::setDirtyDescendancy()
 {
+    ++s_graphRevision;
     _descendancy.clear();
+    _executionPlan.reset();
     const LinkParents::Container &parents = l_parents.getValue();
     for ( unsigned int i = 0; i < parents.size() ; i++ )
     {
@@ -782,6 +1181,13 @@ void DAGNode::executeVisitorTreeTraversal( simulation::Visitor* action, StatusMa
 }
 
 
+void DAGNode::bwdInit()
+{
+    ++s_graphRevision;
+    Node::bwdInit();
+}
+
+
 void DAGNode::initVisualContext()
 {
     if (getNbParents())
@@ -25,6 +25,9 @@
 #include <sofa/core/objectmodel/Link.h>
 #include <sofa/simulation/Visitor.h>
 
+#include <atomic>
+#include <memory>
+
 namespace sofa::simulation::graph
 {
 
@@ -36,6 +39,10 @@ namespace sofa::simulation::graph
  * NB: contrary to the "tree" traversal, there are no interlinked forward/backward callbacks. There are only forward then only backward callbacks.
  *
  * Note that nodes created during a traversal are not traversed if they are created upper than the current node during the top-down traversal or if they are created during the bottom-up traversal.
+ *
+ * When parallelTraversal is enabled, the thread-safe mechanical visitors are run in parallel on the child subtrees
+ * which are independent from the rest of the graph: each of them is traversed top-down then bottom-up in its own task.
+ * The other children are then traversed sequentially, as usual.
  */
 class SOFA_SOFASIMULATIONGRAPH_API DAGNode : public simulation::Node
 {
@@ -46,6 +53,7 @@ public:
     typedef MultiLink<DAGNode,DAGNode,BaseLink::FLAG_STOREPATH|BaseLink::FLAG_DOUBLELINK> LinkParents;
     typedef LinkParents::const_iterator ParentIterator;
 
+    Data<bool> d_parallelTraversal; ///< run the thread-safe mechanical visitors in parallel on the independent child subtrees
 
 protected:
     DAGNode( const std::string& name="", DAGNode* parent=nullptr  );
@@ -110,6 +118,9 @@ public:
     /// Called during initialization to corectly propagate the visual context to the children
     void initVisualContext() override;
 
+    /// Called after the initialization of the components, which resolves their links between the subtrees
+    void bwdInit() override;
+
     /// Update the whole context values, based on parent and local ContextObjects
     void updateContext() override;
 
@@ -147,6 +158,9 @@ protected:
     virtual void doRemoveChild(BaseNode::SPtr node) override;
     virtual void doMoveChild(BaseNode::SPtr node, BaseNode::SPtr previous_parent) override;
 
+    bool doAddObject(sofa::core::objectmodel::BaseObject::SPtr obj) override;
+    bool doRemoveObject(sofa::core::objectmodel::BaseObject::SPtr obj) override;
+
 
     /// Execute a recursive action starting from this node.
     void doExecuteVisitor(simulation::Visitor* action, bool precomputedOrder=false) override;
@@ -203,6 +217,63 @@ protected:
     /// @visitorRoot node from where the visitor has been run
     void executeVisitorTopDown(simulation::Visitor* action, NodeList& executedNodes, StatusMap& statusMap, DAGNode* visitorRoot );
     void executeVisitorBottomUp(simulation::Visitor* action, NodeList& executedNodes );
+
+    /// flattened traversal of the sub-graph from this Node, built once and reused until the graph is modified
+    struct ExecutionPlan
+    {
+        struct Entry
+        {
+            DAGNode* node;
+            unsigned int childBegin; ///< first index of the child entries in ExecutionPlan::children
+            unsigned int childEnd;
+        };
+
+        std::vector<Entry> entries;          ///< the sub-graph nodes in depth-first order, starting from this Node
+        std::vector<unsigned int> children;  ///< indices of the child entries, grouped per node
+        bool isTree { true };                ///< the plan can only be used if no node has several parents in the sub-graph
+    };
+
+    /// the cached execution plan, reset when the descendancy is dirtied
+    std::shared_ptr<const ExecutionPlan> _executionPlan;
+
+    /// @internal get the execution plan of the sub-graph from this Node, building it if needed
+    std::shared_ptr<const ExecutionPlan> getExecutionPlan();
+
+    /// @internal add the given node and its sub-graph to the plan, returns false as soon as a node is reached twice
+    static bool addToExecutionPlan(ExecutionPlan& plan, DAGNode* node, std::size_t maxSize);
+
+    /// @internal performing the top-down and bottom-up traversals following the execution plan
+    void executeVisitorWithPlan(simulation::Visitor* action, const ExecutionPlan& plan);
+
+    /// @internal whether the children of this node can be traversed in parallel by the given visitor
+    bool canTraverseChildrenInParallel(simulation::Visitor* action);
+
+    /// @internal traverse the groups of independent child subtrees in parallel, each subtree top-down then bottom-up,
+    /// and mark them as visited in the statusMap
+    void executeVisitorOnIndependentChildren(simulation::Visitor* action, StatusMap& statusMap);
+
+    /// @internal traverse the groups of independent child subtrees in parallel, each subtree top-down then bottom-up,
+    /// and return them in subtrees
+    void executeVisitorOnIndependentChildren(simulation::Visitor* action, std::vector<DAGNode*>& subtrees);
+
+    /// @internal group of each child whose subtree is not linked to the rest of the graph, -1 for the other children:
+    /// its nodes have no parent outside of the subtree, and no mapping or interaction component
+    /// links a mechanical state of the subtree with one outside of it.
+    /// The subtrees sharing a dependency through a Data link, an engine input or an object link (with each other, or with
+    /// the same node outside of them) are in the same group, and are traversed sequentially.
+    /// The result is cached until the structure of a graph changes (see s_graphRevision).
+    const std::vector<int>& findIndependentChildren();
+
+    /// @internal compute the groups returned by findIndependentChildren
+    void computeIndependentChildren(std::vector<int>& groups);
+
+    /// @internal cached result of findIndependentChildren, valid if _independentChildrenRevision is s_graphRevision
+    std::vector<int> _independentChildren;
+    std::size_t _independentChildrenRevision { 0 };
+
+    /// @internal incremented when nodes or objects are added to or removed from any graph, or when the components
+    /// of a node are initialized, as it can change the links between the subtrees
+    static std::atomic<std::size_t> s_graphRevision;
     /// @}
 
     /// @internal tree traversal implementation
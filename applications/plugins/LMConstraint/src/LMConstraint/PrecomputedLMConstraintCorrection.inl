@@ -236,8 +236,6 @@ void PrecomputedLMConstraintCorrection<DataTypes>::bwdInit()
         }
     }
 
-    this->appCompliance = this->invM->data;
-
     // Optimisation for the computation of W
     this->_indexNodeSparseCompliance.resize(v0.size());
 
@@ -250,7 +248,7 @@ void PrecomputedLMConstraintCorrection<DataTypes>::bwdInit()
         {
             for (unsigned int j = 0; j < 20 && j < this->nbCols; j++)
             {
-                msg_info() << " \t " << this->appCompliance[j*this->nbCols + i];
+                msg_info() << " \t " << this->invM->value(j*this->nbCols + i);
             }
         }
 
@@ -25,6 +25,15 @@ using sofa::testing::BaseSimulationTest;
 #include <SofaSimulationGraph/SimpleApi.h>
 using namespace sofa::simpleapi;
 
+#include <SofaConstraint/GenericConstraintSolver.h>
+using sofa::component::constraintset::GenericConstraintProblem;
+#include <SofaConstraint/UnilateralInteractionConstraint.h>
+using sofa::component::constraintset::UnilateralConstraintResolutionWithFriction;
+
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <random>
+
 namespace
 {
 
@@ -38,6 +47,64 @@ struct GenericConstraintSolver_test : BaseSimulationTest
         sofa::simpleapi::importPlugin("SofaMiscCollision");
     }
 
+    /// A rigid box resting on a floor with friction, the solver being warm started or not. Returns the number of
+    /// Gauss-Seidel iterations of the last step.
+    int restingContactIterations(bool warmStart, int& nbGroups, int& nbWarmStartedGroups)
+    {
+        SceneInstance sceneinstance("xml",
+                    "<Node dt='0.01' gravity='0 -9.81 0'>\n"
+                    "   <RequiredPlugin name='SofaComponentAll'/>"
+                    "   <RequiredPlugin name='SofaMiscCollision'/>"
+                    "   <FreeMotionAnimationLoop />\n"
+                    "   <GenericConstraintSolver name='solver' maxIterations='1000' tolerance='1e-8' warmStart='" + std::string(warmStart ? "1" : "0") + "'/>\n"
+                    "   <DefaultPipeline />\n"
+                    "   <BruteForceBroadPhase />\n"
+                    "   <BVHNarrowPhase />\n"
+                    "   <MinProximityIntersection alarmDistance='0.2' contactDistance='0.05' />\n"
+                    "   <DefaultContactManager response='FrictionContactConstraint' responseParams='mu=0.5' />\n"
+                    "   <Node name='box'>\n"
+                    "      <EulerImplicitSolver rayleighStiffness='0' rayleighMass='0' />\n"
+                    "      <CGLinearSolver iterations='25' tolerance='1e-10' threshold='1e-10' />\n"
+                    "      <MechanicalObject template='Rigid3' position='0 0.5 0  0 0 0 1' />\n"
+                    "      <UniformMass totalMass='1' />\n"
+                    "      <UncoupledConstraintCorrection />\n"
+                    "      <Node name='corners'>\n"
+                    "         <MechanicalObject position='-1 -0.45 -1  1 -0.45 -1  1 -0.45 1  -1 -0.45 1  0 -0.45 0' />\n"
+                    "         <PointCollisionModel />\n"
+                    "         <RigidMapping />\n"
+                    "      </Node>\n"
+                    "   </Node>\n"
+                    "   <Node name='floor'>\n"
+                    "      <MechanicalObject position='-2 0 -2  2 0 -2  2 0 2  -2 0 2' />\n"
+                    "      <TriangleSetTopologyContainer triangles='0 2 1  0 3 2' />\n"
+                    "      <TriangleCollisionModel moving='0' simulated='0' />\n"
+                    "   </Node>\n"
+                    "</Node>\n"
+                    );
+
+        sceneinstance.initScene();
+        auto solver = sceneinstance.root->getObject("solver");
+        EXPECT_NE(solver, nullptr);
+        for(int i=0; i<100; i++)
+            sceneinstance.simulate(0.01);
+
+        nbGroups = std::stoi(solver->findData("currentNumConstraintGroups")->getValueString());
+        nbWarmStartedGroups = std::stoi(solver->findData("currentNumWarmStartedConstraintGroups")->getValueString());
+        return std::stoi(solver->findData("currentIterations")->getValueString());
+    }
+
+    void warmStart()
+    {
+        int nbGroups = 0, nbWarmStartedGroups = 0;
+        const int coldIterations = restingContactIterations(false, nbGroups, nbWarmStartedGroups);
+        EXPECT_EQ(nbWarmStartedGroups, 0);
+
+        const int warmIterations = restingContactIterations(true, nbGroups, nbWarmStartedGroups);
+        EXPECT_GT(nbGroups, 0);
+        EXPECT_EQ(nbWarmStartedGroups, nbGroups);
+        EXPECT_LT(warmIterations, coldIterations);
+    }
+
     void enableConstraintForce()
     {
         SceneInstance sceneinstance("xml",
@@ -68,6 +135,114 @@ TEST_F(GenericConstraintSolver_test, checkConstraintForce)
     enableConstraintForce();
 }
 
+TEST_F(GenericConstraintSolver_test, warmStart)
+{
+    EXPECT_MSG_NOEMIT(Error);
+    warmStart();
+}
+
+
+/** Test the Gauss-Seidel of GenericConstraintProblem on a chain of frictional contacts, each one coupled in W
+    with the next one.
+*/
+struct GenericConstraintProblem_test : sofa::testing::BaseTest
+{
+    static constexpr int nbContacts = 200;
+
+    void fillProblem(GenericConstraintProblem& problem)
+    {
+        const int dimension = 3 * nbContacts;
+        problem.clear(dimension);
+        problem.tolerance = 1e-12;
+        problem.maxIterations = 10000;
+        problem.allVerified = false;
+
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+        double** w = problem.getW();
+        for(int i=0; i<nbContacts; i++)
+        {
+            for(int a=0; a<3; a++)
+            {
+                w[3*i+a][3*i+a] = 4.0;
+                for(int b=0; b<a; b++)
+                    w[3*i+a][3*i+b] = w[3*i+b][3*i+a] = 0.2 * distribution(generator);
+            }
+            if(i+1 < nbContacts)
+            {
+                for(int a=0; a<3; a++)
+                    for(int b=0; b<3; b++)
+                        w[3*i+a][3*(i+1)+b] = w[3*(i+1)+b][3*i+a] = 0.2 * distribution(generator);
+            }
+            problem.getDfree()[3*i] = distribution(generator);
+            problem.getDfree()[3*i+1] = distribution(generator);
+            problem.getDfree()[3*i+2] = distribution(generator);
+
+            problem.constraintsResolutions[3*i] = new UnilateralConstraintResolutionWithFriction(0.5);
+            problem.constraintsResolutions[3*i]->init(3*i, w, problem.getF());
+        }
+    }
+
+    std::vector<double> getForces(GenericConstraintProblem& problem)
+    {
+        return std::vector<double>(problem.getF(), problem.getF() + problem.getDimension());
+    }
+};
+
+TEST_F(GenericConstraintProblem_test, coloring)
+{
+    GenericConstraintProblem problem;
+    fillProblem(problem);
+    problem.computeConstraintColors();
+
+    // a chain only needs two colors, alternating along the chain
+    ASSERT_EQ(problem.colorOffsets.size(), 3u);
+    ASSERT_EQ(problem.coloredGroups.size(), std::size_t(nbContacts));
+    for(int c=0; c<2; c++)
+    {
+        for(int g=problem.colorOffsets[c]; g<problem.colorOffsets[c+1]; g++)
+            EXPECT_EQ(problem.coloredGroups[g] / 3 % 2, c);
+    }
+}
+
+TEST_F(GenericConstraintProblem_test, parallelGaussSeidelAsGaussSeidel)
+{
+    GenericConstraintProblem sequentialProblem;
+    fillProblem(sequentialProblem);
+    sequentialProblem.gaussSeidel();
+
+    GenericConstraintProblem parallelProblem;
+    fillProblem(parallelProblem);
+    parallelProblem.parallelGaussSeidel();
+
+    EXPECT_LT(sequentialProblem.currentIterations, sequentialProblem.maxIterations);
+    EXPECT_LT(parallelProblem.currentIterations, parallelProblem.maxIterations);
+
+    const auto sequentialForces = getForces(sequentialProblem);
+    const auto parallelForces = getForces(parallelProblem);
+    for(std::size_t i=0; i<sequentialForces.size(); i++)
+        EXPECT_NEAR(parallelForces[i], sequentialForces[i], 1e-8) << "line " << i;
+}
+
+TEST_F(GenericConstraintProblem_test, parallelGaussSeidelIsDeterministic)
+{
+    GenericConstraintProblem problem;
+    fillProblem(problem);
+    problem.parallelGaussSeidel();
+    const auto forces = getForces(problem);
+
+    sofa::simulation::TaskScheduler::getInstance()->init(4);
+    GenericConstraintProblem multithreadProblem;
+    fillProblem(multithreadProblem);
+    multithreadProblem.parallelGaussSeidel();
+    sofa::simulation::TaskScheduler::getInstance()->stop();
+
+    EXPECT_EQ(multithreadProblem.currentIterations, problem.currentIterations);
+    EXPECT_EQ(multithreadProblem.currentError, problem.currentError);
+    EXPECT_EQ(getForces(multithreadProblem), forces);
+}
+
 
 } /// namespace sofa
 
@@ -0,0 +1,159 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaSimulationGraph/testing/BaseSimulationTest.h>
+using sofa::testing::BaseSimulationTest;
+
+#include <SofaSimulationGraph/SimpleApi.h>
+
+#include <sofa/core/behavior/BaseMechanicalState.h>
+
+#include <SofaConstraint/ConstraintSolverImpl.h>
+using sofa::component::constraintset::ConstraintProblem;
+using sofa::component::constraintset::ConstraintSolverImpl;
+
+#include <cmath>
+#include <memory>
+
+namespace
+{
+
+/** Test the LinearSolverConstraintCorrection class */
+struct LinearSolverConstraintCorrection_test: public BaseSimulationTest
+{
+    /// A linear elastic beam attached at one end, its other end falling on a floor
+    std::unique_ptr<SceneInstance> createFallingBeam(bool reuseCompliance)
+    {
+        auto sceneinstance = std::make_unique<SceneInstance>("xml",
+                    "<Node dt='0.01' gravity='0 -9.81 0'>\n"
+                    "   <RequiredPlugin name='SofaComponentAll'/>"
+                    "   <RequiredPlugin name='SofaMiscCollision'/>"
+                    "   <FreeMotionAnimationLoop />\n"
+                    "   <GenericConstraintSolver name='solver' maxIterations='10000' tolerance='1e-14' />\n"
+                    "   <DefaultPipeline />\n"
+                    "   <BruteForceBroadPhase />\n"
+                    "   <BVHNarrowPhase />\n"
+                    "   <MinProximityIntersection alarmDistance='0.2' contactDistance='0.05' />\n"
+                    "   <DefaultContactManager response='FrictionContactConstraint' responseParams='mu=0' />\n"
+                    "   <Node name='beam'>\n"
+                    "      <EulerImplicitSolver rayleighStiffness='0' rayleighMass='0' />\n"
+                    "      <SparseLDLSolver />\n"
+                    "      <RegularGridTopology n='5 2 2' min='-1 0.1 -0.1' max='1 0.3 0.1' />\n"
+                    "      <MechanicalObject name='dofs' />\n"
+                    "      <UniformMass totalMass='1' />\n"
+                    "      <HexahedronFEMForceField youngModulus='1000' poissonRatio='0.3' method='small' />\n"
+                    "      <PointCollisionModel />\n"
+                    "      <LinearSolverConstraintCorrection name='correction' reuseCompliance='" + std::string(reuseCompliance ? "1" : "0") + "' />\n"
+                    "   </Node>\n"
+                    "   <Node name='anchor'>\n"
+                    "      <MechanicalObject name='dofs' position='-1 0.1 -0.1  -1 0.3 -0.1  -1 0.1 0.1  -1 0.3 0.1' />\n"
+                    "   </Node>\n"
+                    "   <BilateralInteractionConstraint object1='@beam/dofs' object2='@anchor/dofs' first_point='0 5 10 15' second_point='0 1 2 3' />\n"
+                    "   <Node name='floor'>\n"
+                    "      <MechanicalObject position='-2 -0.2 -2  2 -0.2 -2  2 -0.2 2  -2 -0.2 2' />\n"
+                    "      <TriangleSetTopologyContainer triangles='0 2 1  0 3 2' />\n"
+                    "      <TriangleCollisionModel moving='0' simulated='0' />\n"
+                    "   </Node>\n"
+                    "</Node>\n"
+                    );
+        sceneinstance->initScene();
+        return sceneinstance;
+    }
+
+    static std::vector<double> beamPositions(const SceneInstance& sceneinstance)
+    {
+        auto dofs = dynamic_cast<sofa::core::behavior::BaseMechanicalState*>(sceneinstance.root->getChild("beam")->getObject("dofs"));
+        EXPECT_NE(dofs, nullptr);
+        std::vector<double> positions;
+        if (dofs)
+        {
+            for (sofa::Index i = 0; i < dofs->getSize(); ++i)
+                positions.push_back(dofs->getPX(i)), positions.push_back(dofs->getPY(i)), positions.push_back(dofs->getPZ(i));
+        }
+        return positions;
+    }
+
+    static ConstraintProblem* constraintProblem(const SceneInstance& sceneinstance)
+    {
+        auto solver = dynamic_cast<ConstraintSolverImpl*>(sceneinstance.root->getObject("solver"));
+        return solver ? solver->getConstraintProblem() : nullptr;
+    }
+
+    /// the compliance of the constraints which did not change is reused: W and the result must not change
+    void reuseCompliance()
+    {
+        const auto full = createFallingBeam(false);
+        const auto reused = createFallingBeam(true);
+        auto correction = reused->root->getChild("beam")->getObject("correction");
+        ASSERT_NE(correction, nullptr);
+
+        int nbComparedSteps = 0;
+        for (int step = 0; step < 50; ++step)
+        {
+            full->simulate(0.01);
+            reused->simulate(0.01);
+
+            // the rows of the 4 points of the bilateral constraint do not change after the first step
+            const int nbReusedConstraints = std::stoi(correction->findData("nbReusedConstraints")->getValueString());
+            if (step > 0)
+                EXPECT_GE(nbReusedConstraints, 12) << "step " << step;
+
+            ConstraintProblem* fullProblem = constraintProblem(*full);
+            ConstraintProblem* reusedProblem = constraintProblem(*reused);
+            ASSERT_NE(fullProblem, nullptr);
+            ASSERT_NE(reusedProblem, nullptr);
+            if (nbReusedConstraints == 0 || fullProblem->getDimension() != reusedProblem->getDimension())
+                continue;
+
+            ++nbComparedSteps;
+            const int dimension = fullProblem->getDimension();
+            double maxCompliance = 0.0;
+            for (int i = 0; i < dimension; ++i)
+                for (int j = 0; j < dimension; ++j)
+                    maxCompliance = std::max(maxCompliance, std::abs(fullProblem->W.element(i, j)));
+            for (int i = 0; i < dimension; ++i)
+                for (int j = 0; j < dimension; ++j)
+                    EXPECT_NEAR(reusedProblem->W.element(i, j), fullProblem->W.element(i, j), 1e-9 * maxCompliance)
+                        << "step " << step << ", W(" << i << ", " << j << ")";
+        }
+        EXPECT_GT(nbComparedSteps, 0);
+
+        const auto positions = beamPositions(*full);
+        const auto reusedPositions = beamPositions(*reused);
+        ASSERT_EQ(reusedPositions.size(), positions.size());
+        ASSERT_FALSE(positions.empty());
+        for (std::size_t i = 0; i < positions.size(); ++i)
+            EXPECT_NEAR(reusedPositions[i], positions[i], 1e-9);
+
+        // the beam rests on the floor
+        for (std::size_t i = 1; i < positions.size(); i += 3)
+            EXPECT_GT(positions[i], -0.2);
+    }
+};
+
+/// run the tests
+TEST_F( LinearSolverConstraintCorrection_test, reuseCompliance)
+{
+    EXPECT_MSG_NOEMIT(Error) ;
+    reuseCompliance();
+}
+
+}/// namespace sofa
@@ -0,0 +1,151 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaSimulationGraph/testing/BaseSimulationTest.h>
+using sofa::testing::BaseSimulationTest;
+
+#include <SofaSimulationGraph/SimpleApi.h>
+
+#include <SofaConstraint/PrecomputedConstraintCorrection.h>
+#include <SofaBaseLinearSolver/FullMatrix.h>
+
+#include <cmath>
+#include <filesystem>
+
+namespace
+{
+
+using Storage = sofa::component::constraintset::PrecomputedConstraintCorrection<sofa::defaulttype::Vec3Types>::InverseStorage;
+
+/** Test the PrecomputedConstraintCorrection class */
+struct PrecomputedConstraintCorrection_test: public BaseSimulationTest
+{
+    std::string m_dir;
+
+    void SetUp() override
+    {
+        m_dir = (std::filesystem::temp_directory_path() / "PrecomputedConstraintCorrection_test").string();
+        std::filesystem::remove_all(m_dir);
+        std::filesystem::create_directories(m_dir);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(m_dir);
+    }
+
+    /// Precompute (or load) the compliance of an elastic beam, stored in the given precision.
+    sofa::component::linearsolver::FullMatrix<double> beamCompliance(const std::string& storage)
+    {
+        SceneInstance sceneinstance("xml",
+                    "<Node dt='0.01' gravity='0 -9.81 0'>\n"
+                    "   <RequiredPlugin name='SofaComponentAll'/>"
+                    "   <Node name='beam'>\n"
+                    "      <EulerImplicitSolver rayleighStiffness='0' rayleighMass='0' />\n"
+                    "      <CGLinearSolver iterations='1000' tolerance='1e-20' threshold='1e-30' />\n"
+                    "      <RegularGridTopology n='3 2 2' min='-1 0 0' max='1 0.2 0.2' />\n"
+                    "      <MechanicalObject />\n"
+                    "      <UniformMass totalMass='1' />\n"
+                    "      <HexahedronFEMForceField youngModulus='1000' poissonRatio='0.3' method='small' />\n"
+                    "      <PrecomputedConstraintCorrection name='correction' fileDir='" + m_dir + "' complianceStorage='" + storage + "' />\n"
+                    "   </Node>\n"
+                    "</Node>\n"
+                    );
+
+        sceneinstance.initScene();
+
+        sofa::component::linearsolver::FullMatrix<double> compliance;
+        auto correction = dynamic_cast<sofa::core::behavior::BaseConstraintCorrection*>(sceneinstance.root->getChild("beam")->getObject("correction"));
+        EXPECT_NE(correction, nullptr);
+        if (correction)
+        {
+            compliance.resize(36, 36);
+            correction->getComplianceMatrix(&compliance);
+        }
+        return compliance;
+    }
+
+    /// the compressed compliance is written aside the raw one, and matches it up to its precision
+    void compressedCompliance()
+    {
+        const auto reference = beamCompliance("double");
+        ASSERT_EQ(reference.rowSize(), 36);
+        ASSERT_TRUE(std::filesystem::exists(m_dir + "/beam-36-0.01.comp"));
+
+        double maxValue = 0;
+        for (sofa::Index i = 0; i < 36; ++i)
+            for (sofa::Index j = 0; j < 36; ++j)
+                maxValue = std::max(maxValue, std::abs(reference.element(i, j)));
+        ASSERT_GT(maxValue, 0);
+
+        // converted from the raw file
+        const auto floatCompliance = beamCompliance("float");
+        const auto halfCompliance = beamCompliance("half");
+        EXPECT_TRUE(std::filesystem::exists(m_dir + "/beam-36-0.01.comp.float"));
+        EXPECT_TRUE(std::filesystem::exists(m_dir + "/beam-36-0.01.comp.half"));
+
+        ASSERT_EQ(floatCompliance.rowSize(), 36);
+        ASSERT_EQ(halfCompliance.rowSize(), 36);
+        for (sofa::Index i = 0; i < 36; ++i)
+        {
+            for (sofa::Index j = 0; j < 36; ++j)
+            {
+                EXPECT_NEAR(floatCompliance.element(i, j), reference.element(i, j), 1e-6 * maxValue);
+                EXPECT_NEAR(halfCompliance.element(i, j), reference.element(i, j), 1e-3 * maxValue);
+            }
+        }
+
+        // mapped from the compressed file only
+        std::filesystem::remove(m_dir + "/beam-36-0.01.comp");
+        const auto mappedCompliance = beamCompliance("half");
+        ASSERT_EQ(mappedCompliance.rowSize(), 36);
+        for (sofa::Index i = 0; i < 36; ++i)
+            for (sofa::Index j = 0; j < 36; ++j)
+                EXPECT_EQ(mappedCompliance.element(i, j), halfCompliance.element(i, j));
+    }
+
+    void halfConversion()
+    {
+        for (const float f : {0.f, 1.f, -0.5f, 0.333251953125f, 65504.f, -6.103515625e-05f, 5.9604644775390625e-08f})
+            EXPECT_EQ(Storage::halfToFloat(Storage::floatToHalf(f)), f);
+
+        EXPECT_EQ(Storage::floatToHalf(1.f), 0x3c00);
+        EXPECT_EQ(Storage::floatToHalf(-2.f), 0xc000);
+        EXPECT_EQ(Storage::floatToHalf(1e6f), 0x7c00);
+        EXPECT_EQ(Storage::floatToHalf(1e-9f), 0);
+        EXPECT_NEAR(Storage::halfToFloat(Storage::floatToHalf(0.1f)), 0.1f, 0.1f / 2048);
+        EXPECT_NEAR(Storage::halfToFloat(Storage::floatToHalf(1e-6f)), 1e-6f, 6e-8f);
+    }
+};
+
+/// run the tests
+TEST_F( PrecomputedConstraintCorrection_test, compressedCompliance)
+{
+    EXPECT_MSG_NOEMIT(Error) ;
+    compressedCompliance();
+}
+
+TEST_F( PrecomputedConstraintCorrection_test, halfConversion)
+{
+    halfConversion();
+}
+
+}/// namespace sofa
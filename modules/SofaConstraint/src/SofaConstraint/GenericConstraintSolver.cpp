@@ -28,8 +28,10 @@
 #include <sofa/core/ObjectFactory.h>
 #include <sofa/core/behavior/MultiMatrixAccessor.h>
 #include <SofaConstraint/ConstraintStoreLambdaVisitor.h>
+#include <SofaConstraint/LCPConstraintSolver.h>
 #include <sofa/core/behavior/MultiVec.h>
 #include <sofa/simulation/DefaultTaskScheduler.h>
+#include <sofa/simulation/ParallelForEach.h>
 
 #include <functional>
 
@@ -78,6 +80,8 @@ GenericConstraintSolver::GenericConstraintSolver()
     , schemeCorrection( initData(&schemeCorrection, false, "schemeCorrection", "Apply new scheme where compliance is progressively corrected"))
     , unbuilt(initData(&unbuilt, false, "unbuilt", "Compliance is not fully built"))
     , d_multithreading(initData(&d_multithreading, false, "multithreading", "Build compliances concurrently"))
+    , d_parallelGaussSeidel(initData(&d_parallelGaussSeidel, false, "parallelGaussSeidel", "Solve concurrently the constraint groups sharing no DOF, color by color, on the task scheduler (not available with unbuilt compliance)"))
+    , d_warmStart(initData(&d_warmStart, false, "warmStart", "Start the Gauss-Seidel from the forces of the previous step for the constraints having a persistent id, as the contacts identified across the steps"))
     , computeGraphs(initData(&computeGraphs, false, "computeGraphs", "Compute graphs of errors and forces during resolution"))
     , graphErrors( initData(&graphErrors,"graphErrors","Sum of the constraints' errors at each iteration"))
     , graphConstraints( initData(&graphConstraints,"graphConstraints","Graph of each constraint's error at the end of the resolution"))
@@ -85,6 +89,8 @@ GenericConstraintSolver::GenericConstraintSolver()
     , graphViolations( initData(&graphViolations, "graphViolations", "Graph of each constraint's violation at each step of the resolution"))
     , currentNumConstraints(initData(&currentNumConstraints, 0, "currentNumConstraints", "OUTPUT: current number of constraints"))
     , currentNumConstraintGroups(initData(&currentNumConstraintGroups, 0, "currentNumConstraintGroups", "OUTPUT: current number of constraints"))
+    , currentNumConstraintColors(initData(&currentNumConstraintColors, 0, "currentNumConstraintColors", "OUTPUT: current number of colors of the constraint groups solved concurrently"))
+    , currentNumWarmStartedConstraintGroups(initData(&currentNumWarmStartedConstraintGroups, 0, "currentNumWarmStartedConstraintGroups", "OUTPUT: current number of constraint groups started from their force at the previous step"))
     , currentIterations(initData(&currentIterations, 0, "currentIterations", "OUTPUT: current number of constraint groups"))
     , currentError(initData(&currentError, 0.0, "currentError", "OUTPUT: current error"))
     , reverseAccumulateOrder(initData(&reverseAccumulateOrder, false, "reverseAccumulateOrder", "True to accumulate constraints from nodes in reversed order (can be necessary when using multi-mappings or interaction constraints not following the node hierarchy)"))
@@ -113,6 +119,10 @@ GenericConstraintSolver::GenericConstraintSolver()
     currentNumConstraints.setGroup("Stats");
     currentNumConstraintGroups.setReadOnly(true);
     currentNumConstraintGroups.setGroup("Stats");
+    currentNumConstraintColors.setReadOnly(true);
+    currentNumConstraintColors.setGroup("Stats");
+    currentNumWarmStartedConstraintGroups.setReadOnly(true);
+    currentNumWarmStartedConstraintGroups.setGroup("Stats");
     currentIterations.setReadOnly(true);
     currentIterations.setGroup("Stats");
     currentError.setReadOnly(true);
@@ -159,6 +169,19 @@ void GenericConstraintSolver::init()
 
     if(d_multithreading.getValue())
         simulation::TaskScheduler::getInstance()->init();
+
+    if (d_parallelGaussSeidel.getValue())
+    {
+        if (unbuilt.getValue())
+            msg_warning() << "parallelGaussSeidel is not available with unbuilt compliance: the constraints are solved sequentially";
+
+        auto* taskScheduler = simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 1)
+        {
+            taskScheduler->init(0);
+            msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+        }
+    }
 }
 
 void GenericConstraintSolver::cleanup()
@@ -248,6 +271,22 @@ bool GenericConstraintSolver::buildSystem(const core::ConstraintParams *cParams,
     MechanicalGetConstraintResolutionVisitor(cParams, current_cp->constraintsResolutions).execute(context);
     sofa::helper::AdvancedTimer::stepEnd("Get Constraint Resolutions");
 
+    m_constraintBlockInfo.clear();
+    m_constraintIds.clear();
+    m_constraintPositions.clear();
+    m_constraintDirections.clear();
+    m_constraintAreas.clear();
+
+    if (d_warmStart.getValue() && numConstraints != 0)
+    {
+        sofa::helper::AdvancedTimer::stepBegin("Get Constraint Info");
+        MechanicalGetConstraintInfoVisitor(cParams, m_constraintBlockInfo, m_constraintIds, m_constraintPositions, m_constraintDirections, m_constraintAreas).execute(context);
+        sofa::helper::AdvancedTimer::stepEnd  ("Get Constraint Info");
+        computeInitialGuess();
+    }
+    else
+        currentNumWarmStartedConstraintGroups.setValue(0);
+
     msg_info() <<"GenericConstraintSolver: "<<numConstraints<<" constraints";
 
     // Test if the nodes containing the constraint correction are active (not sleeping)
@@ -438,15 +477,28 @@ bool GenericConstraintSolver::solveSystem(const core::ConstraintParams * /*cPara
             msg_info() << tmp.str() ;
         }
 
-        sofa::helper::AdvancedTimer::stepBegin("ConstraintsGaussSeidel");
-        current_cp->gaussSeidel(0, this);
-        sofa::helper::AdvancedTimer::stepEnd("ConstraintsGaussSeidel");
+        if (d_parallelGaussSeidel.getValue())
+        {
+            sofa::helper::AdvancedTimer::stepBegin("ConstraintsParallelGaussSeidel");
+            current_cp->parallelGaussSeidel(0, this);
+            sofa::helper::AdvancedTimer::stepEnd("ConstraintsParallelGaussSeidel");
+        }
+        else
+        {
+            sofa::helper::AdvancedTimer::stepBegin("ConstraintsGaussSeidel");
+            current_cp->gaussSeidel(0, this);
+            sofa::helper::AdvancedTimer::stepEnd("ConstraintsGaussSeidel");
+        }
     }
 
     this->currentError.setValue(current_cp->currentError);
     this->currentIterations.setValue(current_cp->currentIterations);
     this->currentNumConstraints.setValue(current_cp->getNumConstraints());
     this->currentNumConstraintGroups.setValue(current_cp->getNumConstraintGroups());
+    if (d_warmStart.getValue())
+        keepContactForcesValue();
+
+    this->currentNumConstraintColors.setValue(d_parallelGaussSeidel.getValue() && !unbuilt.getValue() ? int(current_cp->colorOffsets.size()) - 1 : 0);
 
     if ( displayTime.getValue() )
     {
@@ -475,6 +527,57 @@ bool GenericConstraintSolver::solveSystem(const core::ConstraintParams * /*cPara
     return true;
 }
 
+void GenericConstraintSolver::computeInitialGuess()
+{
+    sofa::helper::AdvancedTimer::StepVar vtimer("InitialGuess");
+
+    double* force = current_cp->getF();
+    std::fill_n(force, current_cp->getDimension(), 0.0);
+
+    int nbWarmStarted = 0;
+    for (const auto& info : m_constraintBlockInfo)
+    {
+        if (!info.hasId) continue;
+        const auto previt = m_previousConstraints.find(info.parent);
+        if (previt == m_previousConstraints.end()) continue;
+        const ConstraintBlockBuf& buf = previt->second;
+        if (buf.nbLines != info.nbLines) continue;
+
+        for (int c = 0; c < info.nbGroups; ++c)
+        {
+            const auto it = buf.persistentToConstraintIdMap.find(m_constraintIds[info.offsetId + c]);
+            if (it == buf.persistentToConstraintIdMap.end()) continue;
+            const int prevIndex = it->second;
+            const int index = info.const0 + c*info.nbLines;
+            if (prevIndex + info.nbLines <= (int) m_previousForces.size() && index + info.nbLines <= current_cp->getDimension())
+            {
+                std::copy_n(&m_previousForces[prevIndex], info.nbLines, &force[index]);
+                ++nbWarmStarted;
+            }
+        }
+    }
+    currentNumWarmStartedConstraintGroups.setValue(nbWarmStarted);
+}
+
+void GenericConstraintSolver::keepContactForcesValue()
+{
+    sofa::helper::AdvancedTimer::StepVar vtimer("KeepForces");
+
+    // the constraints which disappeared are forgotten
+    m_previousConstraints.clear();
+    m_previousForces.assign(current_cp->getF(), current_cp->getF() + current_cp->getDimension());
+
+    for (const auto& info : m_constraintBlockInfo)
+    {
+        if (!info.parent) continue;
+        if (!info.hasId) continue;
+        ConstraintBlockBuf& buf = m_previousConstraints[info.parent];
+        buf.nbLines = info.nbLines;
+        for (int c = 0; c < info.nbGroups; ++c)
+            buf.persistentToConstraintIdMap[m_constraintIds[info.offsetId + c]] = info.const0 + c*info.nbLines;
+    }
+}
+
 void GenericConstraintSolver::computeResidual(const core::ExecParams* eparam)
 {
     for (auto* cc : constraintCorrections)
@@ -894,6 +997,333 @@ void GenericConstraintProblem::gaussSeidel(double timeout, GenericConstraintSolv
 }
 
 
+void GenericConstraintProblem::computeConstraintColors()
+{
+    double **w = getW();
+
+    // first line of each group, and group of each line
+    std::vector<int> groupFirstLine;
+    std::vector<int> groupOfLine(dimension);
+    for(int j=0; j<dimension; )
+    {
+        const int nb = constraintsResolutions[j]->getNbLines();
+        for(int l=0; l<nb; l++)
+            groupOfLine[j+l] = int(groupFirstLine.size());
+        groupFirstLine.push_back(j);
+        j += nb;
+    }
+    const int nbGroups = int(groupFirstLine.size());
+
+    // groups coupled to each group, found on the rows and columns of its lines as W may not be exactly symmetric
+    std::vector< std::vector<int> > neighbors(nbGroups);
+    simulation::parallelForEach(0, nbGroups, [&](int g)
+    {
+        const int first = groupFirstLine[g];
+        const int last = g+1 < nbGroups ? groupFirstLine[g+1] : dimension;
+        std::vector<int>& groupNeighbors = neighbors[g];
+        for(int k=0; k<dimension; k++)
+        {
+            const int h = groupOfLine[k];
+            if(h == g || (!groupNeighbors.empty() && groupNeighbors.back() == h))
+                continue;
+            for(int a=first; a<last; a++)
+            {
+                if(w[a][k] != 0.0 || w[k][a] != 0.0)
+                {
+                    groupNeighbors.push_back(h);
+                    break;
+                }
+            }
+        }
+    });
+
+    // greedy coloring in the order of the groups, so that the colors do not depend on the number of threads
+    std::vector<int> groupColor(nbGroups, -1);
+    std::vector<int> colorUsedBy; // last group which found the color among its neighbors
+    int nbColors = 0;
+    for(int g=0; g<nbGroups; g++)
+    {
+        for(const int h : neighbors[g])
+            if(groupColor[h] >= 0)
+                colorUsedBy[groupColor[h]] = g;
+
+        int color = 0;
+        while(color < nbColors && colorUsedBy[color] == g)
+            ++color;
+        if(color == nbColors)
+        {
+            ++nbColors;
+            colorUsedBy.push_back(-1);
+        }
+        groupColor[g] = color;
+    }
+
+    // sort the groups by color, keeping their order within a color
+    colorOffsets.assign(nbColors+1, 0);
+    for(int g=0; g<nbGroups; g++)
+        colorOffsets[groupColor[g]+1]++;
+    for(int c=0; c<nbColors; c++)
+        colorOffsets[c+1] += colorOffsets[c];
+
+    coloredGroups.resize(nbGroups);
+    std::vector<int> position(colorOffsets.begin(), colorOffsets.end()-1);
+    for(int g=0; g<nbGroups; g++)
+        coloredGroups[position[groupColor[g]]++] = groupFirstLine[g];
+}
+
+void GenericConstraintProblem::parallelGaussSeidel(double timeout, GenericConstraintSolver* solver)
+{
+    if(!dimension)
+    {
+        currentError = 0.0;
+        currentIterations = 0;
+        coloredGroups.clear();
+        colorOffsets.assign(1, 0);
+        return;
+    }
+
+    double t0 = (double)sofa::helper::system::thread::CTime::getTime() ;
+    double timeScale = 1.0 / (double)sofa::helper::system::thread::CTime::getTicksPerSec();
+
+    double *dfree = getDfree();
+    double *force = getF();
+    double **w = getW();
+    double tol = tolerance;
+
+    double *d = _d.ptr();
+
+    double error=0.0;
+
+    bool convergence = false;
+    sofa::type::vector<double> tempForces;
+    if(sor != 1.0) tempForces.resize(dimension);
+
+    if(scaleTolerance && !allVerified)
+        tol *= dimension;
+
+    if(solver)
+    {
+        for(int i=0; i<dimension; )
+        {
+            if(!constraintsResolutions[i])
+            {
+                msg_error(solver) << "Bad size of constraintsResolutions in GenericConstraintProblem" ;
+
+                dimension = i;
+                break;
+            }
+            constraintsResolutions[i]->init(i, w, force);
+            i += constraintsResolutions[i]->getNbLines();
+        }
+    }
+
+    computeConstraintColors();
+
+    bool showGraphs = false;
+    sofa::type::vector<double>* graph_residuals = nullptr;
+    std::map < std::string, sofa::type::vector<double> > *graph_forces = nullptr, *graph_violations = nullptr;
+
+    if(solver)
+    {
+        showGraphs = solver->computeGraphs.getValue();
+
+        if(showGraphs)
+        {
+            graph_forces = solver->graphForces.beginEdit();
+            graph_forces->clear();
+
+            graph_violations = solver->graphViolations.beginEdit();
+            graph_violations->clear();
+
+            graph_residuals = &(*solver->graphErrors.beginEdit())["Error"];
+            graph_residuals->clear();
+        }
+    }
+
+    // error of each constraint group, stored on its first line to be summed in the order of the lines
+    sofa::type::vector<double> tabErrors(dimension, 0.0);
+    std::vector<char> tabVerified(dimension, 1);
+    sofa::type::vector<double> previousForces(dimension);
+
+    // each group computes a row block of W*f, so that a sub-range of a few groups has enough work for a task
+    const std::size_t grainSize = std::max<std::size_t>(1, 65536 / std::size_t(dimension));
+
+    const int nbColors = int(colorOffsets.size()) - 1;
+    int i;
+    for(i=0; i<maxIterations; i++)
+    {
+        if(sor != 1.0)
+        {
+            std::copy_n(force, dimension, tempForces.begin());
+        }
+
+        for(int c=0; c<nbColors; c++)
+        {
+            // 1. d is computed for all the groups of the color, before any of their forces is updated. The groups
+            //    are not coupled, so this gives the same d as a sequential Gauss-Seidel in this order.
+            simulation::parallelForEach(colorOffsets[c], colorOffsets[c+1], [&](int g)
+            {
+                const int j = coloredGroups[g];
+                const int nb = constraintsResolutions[j]->getNbLines();
+                for(int l=0; l<nb; l++)
+                {
+                    double dl = dfree[j+l];
+                    const double* wl = w[j+l];
+                    for(int k=0; k<dimension; k++)
+                        dl += wl[k] * force[k];
+                    d[j+l] = dl;
+                }
+            }, grainSize);
+
+            // 2. the specific resolution of each group is called, and its error is measured
+            simulation::parallelForEach(colorOffsets[c], colorOffsets[c+1], [&](int g)
+            {
+                const int j = coloredGroups[g];
+                const int nb = constraintsResolutions[j]->getNbLines();
+                std::copy_n(&force[j], nb, &previousForces[j]);
+
+                constraintsResolutions[j]->resolution(j, w, d, force, dfree);
+
+                bool verified = true;
+                double contraintError = 0.0;
+                if(nb > 1)
+                {
+                    for(int l=0; l<nb; l++)
+                    {
+                        double lineError = 0.0;
+                        for (int m=0; m<nb; m++)
+                        {
+                            double dofError = w[j+l][j+m] * (force[j+m] - previousForces[j+m]);
+                            lineError += dofError * dofError;
+                        }
+                        lineError = sqrt(lineError);
+                        if(lineError > tol)
+                            verified = false;
+
+                        contraintError += lineError;
+                    }
+                }
+                else
+                {
+                    contraintError = fabs(w[j][j] * (force[j] - previousForces[j]));
+                    if(contraintError > tol)
+                        verified = false;
+                }
+
+                if(constraintsResolutions[j]->getTolerance())
+                {
+                    if(contraintError > constraintsResolutions[j]->getTolerance())
+                        verified = false;
+                    contraintError *= tol / constraintsResolutions[j]->getTolerance();
+                }
+
+                tabErrors[j] = contraintError;
+                tabVerified[j] = verified;
+            });
+        }
+
+        error = 0.0;
+        bool constraintsAreVerified = true;
+        for(int j=0; j<dimension; j += constraintsResolutions[j]->getNbLines())
+        {
+            error += tabErrors[j];
+            constraintsAreVerified = constraintsAreVerified && tabVerified[j];
+        }
+
+        if(showGraphs)
+        {
+            for(int j=0; j<dimension; j++)
+            {
+                std::ostringstream oss;
+                oss << "f" << j;
+
+                sofa::type::vector<double>& graph_force = (*graph_forces)[oss.str()];
+                graph_force.push_back(force[j]);
+
+                sofa::type::vector<double>& graph_violation = (*graph_violations)[oss.str()];
+                graph_violation.push_back(d[j]);
+            }
+
+            graph_residuals->push_back(error);
+        }
+
+        if(sor != 1.0)
+        {
+            for(int j=0; j<dimension; j++)
+                force[j] = sor * force[j] + (1-sor) * tempForces[j];
+        }
+
+        double t1 = (double)sofa::helper::system::thread::CTime::getTime();
+        double dt = (t1 - t0)*timeScale;
+
+        if(timeout && dt > timeout)
+        {
+
+            msg_info_when(solver!=nullptr, solver) <<  "TimeOut" ;
+
+            currentError = error;
+            currentIterations = i+1;
+            return;
+        }
+        else if(allVerified)
+        {
+            if(constraintsAreVerified)
+            {
+                convergence = true;
+                break;
+            }
+        }
+        else if(error < tol)
+        {
+            convergence = true;
+            break;
+        }
+    }
+
+    currentError = error;
+    currentIterations = i+1;
+
+    sofa::helper::AdvancedTimer::valSet("GS iterations", currentIterations);
+
+    if(solver)
+    {
+        if(!convergence)
+        {
+            msg_info(solver) << "No convergence : error = " << error ;
+        }
+        else msg_info_when(solver->displayTime.getValue(), solver) << " Convergence after " << i+1 << " iterations with " << nbColors << " colors" ;
+
+        for(int j=0; j<dimension; j += constraintsResolutions[j]->getNbLines())
+            constraintsResolutions[j]->store(j, force, convergence);
+    }
+
+    if(showGraphs)
+    {
+        solver->graphErrors.endEdit();
+
+        sofa::type::vector<double>& graph_constraints = (*solver->graphConstraints.beginEdit())["Constraints"];
+        graph_constraints.clear();
+
+        for(int j=0; j<dimension; )
+        {
+            const unsigned int nb = constraintsResolutions[j]->getNbLines();
+
+            if(tabErrors[j])
+                graph_constraints.push_back(tabErrors[j]);
+            else if(constraintsResolutions[j]->getTolerance())
+                graph_constraints.push_back(constraintsResolutions[j]->getTolerance());
+            else
+                graph_constraints.push_back(tol);
+
+            j += nb;
+        }
+        solver->graphConstraints.endEdit();
+
+        solver->graphForces.endEdit();
+    }
+}
+
+
 void GenericConstraintProblem::unbuiltGaussSeidel(double timeout, GenericConstraintSolver* solver)
 {
     if(!dimension)
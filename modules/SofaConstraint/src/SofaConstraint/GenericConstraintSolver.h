@@ -46,6 +46,10 @@ public:
     double currentError;
     int currentIterations;
 
+    // For parallel version : constraint groups sorted by color, given by their first line
+    std::vector<int> coloredGroups;
+    std::vector<int> colorOffsets; ///< groups of color c are coloredGroups[colorOffsets[c]] to coloredGroups[colorOffsets[c+1]-1]
+
     // For unbuilt version :
     sofa::component::linearsolver::SparseMatrix<double> Wdiag;
     std::list<unsigned int> constraints_sequence;
@@ -69,6 +73,13 @@ public:
     void gaussSeidel(double timeout=0, GenericConstraintSolver* solver = nullptr);
     void unbuiltGaussSeidel(double timeout=0, GenericConstraintSolver* solver = nullptr);
 
+    /// Gauss-Seidel processing the constraint groups color by color. The groups of a color are not coupled in W
+    /// (they share no DOF), so they are solved concurrently on the task scheduler.
+    void parallelGaussSeidel(double timeout=0, GenericConstraintSolver* solver = nullptr);
+
+    /// Greedy coloring of the constraint groups, two groups coupled by a non-zero block of W having different colors
+    void computeConstraintColors();
+
     int getNumConstraints();
     int getNumConstraintGroups();
 };
@@ -107,6 +118,8 @@ public:
     Data<bool> schemeCorrection; ///< Apply new scheme where compliance is progressively corrected
     Data<bool> unbuilt; ///< Compliance is not fully built
     Data<bool> d_multithreading; ///< Compliances built concurrently
+    Data<bool> d_parallelGaussSeidel; ///< Solve the constraint groups sharing no DOF concurrently
+    Data<bool> d_warmStart; ///< Start the resolution from the forces of the previous step for the persistent constraints
     Data<bool> computeGraphs; ///< Compute graphs of errors and forces during resolution
     Data<std::map < std::string, sofa::type::vector<double> > > graphErrors; ///< Sum of the constraints' errors at each iteration
     Data<std::map < std::string, sofa::type::vector<double> > > graphConstraints; ///< Graph of each constraint's error at the end of the resolution
@@ -115,6 +128,8 @@ public:
 
     Data<int> currentNumConstraints; ///< OUTPUT: current number of constraints
     Data<int> currentNumConstraintGroups; ///< OUTPUT: current number of constraints
+    Data<int> currentNumConstraintColors; ///< OUTPUT: current number of colors of the constraint groups solved concurrently
+    Data<int> currentNumWarmStartedConstraintGroups; ///< OUTPUT: current number of constraint groups started from their force at the previous step
     Data<int> currentIterations; ///< OUTPUT: current number of constraint groups
     Data<double> currentError; ///< OUTPUT: current error
     Data<bool> reverseAccumulateOrder; ///< True to accumulate constraints from nodes in reversed order (can be necessary when using multi-mappings or interaction constraints not following the node hierarchy)
@@ -128,6 +143,11 @@ protected:
 
     void clearConstraintProblemLocks();
 
+    /// Sets the initial forces of the constraints found at the previous step, matched by their persistent id
+    void computeInitialGuess();
+    /// Keeps the forces of the constraints having a persistent id, for the warm start of the next step
+    void keepContactForcesValue();
+
     enum { CP_BUFFER_SIZE = 10 };
     sofa::type::fixed_array<GenericConstraintProblem,CP_BUFFER_SIZE> m_cpBuffer;
     sofa::type::fixed_array<bool,CP_BUFFER_SIZE> m_cpIsLocked;
@@ -138,6 +158,29 @@ protected:
 
     sofa::core::objectmodel::BaseContext *context;
 
+    typedef core::behavior::BaseConstraint::PersistentID PersistentID;
+    typedef core::behavior::BaseConstraint::VecConstraintBlockInfo VecConstraintBlockInfo;
+    typedef core::behavior::BaseConstraint::VecPersistentID VecPersistentID;
+    typedef core::behavior::BaseConstraint::VecConstCoord VecConstCoord;
+    typedef core::behavior::BaseConstraint::VecConstDeriv VecConstDeriv;
+    typedef core::behavior::BaseConstraint::VecConstArea VecConstArea;
+
+    class ConstraintBlockBuf
+    {
+    public:
+        std::map<PersistentID,int> persistentToConstraintIdMap;
+        int nbLines; ///< how many dofs (i.e. lines in the matrix) are used by each constraint
+    };
+
+    // Warm start: constraint info of the current step, and forces of the previous step
+    VecConstraintBlockInfo m_constraintBlockInfo;
+    VecPersistentID m_constraintIds;
+    VecConstCoord m_constraintPositions;
+    VecConstDeriv m_constraintDirections;
+    VecConstArea m_constraintAreas;
+    std::map<core::behavior::BaseConstraint*, ConstraintBlockBuf> m_previousConstraints;
+    type::vector<double> m_previousForces;
+
     sofa::core::MultiVecDerivId m_lambdaId;
     sofa::core::MultiVecDerivId m_dxId;
 
@@ -90,6 +90,9 @@ public:
 
     /// @}
 
+    Data< bool > d_reuseCompliance; ///< keep the compliance of the constraints between the steps, only computing it for the new constraints
+    Data< int > d_nbReusedConstraints; ///< OUTPUT: number of constraints whose compliance was reused at the last step
+
     /// @name Unbuilt constraint system during resolution
     /// @{
 
@@ -117,10 +120,24 @@ protected:
     linearsolver::FullVector<SReal> F; ///< forces computed from the constraints
 
     /**
-    * @brief Compute the compliance matrix
+    * @brief Compute the constraint matrix J, restricted to the constraints of this object:
+    * the row i of J is the constraint constraintIds[i] of W.
     */
     virtual void computeJ(sofa::defaulttype::BaseMatrix* W, const MatrixDeriv& j);
 
+    /**
+    * @brief Fill localW with the compliance of the previous step for the constraints found unchanged in J, and
+    * compute it for the others only. Returns false if the compliance must be fully computed.
+    */
+    bool reuseCompliance(double factor);
+
+    type::vector<int> constraintIds; ///< index in W of each row of J
+    linearsolver::FullMatrix<SReal> localW; ///< compliance of the constraints of this object
+
+    linearsolver::SparseMatrix<SReal> previousJ; ///< constraint matrix at the previous step
+    linearsolver::FullMatrix<SReal> previousW; ///< compliance at the previous step
+    double previousFactor;
+
 
     ////////////////////////// Inherited attributes ////////////////////////////
     /// https://gcc.gnu.org/onlinedocs/gcc/Name-lookup.html
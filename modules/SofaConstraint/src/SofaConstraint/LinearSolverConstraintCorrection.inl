@@ -29,6 +29,7 @@
 
 #include <sstream>
 #include <list>
+#include <unordered_map>
 
 namespace sofa::component::constraintset
 {
@@ -41,10 +42,15 @@ using sofa::core::objectmodel::ComponentState ;
 template<class DataTypes>
 LinearSolverConstraintCorrection<DataTypes>::LinearSolverConstraintCorrection(sofa::core::behavior::MechanicalState<DataTypes> *mm)
 : Inherit(mm)
+, d_reuseCompliance(initData(&d_reuseCompliance, false, "reuseCompliance", "Keep the compliance of the constraints between the steps, and only compute it for the constraints which changed. Valid only if the system matrix does not change (linear material, fixed topology and time step)"))
+, d_nbReusedConstraints(initData(&d_nbReusedConstraints, 0, "nbReusedConstraints", "OUTPUT: number of constraints whose compliance was reused at the last step"))
 , wire_optimization(initData(&wire_optimization, false, "wire_optimization", "constraints are reordered along a wire-like topology (from tip to base)"))
 , solverName( initData(&solverName, "solverName", "search for the following names upward the scene graph") )
 , odesolver(nullptr)
+, previousFactor(0.0)
 {
+    d_nbReusedConstraints.setReadOnly(true);
+    d_nbReusedConstraints.setGroup("Stats");
 }
 
 template<class DataTypes>
@@ -111,7 +117,7 @@ void LinearSolverConstraintCorrection<DataTypes>::init()
 }
 
 template<class TDataTypes>
-void LinearSolverConstraintCorrection<TDataTypes>::computeJ(sofa::defaulttype::BaseMatrix* W, const MatrixDeriv& c)
+void LinearSolverConstraintCorrection<TDataTypes>::computeJ(sofa::defaulttype::BaseMatrix* /*W*/, const MatrixDeriv& c)
 {
     if(d_componentState.getValue() != ComponentState::Valid)
         return ;
@@ -119,16 +125,20 @@ void LinearSolverConstraintCorrection<TDataTypes>::computeJ(sofa::defaulttype::B
     const unsigned int numDOFs = mstate->getSize();
     const unsigned int N = Deriv::size();
     const unsigned int numDOFReals = numDOFs*N;
-    const unsigned int totalNumConstraints = W->rowSize();
 
-    J.resize(totalNumConstraints, numDOFReals);
+    // Only the constraints of this object are put in J, so that the linear solvers do not go through the
+    // (empty) lines of the constraints of the other objects
+    constraintIds.clear();
+    for (MatrixDerivRowConstIterator rowIt = c.begin(); rowIt != c.end(); ++rowIt)
+        constraintIds.push_back(rowIt.index());
 
+    J.resize(constraintIds.size(), numDOFReals);
+
+    int localRow = 0;
     MatrixDerivRowConstIterator rowItEnd = c.end();
 
-    for (MatrixDerivRowConstIterator rowIt = c.begin(); rowIt != rowItEnd; ++rowIt)
+    for (MatrixDerivRowConstIterator rowIt = c.begin(); rowIt != rowItEnd; ++rowIt, ++localRow)
     {
-        const int cid = rowIt.index();
-
         MatrixDerivColConstIterator colItEnd = rowIt.end();
 
         for (MatrixDerivColConstIterator colIt = rowIt.begin(); colIt != colItEnd; ++colIt)
@@ -138,7 +148,7 @@ void LinearSolverConstraintCorrection<TDataTypes>::computeJ(sofa::defaulttype::B
 
             for (unsigned int r = 0; r < N; ++r)
             {
-                J.add(cid, dof * N + r, n[r]);
+                J.add(localRow, dof * N + r, n[r]);
             }
         }
     }
@@ -169,17 +179,139 @@ void LinearSolverConstraintCorrection<DataTypes>::addComplianceInConstraintSpace
         break;
     }
 
+    d_nbReusedConstraints.setValue(0);
+
     // Compute J
     this->computeJ(W, cparams->readJ(this->mstate)->getValue());
 
-    // use the Linear solver to compute J*inv(M)*Jt, where M is the mechanical linear system matrix
-    for (unsigned i = 0; i < linearsolvers.size(); i++)
+    const int nbConstraints = constraintIds.size();
+    if (nbConstraints == 0)
+        return;
+
+    localW.resize(nbConstraints, nbConstraints);
+    localW.clear();
+
+    if (!d_reuseCompliance.getValue() || !reuseCompliance(factor))
     {
-        linearsolvers[i]->setSystemLHVector(sofa::core::MultiVecDerivId::null());
-        linearsolvers[i]->addJMInvJt(W, &J, factor);
+        // use the Linear solver to compute J*inv(M)*Jt, where M is the mechanical linear system matrix
+        for (unsigned i = 0; i < linearsolvers.size(); i++)
+        {
+            linearsolvers[i]->setSystemLHVector(sofa::core::MultiVecDerivId::null());
+            linearsolvers[i]->addJMInvJt(&localW, &J, factor);
+        }
+    }
+
+    if (d_reuseCompliance.getValue())
+    {
+        previousJ = J;
+        previousW.resize(nbConstraints, nbConstraints);
+        std::copy_n(localW.ptr(), nbConstraints * nbConstraints, previousW.ptr());
+        previousFactor = factor;
+    }
+
+    for (int i = 0; i < nbConstraints; ++i)
+    {
+        const SReal* line = localW[i];
+        for (int j = 0; j < nbConstraints; ++j)
+            W->add(constraintIds[i], constraintIds[j], line[j]);
     }
 }
 
+template<class DataTypes>
+bool LinearSolverConstraintCorrection<DataTypes>::reuseCompliance(double factor)
+{
+    typedef typename linearsolver::SparseMatrix<SReal>::Line Line;
+
+    if (factor != previousFactor || previousJ.rowSize() == 0 || previousJ.colSize() != J.colSize())
+        return false;
+
+    const auto hashLine = [](const Line& line)
+    {
+        std::size_t h = line.size();
+        for (const auto& e : line)
+        {
+            h = h * 31 + std::hash<defaulttype::BaseMatrix::Index>()(e.first);
+            h = h * 31 + std::hash<SReal>()(e.second);
+        }
+        return h;
+    };
+
+    std::unordered_multimap<std::size_t, int> previousLines;
+    for (int p = 0; p < (int)previousJ.rowSize(); ++p)
+        previousLines.emplace(hashLine(previousJ[p]), p);
+
+    // previous row of each constraint, or -1 if it changed
+    const int nbConstraints = constraintIds.size();
+    type::vector<int> previousRow(nbConstraints, -1);
+    type::vector<int> newRows;
+    for (int i = 0; i < nbConstraints; ++i)
+    {
+        const Line& line = J[i];
+        const auto range = previousLines.equal_range(hashLine(line));
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (previousJ[it->second] == line)
+            {
+                previousRow[i] = it->second;
+                previousLines.erase(it);
+                break;
+            }
+        }
+        if (previousRow[i] < 0)
+            newRows.push_back(i);
+    }
+
+    if ((int)newRows.size() == nbConstraints)
+        return false;
+
+    for (auto* linearsolver : linearsolvers)
+    {
+        if (!linearsolver->getSystemRHBaseVector() || !linearsolver->getSystemLHBaseVector())
+            return false;
+    }
+    d_nbReusedConstraints.setValue(nbConstraints - int(newRows.size()));
+
+    for (int i = 0; i < nbConstraints; ++i)
+    {
+        if (previousRow[i] < 0) continue;
+        for (int j = 0; j < nbConstraints; ++j)
+        {
+            if (previousRow[j] >= 0)
+                localW[i][j] = previousW[previousRow[i]][previousRow[j]];
+        }
+    }
+
+    // J*inv(M)*Jt is computed for the lines and columns of the new constraints only, one solve per new constraint
+    for (auto* linearsolver : linearsolvers)
+    {
+        linearsolver->setSystemLHVector(sofa::core::MultiVecDerivId::null());
+        defaulttype::BaseVector* rhVector = linearsolver->getSystemRHBaseVector();
+        const defaulttype::BaseVector* lhVector = linearsolver->getSystemLHBaseVector();
+
+        for (const int i : newRows)
+        {
+            rhVector->clear();
+            for (const auto& e : J[i])
+                rhVector->set(e.first, e.second);
+
+            linearsolver->solveSystem();
+
+            for (int j = 0; j < nbConstraints; ++j)
+            {
+                double acc = 0.0;
+                for (const auto& e : J[j])
+                    acc += e.second * lhVector->element(e.first);
+                acc *= factor;
+
+                localW[i][j] += acc;
+                if (previousRow[j] >= 0)
+                    localW[j][i] += acc;
+            }
+        }
+    }
+
+    return true;
+}
 
 template<class DataTypes>
 void LinearSolverConstraintCorrection<DataTypes>::rebuildSystem(double massFactor, double forceFactor)
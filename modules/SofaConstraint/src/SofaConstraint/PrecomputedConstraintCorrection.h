@@ -24,12 +24,16 @@
 
 #include <sofa/core/behavior/ConstraintCorrection.h>
 #include <sofa/core/objectmodel/DataFileName.h>
+#include <sofa/helper/OptionsGroup.h>
+#include <sofa/helper/io/ArrayCacheFile.h>
 
 #include <SofaBaseLinearSolver/FullMatrix.h>
 
 #include <sofa/type/Mat.h>
 #include <sofa/type/Vec.h>
 
+#include <cstdint>
+
 namespace sofa::component::constraintset
 {
 
@@ -65,6 +69,7 @@ public:
 	Data<double> debugViewFrameScale; ///< Scale on computed node's frame
 	sofa::core::objectmodel::DataFileName f_fileCompliance; ///< Precomputed compliance matrix data file
 	Data<std::string> fileDir; ///< If not empty, the compliance will be saved in this repertory
+    Data<helper::OptionsGroup> d_complianceStorage; ///< Precision of the stored compliance: double (raw file, default), float, or half
     
 protected:
     PrecomputedConstraintCorrection(sofa::core::behavior::MechanicalState<DataTypes> *mm = nullptr);
@@ -117,16 +122,75 @@ public:
 
 public:
 
+    /// Compliance matrix shared by all the components using the same file.
+    /// It is either a dense matrix of Real (data), or a compressed one, stored in single
+    /// precision, or in half precision with one scale per block of HalfBlockSize values.
+    /// A compressed compliance is mapped read-only from its file whenever it could be written,
+    /// so that the memory pages are shared by all the processes using the same file.
     struct InverseStorage
     {
+        static constexpr std::size_t HalfBlockSize = 64;
+
         Real* data;
         int nbref;
+
+        const float* floatValues {nullptr};
+        const std::uint16_t* halfValues {nullptr};
+        const float* blockScales {nullptr};
+        helper::io::ArrayCacheReader file;
+        std::vector<float> floatBuffer; ///< compressed values kept in memory when the file could not be written
+        std::vector<std::uint16_t> halfBuffer;
+        std::vector<float> scaleBuffer;
+
         InverseStorage() : data(nullptr), nbref(0) {}
+
+        bool empty() const { return data == nullptr && floatValues == nullptr && halfValues == nullptr; }
+
+        /// Coefficients of the compliance matrix, stored row by row, in each storage
+        struct DenseValues
+        {
+            const Real* values;
+            Real operator[](std::size_t i) const { return values[i]; }
+        };
+        struct FloatValues
+        {
+            const float* values;
+            Real operator[](std::size_t i) const { return (Real)values[i]; }
+        };
+        struct HalfValues
+        {
+            const std::uint16_t* values;
+            const float* scales;
+            Real operator[](std::size_t i) const { return (Real)(halfToFloat(values[i]) * scales[i / HalfBlockSize]); }
+        };
+
+        /// Call f with the coefficients of the storage in use, so that the loops on the compliance
+        /// are compiled for each storage instead of testing it at each coefficient
+        template<class Function>
+        void visit(Function&& f) const
+        {
+            if (data)
+                f(DenseValues{data});
+            else if (floatValues)
+                f(FloatValues{floatValues});
+            else
+                f(HalfValues{halfValues, blockScales});
+        }
+
+        /// i-th coefficient of the compliance matrix, stored row by row
+        Real value(std::size_t i) const
+        {
+            Real v {};
+            visit([&v, i](const auto& values) { v = values[i]; });
+            return v;
+        }
+
+        static float halfToFloat(std::uint16_t h);
+        static std::uint16_t floatToHalf(float f);
     };
 
     std::string invName;
     InverseStorage* invM;
-    Real* appCompliance;
     unsigned int dimensionAppCompliance;
 
     static std::map<std::string, InverseStorage>& getInverseMap()
@@ -142,7 +206,7 @@ public:
     unsigned int nbRows, nbCols, dof_on_node, nbNodes;
     type::vector<int> _indexNodeSparseCompliance;
     type::vector<Deriv> _sparseCompliance;
-    Real Fbuf[6], DXbuf;
+    Real Fbuf[6];
 
     // new :  for non building the constraint system during solving process //
     //VecDeriv constraint_disp, constraint_force;
@@ -158,12 +222,13 @@ public:
     std::list<int> constraint_dofs;		// list of indices of each point which is involve with constraint
 
 public:
+    /// Dense compliance matrix, only available when it is stored in double precision
     Real* getInverse()
     {
         if (invM->data)
             return invM->data;
         else
-            msg_error() << "Inverse is not computed yet";
+            msg_error() << "Inverse is not computed yet, or is stored compressed";
         return nullptr;
     }
 
@@ -177,9 +242,34 @@ protected:
 
     /**
      * @brief Save compliance matrix into a file.
+     *
+     * If the compliance is stored compressed, the dense matrix is compressed then released,
+     * and the written file is mapped in memory.
      */
     void saveCompliance(const std::string& fileName);
 
+    /**
+     * @brief Load the raw compliance matrix of doubles from an external file.
+     */
+    bool loadDenseCompliance(const std::string& fileName);
+
+    /**
+     * @brief Map the compressed compliance matrix stored in the given file.
+     */
+    bool mapCompressedCompliance(const std::string& filePath);
+
+    /**
+     * @brief Key identifying the compressed compliance files of this component.
+     */
+    std::uint64_t compressedComplianceKey() const;
+
+    /**
+     * @brief Path of a compliance file, in fileDir if set, else in the data repository.
+     */
+    std::string complianceFilePath(const std::string& fileName) const;
+
+    bool isComplianceCompressed() const { return d_complianceStorage.getValue().getSelectedId() != 0; }
+
     /**
      * @brief Builds the compliance file name using the SOFA component internal data.
      */
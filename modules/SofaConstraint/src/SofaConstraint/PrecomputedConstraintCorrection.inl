@@ -39,6 +39,9 @@
 
 #include <sofa/simulation/fwd.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <list>
@@ -58,8 +61,11 @@ PrecomputedConstraintCorrection<DataTypes>::PrecomputedConstraintCorrection(sofa
     , debugViewFrameScale(initData(&debugViewFrameScale, 1.0, "debugViewFrameScale", "Scale on computed node's frame"))
     , f_fileCompliance(initData(&f_fileCompliance, "fileCompliance", "Precomputed compliance matrix data file"))
     , fileDir(initData(&fileDir, "fileDir", "If not empty, the compliance will be saved in this repertory"))
+    , d_complianceStorage(initData(&d_complianceStorage, helper::OptionsGroup(3, "double", "float", "half"), "complianceStorage",
+                                   "Precision of the stored compliance: double (raw file), float, or half (16-bit floats scaled by blocks). "
+                                   "Compressed compliances are saved in a file suffixed by the precision and mapped read-only in memory, "
+                                   "so that processes running the same scene share it"))
     , invM(nullptr)
-    , appCompliance(nullptr)
     , nbRows(0), nbCols(0), dof_on_node(0), nbNodes(0)
 {
     this->addAlias(&f_fileCompliance, "filePrefix");
@@ -99,6 +105,62 @@ void PrecomputedConstraintCorrection<DataTypes>::releaseInverse(std::string name
 }
 
 
+template<class DataTypes>
+float PrecomputedConstraintCorrection<DataTypes>::InverseStorage::halfToFloat(std::uint16_t h)
+{
+    const std::uint32_t sign = std::uint32_t(h & 0x8000) << 16;
+    const std::uint32_t exponent = (h >> 10) & 0x1f;
+    const std::uint32_t mantissa = h & 0x3ff;
+
+    if (exponent == 0) // zero or subnormal
+    {
+        const float v = std::ldexp((float)mantissa, -24);
+        return sign ? -v : v;
+    }
+
+    std::uint32_t bits;
+    if (exponent == 0x1f) // infinity or NaN
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    else
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+template<class DataTypes>
+std::uint16_t PrecomputedConstraintCorrection<DataTypes>::InverseStorage::floatToHalf(float f)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    const std::uint16_t sign = std::uint16_t((bits >> 16) & 0x8000);
+    const std::uint32_t absBits = bits & 0x7fffffff;
+
+    if (absBits >= 0x7f800000) // infinity or NaN
+        return sign | 0x7c00 | (absBits > 0x7f800000 ? 0x200 : 0);
+    if (absBits >= 0x477ff000) // rounded above the largest half (65504)
+        return sign | 0x7c00;
+
+    // round to nearest even
+    const auto round = [](std::uint32_t value, std::uint32_t remainder, std::uint32_t halfway)
+    {
+        return (remainder > halfway || (remainder == halfway && (value & 1))) ? value + 1 : value;
+    };
+
+    if (absBits < 0x38800000) // subnormal half
+    {
+        if (absBits < 0x33000000) // below half the smallest subnormal
+            return sign;
+        const std::uint32_t shift = 126 - (absBits >> 23);
+        const std::uint32_t mantissa = (absBits & 0x7fffff) | 0x800000;
+        return sign | std::uint16_t(round(mantissa >> shift, mantissa & ((1u << shift) - 1), 1u << (shift - 1)));
+    }
+
+    return sign | std::uint16_t(round((absBits - 0x38000000) >> 13, absBits & 0x1fff, 0x1000));
+}
+
+
 struct ConstraintActivation { bool acc, vel, pos; };
 
 
@@ -119,56 +181,157 @@ std::string PrecomputedConstraintCorrection<DataTypes>::buildFileName()
 template<class DataTypes>
 bool PrecomputedConstraintCorrection<DataTypes>::loadCompliance(std::string fileName)
 {
-    // Try to load from memory
-    msg_info() << "Try to load compliance from memory " << fileName ;
-
-    invM = getInverse(fileName);
     dimensionAppCompliance = nbRows;
 
-    if (invM->data == nullptr)
+    if (!isComplianceCompressed())
+    {
+        // Try to load from memory
+        msg_info() << "Try to load compliance from memory " << fileName ;
+
+        invM = getInverse(fileName);
+
+        if (invM->data == nullptr)
+            return loadDenseCompliance(fileName);
+
+        return true;
+    }
+
+    // A compressed compliance is stored aside the raw one, in a file suffixed by its precision
+    invName = fileName + "." + d_complianceStorage.getValue().getSelectedItem();
+
+    msg_info() << "Try to load compliance from memory " << invName ;
+
+    invM = getInverse(invName);
+    if (!invM->empty())
+        return true;
+
+    std::string filePath = invName;
+    if (!fileDir.getValue().empty())
+        filePath = fileDir.getValue() + "/" + invName;
+    else if (recompute.getValue() || !sofa::helper::system::DataRepository.findFile(filePath, "", nullptr))
+        filePath.clear();
+
+    if (!filePath.empty() && mapCompressedCompliance(filePath))
     {
-        // Try to load from file
-        msg_info() << "Try to load compliance from : " << fileName ;
+        msg_info() << "File " << filePath << " found and mapped" ;
+        return true;
+    }
+
+    // Convert a raw compliance, so that it is not loaded anymore in the next runs
+    if (loadDenseCompliance(fileName))
+    {
+        saveCompliance(invName);
+        return true;
+    }
+
+    return false;
+}
+
 
-        std::string dir = fileDir.getValue();
-        if (!dir.empty())
+
+template<class DataTypes>
+bool PrecomputedConstraintCorrection<DataTypes>::loadDenseCompliance(const std::string& fileName)
+{
+    // Try to load from file
+    msg_info() << "Try to load compliance from : " << fileName ;
+
+    std::string dir = fileDir.getValue();
+    if (!dir.empty())
+    {
+        std::ifstream compFileIn((dir + "/" + fileName).c_str(), std::ifstream::binary);
+        if (compFileIn.is_open())
         {
-            std::ifstream compFileIn((dir + "/" + fileName).c_str(), std::ifstream::binary);
-            if (compFileIn.is_open())
-            {
-                invM->data = new Real[nbRows * nbCols];
+            invM->data = new Real[nbRows * nbCols];
 
-                msg_info() << "File " << dir + "/" + fileName << " found. Loading..." ;
+            msg_info() << "File " << dir + "/" + fileName << " found. Loading..." ;
 
-                compFileIn.read((char*)invM->data, nbCols * nbRows * sizeof(double));
-                compFileIn.close();
+            compFileIn.read((char*)invM->data, nbCols * nbRows * sizeof(double));
+            compFileIn.close();
 
-                return true;
-            }
-            else
-                return false;
+            return true;
         }
-        else if (recompute.getValue() == false)
+        else
+            return false;
+    }
+    else if (recompute.getValue() == false)
+    {
+        std::string filePath = fileName;
+        if(sofa::helper::system::DataRepository.findFile(filePath))
         {
-            if(sofa::helper::system::DataRepository.findFile(fileName))
-            {
-                invM->data = new Real[nbRows * nbCols];
+            invM->data = new Real[nbRows * nbCols];
 
-                std::ifstream compFileIn(fileName.c_str(), std::ifstream::binary);
+            std::ifstream compFileIn(filePath.c_str(), std::ifstream::binary);
 
-                msg_info() << "File " << fileName << " found. Loading..." ;
+            msg_info() << "File " << filePath << " found. Loading..." ;
 
-                compFileIn.read((char*)invM->data, nbCols * nbRows * sizeof(double));
-                compFileIn.close();
+            compFileIn.read((char*)invM->data, nbCols * nbRows * sizeof(double));
+            compFileIn.close();
 
-                return true;
-            }
+            return true;
         }
+    }
+
+    return false;
+}
+
+
+
+template<class DataTypes>
+std::uint64_t PrecomputedConstraintCorrection<DataTypes>::compressedComplianceKey() const
+{
+    using helper::io::ArrayCacheFile;
+
+    static const std::string version = "PrecomputedConstraintCorrection compliance 1";
+    const std::string& storage = d_complianceStorage.getValue().getSelectedItem();
+    const std::uint64_t size[2] = { nbRows, nbCols };
+
+    std::uint64_t key = ArrayCacheFile::hash(version.data(), version.size());
+    key = ArrayCacheFile::hash(storage.data(), storage.size(), key);
+    return ArrayCacheFile::hash(size, sizeof(size), key);
+}
+
 
+
+template<class DataTypes>
+bool PrecomputedConstraintCorrection<DataTypes>::mapCompressedCompliance(const std::string& filePath)
+{
+    InverseStorage& inv = *invM;
+    if (!inv.file.open(filePath, compressedComplianceKey()))
         return false;
+
+    const std::size_t size = std::size_t(nbRows) * nbCols;
+    const std::size_t nbBlocks = (size + InverseStorage::HalfBlockSize - 1) / InverseStorage::HalfBlockSize;
+    std::size_t count = 0, nbScales = 0;
+
+    if (d_complianceStorage.getValue().getSelectedId() == 1)
+    {
+        if (inv.file.get("compliance", inv.floatValues, count) && count == size)
+            return true;
     }
+    else if (inv.file.get("compliance", inv.halfValues, count) && count == size
+             && inv.file.get("scales", inv.blockScales, nbScales) && nbScales == nbBlocks)
+    {
+        return true;
+    }
+
+    msg_warning() << "Invalid compressed compliance file " << filePath ;
+
+    inv.floatValues = nullptr;
+    inv.halfValues = nullptr;
+    inv.blockScales = nullptr;
+    inv.file.close();
+    return false;
+}
+
+
 
-    return true;
+template<class DataTypes>
+std::string PrecomputedConstraintCorrection<DataTypes>::complianceFilePath(const std::string& fileName) const
+{
+    const std::string& dir = fileDir.getValue();
+    if (!dir.empty())
+        return dir + "/" + fileName;
+    return sofa::helper::system::DataRepository.getFirstPath() + "/" + fileName;
 }
 
 
@@ -178,16 +341,68 @@ void PrecomputedConstraintCorrection<DataTypes>::saveCompliance(const std::strin
 {
     msg_info() << "saveCompliance in " << fileName;
 
-    std::string filePathInSofaShare;
-    std::string dir = fileDir.getValue();
-    if (!dir.empty())
-        filePathInSofaShare = dir + "/" + fileName;
+    const std::string filePathInSofaShare = complianceFilePath(fileName);
+
+    if (!isComplianceCompressed())
+    {
+        std::ofstream compFileOut(filePathInSofaShare.c_str(), std::fstream::out | std::fstream::binary);
+        compFileOut.write((char*)invM->data, nbCols * nbRows * sizeof(double));
+        compFileOut.close();
+        return;
+    }
+
+    InverseStorage& inv = *invM;
+    const std::size_t size = std::size_t(nbRows) * nbCols;
+    helper::io::ArrayCacheWriter writer;
+
+    if (d_complianceStorage.getValue().getSelectedId() == 1)
+    {
+        inv.floatBuffer.assign(inv.data, inv.data + size);
+        writer.add("compliance", inv.floatBuffer);
+    }
     else
-        filePathInSofaShare  = sofa::helper::system::DataRepository.getFirstPath() + "/" + fileName;
+    {
+        // Half precision only has 11 significant bits and a narrow range:
+        // each block of values is normalized by its largest magnitude
+        const std::size_t blockSize = InverseStorage::HalfBlockSize;
+        const std::size_t nbBlocks = (size + blockSize - 1) / blockSize;
+        inv.halfBuffer.resize(size);
+        inv.scaleBuffer.resize(nbBlocks);
+        for (std::size_t b = 0; b < nbBlocks; ++b)
+        {
+            const std::size_t first = b * blockSize;
+            const std::size_t last = std::min(first + blockSize, size);
+
+            Real scale = 0;
+            for (std::size_t i = first; i < last; ++i)
+                scale = std::max(scale, std::abs(inv.data[i]));
+            inv.scaleBuffer[b] = (float)scale;
+
+            const Real invScale = (scale > 0) ? 1 / scale : 0;
+            for (std::size_t i = first; i < last; ++i)
+                inv.halfBuffer[i] = InverseStorage::floatToHalf((float)(inv.data[i] * invScale));
+        }
+        writer.add("compliance", inv.halfBuffer);
+        writer.add("scales", inv.scaleBuffer);
+    }
+
+    delete[] inv.data;
+    inv.data = nullptr;
 
-    std::ofstream compFileOut(filePathInSofaShare.c_str(), std::fstream::out | std::fstream::binary);
-    compFileOut.write((char*)invM->data, nbCols * nbRows * sizeof(double));
-    compFileOut.close();
+    if (writer.write(filePathInSofaShare, compressedComplianceKey()) && mapCompressedCompliance(filePathInSofaShare))
+    {
+        std::vector<float>().swap(inv.floatBuffer);
+        std::vector<std::uint16_t>().swap(inv.halfBuffer);
+        std::vector<float>().swap(inv.scaleBuffer);
+        return;
+    }
+
+    msg_warning() << "Could not write the compressed compliance in " << filePathInSofaShare
+                  << ", it is only kept in memory" ;
+
+    inv.floatValues = inv.floatBuffer.empty() ? nullptr : inv.floatBuffer.data();
+    inv.halfValues = inv.halfBuffer.empty() ? nullptr : inv.halfBuffer.data();
+    inv.blockScales = inv.scaleBuffer.empty() ? nullptr : inv.scaleBuffer.data();
 }
 
 
@@ -373,8 +588,6 @@ void PrecomputedConstraintCorrection<DataTypes>::bwdInit()
             pos[i] = prev_pos[i];
     }
 
-    appCompliance = invM->data;
-
     // Optimisation for the computation of W
     _indexNodeSparseCompliance.resize(v0.size());
 
@@ -387,7 +600,7 @@ void PrecomputedConstraintCorrection<DataTypes>::bwdInit()
         {
             for (unsigned int j = 0; j < 20 && j < nbCols; j++)
             {
-                msg_info() << " \t " << appCompliance[j*nbCols + i];
+                msg_info() << " \t " << invM->value(j*nbCols + i);
             }
         }
 
@@ -468,39 +681,42 @@ void PrecomputedConstraintCorrection< DataTypes >::addComplianceInConstraintSpac
 
     _sparseCompliance.resize(nActiveDof * nbConstraints);
 
-    for (int NodeIdx = 0; NodeIdx < (int)noSparseComplianceSize; ++NodeIdx)
+    invM->visit([&](const auto& compliance)
     {
-        if (_indexNodeSparseCompliance[NodeIdx] == -1)
-            continue;
-
-        _indexNodeSparseCompliance[NodeIdx] = it;
-
-        for (MatrixDerivRowConstIterator rowIt = c.begin(); rowIt != rowItEnd; ++rowIt)
+        for (int NodeIdx = 0; NodeIdx < (int)noSparseComplianceSize; ++NodeIdx)
         {
-            Vbuf.clear();
+            if (_indexNodeSparseCompliance[NodeIdx] == -1)
+                continue;
 
-            MatrixDerivColConstIterator colItEnd = rowIt.end();
+            _indexNodeSparseCompliance[NodeIdx] = it;
 
-            for (MatrixDerivColConstIterator colIt = rowIt.begin(); colIt != colItEnd; ++colIt)
+            for (MatrixDerivRowConstIterator rowIt = c.begin(); rowIt != rowItEnd; ++rowIt)
             {
-                const Deriv n2 = colIt.val();
-                offset = dof_on_node * (NodeIdx * nbCols +  colIt.index());
+                Vbuf.clear();
 
-                for (ii = 0; ii < dof_on_node; ii++)
+                MatrixDerivColConstIterator colItEnd = rowIt.end();
+
+                for (MatrixDerivColConstIterator colIt = rowIt.begin(); colIt != colItEnd; ++colIt)
                 {
-                    offset2 = offset + ii * nbCols;
+                    const Deriv n2 = colIt.val();
+                    offset = dof_on_node * (NodeIdx * nbCols +  colIt.index());
 
-                    for (jj = 0; jj < dof_on_node; jj++)
+                    for (ii = 0; ii < dof_on_node; ii++)
                     {
-                        Vbuf[ii] += appCompliance[offset2 + jj] * n2[jj];
+                        offset2 = offset + ii * nbCols;
+
+                        for (jj = 0; jj < dof_on_node; jj++)
+                        {
+                            Vbuf[ii] += compliance[offset2 + jj] * n2[jj];
+                        }
                     }
                 }
-            }
 
-            _sparseCompliance[it] = Vbuf;
-            it++;
+                _sparseCompliance[it] = Vbuf;
+                it++;
+            }
         }
-    }
+    });
 
     unsigned int curConstraint = 0;
 
@@ -553,32 +769,35 @@ void PrecomputedConstraintCorrection<DataTypes>::computeDx(Data<VecDeriv>& dx_d
     std::list<int>::const_iterator IterateurListe;
     unsigned int i, offset, offset2;
 
-    for (IterateurListe = activeDofs.begin(); IterateurListe != activeDofs.end(); ++IterateurListe)
+    invM->visit([&](const auto& compliance)
     {
-        int f = (*IterateurListe);
-
-        for (i = 0; i < dof_on_node; i++)
+        for (IterateurListe = activeDofs.begin(); IterateurListe != activeDofs.end(); ++IterateurListe)
         {
-            Fbuf[i] = force[f][i];
-        }
+            int f = (*IterateurListe);
 
-        for (unsigned int v = 0 ; v < dx.size() ; v++)
-        {
-            offset =  v * dof_on_node * nbCols + f * dof_on_node;
-            for (unsigned int j = 0; j < dof_on_node; j++)
+            for (i = 0; i < dof_on_node; i++)
             {
-                offset2 = offset + j * nbCols;
-                DXbuf = 0.0;
+                Fbuf[i] = force[f][i];
+            }
 
-                for (i = 0; i < dof_on_node; i++)
+            for (unsigned int v = 0 ; v < dx.size() ; v++)
+            {
+                offset =  v * dof_on_node * nbCols + f * dof_on_node;
+                for (unsigned int j = 0; j < dof_on_node; j++)
                 {
-                    DXbuf += appCompliance[ offset2 + i ] * Fbuf[i];
-                }
+                    offset2 = offset + j * nbCols;
+                    Real dxBuf = 0.0;
+
+                    for (i = 0; i < dof_on_node; i++)
+                    {
+                        dxBuf += compliance[offset2 + i] * Fbuf[i];
+                    }
 
-                dx[v][j] += DXbuf;
+                    dx[v][j] += dxBuf;
+                }
             }
         }
-    }
+    });
 
     dx_d.endEdit();
 }
@@ -721,30 +940,33 @@ void PrecomputedConstraintCorrection<DataTypes>::applyContactForce(const default
     std::list<int>::iterator IterateurListe;
     unsigned int i;
     unsigned int offset, offset2;
-    for (IterateurListe = activeDof.begin(); IterateurListe != activeDof.end(); ++IterateurListe)
+    invM->visit([&](const auto& compliance)
     {
-        int f = (*IterateurListe);
-
-        for (i=0; i< dof_on_node; i++)
+        for (IterateurListe = activeDof.begin(); IterateurListe != activeDof.end(); ++IterateurListe)
         {
-            Fbuf[i] = force[f][i];
-        }
+            int f = (*IterateurListe);
 
-        for(unsigned int v = 0 ; v < dx.size() ; v++)
-        {
-            offset =  v * dof_on_node * nbCols + f*dof_on_node;
-            for (unsigned int j=0; j< dof_on_node; j++)
+            for (i=0; i< dof_on_node; i++)
             {
-                offset2 = offset+ j*nbCols;
-                DXbuf=0.0;
-                for (i = 0; i < dof_on_node; i++)
+                Fbuf[i] = force[f][i];
+            }
+
+            for(unsigned int v = 0 ; v < dx.size() ; v++)
+            {
+                offset =  v * dof_on_node * nbCols + f*dof_on_node;
+                for (unsigned int j=0; j< dof_on_node; j++)
                 {
-                    DXbuf += appCompliance[ offset2 + i ] * Fbuf[i];
+                    offset2 = offset+ j*nbCols;
+                    Real dxBuf = 0.0;
+                    for (i = 0; i < dof_on_node; i++)
+                    {
+                        dxBuf += compliance[offset2 + i] * Fbuf[i];
+                    }
+                    dx[v][j]+=dxBuf;
                 }
-                dx[v][j]+=DXbuf;
             }
         }
-    }
+    });
 
     force.clear();
     force.resize(x_free.size());
@@ -768,13 +990,16 @@ void PrecomputedConstraintCorrection<DataTypes>::getComplianceMatrix(defaulttype
 {
     m->resize(dimensionAppCompliance,dimensionAppCompliance);
 
-    for (unsigned int l = 0; l < dimensionAppCompliance; ++l)
+    invM->visit([&](const auto& compliance)
     {
-        for (unsigned int c = 0; c < dimensionAppCompliance; ++c)
+        for (unsigned int l = 0; l < dimensionAppCompliance; ++l)
         {
-            m->set(l, c, appCompliance[l * dimensionAppCompliance + c]);
+            for (unsigned int c = 0; c < dimensionAppCompliance; ++c)
+            {
+                m->set(l, c, compliance[l * dimensionAppCompliance + c]);
+            }
         }
-    }
+    });
 }
 
 
@@ -1036,36 +1261,39 @@ void PrecomputedConstraintCorrection<DataTypes>::resetForUnbuiltResolution(doubl
 
     auto dofsItEnd = constraint_dofs.end();
 
-    for (auto dofsIt = constraint_dofs.begin(); dofsIt != dofsItEnd; ++dofsIt)
+    invM->visit([&](const auto& compliance)
     {
-        int NodeIdx = (*dofsIt);
-        _indexNodeSparseCompliance[NodeIdx] = it;
-
-        for (MatrixDerivRowConstIterator rowIt = c.begin(); rowIt != rowItEnd; ++rowIt)
+        for (auto dofsIt = constraint_dofs.begin(); dofsIt != dofsItEnd; ++dofsIt)
         {
-            Vbuf.clear();
-
-            MatrixDerivColConstIterator colItEnd = rowIt.end();
+            int NodeIdx = (*dofsIt);
+            _indexNodeSparseCompliance[NodeIdx] = it;
 
-            for (MatrixDerivColConstIterator colIt = rowIt.begin(); colIt != colItEnd; ++colIt)
+            for (MatrixDerivRowConstIterator rowIt = c.begin(); rowIt != rowItEnd; ++rowIt)
             {
-                offset = dof_on_node * (NodeIdx * nbCols +  colIt.index());
+                Vbuf.clear();
+
+                MatrixDerivColConstIterator colItEnd = rowIt.end();
 
-                for (unsigned int ii = 0; ii < dof_on_node; ii++)
+                for (MatrixDerivColConstIterator colIt = rowIt.begin(); colIt != colItEnd; ++colIt)
                 {
-                    offset2 = offset + ii *nbCols;
+                    offset = dof_on_node * (NodeIdx * nbCols +  colIt.index());
 
-                    for (unsigned int jj = 0; jj < dof_on_node; jj++)
+                    for (unsigned int ii = 0; ii < dof_on_node; ii++)
                     {
-                        Vbuf[ii] += appCompliance[offset2 + jj] * colIt.val()[jj];
+                        offset2 = offset + ii *nbCols;
+
+                        for (unsigned int jj = 0; jj < dof_on_node; jj++)
+                        {
+                            Vbuf[ii] += compliance[offset2 + jj] * colIt.val()[jj];
+                        }
                     }
                 }
-            }
 
-            _sparseCompliance[it] = Vbuf;
-            it++;
+                _sparseCompliance[it] = Vbuf;
+                it++;
+            }
         }
-    }
+    });
 
     localW.resize(nbConstraints, nbConstraints);
 
@@ -1176,50 +1404,53 @@ void PrecomputedConstraintCorrection<DataTypes>::setConstraintDForce(double * /*
 
     unsigned int offset, offset2;
 
-    for (int i = begin; i <= end; i++)
+    invM->visit([&](const auto& compliance)
     {
-        int cId = id_to_localIndex[i];
-
-        MatrixDerivRowConstIterator rowIt = c.readLine(cId);
-
-        if (rowIt != c.end())
+        for (int i = begin; i <= end; i++)
         {
-            MatrixDerivColConstIterator colItEnd = rowIt.end();
+            int cId = id_to_localIndex[i];
 
-            for (MatrixDerivColConstIterator colIt = rowIt.begin(); colIt != colItEnd; ++colIt)
-            {
-                Deriv n = colIt.val();
-                unsigned int dof = colIt.index();
+            MatrixDerivRowConstIterator rowIt = c.readLine(cId);
 
-                constraint_F[dof] += n * df[i];
+            if (rowIt != c.end())
+            {
+                MatrixDerivColConstIterator colItEnd = rowIt.end();
 
-                for (unsigned int j = 0; j < dof_on_node; j++)
+                for (MatrixDerivColConstIterator colIt = rowIt.begin(); colIt != colItEnd; ++colIt)
                 {
-                    Fbuf[j] = n[j] * df[i];
-                }
+                    Deriv n = colIt.val();
+                    unsigned int dof = colIt.index();
 
-                std::list< int >::const_iterator dofsItEnd = constraint_dofs.end();
-
-                for (std::list< int >::const_iterator dofsIt = constraint_dofs.begin(); dofsIt != dofsItEnd; ++dofsIt)
-                {
-                    int dof2 = *dofsIt;
-                    offset = dof2 * dof_on_node * nbCols + dof * dof_on_node;
+                    constraint_F[dof] += n * df[i];
 
                     for (unsigned int j = 0; j < dof_on_node; j++)
                     {
-                        offset2 = offset + j * nbCols;
-                        DXbuf = 0.0;
-                        for (unsigned int k = 0; k < dof_on_node; k++)
+                        Fbuf[j] = n[j] * df[i];
+                    }
+
+                    std::list< int >::const_iterator dofsItEnd = constraint_dofs.end();
+
+                    for (std::list< int >::const_iterator dofsIt = constraint_dofs.begin(); dofsIt != dofsItEnd; ++dofsIt)
+                    {
+                        int dof2 = *dofsIt;
+                        offset = dof2 * dof_on_node * nbCols + dof * dof_on_node;
+
+                        for (unsigned int j = 0; j < dof_on_node; j++)
                         {
-                            DXbuf += appCompliance[ offset2 + k ] * Fbuf[k];
+                            offset2 = offset + j * nbCols;
+                            Real dxBuf = 0.0;
+                            for (unsigned int k = 0; k < dof_on_node; k++)
+                            {
+                                dxBuf += compliance[offset2 + k] * Fbuf[k];
+                            }
+
+                            constraint_D[dof2][j] += dxBuf;
                         }
-
-                        constraint_D[dof2][j] += DXbuf;
                     }
                 }
             }
         }
-    }
+    });
 #else
     if(!update)
         return;
@@ -1277,46 +1508,49 @@ void PrecomputedConstraintCorrection<DataTypes>::getBlockDiagonalCompliance(defa
 
     std::list< int >::const_iterator dofsItEnd = localActiveDof.end();
 
-    for (std::list< int >::const_iterator dofsIt = localActiveDof.begin(); dofsIt != dofsItEnd; ++dofsIt)
+    invM->visit([&](const auto& compliance)
     {
-        int dof1 = (*dofsIt);
-        _indexNodeSparseCompliance[dof1] = it_localActiveDof;
-        it_localActiveDof++;
-
-        for (int i = begin; i <= end; i++)
+        for (std::list< int >::const_iterator dofsIt = localActiveDof.begin(); dofsIt != dofsItEnd; ++dofsIt)
         {
-            int cId = id_to_localIndex[i];
+            int dof1 = (*dofsIt);
+            _indexNodeSparseCompliance[dof1] = it_localActiveDof;
+            it_localActiveDof++;
 
-            Vbuf.clear();  // displacement obtained on the active node  dof 1  when apply contact force 1 on constraint c
+            for (int i = begin; i <= end; i++)
+            {
+                int cId = id_to_localIndex[i];
 
-            MatrixDerivRowConstIterator rowIt = c.readLine(cId);
+                Vbuf.clear();  // displacement obtained on the active node  dof 1  when apply contact force 1 on constraint c
 
-            if (rowIt != c.end())
-            {
-                MatrixDerivColConstIterator colItEnd = rowIt.end();
+                MatrixDerivRowConstIterator rowIt = c.readLine(cId);
 
-                for (MatrixDerivColConstIterator colIt = rowIt.begin(); colIt != colItEnd; ++colIt)
+                if (rowIt != c.end())
                 {
-                    const Deriv n2 = colIt.val();
-
-                    offset = dof_on_node * (dof1 * nbCols +  colIt.index());
+                    MatrixDerivColConstIterator colItEnd = rowIt.end();
 
-                    for (unsigned int ii = 0; ii < dof_on_node; ii++)
+                    for (MatrixDerivColConstIterator colIt = rowIt.begin(); colIt != colItEnd; ++colIt)
                     {
-                        offset2 = offset + ii * nbCols;
+                        const Deriv n2 = colIt.val();
 
-                        for (unsigned int jj = 0; jj < dof_on_node; jj++)
+                        offset = dof_on_node * (dof1 * nbCols +  colIt.index());
+
+                        for (unsigned int ii = 0; ii < dof_on_node; ii++)
                         {
-                            Vbuf[ii] += appCompliance[offset2 + jj] * n2[jj];
+                            offset2 = offset + ii * nbCols;
+
+                            for (unsigned int jj = 0; jj < dof_on_node; jj++)
+                            {
+                                Vbuf[ii] += compliance[offset2 + jj] * n2[jj];
+                            }
                         }
                     }
                 }
-            }
 
-            _sparseCompliance[it] = Vbuf;   // [it = numLocalConstraints *
-            it++;
+                _sparseCompliance[it] = Vbuf;   // [it = numLocalConstraints *
+                it++;
+            }
         }
-    }
+    });
     it = 0;
 
     for (int i = begin; i <= end; i++)
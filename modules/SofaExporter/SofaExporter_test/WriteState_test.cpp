@@ -79,7 +79,7 @@ namespace sofa {
         }
 
         // Create the scene and the components
-        void createScene(bool symplectic)
+        void createScene(bool symplectic, bool binary = false)
         {
             timeStep = 0.01;
             root->setGravity(Coord(0.0,0.0,gravity));
@@ -117,7 +117,8 @@ namespace sofa {
 
             if(symplectic)
             {
-                writeState->d_filename.setValue(std::string(SOFAEXPORTER_BUILD_DIR)+"particleGravityX.data");
+                writeState->d_filename.setValue(std::string(SOFAEXPORTER_BUILD_DIR)+(binary ? "particleGravityX.bin" : "particleGravityX.data"));
+                writeState->d_compress.setValue(binary);
                 writeState->d_writeX.setValue(true);
                 writeState->d_writeV.setValue(false);
             }
@@ -217,6 +218,48 @@ namespace sofa {
         }
 
 
+        bool test_binary_export()
+        {
+            // The binary recording should hold the same frames as the reference file
+            std::ifstream reference(std::string(SOFAEXPORTER_TESTFILES_DIR)+"particleGravityX-reference.data");
+            sofa::helper::io::BinaryStateReader reader;
+            if (!reader.open(std::string(SOFAEXPORTER_BUILD_DIR)+"particleGravityX.bin"))
+            {
+                std::cout<<"Problem opening binary file"<<std::endl;
+                return false;
+            }
+
+            std::size_t frame = 0;
+            std::string cmd;
+            sofa::helper::io::BinaryStateFrame state;
+            while (reference >> cmd)
+            {
+                if (cmd == "T=")
+                {
+                    double time;
+                    reference >> time;
+                    if (frame >= reader.getNbFrames() || !reader.readFrame(frame, state))
+                        return false;
+                    EXPECT_NEAR(state.time, time, 1e-12);
+                    ++frame;
+                }
+                else if (cmd == "X=")
+                {
+                    const auto* x = state.find("X");
+                    if (!x || x->values.size() != 3)
+                        return false;
+                    for (double value : x->values)
+                    {
+                        double expected;
+                        reference >> expected;
+                        EXPECT_NEAR(value, expected, 1e-12);
+                    }
+                }
+            }
+            EXPECT_EQ(frame, reader.getNbFrames());
+            return true;
+        }
+
         /// Unload the scene
         void TearDown()
         {
@@ -245,7 +288,20 @@ namespace sofa {
         this->TearDown();
     }
 
-    // Test 2 : write velocity of a particle falling under gravity
+    // Test 2 : write position of a particle falling under gravity in a compressed binary file
+    TYPED_TEST( WriteState_test , test_write_binary)
+    {
+        this->SetUp();
+        this->createScene(true, true);
+        this->initScene();
+        this->runScene();
+
+        ASSERT_TRUE( this->simulation_result_test(true) );
+        this->TearDown();
+        ASSERT_TRUE( this->test_binary_export() );
+    }
+
+    // Test 3 : write velocity of a particle falling under gravity
     TYPED_TEST( WriteState_test , test_write_velocity)
     {
         this->SetUp();
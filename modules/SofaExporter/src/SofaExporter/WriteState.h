@@ -32,6 +32,7 @@
 #include <sofa/defaulttype/DataTypeInfo.h>
 #include <sofa/simulation/Visitor.h>
 #include <sofa/core/objectmodel/DataFileName.h>
+#include <sofa/helper/io/BinaryStateFile.h>
 
 #if SOFAEXPORTER_HAVE_ZLIB
 #include <zlib.h>
@@ -53,6 +54,8 @@ namespace misc
  * The DoFs to print can be chosen using DOFsX and DOFsV
  * Stop to write the state if the kinematic energy reach a given threshold (stopAt)
  * The energy will be measured at each period determined by keperiod
+ * If the file name ends with .bin, the state is recorded in the binary format of
+ * helper::io::BinaryStateFile, written from a background thread
 */
 class SOFA_SOFAEXPORTER_API WriteState: public core::objectmodel::BaseObject
 {
@@ -70,6 +73,7 @@ public:
     Data < type::vector<unsigned int> > d_DOFsV; ///< set the velocity DOFs to write
     Data < double > d_stopAt; ///< stop the simulation when the given threshold is reached
     Data < double > d_keperiod; ///< set the period to measure the kinetic energy increase
+    Data < bool > d_compress; ///< losslessly compress the frames of binary (.bin) files
 
 protected:
     core::behavior::BaseMechanicalState* mmodel;
@@ -77,6 +81,7 @@ protected:
 #if SOFAEXPORTER_HAVE_ZLIB
     gzFile gzfile;
 #endif
+    helper::io::BinaryStateWriter binaryWriter;
     unsigned int nextIteration;
     double lastTime;
     bool kineticEnergyThresholdReached;
@@ -89,6 +94,9 @@ protected:
 
     WriteState();
 
+    /// Queue the recorded vectors to the binary writer
+    void writeBinaryState(double time);
+
     ~WriteState() override;
 public:
     void init() override;
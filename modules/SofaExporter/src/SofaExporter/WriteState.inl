@@ -52,6 +52,7 @@ WriteState::WriteState()
     , d_DOFsV( initData(&d_DOFsV, type::vector<unsigned int>(0), "DOFsV", "set the velocity DOFs to write"))
     , d_stopAt( initData(&d_stopAt, 0.0, "stopAt", "stop the simulation when the given threshold is reached"))
     , d_keperiod( initData(&d_keperiod, 0.0, "keperiod", "set the period to measure the kinetic energy increase"))
+    , d_compress( initData(&d_compress, false, "compress", "losslessly compress the frames of binary (.bin) files"))
     , mmodel(nullptr)
     , outfile(nullptr)
 #if SOFAEXPORTER_HAVE_ZLIB
@@ -92,7 +93,14 @@ void WriteState::init()
     ///////////// end of the tests.
 
     const std::string& filename = d_filename.getFullPath();
-    if (!filename.empty())
+    if (filename.size() >= 4 && filename.substr(filename.size()-4)==".bin")
+    {
+        if (!binaryWriter.open(filename, d_compress.getValue()))
+        {
+            msg_error() << "Error creating file " << filename;
+        }
+    }
+    else if (!filename.empty())
     {
 #if SOFAEXPORTER_HAVE_ZLIB
         if (filename.size() >= 3 && filename.substr(filename.size()-3)==".gz")
@@ -234,6 +242,7 @@ if (outfile)
 if (gzfile)
     gzclose(gzfile);
 #endif
+binaryWriter.close();
 init();
 }
 void WriteState::reset()
@@ -258,6 +267,7 @@ void WriteState::handleEvent(sofa::core::objectmodel::Event* event)
 #if SOFAEXPORTER_HAVE_ZLIB
             && !gzfile
 #endif
+            && !binaryWriter.isOpen()
            )
             return;
 
@@ -326,6 +336,11 @@ void WriteState::handleEvent(sofa::core::objectmodel::Event* event)
         }
         if (writeCurrent)
         {
+            if (binaryWriter.isOpen())
+            {
+                writeBinaryState(time);
+            }
+            else
 #if SOFAEXPORTER_HAVE_ZLIB
             if (gzfile)
             {
@@ -393,6 +408,51 @@ void WriteState::handleEvent(sofa::core::objectmodel::Event* event)
     }
 }
 
+void WriteState::writeBinaryState(double time)
+{
+    if (binaryWriter.hasFailed())
+    {
+        msg_error() << "Error writing file " << d_filename.getFullPath() << ", the recording is stopped";
+        binaryWriter.close();
+        return;
+    }
+
+    helper::io::BinaryStateFrame frame;
+    frame.time = time;
+
+    const auto addVector = [&](const char* name, core::ConstVecId id, bool isCoord)
+    {
+        const unsigned int dim = isCoord ? mmodel->getCoordDimension() : mmodel->getDerivDimension();
+        const unsigned int n = dim * mmodel->getSize();
+        helper::io::BinaryStateVector v;
+        v.name = name;
+        v.stride = dim;
+        v.values.resize(n);
+        if constexpr (std::is_same_v<SReal, double>)
+        {
+            mmodel->copyToBuffer(v.values.data(), id, n);
+        }
+        else
+        {
+            std::vector<SReal> buffer(n);
+            mmodel->copyToBuffer(buffer.data(), id, n);
+            std::copy(buffer.begin(), buffer.end(), v.values.begin());
+        }
+        frame.vectors.push_back(std::move(v));
+    };
+
+    if (d_writeX.getValue())
+        addVector("X", core::VecId::position(), true);
+    if (d_writeX0.getValue())
+        addVector("X0", core::VecId::restPosition(), true);
+    if (d_writeV.getValue())
+        addVector("V", core::VecId::velocity(), false);
+    if (d_writeF.getValue())
+        addVector("F", core::VecId::force(), false);
+
+    binaryWriter.write(std::move(frame));
+}
+
 } // namespace misc
 
 } // namespace component
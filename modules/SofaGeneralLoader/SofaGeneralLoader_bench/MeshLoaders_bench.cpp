@@ -0,0 +1,237 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+/**
+ * Benchmark of the ASCII mesh loaders on large generated meshes.
+ *
+ * A noisy n x n triangulated grid is written as OBJ, legacy VTK, OFF and ASCII STL files in the
+ * temporary directory. For each format, it compares the throughput of:
+ *  - a reference parser reading each line with std::getline into a std::istringstream, as the
+ *    loaders did before they parsed mapped files,
+ *  - the loader parsing sequentially,
+ *  - the loader parsing in parallel chunks on the task scheduler.
+ *
+ * Usage: SofaGeneralLoader_bench [gridSize] [nbThreads] [repetitions]
+ */
+
+#include <SofaGeneralLoader/MeshOffLoader.h>
+#include <SofaGeneralLoader/MeshSTLLoader.h>
+#include <SofaLoader/MeshObjLoader.h>
+#include <SofaLoader/MeshVTKLoader.h>
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace sofa::component::loader;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+
+struct Grid
+{
+    std::vector<std::array<double, 3> > points;
+    std::vector<std::array<int, 3> > triangles;
+};
+
+/// n x n quads, each split into 2 triangles, with noisy coordinates to get full-length floats
+Grid createGrid(int n)
+{
+    Grid grid;
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> noise(-0.25, 0.25);
+    const int np = n + 1;
+    for (int j = 0; j < np; ++j)
+        for (int i = 0; i < np; ++i)
+            grid.points.push_back({ i + noise(random), j + noise(random), noise(random) });
+
+    for (int j = 0; j < n; ++j)
+        for (int i = 0; i < n; ++i)
+        {
+            const int a = i + np * j;
+            grid.triangles.push_back({ a, a + 1, a + np + 1 });
+            grid.triangles.push_back({ a, a + np + 1, a + np });
+        }
+    return grid;
+}
+
+void writeObj(const Grid& grid, const std::string& filename)
+{
+    std::ofstream out(filename);
+    out << std::setprecision(9);
+    for (const auto& p : grid.points)
+        out << "v " << p[0] << ' ' << p[1] << ' ' << p[2] << '\n';
+    for (const auto& t : grid.triangles)
+        out << "f " << t[0] + 1 << ' ' << t[1] + 1 << ' ' << t[2] + 1 << '\n';
+}
+
+void writeVtk(const Grid& grid, const std::string& filename)
+{
+    std::ofstream out(filename);
+    out << std::setprecision(9);
+    out << "# vtk DataFile Version 2.0\ngrid\nASCII\nDATASET UNSTRUCTURED_GRID\n";
+    out << "POINTS " << grid.points.size() << " double\n";
+    for (const auto& p : grid.points)
+        out << p[0] << ' ' << p[1] << ' ' << p[2] << '\n';
+    out << "CELLS " << grid.triangles.size() << ' ' << 4 * grid.triangles.size() << '\n';
+    for (const auto& t : grid.triangles)
+        out << "3 " << t[0] << ' ' << t[1] << ' ' << t[2] << '\n';
+    out << "CELL_TYPES " << grid.triangles.size() << '\n';
+    for (std::size_t i = 0; i < grid.triangles.size(); ++i)
+        out << "5\n";
+}
+
+void writeOff(const Grid& grid, const std::string& filename)
+{
+    std::ofstream out(filename);
+    out << std::setprecision(9);
+    out << "OFF\n" << grid.points.size() << ' ' << grid.triangles.size() << " 0\n";
+    for (const auto& p : grid.points)
+        out << p[0] << ' ' << p[1] << ' ' << p[2] << '\n';
+    for (const auto& t : grid.triangles)
+        out << "3 " << t[0] << ' ' << t[1] << ' ' << t[2] << '\n';
+}
+
+void writeStl(const Grid& grid, const std::string& filename)
+{
+    std::ofstream out(filename);
+    out << std::setprecision(9);
+    out << "solid grid\n";
+    for (const auto& t : grid.triangles)
+    {
+        out << "  facet normal 0 0 1\n    outer loop\n";
+        for (int v : t)
+        {
+            const auto& p = grid.points[v];
+            out << "      vertex " << p[0] << ' ' << p[1] << ' ' << p[2] << '\n';
+        }
+        out << "    endloop\n  endfacet\n";
+    }
+    out << "endsolid grid\n";
+}
+
+/// Tokenize each line with a std::istringstream, reading its numbers as doubles
+std::size_t referenceParse(const std::string& filename)
+{
+    std::ifstream file(filename);
+    std::string line, token;
+    std::size_t nbValues = 0;
+    while (std::getline(file, line))
+    {
+        std::istringstream values(line);
+        while (values >> token)
+        {
+            std::istringstream number(token);
+            double value;
+            if (number >> value)
+                ++nbValues;
+        }
+    }
+    return nbValues;
+}
+
+template<class Function>
+double timeIt(int repetitions, Function f)
+{
+    f(); // warm-up
+    double best = 1e300;
+    for (int r = 0; r < repetitions; ++r)
+    {
+        const auto start = Clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+template<class Loader>
+void benchmark(const std::string& name, const std::string& filename, unsigned int nbThreads, int repetitions)
+{
+    const double megabytes = std::filesystem::file_size(filename) / (1024.0 * 1024.0);
+    std::cout << "\n" << name << ": " << std::fixed << std::setprecision(1) << megabytes << " MB\n";
+
+    auto print = [megabytes](const std::string& label, double ms)
+    {
+        std::cout << std::left << std::setw(26) << ("  " + label) << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(12) << ms << " ms"
+                  << std::setprecision(1) << std::setw(10) << megabytes / (ms * 1e-3) << " MB/s\n";
+    };
+
+    print("getline + istringstream", timeIt(repetitions, [&] { referenceParse(filename); }));
+
+    typename Loader::SPtr loader = sofa::core::objectmodel::New<Loader>();
+    loader->setFilename(filename);
+
+    // parsed inline, even if a task scheduler was initialized by a previous benchmark
+    loader->d_parallelParsing.setValue(false);
+    print("loader (sequential)", timeIt(repetitions, [&] { loader->load(); }));
+
+    sofa::simulation::TaskScheduler::getInstance()->init(nbThreads);
+    loader->d_parallelParsing.setValue(true);
+    print("loader (" + std::to_string(sofa::simulation::TaskScheduler::getInstance()->getThreadCount()) + " threads)",
+          timeIt(repetitions, [&] { loader->load(); }));
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int gridSize = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000;
+    const unsigned int nbThreads = argc > 2 ? static_cast<unsigned int>(std::max(0, std::atoi(argv[2]))) : 0;
+    const int repetitions = argc > 3 ? std::max(1, std::atoi(argv[3])) : 3;
+
+    const Grid grid = createGrid(gridSize);
+    std::cout << "Triangulated grid " << gridSize << "^2: " << grid.points.size() << " points, "
+              << grid.triangles.size() << " triangles\n";
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    const std::string obj = (directory / "SofaGeneralLoader_bench.obj").string();
+    const std::string vtk = (directory / "SofaGeneralLoader_bench.vtk").string();
+    const std::string off = (directory / "SofaGeneralLoader_bench.off").string();
+    const std::string stl = (directory / "SofaGeneralLoader_bench.stl").string();
+    writeObj(grid, obj);
+    writeVtk(grid, vtk);
+    writeOff(grid, off);
+    writeStl(grid, stl);
+
+    benchmark<MeshObjLoader>("OBJ", obj, nbThreads, repetitions);
+    benchmark<MeshVTKLoader>("legacy VTK", vtk, nbThreads, repetitions);
+    benchmark<MeshOffLoader>("OFF", off, nbThreads, repetitions);
+    benchmark<MeshSTLLoader>("ASCII STL", stl, nbThreads, repetitions);
+
+    for (const auto& filename : { obj, vtk, off, stl })
+        std::filesystem::remove(filename);
+
+    sofa::simulation::TaskScheduler::getInstance()->stop();
+    return 0;
+}
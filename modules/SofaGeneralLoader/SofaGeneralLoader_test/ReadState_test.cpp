@@ -28,6 +28,15 @@ using sofa::simulation::Node;
 #include <sofa/type/Vec.h>
 using sofa::type::Vec3;
 
+#include <sofa/helper/io/BinaryStateFile.h>
+using sofa::helper::io::BinaryStateFrame;
+using sofa::helper::io::BinaryStateWriter;
+
+#include <SofaGeneralLoader/ReadState.h>
+using sofa::component::misc::ReadStateModifier;
+
+#include <filesystem>
+
 class ReadState_test : public BaseSimulationTest
 {
 public:
@@ -63,6 +72,59 @@ public:
         return true;
     }
 
+    /// Read a binary recording forward, then jump back in time
+    bool testBinaryFile()
+    {
+        const std::string filename = (std::filesystem::temp_directory_path() / "ReadState_test.bin").string();
+        {
+            BinaryStateWriter writer;
+            EXPECT_TRUE(writer.open(filename, true));
+            for (int i = 0; i < 10; ++i)
+            {
+                BinaryStateFrame frame;
+                frame.time = 0.01 * i;
+                frame.vectors.resize(1);
+                frame.vectors[0].name = "X";
+                frame.vectors[0].stride = 3;
+                frame.vectors[0].values = { 0.0, 0.0, -0.5 * i, 1.0, 0.0, -0.5 * i };
+                writer.write(frame);
+            }
+        }
+
+        double dt = 0.01;
+        sofa::simpleapi::importPlugin("SofaComponentAll") ;
+        auto simulation = sofa::simpleapi::createSimulation();
+        Node::SPtr root = sofa::simpleapi::createRootNode(simulation, "root");
+        sofa::simpleapi::createObject(root, "RequiredPlugin", { { "name","SofaGeneralLoader" } });
+        root->setGravity(Vec3(0.0,0.0,0.0));
+        root->setDt(dt);
+
+        Node::SPtr childNode = sofa::simpleapi::createChild(root, "Particle");
+        auto meca = sofa::simpleapi::createObject(childNode, "MechanicalObject", {{"size", "1"}});
+        sofa::simpleapi::createObject(childNode, "ReadState", {{"filename", filename}});
+
+        simulation->init(root.get());
+        for(int i=0; i<7; i++)
+        {
+            simulation->animate(root.get(), dt);
+        }
+
+        // the state is resized to the recorded one
+        EXPECT_EQ(meca->findData("position")->getValueString(),
+                  std::string("0 0 -3 1 0 -3"));
+
+        // go back in time: the matching frame is read directly
+        childNode->setTime(0.025);
+        ReadStateModifier modifier(sofa::core::execparams::defaultInstance(), 0.025);
+        root->execute(modifier);
+        EXPECT_EQ(meca->findData("position")->getValueString(),
+                  std::string("0 0 -1 1 0 -1"));
+
+        simulation->unload(root);
+        std::filesystem::remove(filename);
+        return true;
+    }
+
     /// Run seven steps of simulation then check results
     bool testLoadFailure()
     {
@@ -90,6 +152,12 @@ TEST_F(ReadState_test , test_defaultBehavior)
     ASSERT_TRUE( this->testDefaultBehavior() );
 }
 
+/// Test : read positions from a binary recording
+TEST_F(ReadState_test , test_binaryFile)
+{
+    ASSERT_TRUE( this->testBinaryFile() );
+}
+
 /// Test : when happens when unable to load the file ?
 TEST_F(ReadState_test , test_loadFailure)
 {
@@ -22,7 +22,11 @@
 #include <sofa/core/ObjectFactory.h>
 #include <SofaGeneralLoader/MeshOffLoader.h>
 #include <sofa/core/visual/VisualParams.h>
-#include <fstream>
+#include <sofa/helper/io/AsciiParser.h>
+#include <sofa/helper/io/MappedFile.h>
+#include <sofa/simulation/ParallelForEach.h>
+
+#include <numeric>
 
 namespace sofa::component::loader
 {
@@ -31,116 +35,183 @@ using namespace sofa::type;
 using namespace sofa::defaulttype;
 using namespace sofa::helper;
 
+namespace ascii = sofa::helper::io::ascii;
+
 int MeshOffLoaderClass = core::RegisterObject("Specific mesh loader for Off file format.")
         .add< MeshOffLoader >()
         ;
 
+MeshOffLoader::MeshOffLoader()
+    : MeshLoader()
+    , d_parallelParsing(initData(&d_parallelParsing, false, "parallelParsing", "Parse the file in parallel on the task scheduler, which is initialized if needed"))
+{
+}
+
 bool MeshOffLoader::doLoad()
 {
     msg_info() << "Loading OFF file: " << d_filename;
 
-    bool fileRead = false;
-
     // -- Loading file
     const char* filename = d_filename.getFullPath().c_str();
-    std::string cmd;
-    std::ifstream file(filename);
+    io::MappedFile file;
 
-    if (!file.good())
+    if (!file.open(filename))
     {
         msg_error() << "Cannot read file '" << d_filename << "'.";
         return false;
     }
 
-    file >> cmd;
-    if (cmd != "OFF")
+    const char* cursor = file.data();
+    const char* end = file.data() + file.size();
+    cursor = ascii::skipSpaces(cursor, end);
+    if (ascii::readToken(cursor, end) != "OFF")
     {
         msg_error() << "Not a OFF file (header problem) '" << d_filename << "'.";
         return false;
     }
 
     // -- Reading file
-    fileRead = this->readOFF (file,filename);
-    file.close();
-
-    return fileRead;
+    return this->readOFF(cursor, end);
 }
 
 void MeshOffLoader::doClearBuffers() {}
 
-bool MeshOffLoader::readOFF (std::ifstream &file, const char* /* filename */ )
+namespace
+{
+
+/// Lines which are neither empty nor comments
+bool isOffRecord(const char* line, const char* end)
+{
+    line = ascii::skipBlanks(line, end);
+    return line != end && *line != '\n' && *line != '#';
+}
+
+struct OffFace
+{
+    std::size_t nbVertices;
+    sofa::Index vertices[4];
+};
+
+
+/// Call f(c) for each chunk c in [0, nbChunks): on the task scheduler if the parsing is parallel, inline otherwise
+template<class Function>
+void forEachChunk(std::size_t nbChunks, bool parallel, const Function& f)
+{
+    if (parallel)
+    {
+        simulation::parallelForEach(std::size_t(0), nbChunks, f, 1);
+        return;
+    }
+    for (std::size_t c = 0; c < nbChunks; ++c)
+    {
+        f(c);
+    }
+}
+
+} // namespace
+
+bool MeshOffLoader::readOFF(const char* begin, const char* end)
 {
     msg_info() << "MeshOffLoader::readOFF" ;
 
+    if (d_parallelParsing.getValue())
+    {
+        auto* taskScheduler = simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 1)
+        {
+            taskScheduler->init(0);
+            msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+        }
+    }
+
     auto my_positions = getWriteOnlyAccessor(d_positions);
     auto my_triangles = getWriteOnlyAccessor(d_triangles);
     auto my_quads = getWriteOnlyAccessor(d_quads);
 
     size_t numberOfVertices = 0, numberOfFaces = 0, numberOfEdges = 0;
-    size_t currentNumberOfVertices = 0, currentNumberOfFaces = 0;
-    Vec3d vertex;
-    Triangle triangle;
-    Quad quad;
-    std::string line;
+    const char* cursor = begin;
 
-    while( !file.eof() && (numberOfVertices == 0) )
+    while (cursor != end && numberOfVertices == 0)
     {
-        std::getline(file,line);
-
-        if (line.empty()) continue;
-        if (line[0] == '#') continue;
-
-        std::istringstream values(line);
-        values >> numberOfVertices >> numberOfFaces >> numberOfEdges;
+        const char* lineEnd = ascii::findEndOfLine(cursor, end);
+        if (isOffRecord(cursor, lineEnd))
+        {
+            if (ascii::readNumber(cursor, lineEnd, numberOfVertices) && ascii::readNumber(cursor, lineEnd, numberOfFaces))
+                ascii::readNumber(cursor, lineEnd, numberOfEdges);
+        }
+        cursor = ascii::skipLine(lineEnd, end);
     }
 
     msg_info() << "vertices = "<< numberOfVertices
                << "faces = "<< numberOfFaces
                << "edges = "<< numberOfEdges ;
 
-    currentNumberOfVertices = 0;
-
-    //Vertices
-    while( !file.eof() &&  currentNumberOfVertices < numberOfVertices)
+    // The records (lines of vertices then of faces) are counted in each chunk of lines, so that
+    // the chunks can then be parsed in parallel knowing the index of their first record.
+    const std::vector<const char*> boundaries = ascii::splitLines(cursor, end);
+    const std::size_t nbChunks = boundaries.size() - 1;
+    std::vector<std::size_t> firstRecords(nbChunks + 1, 0);
+    forEachChunk(nbChunks, d_parallelParsing.getValue(), [&](std::size_t c)
     {
-        std::getline(file,line);
-
-        if (line.empty()) continue;
-        if (line[0] == '#') continue;
-
-        std::istringstream values(line);
-
-        values >> vertex[0] >> vertex[1] >> vertex[2];
-        my_positions.push_back(Vector3(vertex[0],vertex[1], vertex[2]));
+        std::size_t nbRecords = 0;
+        for (const char* line = boundaries[c]; line != boundaries[c + 1]; line = ascii::skipLine(line, boundaries[c + 1]))
+        {
+            nbRecords += isOffRecord(line, boundaries[c + 1]);
+        }
+        firstRecords[c + 1] = nbRecords;
+    });
+    std::partial_sum(firstRecords.begin(), firstRecords.end(), firstRecords.begin());
 
-        currentNumberOfVertices++;
-    }
-    currentNumberOfFaces = 0;
-    //Faces
-    while( !file.eof() && currentNumberOfFaces < numberOfFaces)
+    //Vertices
+    my_positions.resize(std::min(numberOfVertices, firstRecords.back()));
+    std::vector<std::vector<OffFace> > chunkFaces(nbChunks);
+    forEachChunk(nbChunks, d_parallelParsing.getValue(), [&](std::size_t c)
     {
-        std::getline(file,line);
-        if (line.empty()) continue;
-        if (line[0] == '#') continue;
-
-        std::istringstream values(line);
-        size_t numberOfVerticesPerFace = 0;
-
-        values >> numberOfVerticesPerFace;
-        if (numberOfVerticesPerFace < 3 || numberOfVerticesPerFace > 4)
-            continue;
-
-        if (numberOfVerticesPerFace == 3)
+        std::size_t record = firstRecords[c];
+        for (const char* line = boundaries[c]; line != boundaries[c + 1]; line = ascii::skipLine(line, boundaries[c + 1]))
         {
-            values >> triangle[0] >> triangle[1] >> triangle[2];
-            addTriangle(my_triangles.wref(), triangle);
+            const char* lineEnd = ascii::findEndOfLine(line, boundaries[c + 1]);
+            if (!isOffRecord(line, lineEnd))
+                continue;
+
+            if (record < numberOfVertices)
+            {
+                Vec3d vertex;
+                ascii::readNumbers(line, lineEnd, vertex.ptr(), 3);
+                my_positions[record] = Vector3(vertex[0], vertex[1], vertex[2]);
+            }
+            else
+            {
+                //Faces
+                OffFace face;
+                if (ascii::readNumber(line, lineEnd, face.nbVertices) && (face.nbVertices == 3 || face.nbVertices == 4))
+                {
+                    ascii::readNumbers(line, lineEnd, face.vertices, face.nbVertices);
+                    chunkFaces[c].push_back(face);
+                }
+            }
+            ++record;
         }
-        if (numberOfVerticesPerFace == 4)
+    });
+
+    // faces which are neither triangles nor quads are skipped and not counted
+    std::size_t currentNumberOfFaces = 0;
+    for (const auto& faces : chunkFaces)
+    {
+        for (const OffFace& face : faces)
         {
-            values >> quad[0] >> quad[1] >> quad[2] >> quad[3];
-            addQuad(my_quads.wref(), quad);
+            if (currentNumberOfFaces == numberOfFaces)
+                break;
+            if (face.nbVertices == 3)
+            {
+                addTriangle(my_triangles.wref(), Triangle(face.vertices[0], face.vertices[1], face.vertices[2]));
+            }
+            else
+            {
+                addQuad(my_quads.wref(), Quad(face.vertices[0], face.vertices[1], face.vertices[2], face.vertices[3]));
+            }
+            currentNumberOfFaces++;
         }
-        currentNumberOfFaces++;
     }
 
     return true;
@@ -35,13 +35,17 @@ public:
     bool doLoad() override;
 
 protected:
+    MeshOffLoader();
 
     void doClearBuffers() override;
-    bool readOFF(std::ifstream &file, const char* filename);
+
+    /// Parse the content of the file after the OFF keyword. The lines are split in chunks
+    /// which are parsed in parallel, then merged in the order of the file.
+    bool readOFF(const char* begin, const char* end);
 
 
 public:
-    // Add specific Data here:
+    Data<bool> d_parallelParsing; ///< parse the file in parallel on the task scheduler
 
 
 };
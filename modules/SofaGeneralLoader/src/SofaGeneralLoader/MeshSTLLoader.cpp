@@ -23,6 +23,9 @@
 #include <sofa/helper/system/FileRepository.h>
 #include <SofaGeneralLoader/MeshSTLLoader.h>
 #include <sofa/core/visual/VisualParams.h>
+#include <sofa/helper/io/AsciiParser.h>
+#include <sofa/helper/io/MappedFile.h>
+#include <sofa/simulation/ParallelForEach.h>
 
 #include <iostream>
 #include <fstream>
@@ -34,6 +37,7 @@ namespace sofa::component::loader
 {
 
 using sofa::helper::getWriteOnlyAccessor;
+namespace ascii = sofa::helper::io::ascii;
 
 using namespace sofa::type;
 using namespace sofa::defaulttype;
@@ -46,6 +50,7 @@ MeshSTLLoader::MeshSTLLoader() : MeshLoader()
     , _headerSize(initData(&_headerSize, 80u, "headerSize","Size of the header binary file (just before the number of facet)."))
     , _forceBinary(initData(&_forceBinary, false, "forceBinary","Force reading in binary mode. Even in first keyword of the file is solid."))
     , d_mergePositionUsingMap(initData(&d_mergePositionUsingMap, true, "mergePositionUsingMap","Since positions are duplicated in a STL, they have to be merged. Using a map to do so will temporarily duplicate memory but should be more efficient. Disable it if memory is really an issue."))
+    , d_parallelParsing(initData(&d_parallelParsing, false, "parallelParsing", "Parse the ASCII files in parallel on the task scheduler, which is initialized if needed"))
 {
 }
 
@@ -60,31 +65,23 @@ bool MeshSTLLoader::doLoad()
         return false;
     }
 
-    std::ifstream file(filename);
-    if (!file.good())
+    if( _forceBinary.getValue() )
+        return this->readBinarySTL(filename); // -- Reading binary file
+
+    sofa::helper::io::MappedFile file;
+    if (!file.open(filename))
     {
-        file.close();
         msg_error(this) << "Cannot read file '" << filename << "'.";
         return false;
     }
 
-    bool ret = false;
-    if( _forceBinary.getValue() )
-        ret = this->readBinarySTL(filename); // -- Reading binary file
-    else
-    {
-        std::string test;
-        file >> test;
+    const char* end = file.data() + file.size();
+    const char* cursor = ascii::skipSpaces(file.data(), end);
+    if (ascii::readToken(cursor, end) == "solid")
+        return this->readSTL(cursor, end);
 
-        if ( test == "solid" )
-            ret = this->readSTL(file);
-        else
-        {
-            file.close(); // no longer need for an ascii-open file
-            ret = this->readBinarySTL(filename); // -- Reading binary file
-        }
-    }
-    return ret;
+    file.close(); // no longer need for an ascii-open file
+    return this->readBinarySTL(filename); // -- Reading binary file
 }
 
 bool isBinarySTLValid(const char* filename, const MeshSTLLoader* _this)
@@ -231,10 +228,94 @@ bool MeshSTLLoader::readBinarySTL(const char *filename)
 }
 
 
-bool MeshSTLLoader::readSTL(std::ifstream& dataFile)
+namespace
+{
+
+/// Content of a chunk of lines of an ASCII STL file
+struct STLChunk
+{
+    enum Keyword : char { Vertex, EndFacet };
+
+    std::vector<Vec3f> normals;
+    std::vector<Vec3f> vertices;
+    std::vector<Keyword> keywords; ///< vertex and endfacet lines, in the order of the file
+    bool endOfSolid { false };
+};
+
+void parseSTLChunk(const char* cursor, const char* end, STLChunk& chunk)
+{
+    while (cursor != end)
+    {
+        const char* lineEnd = ascii::findEndOfLine(cursor, end);
+        const std::string_view keyword = ascii::readToken(cursor, lineEnd);
+
+        if (keyword == "facet")
+        {
+            // Normal
+            Vec3f normal;
+            ascii::readToken(cursor, lineEnd);
+            ascii::readNumbers(cursor, lineEnd, normal.ptr(), 3);
+            chunk.normals.push_back(normal);
+        }
+        else if (keyword == "vertex")
+        {
+            Vec3f vertex;
+            ascii::readNumbers(cursor, lineEnd, vertex.ptr(), 3);
+            chunk.vertices.push_back(vertex);
+            chunk.keywords.push_back(STLChunk::Vertex);
+        }
+        else if (keyword == "endfacet")
+        {
+            chunk.keywords.push_back(STLChunk::EndFacet);
+        }
+        else if (keyword == "endsolid" || keyword == "end")
+        {
+            chunk.endOfSolid = true;
+            return;
+        }
+
+        cursor = lineEnd == end ? end : lineEnd + 1;
+    }
+}
+
+
+/// Call f(c) for each chunk c in [0, nbChunks): on the task scheduler if the parsing is parallel, inline otherwise
+template<class Function>
+void forEachChunk(std::size_t nbChunks, bool parallel, const Function& f)
+{
+    if (parallel)
+    {
+        simulation::parallelForEach(std::size_t(0), nbChunks, f, 1);
+        return;
+    }
+    for (std::size_t c = 0; c < nbChunks; ++c)
+    {
+        f(c);
+    }
+}
+
+} // namespace
+
+bool MeshSTLLoader::readSTL(const char* begin, const char* end)
 {
-    Vec3f result;
-    std::string line;
+    if (d_parallelParsing.getValue())
+    {
+        auto* taskScheduler = simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 1)
+        {
+            taskScheduler->init(0);
+            msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+        }
+    }
+
+    // The chunks of lines are parsed independently, possibly in parallel. The vertices are then
+    // merged in the order of the file.
+    const std::vector<const char*> boundaries = ascii::splitLines(begin, end);
+    std::vector<STLChunk> chunks(boundaries.size() - 1);
+    forEachChunk(chunks.size(), d_parallelParsing.getValue(), [&](std::size_t c)
+    {
+        parseSTLChunk(boundaries[c], boundaries[c + 1], chunks[c]);
+    });
 
     auto my_positions = getWriteOnlyAccessor(d_positions);
     auto my_normals = getWriteOnlyAccessor(d_normals);
@@ -246,24 +327,23 @@ bool MeshSTLLoader::readSTL(std::ifstream& dataFile)
 
     Triangle the_tri;
 
-    while (std::getline(dataFile, line))
+    for (const STLChunk& chunk : chunks)
     {
-        if (line.empty()) continue;
-        std::istringstream values(line);
-
-        std::string bufferWord;
-        values >> bufferWord;
+        my_normals.wref().insert(my_normals.end(), chunk.normals.begin(), chunk.normals.end());
 
-        if (bufferWord == "facet")
+        auto vertex = chunk.vertices.begin();
+        for (const STLChunk::Keyword keyword : chunk.keywords)
         {
-            // Normal
-            values >> bufferWord >> result[0] >> result[1] >> result[2];
-            my_normals.push_back(result);
-        }
-        else if (bufferWord == "vertex")
-        {
-            // Vertex
-            values >> result[0] >> result[1] >> result[2];
+            if (keyword == STLChunk::EndFacet)
+            {
+                this->addTriangle(my_triangles.wref(), the_tri);
+                vertexCounter = 0;
+                continue;
+            }
+
+            const Vec3f& result = *vertex++;
+            if (vertexCounter >= 3)
+                continue;
 
             if( useMap )
             {
@@ -299,19 +379,11 @@ bool MeshSTLLoader::readSTL(std::ifstream& dataFile)
             }
             vertexCounter++;
         }
-        else if (bufferWord == "endfacet")
-        {
-            this->addTriangle(my_triangles.wref(), the_tri);
-            vertexCounter = 0;
-        }
-        else if (bufferWord == "endsolid" || bufferWord == "end")
-        {
+
+        if (chunk.endOfSolid)
             break;
-        }
     }
 
-    dataFile.close();
-
     dmsg_info() << "done!" ;
 
     return true;
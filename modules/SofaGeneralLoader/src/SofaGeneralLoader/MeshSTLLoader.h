@@ -36,8 +36,8 @@ protected:
 
 protected:
 
-    // ascii
-    bool readSTL(std::ifstream& file);
+    // ascii, [begin, end) being the content of the file after the solid keyword
+    bool readSTL(const char* begin, const char* end);
 
     // binary
     bool readBinarySTL(const char* filename);
@@ -51,6 +51,7 @@ public:
     Data <unsigned int> _headerSize; ///< Size of the header binary file (just before the number of facet).
     Data <bool> _forceBinary; ///< Force reading in binary mode. Even in first keyword of the file is solid.
     Data <bool> d_mergePositionUsingMap; ///< Since positions are duplicated in a STL, they have to be merged. Using a map to do so will temporarily duplicate memory but should be more efficient. Disable it if memory is really an issue.
+    Data <bool> d_parallelParsing; ///< Parse the ASCII files in parallel on the task scheduler, which is initialized if needed
 
 };
 
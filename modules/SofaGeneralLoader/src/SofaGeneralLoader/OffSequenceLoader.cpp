@@ -25,8 +25,9 @@
 
 #include <sofa/simulation/AnimateBeginEvent.h>
 #include <sofa/core/ObjectFactory.h>
+#include <sofa/helper/io/AsciiParser.h>
+#include <sofa/helper/io/MappedFile.h>
 #include <sstream>
-#include <fstream>
 
 namespace sofa::component::loader
 {
@@ -143,17 +144,17 @@ bool OffSequenceLoader::load(const char * filename)
 {
     bool fileRead = false;
 
-    std::string cmd;
-    std::ifstream file(filename);
+    helper::io::MappedFile file;
 
-    if (!file.good())
+    if (!file.open(filename))
     {
         msg_error() << "Cannot read file '" << d_filename << "'.";
         return false;
     }
 
-    file >> cmd;
-    if (cmd != "OFF")
+    const char* end = file.data() + file.size();
+    const char* cursor = helper::io::ascii::skipSpaces(file.data(), end);
+    if (helper::io::ascii::readToken(cursor, end) != "OFF")
     {
         msg_error() << "Not a OFF file (header problem) '" << d_filename << "'.";
         return false;
@@ -162,8 +163,7 @@ bool OffSequenceLoader::load(const char * filename)
     clear();
 
     // -- Reading file
-    fileRead = this->readOFF (file,filename);
-    file.close();
+    fileRead = this->readOFF (cursor, end);
 
     return fileRead;
 }
@@ -26,6 +26,7 @@
 #include <sofa/simulation/AnimateEndEvent.h>
 #include <sofa/simulation/Visitor.h>
 #include <sofa/core/objectmodel/DataFileName.h>
+#include <sofa/helper/io/BinaryStateFile.h>
 
 #if SOFAGENERALLOADER_HAVE_ZLIB
 #include <zlib.h>
@@ -37,6 +38,8 @@ namespace sofa::component::misc
 {
 
 /** Read State vectors from file at each timestep
+ * Files recorded in the binary format of helper::io::BinaryStateFile are
+ * mapped in memory and the frames are accessed directly from their time
 */
 class SOFA_SOFAGENERALLOADER_API ReadState: public core::objectmodel::BaseObject
 {
@@ -57,6 +60,9 @@ protected:
 #if SOFAGENERALLOADER_HAVE_ZLIB
     gzFile gzfile;
 #endif
+    helper::io::BinaryStateReader binaryReader;
+    helper::io::BinaryStateFrame binaryState;
+    std::size_t binaryFrame;
     double nextTime;
     double lastTime;
     double loopTime;
@@ -81,6 +87,10 @@ public:
     /// Read the next values in the file corresponding to the last timestep before the given time
     bool readNext(double time, std::vector<std::string>& lines);
 
+    /// Apply the frame of a binary file corresponding to the last timestep before the given time
+    /// Return true if the state was modified
+    bool readBinaryFrame(double time);
+
     /// Pre-construction check method called by ObjectFactory.
     /// Check that DataTypes matches the MechanicalState.
     template<class T>
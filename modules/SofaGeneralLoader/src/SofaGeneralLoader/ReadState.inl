@@ -31,6 +31,7 @@ using sofa::simulation::mechanicalvisitor::MechanicalProjectPositionAndVelocityV
 #include <sofa/simulation/mechanicalvisitor/MechanicalPropagateOnlyPositionAndVelocityVisitor.h>
 using sofa::simulation::mechanicalvisitor::MechanicalPropagateOnlyPositionAndVelocityVisitor;
 
+#include <cmath>
 #include <cstring>
 #include <sstream>
 
@@ -52,6 +53,7 @@ ReadState::ReadState()
 #if SOFAGENERALLOADER_HAVE_ZLIB
     , gzfile(nullptr)
 #endif
+    , binaryFrame(helper::io::BinaryStateReader::InvalidFrame)
     , nextTime(0)
     , lastTime(0)
     , loopTime(0)
@@ -98,6 +100,8 @@ void ReadState::reset()
         gzfile = nullptr;
     }
 #endif
+    binaryReader.close();
+    binaryFrame = helper::io::BinaryStateReader::InvalidFrame;
 
     const std::string& filename = d_filename.getFullPath();
     if (filename.empty())
@@ -114,6 +118,13 @@ void ReadState::reset()
         }
     }
 #endif
+    else if (helper::io::BinaryStateFile::isBinaryStateFile(filename))
+    {
+        if (!binaryReader.open(filename))
+        {
+            msg_error() << "Error opening binary state file "<<filename;
+        }
+    }
     else
     {
         infile = new std::ifstream(filename.c_str());
@@ -145,6 +156,8 @@ void ReadState::handleEvent(sofa::core::objectmodel::Event* event)
 
 void ReadState::setTime(double time)
 {
+    // binary files are accessed directly at any time, no need to rewind them
+    if (binaryReader.isOpen()) return;
     if (time+getContext()->getDt()*0.5 < lastTime) {reset();}
 }
 
@@ -230,35 +243,100 @@ bool ReadState::readNext(double time, std::vector<std::string>& validLines)
     return true;
 }
 
+bool ReadState::readBinaryFrame(double time)
+{
+    if (!mmodel) return false;
+    const std::size_t nbFrames = binaryReader.getNbFrames();
+    if (nbFrames == 0) return false;
+    lastTime = time;
+
+    const double endTime = binaryReader.getFrameTime(nbFrames-1);
+    if (d_loop.getValue() && endTime > 0 && time > endTime)
+        time = std::fmod(time, endTime);
+
+    const std::size_t frame = binaryReader.findFrame(time);
+    if (frame == helper::io::BinaryStateReader::InvalidFrame || frame == binaryFrame)
+        return false;
+    binaryFrame = frame;
+    if (!binaryReader.readFrame(frame, binaryState))
+    {
+        msg_error() << "Error reading frame " << frame << " of " << d_filename.getFullPath();
+        return false;
+    }
+
+    const auto copyVector = [this](const helper::io::BinaryStateVector* v, core::VecId id, sofa::Size dim)
+    {
+        if (!v || dim == 0) return false;
+        const sofa::Size size = sofa::Size(v->values.size() / dim);
+        if (mmodel->getSize() != size)
+            mmodel->resize(size);
+        if constexpr (std::is_same_v<SReal, double>)
+        {
+            mmodel->copyFromBuffer(id, v->values.data(), size * dim);
+        }
+        else
+        {
+            const std::vector<SReal> buffer(v->values.begin(), v->values.begin() + size * dim);
+            mmodel->copyFromBuffer(id, buffer.data(), size * dim);
+        }
+        return true;
+    };
+
+    bool updated = false;
+    if (copyVector(binaryState.find("X"), core::VecId::position(), mmodel->getCoordDimension()))
+    {
+        const double scale = d_scalePos.getValue();
+        const Vector3& rotation = d_rotation.getValue();
+        const Vector3& translation = d_translation.getValue();
+        mmodel->applyScale(scale,scale,scale);
+        mmodel->applyRotation(rotation[0],rotation[1],rotation[2]);
+        mmodel->applyTranslation(translation[0],translation[1],translation[2]);
+        updated = true;
+    }
+    if (copyVector(binaryState.find("V"), core::VecId::velocity(), mmodel->getDerivDimension()))
+    {
+        updated = true;
+    }
+    return updated;
+}
+
 void ReadState::processReadState()
 {
     double time = getContext()->getTime() + d_shift.getValue();
-    std::vector<std::string> validLines;
-    if (!readNext(time, validLines)) return;
     bool updated = false;
 
-    const double scale = d_scalePos.getValue();
-    const Vector3& rotation = d_rotation.getValue();
-    const Vector3& translation = d_translation.getValue();
-
-    for (std::vector<std::string>::iterator it=validLines.begin(); it!=validLines.end(); ++it)
+    if (binaryReader.isOpen())
     {
-        std::istringstream str(*it);
-        std::string cmd;
-        str >> cmd;
-        if (cmd == "X=")
-        {
-            mmodel->readVec(core::VecId::position(), str);
-            mmodel->applyScale(scale,scale,scale);
-            mmodel->applyRotation(rotation[0],rotation[1],rotation[2]);
-            mmodel->applyTranslation(translation[0],translation[1],translation[2]);
+        updated = readBinaryFrame(time);
+    }
+    else
+    {
+        std::vector<std::string> validLines;
+        if (!readNext(time, validLines)) return;
 
-            updated = true;
-        }
-        else if (cmd == "V=")
+        const double scale = d_scalePos.getValue();
+        const Vector3& rotation = d_rotation.getValue();
+        const Vector3& translation = d_translation.getValue();
+
+        for (std::vector<std::string>::iterator it=validLines.begin(); it!=validLines.end(); ++it)
         {
-            mmodel->readVec(core::VecId::velocity(), str);
-            updated = true;
+            std::istringstream str(*it);
+            std::string cmd;
+            str >> cmd;
+            if (cmd == "X=")
+            {
+                mmodel->readVec(core::VecId::position(), str);
+                mmodel->applyScale(scale,scale,scale);
+                mmodel->applyRotation(rotation[0],rotation[1],rotation[2]);
+                mmodel->applyTranslation(translation[0],translation[1],translation[2]);
+
+                updated = true;
+            }
+            else if (cmd == "V=")
+            {
+                mmodel->readVec(core::VecId::velocity(), str);
+                updated = true;
+            }
         }
     }
 
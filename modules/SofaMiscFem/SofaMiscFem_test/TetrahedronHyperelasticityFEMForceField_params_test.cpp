@@ -35,6 +35,7 @@ using sofa::testing::BaseSimulationTest;
 #include <SofaMiscForceField/initSofaMiscForceField.h>
 #include <SofaEngine/initSofaEngine.h>
 #include <sofa/type/Vec.h>
+#include <sofa/simulation/TaskScheduler.h>
 
 #include <iostream>
 #include <fstream>
@@ -141,6 +142,44 @@ struct TetrahedronHyperelasticityFEMForceField_params_test : public BaseSimulati
         sofa::core::objectmodel::BaseObject* hefem = root->getTreeNode("Hyperelastic-Liver")->getObject("FEM") ;
         EXPECT_NE(hefem, nullptr) ;
     }
+
+    /// Positions of the liver after a few steps with the given constitutive law
+    VecCoord simulate(const std::string& materialName, const sofa::type::vector<Real>& parameters, bool parallelEvaluation)
+    {
+        this->scene_load();
+
+        typename TetrahedronHyperelasticityFEMForceField::SPtr FF = sofa::core::objectmodel::New< TetrahedronHyperelasticityFEMForceField >();
+        hyperelasticNode->addObject(FF);
+        FF->setName("FEM");
+        FF->setMaterialName(materialName);
+        FF->setparameter(parameters);
+        FF->findData("parallelEvaluation")->read(parallelEvaluation ? "1" : "0");
+
+        sofa::simulation::getSimulation()->init(this->root.get());
+        for (int i = 0; i < 5; ++i)
+            sofa::simulation::getSimulation()->animate(this->root.get(), timeStep);
+
+        dof = hyperelasticNode->get<DOF>(hyperelasticNode->SearchDown);
+        EXPECT_NE(dof, nullptr);
+        VecCoord positions = dof ? dof->readPositions().ref() : VecCoord();
+        sofa::simulation::getSimulation()->unload(this->root);
+        return positions;
+    }
+
+    /// The elements evaluated in parallel are accumulated in the same order as sequentially: the results are identical
+    void run_test_parallel_evaluation(const std::string& materialName, const sofa::type::vector<Real>& parameters)
+    {
+        const VecCoord positions = simulate(materialName, parameters, false);
+
+        sofa::simulation::TaskScheduler::getInstance()->init(4);
+        const VecCoord parallelPositions = simulate(materialName, parameters, true);
+        sofa::simulation::TaskScheduler::getInstance()->stop();
+
+        ASSERT_EQ(parallelPositions.size(), positions.size());
+        ASSERT_FALSE(positions.empty());
+        for (std::size_t i = 0; i < positions.size(); ++i)
+            EXPECT_EQ(parallelPositions[i], positions[i]) << materialName << " " << i;
+    }
 };
 
 
@@ -162,6 +201,16 @@ TYPED_TEST( TetrahedronHyperelasticityFEMForceField_params_test , extension )
     this->run_test_params_mooney_case();
 }
 
+TYPED_TEST( TetrahedronHyperelasticityFEMForceField_params_test , parallelEvaluation )
+{
+    EXPECT_MSG_NOEMIT(Error) ;
+
+    this->run_test_parallel_evaluation("MooneyRivlin", {151065.460, 101709.668, 1e07});
+    this->run_test_parallel_evaluation("NeoHookean", {1e5, 1e7});
+    this->run_test_parallel_evaluation("StVenantKirchhoff", {1e5, 1e6});
+    this->run_test_parallel_evaluation("Ogden", {1e7, 1e5, 2});
+}
+
 
 } // namespace sofa
 
@@ -43,13 +43,14 @@ the determinant of the deformation gradient J and the right Cauchy Green deforma
 
 
 template<class DataTypes>
-class MooneyRivlin : public HyperelasticMaterial<DataTypes>{
+class MooneyRivlin final : public HyperelasticMaterial<DataTypes>{
 
   typedef typename DataTypes::Coord::value_type Real;
   typedef type::Mat<3,3,Real> Matrix3;
   typedef type::Mat<6,6,Real> Matrix6;
   typedef type::MatSym<3,Real> MatrixSym;
  
+public:
   virtual Real getStrainEnergy(StrainInformation<DataTypes> *sinfo, const MaterialParameters<DataTypes> &param) {
 	  MatrixSym inversematrix;
 		MatrixSym C=sinfo->deformationTensor;
@@ -46,7 +46,7 @@ the determinant of the deformation gradient J and the right Cauchy Green deforma
 
 
 template<class DataTypes>
-class Ogden: public HyperelasticMaterial<DataTypes>
+class Ogden final : public HyperelasticMaterial<DataTypes>
 {
 
     typedef typename DataTypes::Coord::value_type Real;
@@ -57,6 +57,7 @@ class Ogden: public HyperelasticMaterial<DataTypes>
     typedef typename Eigen::SelfAdjointEigenSolver<Eigen::Matrix<Real,3,3> >::MatrixType EigenMatrix;
     typedef typename Eigen::SelfAdjointEigenSolver<Eigen::Matrix<Real,3,3> >::RealVectorType CoordEigen;
 
+public:
     virtual Real getStrainEnergy(StrainInformation<DataTypes> *sinfo, const MaterialParameters<DataTypes> &param)
     {
         MatrixSym C=sinfo->deformationTensor;
@@ -42,7 +42,7 @@ the determinant of the deformation gradient J and the right Cauchy Green deforma
 
 
 template<class DataTypes>
-class STVenantKirchhoff : public HyperelasticMaterial<DataTypes>{
+class STVenantKirchhoff final : public HyperelasticMaterial<DataTypes>{
 
   typedef typename DataTypes::Coord::value_type Real;
   typedef type::Mat<3,3,Real> Matrix3;
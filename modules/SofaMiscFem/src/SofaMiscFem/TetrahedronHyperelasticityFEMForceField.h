@@ -150,6 +150,7 @@ public :
     Data<std::string> d_materialName; ///< the name of the material
     Data<SetParameterArray> d_parameterSet; ///< The global parameters specifying the material
     Data<SetAnisotropyDirectionArray> d_anisotropySet; ///< The global directions of anisotropy of the material
+    Data<bool> d_parallelEvaluation; ///< Evaluate the material on ranges of elements in parallel on the task scheduler
 
     TetrahedronData<sofa::type::vector<TetrahedronRestInformation> > m_tetrahedronInfo; ///< Internal tetrahedron data
     EdgeData<sofa::type::vector<EdgeInformation> > m_edgeInfo; ///< Internal edge data
@@ -217,6 +218,33 @@ public:
     fem::HyperelasticMaterial<DataTypes> *m_myMaterial;
     TetrahedronHandler* m_tetrahedronHandler;
 
+    /// the concrete type of m_myMaterial, to call it without virtual dispatch
+    enum class MaterialType { Generic, ArrudaBoyce, StVenantKirchhoff, NeoHookean, MooneyRivlin, VerondaWestman, Costa, Ogden };
+    MaterialType m_materialType;
+
+    /// per element contributions, computed concurrently then accumulated in the element order:
+    /// 4 vertex forces and 6 edge stiffness matrices per tetrahedron
+    type::vector<Deriv> m_elementForces;
+    type::vector<Matrix3> m_elementEdgeStiffness;
+
+    /// Call f with m_myMaterial cast to its concrete type
+    template<class Function>
+    void dispatchMaterial(const Function& f);
+
+    /// Call f(first, last) on ranges of the elements, in parallel if d_parallelEvaluation is set
+    template<class Function>
+    void forEachElementRange(std::size_t nbElements, const Function& f);
+
+    /// Compute the deformation, the stress and the vertex forces of the elements [first, last)
+    template<class Material>
+    void computeElementForces(Material& material, type::vector<TetrahedronRestInformation>& tetrahedronInf, const VecElement& tetrahedronArray,
+                              const VecCoord& x, Index first, Index last);
+
+    /// Compute the edge stiffness matrices of the elements [first, last)
+    template<class Material>
+    void computeElementStiffness(Material& material, type::vector<TetrahedronRestInformation>& tetrahedronInf, const VecElement& tetrahedronArray,
+                                 const type::vector<Edge>& edgeArray, Index first, Index last);
+
     void testDerivatives();
     void saveMesh( const char *filename );
 
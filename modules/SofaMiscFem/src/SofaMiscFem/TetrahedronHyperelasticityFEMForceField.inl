@@ -40,6 +40,7 @@
 #include <iostream> //for debugging
 #include <sofa/core/behavior/ForceField.inl>
 #include <SofaBaseTopology/TopologyData.inl>
+#include <sofa/simulation/ParallelForEach.h>
 #include <algorithm>
 #include <iterator>
 namespace sofa
@@ -116,10 +117,13 @@ template <class DataTypes> TetrahedronHyperelasticityFEMForceField<DataTypes>::T
     , d_materialName(initData(&d_materialName,std::string("ArrudaBoyce"),"materialName","the name of the material to be used"))
     , d_parameterSet(initData(&d_parameterSet,"ParameterSet","The global parameters specifying the material"))
     , d_anisotropySet(initData(&d_anisotropySet,"AnisotropyDirections","The global directions of anisotropy of the material"))
+    , d_parallelEvaluation(initData(&d_parallelEvaluation, false, "parallelEvaluation", "Evaluate the material on ranges of elements in parallel on the task scheduler, which is initialized if needed"))
     , m_tetrahedronInfo(initData(&m_tetrahedronInfo, "tetrahedronInfo", "Internal tetrahedron data"))
     , m_edgeInfo(initData(&m_edgeInfo, "edgeInfo", "Internal edge data"))
     , l_topology(initLink("topology", "link to the topology container"))
+    , m_myMaterial(nullptr)
     , m_tetrahedronHandler(nullptr)
+    , m_materialType(MaterialType::Generic)
 {
     m_tetrahedronHandler = new TetrahedronHandler(this,&m_tetrahedronInfo);
 }
@@ -171,42 +175,49 @@ template <class DataTypes> void TetrahedronHyperelasticityFEMForceField<DataType
     {
         fem::BoyceAndArruda<DataTypes> *BoyceAndArrudaMaterial = new fem::BoyceAndArruda<DataTypes>;
         m_myMaterial = BoyceAndArrudaMaterial;
+        m_materialType = MaterialType::ArrudaBoyce;
         msg_info() << "The model is " << material;
     }
     else if (material=="StVenantKirchhoff")
     {
         fem::STVenantKirchhoff<DataTypes> *STVenantKirchhoffMaterial = new fem::STVenantKirchhoff<DataTypes>;
         m_myMaterial = STVenantKirchhoffMaterial;
+        m_materialType = MaterialType::StVenantKirchhoff;
         msg_info() << "The model is " << material;
     }
     else if (material=="NeoHookean")
     {
         fem::NeoHookean<DataTypes> *NeoHookeanMaterial = new fem::NeoHookean<DataTypes>;
         m_myMaterial = NeoHookeanMaterial;
+        m_materialType = MaterialType::NeoHookean;
         msg_info() << "The model is " << material;
     }
     else if (material=="MooneyRivlin")
     {
         fem::MooneyRivlin<DataTypes> *MooneyRivlinMaterial = new fem::MooneyRivlin<DataTypes>;
         m_myMaterial = MooneyRivlinMaterial;
+        m_materialType = MaterialType::MooneyRivlin;
         msg_info() << "The model is " << material;
     }
     else if (material=="VerondaWestman")
     {
         fem::VerondaWestman<DataTypes> *VerondaWestmanMaterial = new fem::VerondaWestman<DataTypes>;
         m_myMaterial = VerondaWestmanMaterial;
+        m_materialType = MaterialType::VerondaWestman;
         msg_info() << "The model is " << material;
     }
     else if (material=="Costa")
     {
         fem::Costa<DataTypes> *CostaMaterial = new fem::Costa<DataTypes>;
         m_myMaterial = CostaMaterial;
+        m_materialType = MaterialType::Costa;
         msg_info() << "The model is " << material;
     }
     else if (material=="Ogden")
     {
         fem::Ogden<DataTypes> *OgdenMaterial = new fem::Ogden<DataTypes>;
         m_myMaterial = OgdenMaterial;
+        m_materialType = MaterialType::Ogden;
         msg_info() << "The model is " << material;
     }
     else
@@ -215,6 +226,16 @@ template <class DataTypes> void TetrahedronHyperelasticityFEMForceField<DataType
     }
 
 
+    if (d_parallelEvaluation.getValue())
+    {
+        auto* taskScheduler = simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 1)
+        {
+            taskScheduler->init(0);
+            msg_info() << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+        }
+    }
+
     if (!m_topology->getNbTetrahedra())
     {
         msg_error() << "ERROR(TetrahedronHyperelasticityFEMForceField): object must have a Tetrahedral Set Topology.\n";
@@ -269,23 +290,75 @@ void TetrahedronHyperelasticityFEMForceField<DataTypes>::addForce(const core::Me
         printf( "Mesh saved.\n" );
         m_meshSaved = true;
     }
-    unsigned int i=0,j=0,k=0,l=0;
-    unsigned int nbTetrahedra=m_topology->getNbTetrahedra();
+    const VecElement& tetrahedronArray = m_topology->getTetrahedra();
+    const std::size_t nbTetrahedra = tetrahedronArray.size();
 
     type::vector<TetrahedronRestInformation>& tetrahedronInf = *(m_tetrahedronInfo.beginEdit());
 
+    assert(this->mstate);
 
-    TetrahedronRestInformation *tetInfo;
+    m_elementForces.resize(4 * nbTetrahedra);
+    dispatchMaterial([&](auto& material)
+    {
+        forEachElementRange(nbTetrahedra, [&](std::size_t first, std::size_t last)
+        {
+            computeElementForces(material, tetrahedronInf, tetrahedronArray, x, Index(first), Index(last));
+        });
+    });
 
-    assert(this->mstate);
+    for (std::size_t i = 0; i < nbTetrahedra; ++i)
+    {
+        const Tetrahedron &ta = tetrahedronArray[i];
+        for (unsigned int l = 0; l < 4; ++l)
+            f[ta[l]] -= m_elementForces[4 * i + l];
+    }
 
-    Coord dp[3],x0,sv;
+    /// indicates that the next call to addDForce will need to update the stiffness matrix
+    m_updateMatrix=true;
+    m_tetrahedronInfo.endEdit();
 
+    d_f.endEdit();
+}
 
-    for(i=0; i<nbTetrahedra; i++ )
+template <class DataTypes>
+template <class Function>
+void TetrahedronHyperelasticityFEMForceField<DataTypes>::dispatchMaterial(const Function& f)
+{
+    switch (m_materialType)
     {
-        tetInfo=&tetrahedronInf[i];
-        const Tetrahedron &ta= m_topology->getTetrahedron(i);
+    case MaterialType::ArrudaBoyce:       f(static_cast<fem::BoyceAndArruda<DataTypes>&>(*m_myMaterial)); break;
+    case MaterialType::StVenantKirchhoff: f(static_cast<fem::STVenantKirchhoff<DataTypes>&>(*m_myMaterial)); break;
+    case MaterialType::NeoHookean:        f(static_cast<fem::NeoHookean<DataTypes>&>(*m_myMaterial)); break;
+    case MaterialType::MooneyRivlin:      f(static_cast<fem::MooneyRivlin<DataTypes>&>(*m_myMaterial)); break;
+    case MaterialType::VerondaWestman:    f(static_cast<fem::VerondaWestman<DataTypes>&>(*m_myMaterial)); break;
+    case MaterialType::Costa:             f(static_cast<fem::Costa<DataTypes>&>(*m_myMaterial)); break;
+    case MaterialType::Ogden:             f(static_cast<fem::Ogden<DataTypes>&>(*m_myMaterial)); break;
+    default:                              f(*m_myMaterial); break;
+    }
+}
+
+template <class DataTypes>
+template <class Function>
+void TetrahedronHyperelasticityFEMForceField<DataTypes>::forEachElementRange(std::size_t nbElements, const Function& f)
+{
+    if (d_parallelEvaluation.getValue())
+        simulation::parallelForEachRange(std::size_t(0), nbElements, f);
+    else
+        f(std::size_t(0), nbElements);
+}
+
+template <class DataTypes>
+template <class Material>
+void TetrahedronHyperelasticityFEMForceField<DataTypes>::computeElementForces(Material& material, type::vector<TetrahedronRestInformation>& tetrahedronInf,
+                                                                               const VecElement& tetrahedronArray, const VecCoord& x, Index first, Index last)
+{
+    unsigned int j=0,k=0,l=0;
+    Coord dp[3],x0,sv;
+
+    for(Index i=first; i<last; i++ )
+    {
+        TetrahedronRestInformation *tetInfo=&tetrahedronInf[i];
+        const Tetrahedron &ta= tetrahedronArray[i];
 
         x0=x[ta[0]];
 
@@ -330,48 +403,31 @@ void TetrahedronHyperelasticityFEMForceField<DataTypes>::addForce(const core::Me
         tetInfo->J = dot( areaVec, dp[0] ) * tetInfo->m_volScale;
         tetInfo->trC = (Real)( tetInfo->deformationTensor(0,0) + tetInfo->deformationTensor(1,1) + tetInfo->deformationTensor(2,2));
         tetInfo->m_SPKTensorGeneral.clear();
-        m_myMaterial->deriveSPKTensor(tetInfo,globalParameters,tetInfo->m_SPKTensorGeneral);
+        material.deriveSPKTensor(tetInfo,globalParameters,tetInfo->m_SPKTensorGeneral);
         for(l=0;l<4;++l)
         {
-            f[ta[l]]-=tetInfo->m_deformationGradient*(tetInfo->m_SPKTensorGeneral*tetInfo->m_shapeVector[l])*tetInfo->m_restVolume;
+            m_elementForces[4*i+l]=tetInfo->m_deformationGradient*(tetInfo->m_SPKTensorGeneral*tetInfo->m_shapeVector[l])*tetInfo->m_restVolume;
         }
     }
-
-
-    /// indicates that the next call to addDForce will need to update the stiffness matrix
-    m_updateMatrix=true;
-    m_tetrahedronInfo.endEdit();
-
-    d_f.endEdit();
 }
 
 template <class DataTypes>
-void TetrahedronHyperelasticityFEMForceField<DataTypes>::updateTangentMatrix()
+template <class Material>
+void TetrahedronHyperelasticityFEMForceField<DataTypes>::computeElementStiffness(Material& material, type::vector<TetrahedronRestInformation>& tetrahedronInf,
+                                                                                  const VecElement& tetrahedronArray, const type::vector<Edge>& edgeArray,
+                                                                                  Index first, Index last)
 {
-    unsigned int i=0,j=0,k=0,l=0;
-    unsigned int nbEdges=m_topology->getNbEdges();
-    const type::vector< Edge> &edgeArray=m_topology->getEdges() ;
+    unsigned int j=0,k=0,l=0;
 
-    type::vector<EdgeInformation>& edgeInf = *(m_edgeInfo.beginEdit());
-    type::vector<TetrahedronRestInformation>& tetrahedronInf = *(m_tetrahedronInfo.beginEdit());
-
-    EdgeInformation *einfo;
-    TetrahedronRestInformation *tetInfo;
-    unsigned int nbTetrahedra=m_topology->getNbTetrahedra();
-    const std::vector< Tetrahedron> &tetrahedronArray=m_topology->getTetrahedra() ;
-
-    for(l=0; l<nbEdges; l++ )edgeInf[l].DfDx.clear();
-    for(i=0; i<nbTetrahedra; i++ )
+    for(Index i=first; i<last; i++ )
     {
-        tetInfo=&tetrahedronInf[i];
+        TetrahedronRestInformation *tetInfo=&tetrahedronInf[i];
         Matrix3 &df=tetInfo->m_deformationGradient;
-//			Matrix3 Tdf=df.transposed();
-        BaseMeshTopology::EdgesInTetrahedron te=m_topology->getEdgesInTetrahedron(i);
+        const BaseMeshTopology::EdgesInTetrahedron &te=m_topology->getEdgesInTetrahedron(i);
 
         /// describe the jth vertex index of triangle no i
         const Tetrahedron &ta= tetrahedronArray[i];
         for(j=0;j<6;j++) {
-            einfo= &edgeInf[te[j]];
             Edge e=m_topology->getLocalEdgesInTetrahedron(j);
 
             k=e[0];
@@ -380,8 +436,6 @@ void TetrahedronHyperelasticityFEMForceField<DataTypes>::updateTangentMatrix()
                 k=e[1];
                 l=e[0];
             }
-            Matrix3 &edgeDfDx = einfo->DfDx;
-
 
             Coord svl=tetInfo->m_shapeVector[l];
             Coord svk=tetInfo->m_shapeVector[k];
@@ -389,9 +443,7 @@ void TetrahedronHyperelasticityFEMForceField<DataTypes>::updateTangentMatrix()
             Matrix3  M, N;
             MatrixSym outputTensor;
             N.clear();
-            type::vector<MatrixSym> inputTensor;
-            inputTensor.resize(3);
-            //	MatrixSym input1,input2,input3,outputTensor;
+            MatrixSym inputTensor[3];
             for(int m=0; m<3;m++){
                 for (int n=m;n<3;n++){
                     inputTensor[0](m,n)=svl[m]*df[0][n]+df[0][m]*svl[n];
@@ -402,10 +454,9 @@ void TetrahedronHyperelasticityFEMForceField<DataTypes>::updateTangentMatrix()
 
             for(int m=0; m<3; m++){
 
-                m_myMaterial->applyElasticityTensor(tetInfo,globalParameters,inputTensor[m],outputTensor);
+                material.applyElasticityTensor(tetInfo,globalParameters,inputTensor[m],outputTensor);
                 Coord vectortemp=df*(outputTensor*svk);
                 Matrix3 Nv;
-                //Nv.clear();
                 for(int u=0; u<3;u++){
                     Nv[u][m]=vectortemp[u];
                 }
@@ -421,11 +472,43 @@ void TetrahedronHyperelasticityFEMForceField<DataTypes>::updateTangentMatrix()
             M[0][1]=M[0][2]=M[1][0]=M[1][2]=M[2][0]=M[2][1]=0;
             M[0][0]=M[1][1]=M[2][2]=(Real)productSD;
 
-            edgeDfDx += (M+N)*tetInfo->m_restVolume;
-
-
+            m_elementEdgeStiffness[6*i+j] = (M+N)*tetInfo->m_restVolume;
         }// end of for j
     }//end of for i
+}
+
+template <class DataTypes>
+void TetrahedronHyperelasticityFEMForceField<DataTypes>::updateTangentMatrix()
+{
+    unsigned int nbEdges=m_topology->getNbEdges();
+
+    type::vector<EdgeInformation>& edgeInf = *(m_edgeInfo.beginEdit());
+    type::vector<TetrahedronRestInformation>& tetrahedronInf = *(m_tetrahedronInfo.beginEdit());
+
+    const type::vector< Edge> &edgeArray=m_topology->getEdges() ;
+    const VecElement& tetrahedronArray = m_topology->getTetrahedra();
+    const std::size_t nbTetrahedra = tetrahedronArray.size();
+
+    // the topology may build its arrays on the first access: make sure it is not done concurrently
+    if (nbTetrahedra > 0)
+        m_topology->getEdgesInTetrahedron(0);
+
+    m_elementEdgeStiffness.resize(6 * nbTetrahedra);
+    dispatchMaterial([&](auto& material)
+    {
+        forEachElementRange(nbTetrahedra, [&](std::size_t first, std::size_t last)
+        {
+            computeElementStiffness(material, tetrahedronInf, tetrahedronArray, edgeArray, Index(first), Index(last));
+        });
+    });
+
+    for(unsigned int l=0; l<nbEdges; l++ )edgeInf[l].DfDx.clear();
+    for(std::size_t i=0; i<nbTetrahedra; i++ )
+    {
+        const BaseMeshTopology::EdgesInTetrahedron &te=m_topology->getEdgesInTetrahedron(i);
+        for(unsigned int j=0;j<6;j++)
+            edgeInf[te[j]].DfDx += m_elementEdgeStiffness[6*i+j];
+    }
     m_updateMatrix=false;
 }
 
@@ -0,0 +1,110 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/testing/BaseTest.h>
+using sofa::testing::BaseTest;
+
+#include <SofaSparseSolver/SparseCholeskySolver.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include "StencilMatrix.h"
+
+namespace
+{
+
+using namespace sofa::component::linearsolver;
+using sofa::component::linearsolver::testing::StencilMatrix;
+
+using Solver = SparseCholeskySolver< CompressedRowSparseMatrix<double>, FullVector<double> >;
+
+/** Test the parallel factorization of the SparseCholeskySolver class */
+struct SparseCholeskySolver_test : public BaseTest
+{
+    StencilMatrix matrix { 9, 8, 7 };
+    int n { matrix.n };
+
+    /// Factorize the matrix with a new solver
+    Solver::SPtr factorize(bool parallel)
+    {
+        Solver::SPtr solver = sofa::core::objectmodel::New<Solver>();
+        solver->d_parallelFactorization.setValue(parallel);
+
+        CompressedRowSparseMatrix<double> M(n, n);
+        for (int i = 0 ; i < n ; i++)
+            for (int p = matrix.rowptr[i] ; p < matrix.rowptr[i+1] ; p++)
+                M.add(i, matrix.colind[p], matrix.values[p]);
+        solver->invert(M);
+        return solver;
+    }
+
+    sofa::type::vector<double> solve(Solver& solver)
+    {
+        sofa::type::vector<double> b = matrix.rightHandSide(), x(n);
+        solver.solveT(x.data(), b.data());
+        return x;
+    }
+
+    /// Compare the parallel factorization with cs_chol, with the given number of threads
+    sofa::type::vector<double> checkParallelFactorization(unsigned int nbThreads)
+    {
+        sofa::simulation::TaskScheduler::getInstance()->init(nbThreads);
+        EXPECT_EQ(nbThreads, sofa::simulation::TaskScheduler::getInstance()->getThreadCount());
+
+        Solver::SPtr sequential = factorize(false);
+        Solver::SPtr parallel = factorize(true);
+        EXPECT_NE(sequential->N, nullptr);
+        EXPECT_NE(parallel->N, nullptr);
+        if (!sequential->N || !parallel->N) return {};
+
+        const cs* expected = sequential->N->L;
+        const cs* actual = parallel->N->L;
+        EXPECT_EQ(expected->n, actual->n);
+        for (int j = 0 ; j <= n ; j++) EXPECT_EQ(expected->p[j], actual->p[j]) << "column " << j;
+        for (int p = 0 ; p < expected->p[n] ; p++)
+        {
+            EXPECT_EQ(expected->i[p], actual->i[p]) << "entry " << p;
+            EXPECT_EQ(expected->x[p], actual->x[p]) << "entry " << p;
+        }
+
+        // the forward substitution of the parallel solve is row oriented, so only the factor is bitwise identical
+        const sofa::type::vector<double> b = matrix.rightHandSide();
+        const sofa::type::vector<double> sequentialX = solve(*sequential);
+        const sofa::type::vector<double> parallelX = solve(*parallel);
+        for (int i = 0 ; i < n ; i++)
+            EXPECT_NEAR(sequentialX[i], parallelX[i], 1e-12 * (1.0 + std::abs(sequentialX[i]))) << "row " << i;
+        EXPECT_LT(matrix.residual(parallelX, b), 1e-10);
+
+        sofa::simulation::TaskScheduler::getInstance()->stop();
+        return parallelX;
+    }
+};
+
+TEST_F(SparseCholeskySolver_test, parallelFactorization)
+{
+    const sofa::type::vector<double> oneThread = checkParallelFactorization(1);
+    const sofa::type::vector<double> severalThreads = checkParallelFactorization(4);
+
+    // the parallel solve does not depend on the number of threads
+    ASSERT_EQ(oneThread.size(), (std::size_t) n);
+    ASSERT_EQ(severalThreads.size(), (std::size_t) n);
+    for (int i = 0 ; i < n ; i++) EXPECT_EQ(oneThread[i], severalThreads[i]) << "row " << i;
+}
+
+} // namespace
@@ -0,0 +1,160 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/testing/BaseTest.h>
+using sofa::testing::BaseTest;
+
+#include <SofaSparseSolver/SparseLDLSolver.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include "StencilMatrix.h"
+
+#include <cmath>
+
+namespace
+{
+
+using namespace sofa::component::linearsolver;
+using sofa::component::linearsolver::testing::StencilMatrix;
+
+using Solver = SparseLDLSolver< CompressedRowSparseMatrix<double>, FullVector<double> >;
+using InvertData = Solver::InvertData;
+
+/// Gives access to the factorization of the solver on matrices given in compressed form
+class SparseLDLSolverTester : public Solver
+{
+public:
+    using Solver::factorize;
+    using Solver::solve_cpu;
+};
+
+/** Test the numeric factorizations of the SparseLDLSolver class */
+struct SparseLDLSolver_test : public BaseTest
+{
+    StencilMatrix matrix { 9, 8, 7 };
+    int n { matrix.n };
+
+    void factorize(SparseLDLSolverTester& solver, InvertData& data, bool supernodal, bool parallel = false)
+    {
+        solver.factorize(n, matrix.rowptr.data(), matrix.colind.data(), matrix.values.data(), &data, supernodal, parallel);
+    }
+
+    /// Check that two factorizations are bitwise identical
+    void expectIdentical(const InvertData& expected, const InvertData& actual) const
+    {
+        ASSERT_EQ(expected.L_nnz, actual.L_nnz);
+        for (int j = 0 ; j <= n ; j++) ASSERT_EQ(expected.L_colptr[j], actual.L_colptr[j]) << "column " << j;
+        for (int p = 0 ; p < expected.L_nnz ; p++)
+        {
+            ASSERT_EQ(expected.L_rowind[p], actual.L_rowind[p]) << "entry " << p;
+            ASSERT_EQ(expected.L_values[p], actual.L_values[p]) << "entry " << p;
+            ASSERT_EQ(expected.LT_values[p], actual.LT_values[p]) << "entry " << p;
+        }
+        for (int j = 0 ; j < n ; j++) ASSERT_EQ(expected.invD[j], actual.invD[j]) << "column " << j;
+    }
+
+    /// Compare the parallel factorizations and solves with the sequential ones, with the given number of threads
+    void checkParallelFactorization(unsigned int nbThreads)
+    {
+        sofa::simulation::TaskScheduler::getInstance()->init(nbThreads);
+        ASSERT_EQ(nbThreads, sofa::simulation::TaskScheduler::getInstance()->getThreadCount());
+
+        const sofa::type::vector<double> b = matrix.rightHandSide();
+        for (const bool supernodal : { false, true })
+        {
+            SparseLDLSolverTester::SPtr sequentialSolver = sofa::core::objectmodel::New<SparseLDLSolverTester>();
+            SparseLDLSolverTester::SPtr parallelSolver = sofa::core::objectmodel::New<SparseLDLSolverTester>();
+            SparseLDLSolverTester& sequential = static_cast<SparseLDLSolverTester&>(*sequentialSolver);
+            SparseLDLSolverTester& parallel = static_cast<SparseLDLSolverTester&>(*parallelSolver);
+
+            InvertData sequentialData, parallelData;
+            factorize(sequential, sequentialData, supernodal, false);
+            factorize(parallel, parallelData, supernodal, true);
+            EXPECT_EQ((int) nbThreads, supernodal ? parallelData.supernode_schedule.nbThreads : parallelData.column_schedule.nbThreads);
+            ASSERT_FALSE(parallelData.levels.empty());
+            expectIdentical(sequentialData, parallelData);
+
+            sofa::type::vector<double> sequentialX(n), parallelX(n);
+            sequential.solve_cpu(sequentialX.data(), b.data(), &sequentialData);
+            parallel.solve_cpu(parallelX.data(), b.data(), &parallelData, true);
+            for (int i = 0 ; i < n ; i++) ASSERT_EQ(sequentialX[i], parallelX[i]) << "row " << i;
+            EXPECT_LT(matrix.residual(parallelX, b), 1e-10);
+        }
+
+        sofa::simulation::TaskScheduler::getInstance()->stop();
+    }
+};
+
+TEST_F(SparseLDLSolver_test, supernodalFactorization)
+{
+    SparseLDLSolverTester::SPtr numericSolver = sofa::core::objectmodel::New<SparseLDLSolverTester>();
+    SparseLDLSolverTester::SPtr supernodalSolver = sofa::core::objectmodel::New<SparseLDLSolverTester>();
+    SparseLDLSolverTester& numeric = static_cast<SparseLDLSolverTester&>(*numericSolver);
+    SparseLDLSolverTester& supernodal = static_cast<SparseLDLSolverTester&>(*supernodalSolver);
+
+    InvertData numericData, supernodalData;
+    factorize(numeric, numericData, false);
+    factorize(supernodal, supernodalData, true);
+
+    // the grid gives supernodes of several columns, and the factorization is not trivial
+    ASSERT_GT(supernodalData.supernodes.size(), 1u);
+    EXPECT_LT(supernodalData.supernodes.size() - 1, (std::size_t) n);
+    EXPECT_GT(numericData.L_nnz, matrix.rowptr[n] - n);
+
+    ASSERT_EQ(numericData.L_nnz, supernodalData.L_nnz);
+    for (int j = 0 ; j <= n ; j++) ASSERT_EQ(numericData.L_colptr[j], supernodalData.L_colptr[j]) << "column " << j;
+    for (int p = 0 ; p < numericData.L_nnz ; p++) ASSERT_EQ(numericData.L_rowind[p], supernodalData.L_rowind[p]) << "entry " << p;
+
+    for (int p = 0 ; p < numericData.L_nnz ; p++)
+        EXPECT_NEAR(numericData.L_values[p], supernodalData.L_values[p], 1e-12 * (1.0 + std::abs(numericData.L_values[p]))) << "entry " << p;
+    for (int j = 0 ; j < n ; j++)
+        EXPECT_NEAR(numericData.invD[j], supernodalData.invD[j], 1e-12 * std::abs(numericData.invD[j])) << "column " << j;
+
+    const sofa::type::vector<double> b = matrix.rightHandSide();
+    sofa::type::vector<double> numericX(n), supernodalX(n);
+    numeric.solve_cpu(numericX.data(), b.data(), &numericData);
+    supernodal.solve_cpu(supernodalX.data(), b.data(), &supernodalData);
+    for (int i = 0 ; i < n ; i++)
+        EXPECT_NEAR(numericX[i], supernodalX[i], 1e-10 * (1.0 + std::abs(numericX[i]))) << "row " << i;
+    EXPECT_LT(matrix.residual(supernodalX, b), 1e-10);
+
+    // a new factorization with the same pattern reuses the supernodes
+    for (double& v : matrix.values) v *= 2.0;
+    factorize(numeric, numericData, false);
+    factorize(supernodal, supernodalData, true);
+    EXPECT_FALSE(supernodalData.new_factorization_needed);
+    numeric.solve_cpu(numericX.data(), b.data(), &numericData);
+    supernodal.solve_cpu(supernodalX.data(), b.data(), &supernodalData);
+    for (int i = 0 ; i < n ; i++)
+        EXPECT_NEAR(numericX[i], supernodalX[i], 1e-10 * (1.0 + std::abs(numericX[i]))) << "row " << i;
+    EXPECT_LT(matrix.residual(supernodalX, b), 1e-10);
+}
+
+TEST_F(SparseLDLSolver_test, parallelFactorizationOneThread)
+{
+    checkParallelFactorization(1);
+}
+
+TEST_F(SparseLDLSolver_test, parallelFactorizationSeveralThreads)
+{
+    checkParallelFactorization(4);
+}
+
+} // namespace
@@ -0,0 +1,90 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/type/vector.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace sofa::component::linearsolver::testing
+{
+
+/// Symmetric positive definite matrix with n rows, of a 7-point stencil on a nx*ny*nz grid with varying coefficients.
+/// It is stored with its full pattern, so the compressed rows are also the compressed columns.
+struct StencilMatrix
+{
+    int n { 0 };
+    type::vector<int> rowptr, colind;
+    type::vector<double> values;
+
+    StencilMatrix(int nx, int ny, int nz)
+    {
+        n = nx * ny * nz;
+        auto index = [&](int i, int j, int k) { return i + nx * (j + ny * k); };
+        auto weight = [](int a, int b) { return 1.0 + 0.5 * std::sin(0.37 * (a + 1) * (b + 1)); };
+
+        rowptr.assign(1, 0);
+        for (int k = 0 ; k < nz ; k++)
+            for (int j = 0 ; j < ny ; j++)
+                for (int i = 0 ; i < nx ; i++)
+                {
+                    const int row = index(i, j, k);
+                    const int neighbors[6] = {
+                        k > 0 ? index(i, j, k-1) : -1, j > 0 ? index(i, j-1, k) : -1, i > 0 ? index(i-1, j, k) : -1,
+                        i < nx-1 ? index(i+1, j, k) : -1, j < ny-1 ? index(i, j+1, k) : -1, k < nz-1 ? index(i, j, k+1) : -1 };
+                    double diagonal = 0.1;
+                    for (int c : neighbors)
+                        if (c != -1) diagonal += weight(std::min(row, c), std::max(row, c));
+                    for (int c = 0 ; c < 3 ; c++)
+                        if (neighbors[c] != -1) { colind.push_back(neighbors[c]); values.push_back(-weight(neighbors[c], row)); }
+                    colind.push_back(row);
+                    values.push_back(diagonal);
+                    for (int c = 3 ; c < 6 ; c++)
+                        if (neighbors[c] != -1) { colind.push_back(neighbors[c]); values.push_back(-weight(row, neighbors[c])); }
+                    rowptr.push_back((int) colind.size());
+                }
+    }
+
+    /// Right-hand side used to test the solves
+    type::vector<double> rightHandSide() const
+    {
+        type::vector<double> b(n);
+        for (int i = 0 ; i < n ; i++) b[i] = std::cos(0.1 * i);
+        return b;
+    }
+
+    /// Max norm of Ax - b
+    double residual(const type::vector<double>& x, const type::vector<double>& b) const
+    {
+        double r = 0.0;
+        for (int i = 0 ; i < n ; i++)
+        {
+            double Ax = 0.0;
+            for (int p = rowptr[i] ; p < rowptr[i+1] ; p++) Ax += values[p] * x[colind[p]];
+            r = std::max(r, std::abs(Ax - b[i]));
+        }
+        return r;
+    }
+};
+
+} // namespace sofa::component::linearsolver::testing
@@ -0,0 +1,277 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaSparseSolver/config.h>
+
+#include <sofa/type/vector.h>
+#include <sofa/simulation/ParallelForEach.h>
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <sofa/core/objectmodel/Base.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <queue>
+
+namespace sofa::component::linearsolver
+{
+
+/// Task decomposition of a sparse factorization along its elimination tree.
+/// The nodes (columns, or supernodes) of the tree are numbered such that parent[j] > j, and the
+/// computation of a node only depends on its descendants. The independent subtrees can thus be
+/// computed in parallel, then the remaining nodes near the roots are computed level by level,
+/// a node being in a level higher than all its children.
+///
+/// The schedule only decides which nodes are computed concurrently, not how: as long as the
+/// computation of each node is deterministic, the factorization does not depend on the number of threads.
+class EliminationTreeSchedule
+{
+public:
+    /// Number of independent subtrees targeted per thread, to balance the load between threads
+    static constexpr int SubtreesPerThread = 4;
+
+    /// Build the schedule for the forest given by parent (-1 for the roots).
+    /// cost is an estimation of the amount of work of each node.
+    void build(int n, const int * parent, const type::vector<double>& cost, int nbThreads)
+    {
+        this->nbThreads = nbThreads;
+
+        type::vector<double> subtreeCost(cost.begin(), cost.begin() + n);
+        type::vector<int> childptr(n + 1, 0), children(n);
+        double totalCost = 0.0;
+        for (int j = 0 ; j < n ; j++)
+        {
+            if (parent[j] != -1)
+            {
+                subtreeCost[parent[j]] += subtreeCost[j];
+                childptr[parent[j] + 1]++;
+            }
+            else
+            {
+                totalCost += subtreeCost[j];
+            }
+        }
+        for (int j = 0 ; j < n ; j++) childptr[j+1] += childptr[j];
+        {
+            type::vector<int> fill(childptr.begin(), childptr.end() - 1);
+            for (int j = 0 ; j < n ; j++)
+                if (parent[j] != -1) children[fill[parent[j]]++] = j;
+        }
+
+        // split the most expensive subtree, starting from the roots, until all of them are small enough
+        const double maxSubtreeCost = totalCost / (SubtreesPerThread * std::max(nbThreads, 1));
+        auto cheaper = [&subtreeCost](int a, int b) { return subtreeCost[a] < subtreeCost[b] || (subtreeCost[a] == subtreeCost[b] && a > b); };
+        std::priority_queue<int, std::vector<int>, decltype(cheaper)> candidates(cheaper);
+        for (int j = 0 ; j < n ; j++)
+            if (parent[j] == -1) candidates.push(j);
+
+        type::vector<bool> isTop(n, false);
+        type::vector<int> subtreeRoots;
+        while (!candidates.empty())
+        {
+            const int j = candidates.top();
+            candidates.pop();
+            if (nbThreads > 1 && subtreeCost[j] > maxSubtreeCost && childptr[j+1] > childptr[j])
+            {
+                isTop[j] = true;
+                for (int c = childptr[j] ; c < childptr[j+1] ; c++) candidates.push(children[c]);
+            }
+            else
+            {
+                subtreeRoots.push_back(j);
+            }
+        }
+        std::sort(subtreeRoots.begin(), subtreeRoots.end());
+
+        // the subtree of a node is the one of its parent, which is numbered after it
+        type::vector<int> subtree(n, -1);
+        for (std::size_t s = 0 ; s < subtreeRoots.size() ; s++) subtree[subtreeRoots[s]] = (int) s;
+        for (int j = n - 1 ; j >= 0 ; j--)
+            if (subtree[j] == -1 && !isTop[j] && parent[j] != -1) subtree[j] = subtree[parent[j]];
+
+        subtreeptr.assign(subtreeRoots.size() + 1, 0);
+        for (int j = 0 ; j < n ; j++)
+            if (subtree[j] != -1) subtreeptr[subtree[j] + 1]++;
+        for (std::size_t s = 0 ; s < subtreeRoots.size() ; s++) subtreeptr[s+1] += subtreeptr[s];
+        subtreenodes.resize(subtreeptr.back());
+        {
+            type::vector<int> fill(subtreeptr.begin(), subtreeptr.end() - 1);
+            for (int j = 0 ; j < n ; j++)
+                if (subtree[j] != -1) subtreenodes[fill[subtree[j]]++] = j;
+        }
+
+        // levels of the top nodes
+        type::vector<int> level(n, -1);
+        int nbLevels = 0;
+        for (int j = 0 ; j < n ; j++)
+        {
+            if (!isTop[j]) continue;
+            int l = 0;
+            for (int c = childptr[j] ; c < childptr[j+1] ; c++)
+                if (isTop[children[c]]) l = std::max(l, level[children[c]] + 1);
+            level[j] = l;
+            nbLevels = std::max(nbLevels, l + 1);
+        }
+        bucketByLevel(n, level, nbLevels, levelptr, levelnodes);
+    }
+
+    /// Run f(nodes, nbNodes) on groups of nodes covering all the nodes: each independent subtree is given in
+    /// one call, in increasing order, then each remaining node in its own call, after all its descendants.
+    /// The function returns false if one of the calls returned false (the other nodes may have been computed or not).
+    template<class NodesFunction>
+    bool run(const NodesFunction& f) const
+    {
+        std::atomic<bool> success { true };
+
+        sofa::simulation::parallelForEach(std::size_t(0), subtreeptr.size() - 1, [&](std::size_t s)
+        {
+            if (success.load(std::memory_order_relaxed) && !f(subtreenodes.data() + subtreeptr[s], subtreeptr[s+1] - subtreeptr[s]))
+                success = false;
+        }, 1);
+
+        for (std::size_t l = 0 ; l + 1 < levelptr.size() && success ; l++)
+        {
+            sofa::simulation::parallelForEach(levelptr[l], levelptr[l+1], [&](int p)
+            {
+                if (!f(levelnodes.data() + p, 1)) success = false;
+            }, 1);
+        }
+
+        return success;
+    }
+
+    /// Group the nodes by level: level[j] (-1 to ignore node j) must be greater than the level of the children of j
+    static void bucketByLevel(int n, const type::vector<int>& level, int nbLevels, type::vector<int>& levelptr, type::vector<int>& levelnodes)
+    {
+        levelptr.assign(nbLevels + 1, 0);
+        for (int j = 0 ; j < n ; j++)
+            if (level[j] != -1) levelptr[level[j] + 1]++;
+        for (int l = 0 ; l < nbLevels ; l++) levelptr[l+1] += levelptr[l];
+        levelnodes.resize(levelptr.back());
+        type::vector<int> fill(levelptr.begin(), levelptr.end() - 1);
+        for (int j = 0 ; j < n ; j++)
+            if (level[j] != -1) levelnodes[fill[level[j]]++] = j;
+    }
+
+    int nbThreads = 0; ///< number of threads the schedule has been built for (0 if not built)
+    type::vector<int> subtreeptr, subtreenodes; ///< nodes of each independent subtree
+    type::vector<int> levelptr, levelnodes; ///< remaining nodes, grouped by level
+};
+
+/// Level sets of the columns of a triangular factor, used to parallelize the triangular solves.
+/// The level of a column is its height in the elimination tree: in the forward substitution, a column
+/// only depends on columns of lower levels (its descendants), and in the backward substitution on
+/// columns of higher levels (its ancestors).
+class EliminationTreeLevels
+{
+public:
+    /// Minimum number of columns of a level to solve it in parallel
+    static constexpr int MinimumParallelLevelSize = 256;
+
+    void build(int n, const int * parent)
+    {
+        type::vector<int> height(n, 0);
+        int nbLevels = n > 0 ? 1 : 0;
+        for (int j = 0 ; j < n ; j++)
+        {
+            if (parent[j] != -1)
+            {
+                height[parent[j]] = std::max(height[parent[j]], height[j] + 1);
+                nbLevels = std::max(nbLevels, height[parent[j]] + 1);
+            }
+        }
+        EliminationTreeSchedule::bucketByLevel(n, height, nbLevels, levelptr, levelcols);
+    }
+
+    bool empty() const { return levelptr.empty(); }
+
+    /// Call f(column) for all the columns, level by level in increasing order if forward is true, decreasing otherwise
+    template<class ColumnFunction>
+    void run(bool forward, const ColumnFunction& f) const
+    {
+        const int nbLevels = (int) levelptr.size() - 1;
+        for (int i = 0 ; i < nbLevels ; i++)
+        {
+            const int l = forward ? i : nbLevels - 1 - i;
+            if (levelptr[l+1] - levelptr[l] >= MinimumParallelLevelSize)
+            {
+                sofa::simulation::parallelForEach(levelptr[l], levelptr[l+1], [&](int p) { f(levelcols[p]); });
+            }
+            else
+            {
+                for (int p = levelptr[l] ; p < levelptr[l+1] ; p++) f(levelcols[p]);
+            }
+        }
+    }
+
+    type::vector<int> levelptr, levelcols;
+};
+
+/// Thread-safe pool of the workspaces of the tasks of a parallel factorization.
+/// A task takes a workspace for the duration of its run, so that at most one workspace per thread is allocated.
+template<class Workspace>
+class WorkspacePool
+{
+public:
+    Workspace* acquire()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_available.empty())
+        {
+            m_workspaces.push_back(std::make_unique<Workspace>());
+            return m_workspaces.back().get();
+        }
+        Workspace* workspace = m_available.back();
+        m_available.pop_back();
+        return workspace;
+    }
+
+    void release(Workspace* workspace)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_available.push_back(workspace);
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<Workspace> > m_workspaces;
+    std::vector<Workspace*> m_available;
+};
+
+/// Make sure the TaskScheduler is initialized before using the parallel factorization
+inline void initTaskSchedulerForFactorization(const sofa::core::objectmodel::Base* solver)
+{
+    auto* taskScheduler = sofa::simulation::TaskScheduler::getInstance();
+    if (taskScheduler->getThreadCount() < 1)
+    {
+        taskScheduler->init(0);
+        msg_info(solver) << "Task scheduler initialized on " << taskScheduler->getThreadCount() << " threads";
+    }
+    else
+    {
+        msg_info(solver) << "Task scheduler already initialized on " << taskScheduler->getThreadCount() << " threads";
+    }
+}
+
+} // namespace sofa::component::linearsolver
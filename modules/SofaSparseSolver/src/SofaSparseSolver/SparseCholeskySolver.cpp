@@ -37,7 +37,8 @@ using sofa::helper::system::thread::ctime_t;
 template<class TMatrix, class TVector>
 SparseCholeskySolver<TMatrix,TVector>::SparseCholeskySolver()
     : f_verbose( initData(&f_verbose,false,"verbose","Dump system state at each iteration") )
-    , S(nullptr), N(nullptr)
+    , d_parallelFactorization( initData(&d_parallelFactorization, false, "parallelFactorization", "Compute the numeric factorization and the triangular solves with several threads, by scheduling the independent subtrees of the elimination tree as tasks. The result does not depend on the number of threads."))
+    , S(nullptr), N(nullptr), LT(nullptr)
 {
 }
 
@@ -46,6 +47,169 @@ SparseCholeskySolver<TMatrix,TVector>::~SparseCholeskySolver()
 {
     if (S) cs_sfree (S);
     if (N) cs_nfree (N);
+    if (LT) cs_spfree (LT);
+}
+
+template<class TMatrix, class TVector>
+void SparseCholeskySolver<TMatrix,TVector>::init()
+{
+    Inherit::init();
+
+    if (d_parallelFactorization.getValue())
+    {
+        initTaskSchedulerForFactorization(this);
+    }
+}
+
+template<class TMatrix, class TVector>
+void SparseCholeskySolver<TMatrix,TVector>::triangularSolves(double * x)
+{
+    if (!LT)
+    {
+        cs_lsolve (N->L, x);			//x = L\x
+        cs_ltsolve (N->L, x);			//x = L'\x/
+        return;
+    }
+
+    const int * Lp = N->L->p;
+    const int * Li = N->L->i;
+    const double * Lx = N->L->x;
+    const int * LTp = LT->p;
+    const int * LTi = LT->i;
+    const double * LTx = LT->x;
+
+    // x = L\x, row by row: the last entry of the column j of L^T is L(j,j)
+    levels.run(true, [&](int j)
+    {
+        double acc = x[j];
+        for (int p = LTp[j] ; p < LTp[j+1] - 1 ; p++)
+        {
+            acc -= LTx[p] * x[LTi[p]];
+        }
+        x[j] = acc / LTx[LTp[j+1] - 1];
+    });
+
+    // x = L'\x, as in cs_ltsolve
+    levels.run(false, [&](int j)
+    {
+        double acc = x[j];
+        for (int p = Lp[j] + 1 ; p < Lp[j+1] ; p++)
+        {
+            acc -= Lx[p] * x[Li[p]];
+        }
+        x[j] = acc / Lx[Lp[j]];
+    });
+}
+
+template<class TMatrix, class TVector>
+bool SparseCholeskySolver<TMatrix,TVector>::parallelCholeskyRow(int k, const cs* C, int* nextEntry, ParallelWorkspace& workspace)
+{
+    const int n = C->n;
+    const int * Cp = C->p;
+    const int * Ci = C->i;
+    const double * Cx = C->x;
+    const int * parent = S->parent;
+    const int * Lp = N->L->p;
+    int * Li = N->L->i;
+    double * Lx = N->L->x;
+    int * flag = workspace.flag.data();
+    int * s = workspace.pattern.data();
+    double * x = workspace.x.data();
+
+    // nonzero pattern of L(k,:), as in cs_ereach
+    int top = n;
+    flag[k] = k;
+    for (int p = Cp[k] ; p < Cp[k+1] ; p++)
+    {
+        int i = Ci[p];
+        if (i > k) continue;
+        x[i] = Cx[p];
+        int len = 0;
+        for ( ; flag[i] != k ; i = parent[i])
+        {
+            s[len++] = i;
+            flag[i] = k;
+        }
+        while (len > 0) s[--top] = s[--len];
+    }
+    const int patternBegin = top;
+
+    // triangular solve L(0:k-1,0:k-1) * x = C(:,k)
+    double d = x[k];
+    x[k] = 0;
+    for ( ; top < n ; top++)
+    {
+        const int i = s[top];
+        const double lki = x[i] / Lx[Lp[i]];
+        x[i] = 0;
+        for (int p = Lp[i] + 1 ; p < nextEntry[i] ; p++)
+        {
+            x[Li[p]] -= Lx[p] * lki;
+        }
+        d -= lki * lki;
+        const int p = nextEntry[i]++;
+        Li[p] = k;
+        Lx[p] = lki;
+    }
+
+    // the workspace is left clean for the next row computed by this task
+    for (int p = patternBegin ; p < n ; p++) flag[s[p]] = -1;
+    flag[k] = -1;
+
+    if (d <= 0)
+    {
+        msg_error() << "Failed to factorize, the matrix is not positive definite";
+        return false;
+    }
+    const int p = nextEntry[k]++;
+    Li[p] = k;
+    Lx[p] = sqrt(d);
+    return true;
+}
+
+template<class TMatrix, class TVector>
+csn* SparseCholeskySolver<TMatrix,TVector>::parallelCholesky()
+{
+    const int n = A.n;
+    const int * cp = S->cp;
+    cs * C = S->Pinv ? cs_symperm (&A, S->Pinv, 1) : &A;
+
+    N = (csn*) cs_calloc (1, sizeof (csn));
+    N->L = cs_spalloc (n, n, cp[n], 1, 0);
+    std::copy(cp, cp + n + 1, N->L->p);
+
+    // position of the next entry of each column of L
+    type::vector<int> nextEntry(n);
+    std::copy(cp, cp + n, nextEntry.begin());
+
+    type::vector<double> cost(n);
+    for (int j = 0 ; j < n ; j++) cost[j] = (cp[j+1] - cp[j]) * (double) (cp[j+1] - cp[j]);
+    schedule.build(n, S->parent, cost, (int) simulation::TaskScheduler::getInstance()->getThreadCount());
+
+    const bool success = schedule.run([&](const int * rows, int nbRows)
+    {
+        ParallelWorkspace* workspace = workspaces.acquire();
+        if ((int) workspace->flag.size() != n)
+        {
+            workspace->flag.assign(n, -1);
+            workspace->pattern.resize(n);
+            workspace->x.assign(n, 0.0);
+        }
+        bool rowsSuccess = true;
+        for (int r = 0 ; r < nbRows && rowsSuccess ; r++)
+        {
+            rowsSuccess = parallelCholeskyRow(rows[r], C, nextEntry.data(), *workspace);
+        }
+        workspaces.release(workspace);
+        return rowsSuccess;
+    });
+
+    if (S->Pinv) cs_spfree (C);
+    if (!success)
+    {
+        N = cs_nfree (N);
+    }
+    return N;
 }
 
 template<class TMatrix, class TVector>
@@ -55,8 +219,7 @@ void SparseCholeskySolver<TMatrix,TVector>::solveT(double * z, double * r)
 
     cs_ipvec (n, S->Pinv, r, (double*) &(tmp[0]));	//x = P*b
 
-    cs_lsolve (N->L, (double*) &(tmp[0]));			//x = L\x
-    cs_ltsolve (N->L, (double*) &(tmp[0]));			//x = L'\x/
+    triangularSolves((double*) &(tmp[0]));
 
     cs_pvec (n, S->Pinv, (double*) &(tmp[0]), z);	 //b = P'*x
 }
@@ -71,8 +234,7 @@ void SparseCholeskySolver<TMatrix,TVector>::solveT(float * z, float * r)
 
     cs_ipvec (n, S->Pinv, (double*) &(r_tmp[0]), (double*) &(tmp[0]));	//x = P*b
 
-    cs_lsolve (N->L, (double*) &(tmp[0]));			//x = L\x
-    cs_ltsolve (N->L, (double*) &(tmp[0]));			//x = L'\x/
+    triangularSolves((double*) &(tmp[0]));
 
     cs_pvec (n, S->Pinv, (double*) &(tmp[0]), (double*) &(z_tmp[0]));	 //b = P'*x
 
@@ -92,6 +254,8 @@ void SparseCholeskySolver<TMatrix,TVector>::invert(Matrix& M)
     int order = -1; //?????
     if (S) cs_sfree(S);
     if (N) cs_nfree(N);
+    if (LT) LT = cs_spfree(LT);
+    N = nullptr;
     M.compress();
 
     A.nzmax = M.getColsValue().size();	// maximum number of entries
@@ -109,7 +273,19 @@ void SparseCholeskySolver<TMatrix,TVector>::invert(Matrix& M)
     cs_dropzeros( &A );
     tmp.resize(A.n);
     S = cs_schol (&A, order) ;		/* ordering and symbolic analysis */
-    N = cs_chol (&A, S) ;		/* numeric Cholesky factorization */
+    if (d_parallelFactorization.getValue())
+    {
+        N = parallelCholesky();
+        if (N)
+        {
+            LT = cs_transpose (N->L, 1);
+            levels.build(A.n, S->parent);
+        }
+    }
+    else
+    {
+        N = cs_chol (&A, S) ;		/* numeric Cholesky factorization */
+    }
 }
 
 int SparseCholeskySolverClass = core::RegisterObject("Direct linear solver based on Sparse Cholesky factorization, implemented with the CSPARSE library")
@@ -29,6 +29,7 @@
 #include <SofaBaseLinearSolver/FullMatrix.h>
 #include <SofaBaseLinearSolver/SparseMatrix.h>
 #include <SofaBaseLinearSolver/CompressedRowSparseMatrix.h>
+#include <SofaSparseSolver/EliminationTree.h>
 #include <sofa/helper/map.h>
 #include <cmath>
 #include <csparse.h>
@@ -54,9 +55,11 @@ public:
     typedef sofa::component::linearsolver::MatrixLinearSolver<TMatrix,TVector> Inherit;
 
     Data<bool> f_verbose; ///< Dump system state at each iteration
+    Data<bool> d_parallelFactorization; ///< compute the factorization and the triangular solves with the TaskScheduler
 
     SparseCholeskySolver();
     ~SparseCholeskySolver();
+    void init() override;
     void solve (Matrix& M, Vector& x, Vector& b) override;
     void invert(Matrix& M) override;
 
@@ -70,6 +73,28 @@ public :
 
     void solveT(double * z, double * r);
     void solveT(float * z, float * r);
+
+protected:
+    /// Temporary arrays of a task of the parallel factorization
+    struct ParallelWorkspace
+    {
+        type::vector<int> flag, pattern;
+        type::vector<double> x;
+    };
+
+    /// Numeric factorization equivalent to cs_chol, computing the rows of L by tasks following the elimination tree
+    csn* parallelCholesky();
+
+    /// Compute the row k of L, as one iteration of cs_chol
+    bool parallelCholeskyRow(int k, const cs* C, int* nextEntry, ParallelWorkspace& workspace);
+
+    /// x = L^-T L^-1 x, solved level by level in parallel if the factorization is parallel
+    void triangularSolves(double * x);
+
+    cs* LT; ///< transpose of L, used by the row-oriented forward substitution of the parallel solve
+    EliminationTreeSchedule schedule;
+    EliminationTreeLevels levels;
+    WorkspacePool<ParallelWorkspace> workspaces;
 };
 
 #if  !defined(SOFA_COMPONENT_LINEARSOLVER_SPARSECHOLESKYSOLVER_CPP)
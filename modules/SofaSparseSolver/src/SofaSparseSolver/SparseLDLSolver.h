@@ -57,6 +57,7 @@ public :
     typedef typename Inherit::JMatrixType JMatrixType;
     typedef SparseLDLImplInvertData<type::vector<int>, type::vector<Real> > InvertData;
 
+    void init() override;
     void solve (Matrix& M, Vector& x, Vector& b) override;
     void invert(Matrix& M) override;
     bool addJMInvJtLocal(TMatrix * M, ResMatrixType * result,const JMatrixType * J, double fact) override;
@@ -65,6 +66,8 @@ public :
     Data<bool> f_saveMatrixToFile;      ///< save matrix to a text file (can be very slow, as full matrix is stored)
     sofa::core::objectmodel::DataFileName d_filename;   ///< file where this matrix will be saved
     Data<int> d_precision;      ///< number of digits used to save system's matrix, default is 6
+    Data<bool> d_supernodal;    ///< use the supernodal numeric factorization
+    Data<bool> d_parallelFactorization; ///< compute the factorization and the triangular solves with the TaskScheduler
 
     MatrixInvertData * createInvertData() override {
         return new InvertData();
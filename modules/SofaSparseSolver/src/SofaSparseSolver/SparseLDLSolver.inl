@@ -43,11 +43,24 @@ SparseLDLSolver<TMatrix,TVector,TThreadManager>::SparseLDLSolver()
     , f_saveMatrixToFile( initData(&f_saveMatrixToFile, false, "savingMatrixToFile", "save matrix to a text file (can be very slow, as full matrix is stored"))
     , d_filename( initData(&d_filename, std::string("MatrixInLDL_%04d.txt"),"savingFilename", "Name of file where system matrix (mass, stiffness and damping) will be stored."))
     , d_precision( initData(&d_precision, 6, "savingPrecision", "Number of digits used to store system's matrix. Default is 6."))
+    , d_supernodal( initData(&d_supernodal, false, "supernodal", "Compute the numeric factorization by supernodes (groups of columns sharing the same pattern) with dense kernels. Faster on large meshes."))
+    , d_parallelFactorization( initData(&d_parallelFactorization, false, "parallelFactorization", "Compute the numeric factorization and the triangular solves with several threads, by scheduling the independent subtrees of the elimination tree as tasks. The result does not depend on the number of threads."))
 {}
 
+template<class TMatrix, class TVector, class TThreadManager>
+void SparseLDLSolver<TMatrix,TVector,TThreadManager>::init()
+{
+    Inherit::init();
+
+    if (d_parallelFactorization.getValue())
+    {
+        initTaskSchedulerForFactorization(this);
+    }
+}
+
 template<class TMatrix, class TVector, class TThreadManager>
 void SparseLDLSolver<TMatrix,TVector,TThreadManager>::solve (Matrix& M, Vector& z, Vector& r) {
-    Inherit::solve_cpu(&z[0],&r[0],(InvertData *) this->getMatrixInvertData(&M));
+    Inherit::solve_cpu(&z[0],&r[0],(InvertData *) this->getMatrixInvertData(&M), d_parallelFactorization.getValue());
 }
 
 template<class TMatrix, class TVector, class TThreadManager>
@@ -82,7 +95,7 @@ void SparseLDLSolver<TMatrix,TVector,TThreadManager>::invert(Matrix& M) {
         return ;
     }
 
-    Inherit::factorize(n,M_colptr,M_rowind,M_values,(InvertData *) this->getMatrixInvertData(&M));
+    Inherit::factorize(n,M_colptr,M_rowind,M_values,(InvertData *) this->getMatrixInvertData(&M), d_supernodal.getValue(), d_parallelFactorization.getValue());
 
     numStep++;
 }
@@ -25,6 +25,7 @@
 
 #include <sofa/core/behavior/LinearSolver.h>
 #include <SofaBaseLinearSolver/MatrixLinearSolver.h>
+#include <SofaSparseSolver/EliminationTree.h>
 
 extern "C" {
 #include <metis.h>
@@ -42,6 +43,12 @@ public :
     VecInt perm, invperm;
     VecReal P_values,L_values,LT_values,invD;
     type::vector<int> Parent;
+    type::vector<int> supernodes; ///< first column of each supernode, followed by n (empty if not computed)
+    type::vector<int> column_supernode; ///< supernode containing each column
+    type::vector<int> supernode_updateptr, supernode_updates, supernode_update_positions; ///< see LDL_supernodal_updates
+    EliminationTreeSchedule column_schedule; ///< tasks of the parallel up-looking factorization
+    EliminationTreeSchedule supernode_schedule; ///< tasks of the parallel supernodal factorization
+    EliminationTreeLevels levels; ///< level sets of the parallel triangular solves (empty if not computed)
     bool new_factorization_needed;
 };
 
@@ -128,6 +135,301 @@ inline void CSPARSE_numeric(int n,int * M_colptr,int * M_rowind,Real * M_values,
     }
 }
 
+/// Compute the row indices of L (sorted in each column) without computing its values.
+/// It is the pattern part of CSPARSE_numeric, needed by the supernodal factorization which computes whole columns at once.
+inline void CSPARSE_pattern(int n,int * M_colptr,int * M_rowind,int * colptr,int * rowind,int * perm,int * invperm,int * Parent, int * Flag, int * Lnz)
+{
+    for (int k = 0 ; k < n ; k++)
+    {
+        Flag [k] = k ;		    /* mark node k as visited */
+        Lnz [k] = 0 ;
+        int kk = perm[k];  /* kth original, or permuted, column */
+        for (int p = M_colptr[kk] ; p < M_colptr[kk+1] ; p++)
+        {
+            int i = invperm[M_rowind[p]];
+            if (i < k)
+            {
+                /* follow path from i to root of etree, stop at flagged node */
+                for ( ; Flag [i] != k ; i = Parent [i])
+                {
+                    rowind[colptr[i] + Lnz[i]++] = k ;   /* L (k,i) is nonzero */
+                    Flag [i] = k ;
+                }
+            }
+        }
+    }
+}
+
+/// Partition the columns of L into fundamental supernodes: sets of contiguous columns j..l such that
+/// Parent[j] == j+1 and column j has the pattern of column j+1 plus the row j+1.
+inline void LDL_supernodes(int n, const int * colptr, const int * Parent, type::vector<int>& supernodes, type::vector<int>& column_supernode)
+{
+    supernodes.clear();
+    column_supernode.resize(n);
+    for (int j = 0 ; j < n ; j++)
+    {
+        const bool extendsPrevious = j > 0 && Parent[j-1] == j
+                && (colptr[j] - colptr[j-1]) == (colptr[j+1] - colptr[j]) + 1;
+        if (!extendsPrevious) supernodes.push_back(j);
+        column_supernode[j] = (int) supernodes.size() - 1;
+    }
+    supernodes.push_back(n);
+}
+
+/// List the supernodes updating each supernode s: a supernode t updates s if one of its rows below its diagonal block is
+/// a column of s. For each update, the position of the first such row among the rows of t below its diagonal block is stored.
+/// The updates of each supernode are sorted by increasing t, so the factorization does not depend on the order the supernodes are computed.
+inline void LDL_supernodal_updates(const int * colptr, const int * rowind, const type::vector<int>& supernodes, const type::vector<int>& column_supernode,
+                                   type::vector<int>& updateptr, type::vector<int>& updates, type::vector<int>& positions)
+{
+    const int nbSupernodes = (int) supernodes.size() - 1;
+    updateptr.assign(nbSupernodes + 1, 0);
+    type::vector<int> fill;
+
+    // the first pass counts the updates of each supernode, the second one stores them
+    for (int pass = 0 ; pass < 2 ; pass++)
+    {
+        for (int t = 0 ; t < nbSupernodes ; t++)
+        {
+            const int tLast = supernodes[t+1] - 1;
+            const int * tBelow = rowind + colptr[tLast];
+            const int tNbBelow = colptr[tLast+1] - colptr[tLast];
+            for (int q = 0 ; q < tNbBelow ; )
+            {
+                const int s = column_supernode[tBelow[q]];
+                if (pass == 0) updateptr[s+1]++;
+                else
+                {
+                    updates[fill[s]] = t;
+                    positions[fill[s]++] = q;
+                }
+                const int sLast = supernodes[s+1] - 1;
+                while (q < tNbBelow && tBelow[q] <= sLast) q++;
+            }
+        }
+        if (pass == 0)
+        {
+            for (int s = 0 ; s < nbSupernodes ; s++) updateptr[s+1] += updateptr[s];
+            updates.resize(updateptr[nbSupernodes]);
+            positions.resize(updateptr[nbSupernodes]);
+            fill.assign(updateptr.begin(), updateptr.end() - 1);
+        }
+    }
+}
+
+/// Temporary arrays of the numeric factorization. In a parallel factorization, each task uses its own workspace.
+template<class Real>
+struct LDLFactorizationWorkspace
+{
+    type::vector<int> Flag, Pattern;                ///< up-looking factorization (CSPARSE_numeric_row)
+    type::vector<Real> Y;
+    type::vector<int> rowMap, relativeRow;          ///< supernodal factorization (LDL_supernode_numeric)
+    type::vector<Real> panel, update;
+
+    /// Allocate the arrays of size n. Flag is set to -1 and Y to 0, as expected by CSPARSE_numeric_row.
+    void resize(int n)
+    {
+        if ((int) Flag.size() == n) return;
+        Flag.assign(n, -1);
+        Pattern.resize(n);
+        Y.assign(n, 0.0);
+        rowMap.resize(n);
+    }
+};
+
+/// Compute the row k of L and D(k,k), as one iteration of CSPARSE_numeric.
+/// The rows of L corresponding to the descendants of k in the elimination tree must have been computed.
+/// Flag must be -1 for all columns, and Y 0 for all rows: they are left in this state on return.
+template<class Real>
+inline bool CSPARSE_numeric_row(int k,int n,int * M_colptr,int * M_rowind,Real * M_values,int * colptr,int * rowind,Real * values,Real * D,int * perm,int * invperm,int * Parent, int * Lnz,
+                                LDLFactorizationWorkspace<Real>& workspace)
+{
+    int * Flag = workspace.Flag.data();
+    int * Pattern = workspace.Pattern.data();
+    Real * Y = workspace.Y.data();
+
+    int top = n ;
+    Flag [k] = k ;
+    Lnz [k] = 0 ;
+    const int kk = perm[k];
+    for (int p = M_colptr[kk] ; p < M_colptr[kk+1] ; p++)
+    {
+        int i = invperm[M_rowind[p]];
+        if (i <= k)
+        {
+            Y[i] += M_values[p] ;
+            int len = 0;
+            for ( ; Flag[i] != k ; i = Parent[i])
+            {
+                Pattern [len++] = i ;
+                Flag [i] = k ;
+            }
+            while (len > 0) Pattern[--top] = Pattern [--len] ;
+        }
+    }
+    const int patternBegin = top;
+
+    D[k] = Y [k] ;
+    Y[k] = 0.0 ;
+    for ( ; top < n ; top++)
+    {
+        const int i = Pattern [top] ;
+        const Real yi = Y [i] ;
+        Y [i] = 0.0 ;
+        int p = colptr[i];
+        for ( ; p < colptr[i] + Lnz [i] ; p++)
+        {
+            Y[rowind[p]] -= values[p] * yi ;
+        }
+        const Real l_ki = yi / D[i] ;
+        D[k] -= l_ki * yi ;
+        rowind[p] = k ;
+        values[p] = l_ki ;
+        Lnz[i]++ ;
+    }
+
+    for (int p = patternBegin ; p < n ; p++) Flag[Pattern[p]] = -1;
+    Flag[k] = -1;
+
+    if (D[k] == 0.0)
+    {
+        msg_error("SparseLDLSolver") << "Failed to factorize, D(k,k) is zero" ;
+        return false;
+    }
+    return true;
+}
+
+/// Left-looking supernodal LDL^T numeric factorization of the supernode s.
+/// The row indices of L must have been computed by CSPARSE_pattern. L is stored column by column exactly as in
+/// CSPARSE_numeric, but the columns of a supernode are computed together on a dense panel: the updates from the
+/// supernodes listed by LDL_supernodal_updates are computed as dense rank-k products, then scattered into the panel
+/// which is factorized in place. These supernodes are descendants of s in the elimination tree and must have been computed.
+template<class Real>
+inline bool LDL_supernode_numeric(int s,int * M_colptr,int * M_rowind,Real * M_values,int * colptr,int * rowind,Real * values,Real * D,int * perm,int * invperm,
+                                  const type::vector<int>& supernodes, const type::vector<int>& updateptr, const type::vector<int>& updates, const type::vector<int>& positions,
+                                  LDLFactorizationWorkspace<Real>& workspace)
+{
+    int * rowMap = workspace.rowMap.data();
+    type::vector<int>& relativeRow = workspace.relativeRow;
+    type::vector<Real>& panel = workspace.panel;
+    type::vector<Real>& update = workspace.update;
+
+    const int first = supernodes[s];
+    const int last = supernodes[s+1] - 1;
+    const int nbCols = last - first + 1;
+    const int * below = rowind + colptr[last];   /* rows of the supernode below its diagonal block */
+    const int nbBelow = colptr[last+1] - colptr[last];
+    const int nbRows = nbCols + nbBelow;
+
+    /* local row of each global row of the supernode */
+    for (int k = 0 ; k < nbCols ; k++) rowMap[first + k] = k;
+    for (int q = 0 ; q < nbBelow ; q++) rowMap[below[q]] = nbCols + q;
+
+    /* scatter the lower part of the columns of A into the dense column-major panel */
+    panel.assign((std::size_t) nbRows * nbCols, 0.0);
+    for (int k = first ; k <= last ; k++)
+    {
+        Real * panelCol = panel.data() + (std::size_t) (k - first) * nbRows;
+        const int kk = perm[k];
+        for (int p = M_colptr[kk] ; p < M_colptr[kk+1] ; p++)
+        {
+            const int i = invperm[M_rowind[p]];
+            if (i >= k) panelCol[rowMap[i]] += M_values[p];
+        }
+    }
+
+    /* apply the updates of the previous supernodes having a row in [first,last] */
+    for (int u = updateptr[s] ; u < updateptr[s+1] ; u++)
+    {
+        const int t = updates[u];
+        const int tFirst = supernodes[t];
+        const int tLast = supernodes[t+1] - 1;
+        const int * tBelow = rowind + colptr[tLast];
+        const int tNbBelow = colptr[tLast+1] - colptr[tLast];
+
+        const int q0 = positions[u];
+        int q1 = q0;
+        while (q1 < tNbBelow && tBelow[q1] <= last) q1++;
+
+        const int updateRows = tNbBelow - q0;
+        const int updateCols = q1 - q0;
+
+        /* update = L_t(q0:end,:) * D_t * L_t(q0:q1,:)^T, computed densely */
+        /* the columns of t are processed by blocks of 4 to reuse each loaded entry of the update 4 times */
+        update.assign((std::size_t) updateRows * updateCols, 0.0);
+        for (int j = tFirst ; j <= tLast ; j += 4)
+        {
+            const int nbJ = std::min(4, tLast - j + 1);
+            const Real * L[4];
+            Real dj[4] = {0.0, 0.0, 0.0, 0.0};
+            for (int b = 0 ; b < 4 ; b++)
+            {
+                const int jb = j + std::min(b, nbJ - 1);
+                L[b] = values + colptr[jb] + (tLast - jb) + q0;  /* column jb restricted to rows tBelow[q0:] */
+                if (b < nbJ) dj[b] = D[jb];
+            }
+            for (int c = 0 ; c < updateCols ; c++)
+            {
+                const Real a0 = L[0][c] * dj[0], a1 = L[1][c] * dj[1], a2 = L[2][c] * dj[2], a3 = L[3][c] * dj[3];
+                Real * updateCol = update.data() + (std::size_t) c * updateRows;
+                for (int r = c ; r < updateRows ; r++)
+                    updateCol[r] += L[0][r] * a0 + L[1][r] * a1 + L[2][r] * a2 + L[3][r] * a3;
+            }
+        }
+
+        /* scatter-subtract into the panel */
+        relativeRow.resize(updateRows);
+        for (int r = 0 ; r < updateRows ; r++) relativeRow[r] = rowMap[tBelow[q0 + r]];
+        for (int c = 0 ; c < updateCols ; c++)
+        {
+            Real * panelCol = panel.data() + (std::size_t) relativeRow[c] * nbRows;
+            const Real * updateCol = update.data() + (std::size_t) c * updateRows;
+            for (int r = c ; r < updateRows ; r++) panelCol[relativeRow[r]] -= updateCol[r];
+        }
+    }
+
+    /* dense left-looking LDL^T of the panel: column k is updated by the columns on its left, then scaled */
+    for (int k = 0 ; k < nbCols ; k++)
+    {
+        Real * colK = panel.data() + (std::size_t) k * nbRows;
+        int j = 0;
+        for ( ; j + 3 < k ; j += 4)
+        {
+            const Real * c0 = panel.data() + (std::size_t) j * nbRows;
+            const Real * c1 = c0 + nbRows;
+            const Real * c2 = c1 + nbRows;
+            const Real * c3 = c2 + nbRows;
+            const Real a0 = c0[k] * D[first + j], a1 = c1[k] * D[first + j + 1], a2 = c2[k] * D[first + j + 2], a3 = c3[k] * D[first + j + 3];
+            for (int i = k ; i < nbRows ; i++) colK[i] -= c0[i] * a0 + c1[i] * a1 + c2[i] * a2 + c3[i] * a3;
+        }
+        for ( ; j < k ; j++)
+        {
+            const Real * colJ = panel.data() + (std::size_t) j * nbRows;
+            const Real lkd = colJ[k] * D[first + j];
+            for (int i = k ; i < nbRows ; i++) colK[i] -= colJ[i] * lkd;
+        }
+        const Real d = colK[k];
+        if (d == 0.0)
+        {
+            msg_error("SparseLDLSolver") << "Failed to factorize, D(k,k) is zero" ;
+            return false;
+        }
+        D[first + k] = d;
+        const Real invd = 1.0 / d;
+        for (int i = k + 1 ; i < nbRows ; i++) colK[i] *= invd;
+    }
+
+    /* store the columns, the row indices are already set by CSPARSE_pattern */
+    for (int k = 0 ; k < nbCols ; k++)
+    {
+        const Real * colK = panel.data() + (std::size_t) k * nbRows;
+        Real * Lk = values + colptr[first + k];
+        for (int i = k + 1 ; i < nbRows ; i++) *Lk++ = colK[i];
+    }
+
+    return true;
+}
+
 inline bool CSPARSE_need_symbolic_factorization(int s_M, int * M_colptr,int * M_rowind, int s_P, int * P_colptr,int * P_rowind) {
     if (s_M != s_P) return true;
     if (M_colptr[s_M] != P_colptr[s_M] ) return true;
@@ -160,8 +462,11 @@ protected :
 
     SparseLDLSolverImpl() : Inherit() {}
 
+    /// Solve M x = b with the factorization in data.
+    /// If parallel is true and the level sets of the factorization are computed, the triangular solves are computed level by level,
+    /// the columns of a level being solved in parallel. The result is the same as the sequential solve.
     template<class VecInt,class VecReal>
-    void solve_cpu(Real * x,const Real * b,SparseLDLImplInvertData<VecInt,VecReal> * data) {
+    void solve_cpu(Real * x,const Real * b,SparseLDLImplInvertData<VecInt,VecReal> * data, bool parallel = false) {
         int n = data->n;
         const Real * invD = data->invD.data();
         const int * perm = data->perm.data();
@@ -175,6 +480,26 @@ protected :
         Tmp.clear();
         Tmp.fastResize(n);
 
+        if (parallel && !data->levels.empty()) {
+            Real * tmp = Tmp.data();
+            data->levels.run(true, [&](int j) {
+                Real acc = b[perm[j]];
+                for (int p = LT_colptr [j] ; p < LT_colptr[j+1] ; p++) {
+                    acc -= LT_values[p] * tmp[LT_rowind[p]];
+                }
+                tmp[j] = acc;
+            });
+            data->levels.run(false, [&](int j) {
+                Real acc = tmp[j] * invD[j];
+                for (int p = L_colptr[j] ; p < L_colptr[j+1] ; p++) {
+                    acc -= L_values[p] * tmp[L_rowind[p]];
+                }
+                tmp[j] = acc;
+                x[perm[j]] = acc;
+            });
+            return;
+        }
+
         for (int j = 0 ; j < n ; j++) {
             Real acc = b[perm[j]];
             for (int p = LT_colptr [j] ; p < LT_colptr[j+1] ; p++) {
@@ -272,8 +597,102 @@ protected :
         CSPARSE_numeric<Real>(n,M_colptr,M_rowind,M_values,colptr,rowind,values,D,perm,invperm,Parent,Flag.data(),Lnz.data(),Pattern.data(),Y.data());
     }
 
+    /// Up-looking factorization computing the rows of L in parallel: the rows of the independent subtrees of the elimination tree
+    /// are computed by different tasks, then the rows near the root are computed level by level.
+    /// Each row is computed exactly as in CSPARSE_numeric, so the result does not depend on the number of threads.
+    template<class VecInt,class VecReal>
+    void LDL_numeric_parallel(int n,int * M_colptr,int * M_rowind,Real * M_values,Real * D,SparseLDLImplInvertData<VecInt,VecReal> * data) {
+        int * colptr = data->L_colptr.data();
+        int * rowind = data->L_rowind.data();
+        Real * values = data->L_values.data();
+
+        const int nbThreads = (int) sofa::simulation::TaskScheduler::getInstance()->getThreadCount();
+        if (data->column_schedule.nbThreads != nbThreads) {
+            // the cost of the row k is roughly proportional to the squared number of entries of the column k
+            type::vector<double> cost(n);
+            for (int j = 0 ; j < n ; j++) cost[j] = (colptr[j+1] - colptr[j] + 1.0) * (colptr[j+1] - colptr[j] + 1.0);
+            data->column_schedule.build(n, data->Parent.data(), cost, nbThreads);
+        }
+
+        Lnz.resize(n);
+        data->column_schedule.run([&](const int * rows, int nbRows) {
+            LDLFactorizationWorkspace<Real> * workspace = workspaces.acquire();
+            workspace->resize(n);
+            bool success = true;
+            for (int r = 0 ; r < nbRows && success ; r++) {
+                success = CSPARSE_numeric_row<Real>(rows[r],n,M_colptr,M_rowind,M_values,colptr,rowind,values,D,data->perm.data(),data->invperm.data(),data->Parent.data(),Lnz.data(),*workspace);
+            }
+            workspaces.release(workspace);
+            return success;
+        });
+    }
+
+    /// Supernodal factorization (see LDL_supernode_numeric). If parallel is true, the independent subtrees of the tree of the supernodes
+    /// are computed by different tasks. The updates of each supernode are applied in the same order in both cases.
+    template<class VecInt,class VecReal>
+    void LDL_numeric_supernodal(int n,int * M_colptr,int * M_rowind,Real * M_values,Real * D,SparseLDLImplInvertData<VecInt,VecReal> * data, bool parallel = false) {
+        int * colptr = data->L_colptr.data();
+        int * rowind = data->L_rowind.data();
+        Real * values = data->L_values.data();
+
+        // the pattern of L and the supernodes only change with the symbolic factorization
+        if (data->new_factorization_needed || data->supernodes.empty()) {
+            Lnz.resize(n);
+            Flag.resize(n);
+            CSPARSE_pattern(n,M_colptr,M_rowind,colptr,rowind,data->perm.data(),data->invperm.data(),data->Parent.data(),Flag.data(),Lnz.data());
+            LDL_supernodes(n,colptr,data->Parent.data(),data->supernodes,data->column_supernode);
+            LDL_supernodal_updates(colptr,rowind,data->supernodes,data->column_supernode,
+                                   data->supernode_updateptr,data->supernode_updates,data->supernode_update_positions);
+            data->supernode_schedule.nbThreads = 0;
+            msg_info() << data->supernodes.size() - 1 << " supernodes for " << n << " columns" ;
+        }
+
+        const int nbSupernodes = (int) data->supernodes.size() - 1;
+        auto factorizeSupernodes = [&](const int * nodes, int nbNodes, LDLFactorizationWorkspace<Real>& workspace) {
+            workspace.resize(n);
+            bool success = true;
+            for (int i = 0 ; i < nbNodes && success ; i++) {
+                success = LDL_supernode_numeric<Real>(nodes[i],M_colptr,M_rowind,M_values,colptr,rowind,values,D,data->perm.data(),data->invperm.data(),
+                                                      data->supernodes,data->supernode_updateptr,data->supernode_updates,data->supernode_update_positions,workspace);
+            }
+            return success;
+        };
+
+        if (!parallel) {
+            supernodeOrder.resize(nbSupernodes);
+            for (int s = 0 ; s < nbSupernodes ; s++) supernodeOrder[s] = s;
+            factorizeSupernodes(supernodeOrder.data(), nbSupernodes, supernodalWorkspace);
+            return;
+        }
+
+        const int nbThreads = (int) sofa::simulation::TaskScheduler::getInstance()->getThreadCount();
+        if (data->supernode_schedule.nbThreads != nbThreads) {
+            type::vector<int> parent(nbSupernodes);
+            type::vector<double> cost(nbSupernodes);
+            for (int s = 0 ; s < nbSupernodes ; s++) {
+                const int last = data->supernodes[s+1] - 1;
+                const int nbBelow = colptr[last+1] - colptr[last];
+                const double nbRows = nbBelow + last - data->supernodes[s] + 1;
+                parent[s] = nbBelow > 0 ? data->column_supernode[rowind[colptr[last]]] : -1;
+                cost[s] = nbRows * nbRows * (last - data->supernodes[s] + 1);
+            }
+            data->supernode_schedule.build(nbSupernodes, parent.data(), cost, nbThreads);
+        }
+
+        data->supernode_schedule.run([&](const int * nodes, int nbNodes) {
+            LDLFactorizationWorkspace<Real> * workspace = workspaces.acquire();
+            const bool success = factorizeSupernodes(nodes, nbNodes, *workspace);
+            workspaces.release(workspace);
+            return success;
+        });
+    }
+
+    /// Factorize the matrix M, reusing the ordering and the symbolic factorization if its pattern did not change.
+    /// If supernodal is true, the numeric factorization is computed by supernodes instead of CSPARSE_numeric.
+    /// If parallel is true, the numeric factorization is computed by tasks of the TaskScheduler, and the level sets
+    /// used by solve_cpu to parallelize the triangular solves are computed. The factors do not depend on parallel.
     template<class VecInt,class VecReal>
-    void factorize(int n,int * M_colptr, int * M_rowind, Real * M_values, SparseLDLImplInvertData<VecInt,VecReal> * data) {
+    void factorize(int n,int * M_colptr, int * M_rowind, Real * M_values, SparseLDLImplInvertData<VecInt,VecReal> * data, bool supernodal = false, bool parallel = false) {
         data->new_factorization_needed = data->P_colptr.size() == 0 || data->P_rowind.size() == 0 || CSPARSE_need_symbolic_factorization(n, M_colptr, M_rowind, data->n,
                                                                                                                                          (int *) data->P_colptr.data(),(int *) data->P_rowind.data());
 
@@ -308,6 +727,9 @@ protected :
                          data->perm.data(),data->invperm.data(),data->Parent.data());
 
             data->L_nnz = data->L_colptr[data->n];
+            data->supernodes.clear();
+            data->column_schedule.nbThreads = 0;
+            data->levels = EliminationTreeLevels();
 
             data->L_rowind.clear();data->L_rowind.fastResize(data->L_nnz);
             data->L_values.clear();data->L_values.fastResize(data->L_nnz);
@@ -324,12 +746,20 @@ protected :
         Real * tran_values = data->LT_values.data();
 
         //Numeric Factorization
-        LDL_numeric(data->n,M_colptr,M_rowind,M_values,colptr,rowind,values,D,
-                    data->perm.data(),data->invperm.data(),data->Parent.data());
+        if (supernodal) {
+            LDL_numeric_supernodal(data->n,M_colptr,M_rowind,M_values,D,data,parallel);
+        } else if (parallel) {
+            LDL_numeric_parallel(data->n,M_colptr,M_rowind,M_values,D,data);
+        } else {
+            LDL_numeric(data->n,M_colptr,M_rowind,M_values,colptr,rowind,values,D,
+                        data->perm.data(),data->invperm.data(),data->Parent.data());
+        }
 
         //inverse the diagonal
         for (int i=0;i<data->n;i++) D[i] = 1.0/D[i];
 
+        if (parallel && data->levels.empty()) data->levels.build(data->n, data->Parent.data());
+
         // split the bloc diag in data->Bdiag
 
         if (data->new_factorization_needed) {
@@ -365,6 +795,9 @@ protected : //the folowing variables are used during the factorization they cann
     type::vector<Real> Y;
     type::vector<int> Lnz,Flag,Pattern;
     type::vector<int> tran_countvec;
+    type::vector<int> supernodeOrder;
+    LDLFactorizationWorkspace<Real> supernodalWorkspace;
+    WorkspacePool<LDLFactorizationWorkspace<Real> > workspaces;
 
 //    type::vector<int> perm, invperm; //premutation inverse
 